@@ -0,0 +1,167 @@
+//
+//  @file MipCommand_Sample20261018.ino
+//  @brief MIP command encoder and field decoder sample code
+//  @author SagaraLab
+//  @date 2026/10/18
+//  @copyright SagaraLab 2026
+//
+
+//
+//   MipCommand_Sample20261018.inoはMipCommandで3DM-CV7-AHRSにオイラー角のストリームを設定し(ACK/NACKはMipExecutorで待ちます)、
+//   受信したパケットからMipFieldReaderとMipConvでオイラー角を取り出して表示するサンプルコードです。
+//   MipCommand_Sample20261018.ino is a sample code that configures the Euler angle stream of the 3DM-CV7-AHRS
+//   with MipCommand (MipExecutor waits for the ACK/NACK), and decodes the received angles with MipFieldReader and MipConv.
+//
+
+//
+//  Sample Board : Teensy4.1
+//  Teensy4.1 <=> 3DM-CV7-AHRS
+//  USB Host(5pin header) <=> USB
+//
+
+
+#include <Arduino.h>
+
+#include "USBHost_t36.h"
+#include <MipParser.h>
+
+USBHost myusb;
+USBHub hub1(myusb);
+USBSerial userial(myusb, 1);
+
+MipRing<4096> ring;
+MipIngest ingest;
+MipFramer framer;
+MipExecutor executor;
+
+float rpy[3] = {0.0f, 0.0f, 0.0f};  // Roll, Pitch, Yaw [rad]
+unsigned long eulerCount = 0;       // オイラー角の受信数
+unsigned long malformedCount = 0;   // 壊れたフィールドがあったパケットの数
+
+// 完成したパケットを受け取ります
+void onPacket(const uint8_t *packet, int length, void *context)
+{
+  (void)length;
+  (void)context;
+
+  // コマンドの返信(ACK/NACK)
+  if(executor.handlePacket(packet, millis()))
+  {
+    return;
+  }
+
+  if(packet[MIP::BuffPter::Descriptor] != MIP::DescSet::Filter)
+  {
+    return;
+  }
+
+  // フィールドを順番に取り出す(データはコピーしない)
+  MipFieldReader reader(packet);
+  MipField field;
+  while(reader.next(field))
+  {
+    if(field.descriptor == MIP::FilterField::Euler && field.length >= 12)
+    {
+      MipConv::toVector3f(field.data, rpy);
+      eulerCount++;
+    }
+  }
+  if(reader.isMalformed())
+  {
+    malformedCount++;
+  }
+}
+
+// コマンドの結果を受け取ります
+void onResult(const MipExecutor::Result &result, const uint8_t *reply, void *context)
+{
+  (void)reply;
+  (void)context;
+
+  Serial.print("Command 0x");
+  Serial.print(result.descSet, HEX);
+  Serial.print("/0x");
+  Serial.print(result.fieldDesc, HEX);
+  Serial.print(" ");
+  Serial.print(MipExecutor::statusName(result.status));
+  Serial.print(" code=");
+  Serial.print(result.code);
+  Serial.print(" ");
+  Serial.print(result.latency);
+  Serial.println("ms");
+}
+
+// オイラー角のストリームを設定します
+// 送信はloopのexecutor.updateで行い、ACKを受信したらすぐ次のコマンドを送ります
+void configureSensor()
+{
+  MipCommand cmd;
+
+  // Set to Idle
+  cmd.buildIdle();
+  executor.enqueue(cmd);
+
+  // Message Format : 0x82にオイラー角(0x05)を分周比1で出力
+  const uint8_t fields[] = {MIP::FilterField::Euler};
+  const uint16_t decimation[] = {1};
+  cmd.buildMessageFormat(MIP::DescSet::Filter, fields, decimation, 1);
+  executor.enqueue(cmd);
+
+  // Enable Data Stream : 0x82を有効にする
+  cmd.buildEnableStream(MIP::DescSet::Filter, true);
+  executor.enqueue(cmd);
+}
+
+void setup() {
+
+  Serial.begin(115200);   // PCと通信を開始する
+
+  myusb.begin();
+  framer.setHandler(onPacket);
+  executor.setHandler(onResult);
+}
+
+
+void loop() {
+
+  static bool connected = false;
+  static unsigned long lastPrint = 0;
+
+  myusb.Task();
+
+  if(userial && !connected)
+  {
+    userial.begin(115200);
+    configureSensor();
+    connected = true;
+  }
+  else if(!userial && connected)
+  {
+    // 溜まっているデータと組み立て中のパケットは捨てる
+    ring.flush();
+    framer.reset();
+    executor.cancel();
+    connected = false;
+  }
+
+  ingest.read(userial, ring, micros());
+  framer.drain(ring);
+  executor.update(userial, millis());
+
+  // 1秒に1回、オイラー角を表示します
+  if(millis() - lastPrint >= 1000)
+  {
+    lastPrint = millis();
+
+    Serial.print("Roll=");
+    Serial.print(rpy[0] * 180.0f / PI, 2);
+    Serial.print(" Pitch=");
+    Serial.print(rpy[1] * 180.0f / PI, 2);
+    Serial.print(" Yaw=");
+    Serial.print(rpy[2] * 180.0f / PI, 2);
+    Serial.print(" Count=");
+    Serial.print(eulerCount);
+    Serial.print(" Malformed=");
+    Serial.println(malformedCount);
+  }
+}
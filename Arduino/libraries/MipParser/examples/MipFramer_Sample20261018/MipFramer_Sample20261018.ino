@@ -0,0 +1,113 @@
+//
+//  @file MipFramer_Sample20261018.ino
+//  @brief MIP framer sample code
+//  @author SagaraLab
+//  @date 2026/10/18
+//  @copyright SagaraLab 2026
+//
+
+//
+//   MipFramer_Sample20261018.inoはUSBホストに接続した3DM-CV7-AHRSからのデータを
+//   MipFramerでパケットに切り出し、ディスクリプタセットごとの受信数と通信エラーを表示するサンプルコードです。
+//   MipFramer_Sample20261018.ino is a sample code that frames the 3DM-CV7-AHRS stream on the USB host
+//   with MipFramer and shows the packet count per descriptor set and the link errors.
+//
+
+//
+//  Sample Board : Teensy4.1
+//  Teensy4.1 <=> 3DM-CV7-AHRS
+//  USB Host(5pin header) <=> USB
+//
+
+
+#include <Arduino.h>
+
+#include "USBHost_t36.h"
+#include <MipParser.h>
+
+USBHost myusb;
+USBHub hub1(myusb);
+USBSerial userial(myusb, 1);
+
+MipFramer framer;
+
+unsigned long imuCount = 0;     // 0x80の受信数
+unsigned long filterCount = 0;  // 0x82の受信数
+unsigned long otherCount = 0;   // その他の受信数
+
+// 完成したパケットを受け取ります
+void onPacket(const uint8_t *packet, int length, void *context)
+{
+  (void)length;
+  (void)context;
+
+  switch(packet[MIP::BuffPter::Descriptor])
+  {
+    case MIP::DescSet::Imu:
+      imuCount++;
+      break;
+    case MIP::DescSet::Filter:
+      filterCount++;
+      break;
+    default:
+      otherCount++;
+      break;
+  }
+}
+
+
+void setup() {
+
+  Serial.begin(115200);   // PCと通信を開始する
+
+  myusb.begin();
+  framer.setHandler(onPacket);
+}
+
+
+void loop() {
+
+  static bool connected = false;
+  static unsigned long lastPrint = 0;
+
+  myusb.Task();
+
+  if(userial && !connected)
+  {
+    userial.begin(115200);
+    connected = true;
+  }
+  else if(!userial && connected)
+  {
+    // 組み立て中のパケットは捨てる
+    framer.reset();
+    connected = false;
+  }
+
+  // 各byteは1回だけ処理されます
+  while(userial.available())
+  {
+    framer.push((uint8_t)userial.read());
+  }
+
+  // 1秒に1回、受信数とエラーを表示します
+  if(millis() - lastPrint >= 1000)
+  {
+    lastPrint = millis();
+
+    Serial.print("IMU=");
+    Serial.print(imuCount);
+    Serial.print(" Filter=");
+    Serial.print(filterCount);
+    Serial.print(" Other=");
+    Serial.print(otherCount);
+    Serial.print(" ChecksumError=");
+    Serial.print(framer.getChecksumErrorCount());
+    Serial.print(" SyncLoss=");
+    Serial.print(framer.getSyncLossCount());
+    Serial.print(" Discarded=");
+    Serial.print(framer.getDiscardedBytes());
+    Serial.print(" Oversize=");
+    Serial.println(framer.getOversizeCount());
+  }
+}
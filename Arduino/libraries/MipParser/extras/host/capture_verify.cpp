@@ -0,0 +1,213 @@
+/**
+* @file capture_verify.cpp
+* @brief  Host verification of MipCaptureWriter ring capture and MipCaptureReader resynchronisation
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details MipCaptureWriterのwriteRingが受信データを1回ずつ記録するか、MipCaptureReaderが偽の同期バイトの後ろのレコードを取り出せるか確認します。
+* @details * ring : MipRingへの書き込みとdrain(consume)の量を乱数で変え、記録したDataレコードをつなげたbyte列が受信したbyte列と一致するか確認します
+* @details * drop : 送信先の空きを乱数で変え、Dataレコードと捨てたbyte数(Gap)の合計が受信したbyte数と一致するか確認します
+* @details * reader : サイズが残りより大きい偽のヘッダーの後ろのレコードを取り出せるか、最後の途中で切れたレコードが読み残しになるか確認します
+*
+* g++ -std=gnu++11 -O2 -I../../src capture_verify.cpp ../../src/Mip*.cpp -o capture_verify
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "MipParser.h"
+
+namespace
+{
+    uint32_t seed = 12345;
+    uint32_t nextRandom()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return seed >> 8;
+    }
+
+    int failed = 0;
+
+    /// @brief 条件を確認し、結果を表示します
+    void expect(const char *name, bool ok)
+    {
+        printf("  %-60s %s\n", name, ok ? "ok" : "FAIL");
+        if(!ok)
+        {
+            failed++;
+        }
+    }
+
+    /// @brief 書き込んだbyte列を記録する送信先(空きはroomで変えられます)
+    struct Output
+    {
+        std::vector<uint8_t> bytes;
+        size_t room = 1 << 20;
+
+        int availableForWrite(){return (int)room;}
+        size_t write(const uint8_t *data, size_t length)
+        {
+            bytes.insert(bytes.end(), data, data + length);
+            return length;
+        }
+    };
+
+    /// @brief キャプチャのDataレコードをつなげ、Gapレコードのbyte数を数えます
+    void collect(const std::vector<uint8_t> &capture, std::vector<uint8_t> &data, uint32_t &gapBytes, uint32_t &records)
+    {
+        MipCaptureReader reader(capture.data(), capture.size());
+        MipCaptureRecord record;
+        gapBytes = 0;
+        records = 0;
+        while(reader.next(record))
+        {
+            records++;
+            if(record.type == MipCapture::Type::Data)
+            {
+                data.insert(data.end(), record.data, record.data + record.length);
+            }
+            else if(record.type == MipCapture::Type::Gap)
+            {
+                gapBytes += MipConv::toUint32(record.data);
+            }
+        }
+    }
+
+    /// @brief 1つのレコードを追加します
+    void addRecord(std::vector<uint8_t> &capture, uint8_t type, const uint8_t *data, uint16_t length, uint32_t stamp)
+    {
+        uint8_t header[MipCapture::HeaderSize];
+        MipCapture::encodeHeader(header, type, length, stamp);
+        uint16_t checksum = MipCapture::getChecksum(header, data, length);
+        capture.insert(capture.end(), header, header + sizeof(header));
+        capture.insert(capture.end(), data, data + length);
+        capture.push_back((uint8_t)(checksum >> 8));
+        capture.push_back((uint8_t)(checksum & 0xFF));
+    }
+}
+
+
+int main()
+{
+    //ring : writeRingの後にdrainが一部しかconsumeしなくても、同じbyteを2回記録しない
+    {
+        printf("ring\n");
+        MipRing<512> ring;
+        MipCaptureWriter writer;
+        Output out;
+        std::vector<uint8_t> received;
+
+        for(int loop = 0; loop < 5000; loop++)
+        {
+            uint8_t chunk[200];
+            size_t length = nextRandom() % sizeof(chunk);
+            for(size_t i = 0; i < length; i++)
+            {
+                chunk[i] = (uint8_t)nextRandom();
+            }
+            size_t written = ring.write(chunk, length);
+            received.insert(received.end(), chunk, chunk + written);
+
+            writer.writeRing(out, ring, (uint32_t)loop);
+
+            //MipFramer::drainのように、パケットの途中までは残す
+            size_t available = ring.available();
+            ring.consume((nextRandom() % 4 == 0) ? available : nextRandom() % (available + 1));
+        }
+
+        std::vector<uint8_t> captured;
+        uint32_t gapBytes;
+        uint32_t records;
+        collect(out.bytes, captured, gapBytes, records);
+        printf("  %zu bytes received, %zu bytes captured in %u records\n", received.size(), captured.size(), records);
+        expect("captured bytes equal received bytes", captured == received);
+        expect("no gap", gapBytes == 0 && writer.getDroppedBytes() == 0);
+    }
+
+    //drop : 送信先の空きが足りない分はGapで知らせ、後でもう一度送らない
+    {
+        printf("drop\n");
+        MipRing<512> ring;
+        MipCaptureWriter writer;
+        Output out;
+        size_t receivedBytes = 0;
+
+        for(int loop = 0; loop < 5000; loop++)
+        {
+            uint8_t chunk[200];
+            size_t length = nextRandom() % sizeof(chunk);
+            memset(chunk, (uint8_t)loop, length);
+            receivedBytes += ring.write(chunk, length);
+
+            out.room = (nextRandom() % 3 == 0) ? 0 : 1 << 20;
+            writer.writeRing(out, ring, (uint32_t)loop);
+
+            size_t available = ring.available();
+            ring.consume((nextRandom() % 4 == 0) ? available : nextRandom() % (available + 1));
+        }
+        //最後の捨てた分をGapで送る
+        out.room = 1 << 20;
+        uint8_t last = 0;
+        ring.write(&last, 1);
+        receivedBytes++;
+        writer.writeRing(out, ring, 0);
+
+        std::vector<uint8_t> captured;
+        uint32_t gapBytes;
+        uint32_t records;
+        collect(out.bytes, captured, gapBytes, records);
+        printf("  %zu bytes received, %zu captured + %u dropped\n", receivedBytes, captured.size(), gapBytes);
+        expect("captured + gap bytes equal received bytes", captured.size() + gapBytes == receivedBytes);
+        expect("gap bytes equal getDroppedBytes", gapBytes == writer.getDroppedBytes() && gapBytes > 0);
+    }
+
+    //reader : 偽のヘッダーと途中で切れたレコード
+    {
+        printf("reader\n");
+        uint8_t data[40];
+        for(size_t i = 0; i < sizeof(data); i++)
+        {
+            data[i] = (uint8_t)i;
+        }
+
+        //サイズが残りより大きい偽のヘッダーの後ろに、正しいレコードが3つ
+        std::vector<uint8_t> capture;
+        const uint8_t falseSync[] = {MipCapture::Sync1, MipCapture::Sync2, MipCapture::Type::Data, 0x03, 0xF0, 0, 0, 0, 0};
+        capture.insert(capture.end(), falseSync, falseSync + sizeof(falseSync));
+        for(int i = 0; i < 3; i++)
+        {
+            addRecord(capture, MipCapture::Type::Data, data, sizeof(data), (uint32_t)i);
+        }
+        MipCaptureReader reader(capture.data(), capture.size());
+        MipCaptureRecord record;
+        int count = 0;
+        while(reader.next(record))
+        {
+            count++;
+        }
+        expect("records behind a false header are read", count == 3);
+        expect("false header is skipped", reader.getSkippedBytes() == sizeof(falseSync) && reader.getRemaining() == 0);
+
+        //最後のレコードが途中で切れている
+        std::vector<uint8_t> tail;
+        addRecord(tail, MipCapture::Type::Data, data, sizeof(data), 0);
+        addRecord(tail, MipCapture::Type::Data, data, sizeof(data), 1);
+        size_t cut = tail.size() - 10;
+        tail.resize(cut);
+        MipCaptureReader tailReader(tail.data(), tail.size());
+        count = 0;
+        while(tailReader.next(record))
+        {
+            count++;
+        }
+        size_t truncatedBytes = cut - (MipCapture::HeaderSize + sizeof(data) + MipCapture::ChecksumSize);
+        expect("truncated last record is left as remaining", count == 1 && tailReader.getRemaining() == truncatedBytes && tailReader.getSkippedBytes() == 0);
+        expect("next still returns false at the end", tailReader.next(record) == false && tailReader.getRemaining() == truncatedBytes);
+    }
+
+    printf("verify: %d failed\n", failed);
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+/**
+* @file checksum_verify.cpp
+* @brief  Host verification and benchmark of the word-at-a-time MIP Fletcher checksum
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details MipChecksum::update(4byteずつ)を、従来のスケッチの1byteずつの計算と比べます。
+* @details * verify : 生成したデータ(乱数、0x00/0xFFのみ、MIPパケット)で、長さ・先頭の位置(アライメント)・分割位置を変えて一致を確認します
+* @details * bench : パケットのサイズごとに1byteあたりの処理時間を比べます
+*
+* g++ -std=gnu++11 -O2 -I../../src checksum_verify.cpp ../../src/Mip*.cpp -o checksum_verify
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "MipParser.h"
+
+namespace
+{
+    // ===== 従来のスケッチの処理(比較用にそのまま移植) =====
+    // MipChecksumと同じく関数呼び出しの時間を含めて比べるため、インライン展開しない
+    __attribute__((noinline)) void calculateChecksum(const uint8_t* data, int length, uint8_t* checksum1, uint8_t* checksum2)
+    {
+        uint8_t sum1 = 0;
+        uint8_t sum2 = 0;
+        for (int i = 0; i < length; i++) {
+            sum1 = (sum1 + data[i]) & 0xFF;
+            sum2 = (sum2 + sum1) & 0xFF;
+        }
+        *checksum1 = sum1;
+        *checksum2 = sum2;
+    }
+
+    /// @brief 途中の値から続けて計算する版(分割して計算した時の確認用)
+    void referenceUpdate(uint8_t &sum1, uint8_t &sum2, const uint8_t *data, size_t length)
+    {
+        for(size_t i = 0; i < length; i++)
+        {
+            sum1 = (sum1 + data[i]) & 0xFF;
+            sum2 = (sum2 + sum1) & 0xFF;
+        }
+    }
+
+    uint32_t seed = 12345;
+    uint8_t nextByte()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return (uint8_t)(seed >> 16);
+    }
+
+    /// @brief データの種類
+    enum Pattern
+    {
+        Random = 0,
+        AllZero,
+        AllOne,     //0xFFのみ(レーンが最も大きくなる)
+        Packet,     //MIPパケットを並べたもの
+        PatternCount
+    };
+
+    void fill(uint8_t *data, size_t length, int pattern)
+    {
+        for(size_t i = 0; i < length; i++)
+        {
+            switch(pattern)
+            {
+                case AllZero: data[i] = 0x00; break;
+                case AllOne: data[i] = 0xFF; break;
+                default: data[i] = nextByte(); break;
+            }
+        }
+
+        if(pattern == Packet)
+        {
+            //オイラー角のパケットを埋める(最後のパケットは途中で切れてもよい)
+            for(size_t i = 0; i + 4 <= length; i += 24)
+            {
+                data[i] = MIP::Sync1;
+                data[i + 1] = MIP::Sync2;
+                data[i + 2] = MIP::DescSet::Filter;
+                data[i + 3] = 18;
+            }
+        }
+    }
+
+    double nowNs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+    }
+
+    volatile uint8_t sink;
+}
+
+
+int main()
+{
+    // ===== verify =====
+    const size_t maxLength = 1024;
+    static uint8_t buffer[maxLength + 8];
+    unsigned long cases = 0;
+    unsigned long errors = 0;
+
+    for(int pattern = 0; pattern < PatternCount; pattern++)
+    {
+        for(size_t length = 0; length <= maxLength; length++)
+        {
+            for(size_t offset = 0; offset < 8; offset++)
+            {
+                uint8_t *data = &buffer[offset];
+                fill(data, length, pattern);
+
+                //一度に計算
+                uint8_t r1, r2;
+                calculateChecksum(data, (int)length, &r1, &r2);
+                uint16_t fast = MipChecksum::getChecksum(data, length);
+                cases++;
+                if((uint8_t)(fast >> 8) != r1 || (uint8_t)(fast & 0xFF) != r2)
+                {
+                    errors++;
+                    printf("mismatch: pattern=%d length=%zu offset=%zu\n", pattern, length, offset);
+                }
+
+                //途中の値から分割して計算(MipFramerと同じ使い方)
+                uint8_t a1 = nextByte(), a2 = nextByte();
+                uint8_t b1 = a1, b2 = a2;
+                size_t split = (length == 0) ? 0 : (nextByte() % (length + 1));
+                referenceUpdate(a1, a2, data, length);
+                MipChecksum::update(b1, b2, data, split);
+                MipChecksum::update(b1, b2, &data[split], length - split);
+                cases++;
+                if(a1 != b1 || a2 != b2)
+                {
+                    errors++;
+                    printf("mismatch: pattern=%d length=%zu offset=%zu split=%zu\n", pattern, length, offset, split);
+                }
+            }
+        }
+    }
+
+    //MipFramer経由(受信しながら計算したチェックサムでパケットが通るか)
+    int framed = 0;
+    {
+        MipFramer framer;
+        std::vector<uint8_t> stream;
+        int expected = 0;
+        for(int payload = 2; payload <= MIP::MaxPayload; payload++)
+        {
+            uint8_t p[MIP::MaxPacket] = {MIP::Sync1, MIP::Sync2, MIP::DescSet::Filter, (uint8_t)payload, (uint8_t)payload, 0x05};
+            for(int i = 6; i < 4 + payload; i++) p[i] = nextByte();
+            MipChecksum::setChecksum(p);
+            stream.insert(stream.end(), p, p + 4 + payload + 2);
+            expected++;
+        }
+        for(size_t i = 0; i < stream.size(); )
+        {
+            size_t chunk = 1 + nextByte() % 64;
+            if(chunk > stream.size() - i) chunk = stream.size() - i;
+            framed += framer.push(&stream[i], chunk);
+            i += chunk;
+        }
+        cases++;
+        if(framed != expected || framer.getChecksumErrorCount() != 0)
+        {
+            errors++;
+            printf("framer: %d/%d packets, %u checksum errors\n", framed, expected, (unsigned)framer.getChecksumErrorCount());
+        }
+    }
+
+    printf("verify: %lu cases, %lu errors, framer %d packets\n", cases, errors, framed);
+
+    // ===== bench =====
+    //256KBの乱数の上を順番にずらして計算する(キャッシュに乗る大きさ、毎回違うデータ)
+    const size_t lengths[] = {8, 16, 24, 33, 34, 48, 64, 127, 261, 1024};
+    const size_t areaSize = 256 * 1024;
+    const size_t total = 64 * 1024 * 1024;     //各サイズで計算するbyte数
+    std::vector<uint8_t> area(areaSize + maxLength);
+    fill(area.data(), area.size(), Random);
+
+    printf("length[byte] byte[ns/byte] word[ns/byte] speedup\n");
+
+    for(size_t length : lengths)
+    {
+        size_t loops = total / length;
+        uint8_t x = 0;
+
+        double start = nowNs();
+        for(size_t i = 0, pos = 0; i < loops; i++)
+        {
+            uint8_t c1, c2;
+            calculateChecksum(&area[pos], (int)length, &c1, &c2);
+            x ^= c1 ^ c2;
+            pos += length;
+            if(pos >= areaSize) pos = 0;
+        }
+        double byteNs = (nowNs() - start) / (double)(loops * length);
+
+        start = nowNs();
+        for(size_t i = 0, pos = 0; i < loops; i++)
+        {
+            uint16_t checksum = MipChecksum::getChecksum(&area[pos], length);
+            x ^= (uint8_t)(checksum ^ (checksum >> 8));
+            pos += length;
+            if(pos >= areaSize) pos = 0;
+        }
+        double wordNs = (nowNs() - start) / (double)(loops * length);
+        sink = x;
+
+        printf("%12zu %13.3f %13.3f %7.1fx\n", length, byteNs, wordNs, byteNs / wordNs);
+    }
+
+    return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,266 @@
+/**
+* @file convert_bench.cpp
+* @brief  Host verification and benchmark of the batched MIP big-endian vector decoders
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details MipConv::toFloats等(ベクトルをまとめて変換)を、従来のスケッチの1つずつの変換(parseFloat)と比べます。
+* @details * verify : 乱数のbit列(NaN・非正規化数を含む)で、変換結果のbitが一致することを確認します
+* @details * bench : float x3(オイラー角等)、float x4(クォータニオン)、double x3、度への変換で1ベクトルあたりの処理時間を比べます
+*
+* g++ -std=gnu++11 -O2 -I../../src convert_bench.cpp ../../src/Mip*.cpp -o convert_bench
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <vector>
+
+#include "MipParser.h"
+
+namespace
+{
+    // ===== 従来のスケッチの処理(比較用にそのまま移植) =====
+    // MipConvと同じく関数呼び出しの時間を含めて比べるため、インライン展開しない
+    __attribute__((noinline)) float parseFloat(const uint8_t* bytes) {
+      union {
+        float f;
+        uint8_t b[4];
+      } u;
+
+      // ビッグエンディアンからリトルエンディアンへ変換
+      u.b[0] = bytes[3];
+      u.b[1] = bytes[2];
+      u.b[2] = bytes[1];
+      u.b[3] = bytes[0];
+
+      return u.f;
+    }
+
+    /// @brief doubleを1byteずつ並べ替える版(parseFloatと同じ書き方)
+    __attribute__((noinline)) double parseDouble(const uint8_t* bytes) {
+      union {
+        double d;
+        uint8_t b[8];
+      } u;
+
+      for (int i = 0; i < 8; i++) {
+        u.b[i] = bytes[7 - i];
+      }
+      return u.d;
+    }
+
+    uint32_t seed = 12345;
+    uint8_t nextByte()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return (uint8_t)(seed >> 16);
+    }
+
+    bool sameBits(const void *a, const void *b, size_t size)
+    {
+        return memcmp(a, b, size) == 0;
+    }
+
+    double nowNs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+    }
+
+    volatile float sinkF;
+    volatile double sinkD;
+}
+
+
+int main()
+{
+    // ===== verify =====
+    const size_t areaSize = 64 * 1024;
+    std::vector<uint8_t> area(areaSize + 32);
+    for(size_t i = 0; i < area.size(); i++)
+    {
+        area[i] = nextByte();
+    }
+
+    unsigned long cases = 0;
+    unsigned long errors = 0;
+
+    for(size_t pos = 0; pos + 32 <= area.size(); pos += 3)     //3byteずつずらしてアライメントも変える
+    {
+        const uint8_t *data = &area[pos];
+
+        float batch[4];
+        MipConv::toVector4f(data, batch);
+        for(int i = 0; i < 4; i++)
+        {
+            float ref = parseFloat(&data[i * 4]);
+            cases++;
+            if(!sameBits(&ref, &batch[i], sizeof(float)))
+            {
+                errors++;
+                printf("float mismatch: pos=%zu index=%d\n", pos, i);
+            }
+        }
+
+        double batchD[3];
+        MipConv::toVector3d(data, batchD);
+        for(int i = 0; i < 3; i++)
+        {
+            double ref = parseDouble(&data[i * 8]);
+            cases++;
+            if(!sameBits(&ref, &batchD[i], sizeof(double)))
+            {
+                errors++;
+                printf("double mismatch: pos=%zu index=%d\n", pos, i);
+            }
+        }
+
+        //単位の変換はfloatで掛けたものと一致する(NaNは比べない)
+        float deg[3];
+        MipConv::toFloats(data, deg, 3, MipConv::RadToDeg);
+        for(int i = 0; i < 3; i++)
+        {
+            float ref = parseFloat(&data[i * 4]) * MipConv::RadToDeg;
+            cases++;
+            if(!isnan(ref) && !sameBits(&ref, &deg[i], sizeof(float)))
+            {
+                errors++;
+                printf("scale mismatch: pos=%zu index=%d\n", pos, i);
+            }
+        }
+    }
+
+    printf("verify: %lu cases, %lu errors\n", cases, errors);
+
+    // ===== bench =====
+    //有限の値だけのフィールドを並べる(NaN・非正規化数で計算が遅くならないように)
+    const size_t stride = 28;   //フィールドの間隔(Length, Descriptor + float x4 + valid flags + 余り)
+    const size_t vectors = areaSize / stride;
+    for(size_t v = 0; v < vectors; v++)
+    {
+        for(int i = 0; i < 4; i++)
+        {
+            MipConv::fromFloat((float)((int)(nextByte() % 200) - 100) * 0.0314f, &area[v * stride + i * 4]);
+        }
+    }
+    const size_t loops = 20 * 1000 * 1000;
+
+    printf("case                 per-float[ns] batched[ns] speedup\n");
+
+    //float x3
+    {
+        float x = 0.0f;
+        double start = nowNs();
+        for(size_t i = 0, v = 0; i < loops; i++)
+        {
+            const uint8_t *data = &area[v * stride];
+            float r = parseFloat(&data[0]);
+            float p = parseFloat(&data[4]);
+            float y = parseFloat(&data[8]);
+            x += r + p + y;
+            if(++v == vectors) v = 0;
+        }
+        double perNs = (nowNs() - start) / loops;
+
+        start = nowNs();
+        for(size_t i = 0, v = 0; i < loops; i++)
+        {
+            float rpy[3];
+            MipConv::toVector3f(&area[v * stride], rpy);
+            x += rpy[0] + rpy[1] + rpy[2];
+            if(++v == vectors) v = 0;
+        }
+        double batchNs = (nowNs() - start) / loops;
+        sinkF = x;
+        printf("float x3             %13.2f %11.2f %6.1fx\n", perNs, batchNs, perNs / batchNs);
+    }
+
+    //float x4
+    {
+        float x = 0.0f;
+        double start = nowNs();
+        for(size_t i = 0, v = 0; i < loops; i++)
+        {
+            const uint8_t *data = &area[v * stride];
+            for(int k = 0; k < 4; k++)
+            {
+                x += parseFloat(&data[k * 4]);
+            }
+            if(++v == vectors) v = 0;
+        }
+        double perNs = (nowNs() - start) / loops;
+
+        start = nowNs();
+        for(size_t i = 0, v = 0; i < loops; i++)
+        {
+            float q[4];
+            MipConv::toVector4f(&area[v * stride], q);
+            x += q[0] + q[1] + q[2] + q[3];
+            if(++v == vectors) v = 0;
+        }
+        double batchNs = (nowNs() - start) / loops;
+        sinkF = x;
+        printf("float x4             %13.2f %11.2f %6.1fx\n", perNs, batchNs, perNs / batchNs);
+    }
+
+    //double x3
+    {
+        double x = 0.0;
+        double start = nowNs();
+        for(size_t i = 0, v = 0; i < loops; i++)
+        {
+            const uint8_t *data = &area[v * stride];
+            x += parseDouble(&data[0]) + parseDouble(&data[8]) + parseDouble(&data[16]);
+            if(++v == vectors) v = 0;
+        }
+        double perNs = (nowNs() - start) / loops;
+
+        start = nowNs();
+        for(size_t i = 0, v = 0; i < loops; i++)
+        {
+            double d[3];
+            MipConv::toVector3d(&area[v * stride], d);
+            x += d[0] + d[1] + d[2];
+            if(++v == vectors) v = 0;
+        }
+        double batchNs = (nowNs() - start) / loops;
+        sinkD = x;
+        printf("double x3            %13.2f %11.2f %6.1fx\n", perNs, batchNs, perNs / batchNs);
+    }
+
+    //float x3 → 度(従来: double で180.0/PIを掛ける、batched: floatで掛ける)
+    {
+        float x = 0.0f;
+        double start = nowNs();
+        for(size_t i = 0, v = 0; i < loops; i++)
+        {
+            const uint8_t *data = &area[v * stride];
+            float r = parseFloat(&data[0]) * 180.0 / M_PI;
+            float p = parseFloat(&data[4]) * 180.0 / M_PI;
+            float y = parseFloat(&data[8]) * 180.0 / M_PI;
+            x += r + p + y;
+            if(++v == vectors) v = 0;
+        }
+        double perNs = (nowNs() - start) / loops;
+
+        start = nowNs();
+        for(size_t i = 0, v = 0; i < loops; i++)
+        {
+            float rpy[3];
+            MipConv::toFloats(&area[v * stride], rpy, 3, MipConv::RadToDeg);
+            x += rpy[0] + rpy[1] + rpy[2];
+            if(++v == vectors) v = 0;
+        }
+        double batchNs = (nowNs() - start) / loops;
+        sinkF = x;
+        printf("float x3 -> deg      %13.2f %11.2f %6.1fx\n", perNs, batchNs, perNs / batchNs);
+    }
+
+    return (errors == 0) ? 0 : 1;
+}
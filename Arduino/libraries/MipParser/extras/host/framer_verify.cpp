@@ -0,0 +1,271 @@
+/**
+* @file framer_verify.cpp
+* @brief  Host verification of MipFramer resynchronisation after false syncs and checksum errors
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details 偽の同期バイト・チェックサムエラー・途中で切れたパケットの後ろにある正しいパケットを、MipFramerがすべて取り出せるか確認します。
+* @details * 各ケースのパケットには通し番号を入れ、取り出したパケットの番号の並びが、ストリームに入れた正しいパケットの並びと一致するか確認します
+* @details * ストリームは1byteずつ・いくつかのサイズのチャンク・まとめて1回で渡し、pushの分け方で結果が変わらないことも確認します
+* @details * randomは、mip_benchと同じ形のゴミ(4回に1回は同期バイトで始まる)・チェックサムエラーを混ぜたストリームです
+*
+* g++ -std=gnu++11 -O2 -I../../src framer_verify.cpp ../../src/Mip*.cpp -o framer_verify
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "MipParser.h"
+
+namespace
+{
+    constexpr uint8_t SequenceField = 0x01;    //通し番号を入れるフィールド
+
+    uint32_t seed = 12345;
+    uint32_t nextRandom()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return seed >> 8;
+    }
+
+    /// @brief 1つのケース(ストリームと、取り出せるはずの通し番号)
+    struct Case
+    {
+        const char *name;
+        std::vector<uint8_t> bytes;
+        std::vector<uint32_t> expected;
+        uint32_t nextSequence = 0;
+    };
+
+    /// @brief 通し番号とpadding[byte]の詰め物を入れたパケットを作ります
+    int makePacket(MipCommand &packet, uint32_t sequence, int padding)
+    {
+        packet.begin(MIP::DescSet::Filter);
+        packet.beginField(SequenceField);
+        packet.addU32(sequence);
+        for(int i = 0; i < padding; i++)
+        {
+            packet.addU8((uint8_t)(sequence + i));
+        }
+        packet.endField();
+        return packet.finish();
+    }
+
+    /// @brief 正しいパケットを追加します
+    void addValid(Case &c, int padding=8)
+    {
+        MipCommand packet;
+        int length = makePacket(packet, c.nextSequence, padding);
+        c.bytes.insert(c.bytes.end(), packet.getData(), packet.getData() + length);
+        c.expected.push_back(c.nextSequence++);
+    }
+
+    /// @brief チェックサムを壊したパケットを追加します
+    void addCorrupt(Case &c, int padding=8)
+    {
+        MipCommand packet;
+        int length = makePacket(packet, c.nextSequence++, padding);
+        size_t start = c.bytes.size();
+        c.bytes.insert(c.bytes.end(), packet.getData(), packet.getData() + length);
+        c.bytes[start + length - 3] ^= 0x5A;
+    }
+
+    /// @brief 先頭のlength[byte]だけ届いたパケット(USBの取りこぼし)を追加します
+    void addTruncated(Case &c, int length, int padding=40)
+    {
+        MipCommand packet;
+        makePacket(packet, c.nextSequence++, padding);
+        c.bytes.insert(c.bytes.end(), packet.getData(), packet.getData() + length);
+    }
+
+    /// @brief 偽のヘッダ(同期バイト、ディスクリプタ、Length)を追加します
+    void addFalseSync(Case &c, uint8_t length)
+    {
+        const uint8_t header[] = {MIP::Sync1, MIP::Sync2, MIP::DescSet::Filter, length};
+        c.bytes.insert(c.bytes.end(), header, header + sizeof(header));
+    }
+
+    /// @brief 偽の同期バイトだけを追加します(次のパケットの先頭がディスクリプタ・Lengthとして読まれる)
+    void addSyncOnly(Case &c)
+    {
+        c.bytes.push_back(MIP::Sync1);
+        c.bytes.push_back(MIP::Sync2);
+    }
+
+    /// @brief 取り出したパケットの通し番号
+    struct Collected
+    {
+        std::vector<uint32_t> sequences;
+        uint32_t malformed = 0;
+    };
+
+    void onPacket(const uint8_t *packet, int length, void *context)
+    {
+        Collected *collected = (Collected *)context;
+        if(length < MIP::HeaderLength + 6 + MIP::ChecksumLength || packet[MIP::BuffPter::Payload + 1] != SequenceField)
+        {
+            collected->malformed++;
+            return;
+        }
+        const uint8_t *p = &packet[MIP::BuffPter::Payload + 2];
+        collected->sequences.push_back(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]);
+    }
+
+    /// @brief チャンクのサイズを変えてケースを流し、結果を表示します
+    bool runCase(const Case &c)
+    {
+        const size_t chunks[] = {1, 3, 17, 64, (size_t)-1};
+        bool ok = true;
+
+        for(size_t chunk : chunks)
+        {
+            MipFramer framer;
+            Collected collected;
+            framer.setHandler(onPacket, &collected);
+
+            int framed = 0;
+            for(size_t i = 0; i < c.bytes.size(); i += chunk)
+            {
+                size_t length = (c.bytes.size() - i < chunk) ? c.bytes.size() - i : chunk;
+                framed += framer.push(&c.bytes[i], length);
+            }
+
+            bool match = (collected.sequences == c.expected) && collected.malformed == 0 && framed == (int)c.expected.size();
+            if(!match)
+            {
+                ok = false;
+            }
+
+            if(!match || chunk == (size_t)-1)
+            {
+                printf("%-24s chunk=%-5d %s: %zu/%zu packets, returned %d, %u checksum errors, %u rescans, %u discarded\n",
+                       c.name, (chunk == (size_t)-1) ? -1 : (int)chunk, match ? "ok  " : "FAIL",
+                       collected.sequences.size(), c.expected.size(), framed,
+                       (unsigned)framer.getChecksumErrorCount(), (unsigned)framer.getRescanCount(), (unsigned)framer.getDiscardedBytes());
+            }
+        }
+
+        return ok;
+    }
+}
+
+
+int main()
+{
+    std::vector<Case> cases;
+
+    //偽の同期バイトと大きなLengthの後ろに、正しいパケットが続く
+    {
+        Case c;
+        c.name = "false_sync_long";
+        addValid(c);
+        addFalseSync(c, 0xF0);
+        for(int i = 0; i < 20; i++) addValid(c);
+        cases.push_back(c);
+    }
+
+    //同期バイトだけの後ろに正しいパケット(パケットのSync1・Sync2がディスクリプタ・Lengthとして読まれる)
+    {
+        Case c;
+        c.name = "false_sync_then_packet";
+        addSyncOnly(c);
+        for(int i = 0; i < 10; i++) addValid(c);
+        cases.push_back(c);
+    }
+
+    //偽のパケットの中に、さらに偽の同期バイトがある
+    {
+        Case c;
+        c.name = "nested_false_sync";
+        addFalseSync(c, 0xC8);
+        addFalseSync(c, 0x40);
+        addSyncOnly(c);
+        for(int i = 0; i < 20; i++) addValid(c);
+        cases.push_back(c);
+    }
+
+    //チェックサムエラーのパケットの直後に正しいパケット
+    {
+        Case c;
+        c.name = "corrupt_then_valid";
+        for(int i = 0; i < 5; i++)
+        {
+            addCorrupt(c);
+            addValid(c);
+        }
+        cases.push_back(c);
+    }
+
+    //途中で切れたパケットが、後ろのパケットを自分のペイロードとして読む
+    {
+        Case c;
+        c.name = "truncated_then_valid";
+        for(int i = 0; i < 5; i++)
+        {
+            addTruncated(c, 10 + i * 7);
+            addValid(c);
+            addValid(c, 2);
+        }
+        cases.push_back(c);
+    }
+
+    //サイズ異常のヘッダ(Length 0・1、ディスクリプタが同期バイト)の後ろに正しいパケット
+    {
+        Case c;
+        c.name = "oversize_then_valid";
+        addFalseSync(c, 0x00);
+        addValid(c);
+        addSyncOnly(c);
+        c.bytes.push_back(MIP::Sync1);
+        c.bytes.push_back(0x01);
+        addValid(c);
+        addValid(c);
+        cases.push_back(c);
+    }
+
+    //mip_benchと同じ形のゴミ・チェックサムエラーを混ぜたストリーム
+    {
+        Case c;
+        c.name = "random";
+        for(int i = 0; i < 20000; i++)
+        {
+            if(nextRandom() % 100 < 5)
+            {
+                int count = 1 + (int)(nextRandom() % 32);
+                bool fakeSync = (nextRandom() % 4) == 0;
+                for(int k = 0; k < count; k++)
+                {
+                    uint8_t b = (uint8_t)nextRandom();
+                    if(fakeSync && k == 0) b = MIP::Sync1;
+                    if(fakeSync && k == 1) b = MIP::Sync2;
+                    c.bytes.push_back(b);
+                }
+            }
+
+            int padding = (int)(nextRandom() % 60);
+            switch(nextRandom() % 100)
+            {
+                case 0: addCorrupt(c, padding); break;
+                case 1: addTruncated(c, 1 + (int)(nextRandom() % 20), padding + 20); break;
+                default: addValid(c, padding); break;
+            }
+        }
+        cases.push_back(c);
+    }
+
+    int failed = 0;
+    for(const Case &c : cases)
+    {
+        if(!runCase(c))
+        {
+            failed++;
+        }
+    }
+
+    printf("verify: %zu cases, %d failed\n", cases.size(), failed);
+    return (failed == 0) ? 0 : 1;
+}
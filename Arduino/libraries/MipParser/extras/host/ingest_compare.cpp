@@ -0,0 +1,275 @@
+/**
+* @file ingest_compare.cpp
+* @brief  Host comparison of the byte-at-a-time and bulk MIP ingest paths
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details 100Hz～1kHzのAHRSストリームを模擬して、loop()内の受信処理にかかる時間を比べます。
+* @details * old : 1byteずつread()してmillis()を記録し、毎回processBuffer()で先頭から探し直す(従来のスケッチ)
+* @details * bulk : MipIngest(標準、available()の分だけread())でMipRingへ移し、MipFramerで1回だけ処理する
+* @details * readBytes : MipIngestのsetBulkRead(true)で、StreamのreadBytes(1byteごとにmillis()・read()を呼ぶtimedRead)を使った場合
+* @details USBHost_t36のUSBSerialと同じく、read()は関数呼び出し1回、readBytesはStreamの既定の処理にしています。
+* @details 実機(Teensy)の時間はこの比と同じになるとは限りません。
+*
+* g++ -std=gnu++11 -O2 -I../../src ingest_compare.cpp ../../src/Mip*.cpp -o ingest_compare
+**/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "MipParser.h"
+
+namespace
+{
+    volatile uint32_t fakeMillis = 0;
+    __attribute__((noinline)) uint32_t millis(){return fakeMillis;}
+
+    /// @brief USBSerialの代わり(available/read/readBytesのみ)
+    /// @details USBHost_t36のUSBSerialと同じく、read()はインライン展開せず、readBytesはStream::readBytes(timedReadの繰り返し)と同じ処理にします
+    class FakeSerial
+    {
+        public:
+            const uint8_t *data = nullptr;
+            size_t end = 0;     //ここまで受信済み
+            size_t pos = 0;     //ここまで読み出し済み
+            unsigned long timeout = 1000;
+
+            int available(){return (int)(end - pos);}
+            __attribute__((noinline)) int read(){return (pos < end) ? data[pos++] : -1;}
+            size_t readBytes(char *buffer, size_t length)
+            {
+                size_t count = 0;
+                while(count < length)
+                {
+                    int c = timedRead();
+                    if(c < 0)
+                    {
+                        break;
+                    }
+                    *buffer++ = (char)c;
+                    count++;
+                }
+                return count;
+            }
+
+        private:
+            int timedRead()
+            {
+                unsigned long startMillis = millis();
+                do
+                {
+                    int c = read();
+                    if(c >= 0)
+                    {
+                        return c;
+                    }
+                } while(millis() - startMillis < timeout);
+                return -1;
+            }
+    };
+
+    int handled = 0;
+
+    // ===== 従来のスケッチの処理(比較用にそのまま移植) =====
+    uint8_t buffer[1024];
+    int bufferIndex = 0;
+    unsigned long lastActivityTime = 0;
+
+    void calculateChecksum(const uint8_t* data, int length, uint8_t* checksum1, uint8_t* checksum2)
+    {
+        uint8_t sum1 = 0;
+        uint8_t sum2 = 0;
+        for (int i = 0; i < length; i++) {
+            sum1 = (sum1 + data[i]) & 0xFF;
+            sum2 = (sum2 + sum1) & 0xFF;
+        }
+        *checksum1 = sum1;
+        *checksum2 = sum2;
+    }
+
+    bool verifyChecksum(const uint8_t* packet, int length)
+    {
+        uint8_t c1, c2;
+        calculateChecksum(packet, length - 2, &c1, &c2);
+        return (packet[length - 2] == c1 && packet[length - 1] == c2);
+    }
+
+    void shiftBuffer()
+    {
+        int shiftAmount = bufferIndex / 2;
+        memmove(buffer, &buffer[shiftAmount], bufferIndex - shiftAmount);
+        bufferIndex -= shiftAmount;
+    }
+
+    void processBuffer()
+    {
+        int processedBytes = 0;
+        while (processedBytes < bufferIndex - 3) {
+            bool foundPacket = false;
+            for (int i = processedBytes; i <= bufferIndex - 4; i++) {
+                if (buffer[i] == 0x75 && buffer[i+1] == 0x65) {
+                    uint8_t length = buffer[i+3];
+                    int packetSize = 4 + length + 2;
+                    if (i + packetSize <= bufferIndex) {
+                        if (verifyChecksum(&buffer[i], packetSize)) {
+                            handled++;
+                        }
+                        processedBytes = i + packetSize;
+                        foundPacket = true;
+                        break;
+                    } else {
+                        processedBytes = i;
+                        foundPacket = false;
+                        break;
+                    }
+                }
+            }
+            if (!foundPacket) break;
+        }
+        if (processedBytes > 0) {
+            memmove(buffer, &buffer[processedBytes], bufferIndex - processedBytes);
+            bufferIndex -= processedBytes;
+        }
+    }
+
+    void readOld(FakeSerial &serial)
+    {
+        while (serial.available()) {
+            if (bufferIndex >= (int)(sizeof(buffer) - 1)) {
+                shiftBuffer();
+            }
+            buffer[bufferIndex++] = (uint8_t)serial.read();
+            lastActivityTime = millis();
+            processBuffer();
+        }
+    }
+
+    // ===== 新しい処理 =====
+    MipRing<4096> ring;
+    MipFramer framer;
+    MipIngest ingest;
+
+    void onPacket(const uint8_t *, int, void *){handled++;}
+
+    void readBulk(FakeSerial &serial, uint32_t now)
+    {
+        ingest.read(serial, ring, now);
+        framer.drain(ring);
+    }
+
+    // ===== ストリームの生成 =====
+    // 0x82: オイラー角(0x05, 16byte) + 角速度(0x0E, 14byte)
+    std::vector<uint8_t> makeStream(int packets)
+    {
+        std::vector<uint8_t> out;
+        for(int n = 0; n < packets; n++)
+        {
+            uint8_t p[4 + 30 + 2] = {0x75, 0x65, 0x82, 30, 16, 0x05};
+            for(int i = 6; i < 20; i++) p[i] = (uint8_t)(n + i);
+            p[20] = 14;
+            p[21] = 0x0E;
+            for(int i = 22; i < 34; i++) p[i] = (uint8_t)(n * 3 + i);
+            uint8_t c1, c2;
+            calculateChecksum(p, 34, &c1, &c2);
+            p[34] = c1;
+            p[35] = c2;
+            out.insert(out.end(), p, p + sizeof(p));
+        }
+        return out;
+    }
+
+    double nowNs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+    }
+
+    /// @brief 1秒分のストリームをloopPeriod[us]ごとのloop()で受信した時の処理時間[us]を返します
+    /// @brief 比べる処理
+    enum Path
+    {
+        Old = 0,
+        Bulk,
+        ReadBytes
+    };
+
+    double run(const std::vector<uint8_t> &stream, int rateHz, int loopPeriodUs, Path path)
+    {
+        FakeSerial serial;
+        serial.data = stream.data();
+        size_t packetSize = stream.size() / rateHz;
+
+        handled = 0;
+        bufferIndex = 0;
+        ring.flush();
+        framer.reset();
+        ingest.setBulkRead(path == ReadBytes);
+
+        //時刻の取得はloopの外で行い、受信データがない呼び出しも含めた合計を測る
+        double start = nowNs();
+        for(int t = 0; t < 1000000; t += loopPeriodUs)
+        {
+            //この時刻までに届いたパケット
+            size_t arrived = (size_t)((long long)(t + loopPeriodUs) * rateHz / 1000000) * packetSize;
+            serial.end = (arrived < stream.size()) ? arrived : stream.size();
+            fakeMillis = t / 1000;
+
+            if(path == Old)
+            {
+                readOld(serial);
+            }
+            else
+            {
+                readBulk(serial, (uint32_t)t);
+            }
+        }
+        double spent = nowNs() - start;
+
+        return spent / 1000.0;
+    }
+}
+
+
+int main()
+{
+    framer.setHandler(onPacket);
+
+    const int rates[] = {100, 200, 500, 1000};     //200HzはPD制御の周期、1000Hzは3DM-CV7-AHRSの基本周波数
+    const int loops[] = {100, 1000, 5000};   //loop()の周期[us](5000はPD制御でPMX通信に待たされる場合)
+    const int repeat = 20;
+
+    printf("rate[Hz] loop[us] old[us/s] bulk[us/s] readBytes[us/s] speedup packets(old/bulk/readBytes)\n");
+
+    for(int rate : rates)
+    {
+        std::vector<uint8_t> stream = makeStream(rate);
+
+        for(int loopUs : loops)
+        {
+            double oldUs = 0, bulkUs = 0, readBytesUs = 0;
+            int oldPackets = 0, bulkPackets = 0, readBytesPackets = 0;
+
+            for(int r = 0; r < repeat; r++)
+            {
+                oldUs += run(stream, rate, loopUs, Old);
+                oldPackets = handled;
+                bulkUs += run(stream, rate, loopUs, Bulk);
+                bulkPackets = handled;
+                readBytesUs += run(stream, rate, loopUs, ReadBytes);
+                readBytesPackets = handled;
+            }
+            oldUs /= repeat;
+            bulkUs /= repeat;
+            readBytesUs /= repeat;
+
+            printf("%8d %8d %10.1f %10.1f %15.1f %7.1fx %d/%d/%d\n", rate, loopUs, oldUs, bulkUs, readBytesUs, oldUs / bulkUs, oldPackets, bulkPackets, readBytesPackets);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,746 @@
+/**
+* @file mip_bench.cpp
+* @brief  Host throughput benchmark of the MIP parse paths with JSON output
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details 合成したMIPストリーム、もしくは記録したキャプチャ(--capture)を、USBの受信のまとまり(チャンク)ごとに各パーサーへ流し、処理時間を計測します。
+* @details * 合成ストリーム : 0x82(オイラー角 + 角速度 + Reference Timestamp)を100Hz～1kHz、0x80(加速度 + ジャイロ + Reference Timestamp)、
+* @details   ACKのパケット(100msごと)に、ゴミのbyte列(--garbage)とチェックサムエラー(--checksum-error)を混ぜます。チャンクはloop()の周期(--loop)ごとに届いた分です
+* @details * キャプチャ : MipCaptureWriterで記録したDataレコードを、そのまま1チャンクとして流します
+* @details * パーサー : legacy(従来のスケッチの1byteずつの処理)、framer_byte(MipFramerに1byteずつ)、framer_bulk(MipIngest → MipRing → MipFramer)、
+* @details   device(スケッチが使うMipDeviceのreceive/process、振り分け・AHRSサンプル・公開まで)、device_estimator(deviceにMipAttitudeEstimatorのEKFを追加)
+* @details * 結果(MB/s、packets/s、ns/packet、1チャンクの最大・99%の処理時間)をJSONで出力します。時刻の取得(clock_gettime)の時間を含みます
+* @details * 合成ストリームでは、取り出せなかった正しいパケットの数(valid_packets_lost = valid_packets - packets)も出力します
+*
+* g++ -std=gnu++11 -O2 -I../../src mip_bench.cpp ../../src/Mip*.cpp -o mip_bench
+*
+* ./mip_bench [--seconds S] [--repeat N] [--loop US] [--garbage P] [--checksum-error P] [--seed N] [--capture session.mcap] [--out result.json]
+**/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "MipParser.h"
+
+namespace
+{
+    constexpr int BaseRate = 1000;          //合成ストリームの基本周波数[Hz](3DM-CV7と同じ)
+    constexpr int AckPeriod = 100;          //ACKのパケットを混ぜる間隔[tick]
+    constexpr double TwoPi = 6.283185307179586;
+
+    /// @brief USBSerialの代わり(available/read/readBytesのみ)
+    class FakeSerial
+    {
+        public:
+            const uint8_t *data = nullptr;
+            size_t end = 0;     //ここまで受信済み
+            size_t pos = 0;     //ここまで読み出し済み
+
+            int available(){return (int)(end - pos);}
+            int read(){return (pos < end) ? data[pos++] : -1;}
+            size_t readBytes(char *buffer, size_t length)
+            {
+                size_t n = (length < end - pos) ? length : end - pos;
+                memcpy(buffer, &data[pos], n);
+                pos += n;
+                return n;
+            }
+    };
+
+    /// @brief 流すデータ(byte列と、チャンクの終わりの位置・受信時刻)
+    struct Corpus
+    {
+        std::string name;
+        std::string source;         //synthetic / capture
+        int filterHz = 0;
+        int imuHz = 0;
+        double garbage = 0.0;
+        double checksumError = 0.0;
+        int loopUs = 0;
+        std::vector<uint8_t> bytes;
+        std::vector<size_t> chunkEnd;
+        std::vector<uint32_t> chunkStamp;
+        uint32_t validPackets = 0;  //チェックサムが正しいパケットの数(合成ストリームのみ)
+        uint32_t corruptPackets = 0;
+        uint32_t garbageBytes = 0;
+        double seconds = 0.0;       //ストリームの長さ[s]
+    };
+
+    /// @brief 1つのパーサーの結果
+    struct Result
+    {
+        const char *parser;
+        double totalNs = 0.0;       //最も速かった回の合計
+        double worstChunkNs = 0.0;
+        double p99ChunkNs = 0.0;
+        uint32_t packets = 0;
+        uint32_t checksumErrors = 0;
+        uint32_t samples = 0;       //公開したAHRSサンプル(deviceのみ)
+    };
+
+    double nowNs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+    }
+
+    /// @brief 時刻の取得1回にかかる時間[ns](チャンクごとの計測に含まれます)
+    double timerOverheadNs()
+    {
+        double start = nowNs();
+        for(int i = 0; i < 1000; i++)
+        {
+            nowNs();
+        }
+        return (nowNs() - start) / 1000.0;
+    }
+
+    uint32_t seed = 12345;
+    uint32_t nextRandom()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return seed >> 8;
+    }
+    double nextUniform(){return (nextRandom() & 0xFFFFFF) / 16777216.0;}
+
+
+    // ===== 従来のスケッチの処理(比較用にそのまま移植、ingest_compareと同じ) =====
+    namespace legacy
+    {
+        uint8_t buffer[1024];
+        int bufferIndex = 0;
+        unsigned long lastActivityTime = 0;
+        uint32_t handled = 0;
+        uint32_t checksumErrors = 0;
+        uint32_t fakeMillis = 0;
+        uint32_t millis(){return fakeMillis;}
+
+        void calculateChecksum(const uint8_t* data, int length, uint8_t* checksum1, uint8_t* checksum2)
+        {
+            uint8_t sum1 = 0;
+            uint8_t sum2 = 0;
+            for (int i = 0; i < length; i++) {
+                sum1 = (sum1 + data[i]) & 0xFF;
+                sum2 = (sum2 + sum1) & 0xFF;
+            }
+            *checksum1 = sum1;
+            *checksum2 = sum2;
+        }
+
+        bool verifyChecksum(const uint8_t* packet, int length)
+        {
+            uint8_t c1, c2;
+            calculateChecksum(packet, length - 2, &c1, &c2);
+            return (packet[length - 2] == c1 && packet[length - 1] == c2);
+        }
+
+        void shiftBuffer()
+        {
+            int shiftAmount = bufferIndex / 2;
+            memmove(buffer, &buffer[shiftAmount], bufferIndex - shiftAmount);
+            bufferIndex -= shiftAmount;
+        }
+
+        void processBuffer()
+        {
+            int processedBytes = 0;
+            while (processedBytes < bufferIndex - 3) {
+                bool foundPacket = false;
+                for (int i = processedBytes; i <= bufferIndex - 4; i++) {
+                    if (buffer[i] == 0x75 && buffer[i+1] == 0x65) {
+                        uint8_t length = buffer[i+3];
+                        int packetSize = 4 + length + 2;
+                        if (i + packetSize <= bufferIndex) {
+                            if (verifyChecksum(&buffer[i], packetSize)) {
+                                handled++;
+                            } else {
+                                checksumErrors++;
+                            }
+                            processedBytes = i + packetSize;
+                            foundPacket = true;
+                            break;
+                        } else {
+                            processedBytes = i;
+                            foundPacket = false;
+                            break;
+                        }
+                    }
+                }
+                if (!foundPacket) break;
+            }
+            if (processedBytes > 0) {
+                memmove(buffer, &buffer[processedBytes], bufferIndex - processedBytes);
+                bufferIndex -= processedBytes;
+            }
+        }
+
+        void read(FakeSerial &serial)
+        {
+            while (serial.available()) {
+                if (bufferIndex >= (int)(sizeof(buffer) - 1)) {
+                    shiftBuffer();
+                }
+                buffer[bufferIndex++] = (uint8_t)serial.read();
+                lastActivityTime = millis();
+                processBuffer();
+            }
+        }
+
+        void reset()
+        {
+            bufferIndex = 0;
+            handled = 0;
+            checksumErrors = 0;
+        }
+    }
+
+
+    // ===== 合成ストリーム =====
+
+    void addVector(MipCommand &packet, uint8_t field, const float v[3], bool flags)
+    {
+        packet.beginField(field);
+        for(int i = 0; i < 3; i++)
+        {
+            packet.addFloat(v[i]);
+        }
+        if(flags)
+        {
+            packet.addU16(1);
+        }
+        packet.endField();
+    }
+
+    void addReferenceTime(MipCommand &packet, uint64_t nanos)
+    {
+        packet.beginField(MIP::SharedField::ReferenceTime);
+        packet.addU32((uint32_t)(nanos >> 32));
+        packet.addU32((uint32_t)nanos);
+        packet.endField();
+    }
+
+    /// @brief パケットを追加します(確率でチェックサムを壊し、前にゴミを入れます)
+    void appendPacket(Corpus &corpus, MipCommand &packet)
+    {
+        int length = packet.finish();
+        if(length <= 0)
+        {
+            return;
+        }
+
+        if(nextUniform() < corpus.garbage)
+        {
+            //ゴミ(4回に1回は同期バイトで始め、パーサーに偽のパケットを探させる)
+            int count = 1 + (int)(nextRandom() % 32);
+            bool fakeSync = (nextRandom() % 4) == 0;
+            for(int i = 0; i < count; i++)
+            {
+                uint8_t b = (uint8_t)nextRandom();
+                if(fakeSync && i == 0) b = MIP::Sync1;
+                if(fakeSync && i == 1) b = MIP::Sync2;
+                corpus.bytes.push_back(b);
+            }
+            corpus.garbageBytes += count;
+        }
+
+        size_t start = corpus.bytes.size();
+        corpus.bytes.insert(corpus.bytes.end(), packet.getData(), packet.getData() + length);
+        if(nextUniform() < corpus.checksumError)
+        {
+            //ペイロードの1byteを壊す
+            size_t at = start + MIP::BuffPter::Payload + nextRandom() % (length - MIP::BuffPter::Payload - 2);
+            corpus.bytes[at] ^= (uint8_t)(1 + nextRandom() % 255);
+            corpus.corruptPackets++;
+        }
+        else
+        {
+            corpus.validPackets++;
+        }
+    }
+
+    /// @brief 合成ストリームを作ります
+    void makeSynthetic(Corpus &corpus, double seconds)
+    {
+        int ticks = (int)(seconds * BaseRate);
+        int filterDecimation = (corpus.filterHz > 0) ? BaseRate / corpus.filterHz : 0;
+        int imuDecimation = (corpus.imuHz > 0) ? BaseRate / corpus.imuHz : 0;
+        size_t lastChunk = 0;
+        int loopTicks = 0;
+
+        corpus.source = "synthetic";
+        corpus.seconds = (double)ticks / BaseRate;
+
+        for(int tick = 0; tick < ticks; tick++)
+        {
+            double t = (double)tick / BaseRate;
+            uint64_t nanos = (uint64_t)tick * (1000000000ULL / BaseRate);
+            float roll = (float)(0.35 * sin(TwoPi * 0.5 * t));
+            float pitch = (float)(0.2 * sin(TwoPi * 0.2 * t + 1.0));
+            float yaw = (float)(fmod(0.3 * t + M_PI, TwoPi) - M_PI);
+            float euler[3] = {roll, pitch, yaw};
+            float rate[3] = {(float)(0.35 * TwoPi * 0.5 * cos(TwoPi * 0.5 * t)), (float)(0.2 * TwoPi * 0.2 * cos(TwoPi * 0.2 * t + 1.0)), 0.3f};
+            float accel[3] = {sinf(pitch), -sinf(roll) * cosf(pitch), -cosf(roll) * cosf(pitch)};
+
+            if(imuDecimation > 0 && tick % imuDecimation == 0)
+            {
+                MipCommand packet;
+                packet.begin(MIP::DescSet::Imu);
+                addVector(packet, MIP::ImuField::Accel, accel, false);
+                addVector(packet, MIP::ImuField::Gyro, rate, false);
+                addReferenceTime(packet, nanos);
+                appendPacket(corpus, packet);
+            }
+            if(filterDecimation > 0 && tick % filterDecimation == 0)
+            {
+                MipCommand packet;
+                packet.begin(MIP::DescSet::Filter);
+                addVector(packet, MIP::FilterField::Euler, euler, true);
+                addVector(packet, MIP::FilterField::AngularRate, rate, true);
+                addReferenceTime(packet, nanos);
+                appendPacket(corpus, packet);
+            }
+            if(tick % AckPeriod == AckPeriod - 1)
+            {
+                //返信を待っていないACK(設定中のセンサーからの返信と同じ形)
+                MipCommand packet;
+                packet.begin(MIP::DescSet::Base);
+                packet.beginField(MIP::ReplyField::AckNack);
+                packet.addU8(MIP::BaseCmd::Ping);
+                packet.addU8(MIP::AckCode::Ok);
+                packet.endField();
+                appendPacket(corpus, packet);
+            }
+
+            //loop()の周期ごとに、それまでに届いた分を1チャンクにする
+            loopTicks += 1000;
+            if(loopTicks >= corpus.loopUs || tick == ticks - 1)
+            {
+                loopTicks = 0;
+                if(corpus.bytes.size() > lastChunk)
+                {
+                    lastChunk = corpus.bytes.size();
+                    corpus.chunkEnd.push_back(lastChunk);
+                    corpus.chunkStamp.push_back((uint32_t)((tick + 1) * (1000000 / BaseRate)));
+                }
+            }
+        }
+    }
+
+    bool readFile(const char *path, std::vector<uint8_t> &out)
+    {
+        FILE *fp = fopen(path, "rb");
+        if(fp == nullptr)
+        {
+            return false;
+        }
+        uint8_t block[4096];
+        size_t n;
+        while((n = fread(block, 1, sizeof(block), fp)) > 0)
+        {
+            out.insert(out.end(), block, block + n);
+        }
+        fclose(fp);
+        return true;
+    }
+
+    /// @brief キャプチャのDataレコードを1チャンクずつ並べます
+    bool loadCapture(Corpus &corpus, const char *path)
+    {
+        std::vector<uint8_t> file;
+        if(!readFile(path, file))
+        {
+            return false;
+        }
+
+        corpus.name = path;
+        corpus.source = "capture";
+        MipCaptureReader reader(file.data(), file.size());
+        MipCaptureRecord record;
+        bool first = true;
+        uint32_t firstStamp = 0;
+        uint32_t lastStamp = 0;
+        while(reader.next(record))
+        {
+            if(record.type != MipCapture::Type::Data || record.length == 0)
+            {
+                continue;
+            }
+            if(first)
+            {
+                first = false;
+                firstStamp = record.stamp;
+            }
+            lastStamp = record.stamp;
+            corpus.bytes.insert(corpus.bytes.end(), record.data, record.data + record.length);
+            corpus.chunkEnd.push_back(corpus.bytes.size());
+            corpus.chunkStamp.push_back(record.stamp);
+        }
+        corpus.seconds = (double)(uint32_t)(lastStamp - firstStamp) * 1e-6;
+        return !corpus.chunkEnd.empty();
+    }
+
+
+    // ===== 計測 =====
+
+    enum Parser
+    {
+        Legacy,
+        FramerByte,
+        FramerBulk,
+        Device,
+        DeviceEstimator,
+        ParserCount
+    };
+
+    const char *parserName(int parser)
+    {
+        switch(parser)
+        {
+            case Legacy:            return "legacy";
+            case FramerByte:        return "framer_byte";
+            case FramerBulk:        return "framer_bulk";
+            case Device:            return "device";
+            case DeviceEstimator:   return "device_estimator";
+        }
+        return "?";
+    }
+
+    void onPacket(const uint8_t *, int, void *){}
+
+    /// @brief 1回分流し、チャンクごとの処理時間[ns]をchunkNsに入れます
+    double runOnce(const Corpus &corpus, int parser, std::vector<float> &chunkNs, Result &result)
+    {
+        static MipFramer framer;
+        static MipRing<4096> ring;
+        static MipIngest ingest;
+        static MipDevice filterDevice("bench");
+        static MipDevice estimatorDevice("bench_estimator");
+        static MipAttitudeEstimator estimator;
+        static bool initialized = false;
+        if(!initialized)
+        {
+            initialized = true;
+            framer.setHandler(onPacket);
+            estimator.setMode(MipAttitudeEstimator::Ekf);
+            estimatorDevice.setEstimator(&estimator);
+            estimatorDevice.setSource(MipDevice::EstimatorSource);
+        }
+
+        //パーサーを初期化する(計測に含めない)
+        FakeSerial serial;
+        serial.data = corpus.bytes.data();
+        legacy::reset();
+        framer.reset();
+        framer.resetCounters();
+        ring.flush();
+        MipDevice *device = (parser == DeviceEstimator) ? &estimatorDevice : &filterDevice;
+        device->disconnect();
+        device->getFramer().resetCounters();
+        device->connect("bench");
+        uint32_t firstSequence = device->getSnapshot().getSequence();
+
+        chunkNs.clear();
+        double total = 0.0;
+        for(size_t c = 0; c < corpus.chunkEnd.size(); c++)
+        {
+            serial.end = corpus.chunkEnd[c];
+            uint32_t stamp = corpus.chunkStamp[c];
+
+            double start = nowNs();
+            switch(parser)
+            {
+                case Legacy:
+                    legacy::fakeMillis = stamp / 1000;
+                    legacy::read(serial);
+                    break;
+                case FramerByte:
+                    while(serial.available())
+                    {
+                        framer.push((uint8_t)serial.read());
+                    }
+                    break;
+                case FramerBulk:
+                    while(serial.available())
+                    {
+                        ingest.read(serial, ring, stamp);
+                        framer.drain(ring);
+                    }
+                    break;
+                case Device:
+                case DeviceEstimator:
+                    while(serial.available())
+                    {
+                        device->receive(serial, stamp);
+                        device->process(stamp, stamp / 1000);
+                    }
+                    break;
+            }
+            double spent = nowNs() - start;
+            chunkNs.push_back((float)spent);
+            total += spent;
+        }
+
+        switch(parser)
+        {
+            case Legacy:
+                result.packets = legacy::handled;
+                result.checksumErrors = legacy::checksumErrors;
+                break;
+            case FramerByte:
+            case FramerBulk:
+                result.packets = framer.getPacketCount();
+                result.checksumErrors = framer.getChecksumErrorCount();
+                break;
+            default:
+                result.packets = device->getFramer().getPacketCount();
+                result.checksumErrors = device->getFramer().getChecksumErrorCount();
+                result.samples = device->getSnapshot().getSequence() - firstSequence;
+                break;
+        }
+        return total;
+    }
+
+    Result measure(const Corpus &corpus, int parser, int repeat)
+    {
+        Result result;
+        result.parser = parserName(parser);
+
+        std::vector<float> chunkNs;
+        std::vector<float> all;
+        for(int r = 0; r < repeat; r++)
+        {
+            double total = runOnce(corpus, parser, chunkNs, result);
+            if(r == 0 || total < result.totalNs)
+            {
+                result.totalNs = total;
+            }
+            all.insert(all.end(), chunkNs.begin(), chunkNs.end());
+        }
+
+        //最大はすべての回から、99%は並べ替えて求める
+        if(!all.empty())
+        {
+            std::sort(all.begin(), all.end());
+            result.worstChunkNs = all.back();
+            result.p99ChunkNs = all[(size_t)(0.99 * (all.size() - 1))];
+        }
+        return result;
+    }
+
+
+    // ===== JSON =====
+
+    void printCorpus(FILE *out, const Corpus &corpus, int repeat, bool last)
+    {
+        std::vector<Result> results;
+        for(int parser = 0; parser < ParserCount; parser++)
+        {
+            results.push_back(measure(corpus, parser, repeat));
+        }
+
+        size_t maxChunk = 0;
+        size_t prev = 0;
+        for(size_t end : corpus.chunkEnd)
+        {
+            maxChunk = std::max(maxChunk, end - prev);
+            prev = end;
+        }
+
+        fprintf(out, "    {\n");
+        fprintf(out, "      \"name\": \"%s\",\n", corpus.name.c_str());
+        fprintf(out, "      \"source\": \"%s\",\n", corpus.source.c_str());
+        if(corpus.source == "synthetic")
+        {
+            fprintf(out, "      \"filter_hz\": %d,\n", corpus.filterHz);
+            fprintf(out, "      \"imu_hz\": %d,\n", corpus.imuHz);
+            fprintf(out, "      \"garbage\": %g,\n", corpus.garbage);
+            fprintf(out, "      \"checksum_error\": %g,\n", corpus.checksumError);
+            fprintf(out, "      \"loop_us\": %d,\n", corpus.loopUs);
+            fprintf(out, "      \"valid_packets\": %u,\n", corpus.validPackets);
+            fprintf(out, "      \"corrupt_packets\": %u,\n", corpus.corruptPackets);
+            fprintf(out, "      \"garbage_bytes\": %u,\n", corpus.garbageBytes);
+        }
+        fprintf(out, "      \"stream_seconds\": %.3f,\n", corpus.seconds);
+        fprintf(out, "      \"bytes\": %zu,\n", corpus.bytes.size());
+        fprintf(out, "      \"chunks\": %zu,\n", corpus.chunkEnd.size());
+        fprintf(out, "      \"max_chunk_bytes\": %zu,\n", maxChunk);
+        fprintf(out, "      \"results\": [\n");
+        for(size_t i = 0; i < results.size(); i++)
+        {
+            const Result &r = results[i];
+            double seconds = r.totalNs * 1e-9;
+
+            //取り出せなかった正しいパケットの数(合成ストリームのみ、0でなければパーサーの取りこぼし)
+            std::string lost;
+            if(corpus.source == "synthetic")
+            {
+                lost = ", \"valid_packets_lost\": " + std::to_string((long)corpus.validPackets - (long)r.packets);
+            }
+
+            fprintf(out, "        {\"parser\": \"%s\", \"mb_per_s\": %.2f, \"packets_per_s\": %.0f, \"ns_per_packet\": %.1f, "
+                         "\"worst_chunk_ns\": %.0f, \"p99_chunk_ns\": %.0f, \"packets\": %u, \"checksum_errors\": %u, \"samples\": %u%s}%s\n",
+                    r.parser,
+                    (seconds > 0.0) ? corpus.bytes.size() / seconds * 1e-6 : 0.0,
+                    (seconds > 0.0) ? r.packets / seconds : 0.0,
+                    (r.packets > 0) ? r.totalNs / r.packets : 0.0,
+                    r.worstChunkNs, r.p99ChunkNs, r.packets, r.checksumErrors, r.samples, lost.c_str(),
+                    (i + 1 < results.size()) ? "," : "");
+        }
+        fprintf(out, "      ]\n");
+        fprintf(out, "    }%s\n", last ? "" : ",");
+    }
+
+    void usage()
+    {
+        printf("usage: mip_bench [--seconds S] [--repeat N] [--loop US] [--garbage P] [--checksum-error P] [--seed N] [--capture session.mcap] [--out result.json]\n");
+        printf("  --seconds S         length of each synthetic stream (default 5)\n");
+        printf("  --repeat N          passes per parser; throughput is the fastest pass (default 5)\n");
+        printf("  --loop US           loop() period that forms one USB chunk (default 1000)\n");
+        printf("  --garbage P         probability of garbage bytes before a packet in the error streams (default 0.01)\n");
+        printf("  --checksum-error P  probability of a corrupted packet in the error streams (default 0.01)\n");
+        printf("  --capture FILE      also run a recorded capture, one chunk per Data record\n");
+        printf("  --out FILE          write the JSON to FILE instead of stdout\n");
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    double seconds = 5.0;
+    int repeat = 5;
+    int loopUs = 1000;
+    double garbage = 0.01;
+    double checksumError = 0.01;
+    const char *capture = nullptr;
+    const char *outPath = nullptr;
+
+    for(int i = 1; i < argc; i++)
+    {
+        bool hasValue = (i + 1 < argc);
+        if(strcmp(argv[i], "--seconds") == 0 && hasValue)
+        {
+            seconds = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--repeat") == 0 && hasValue)
+        {
+            repeat = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--loop") == 0 && hasValue)
+        {
+            loopUs = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--garbage") == 0 && hasValue)
+        {
+            garbage = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--checksum-error") == 0 && hasValue)
+        {
+            checksumError = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        }
+        else if(strcmp(argv[i], "--capture") == 0 && hasValue)
+        {
+            capture = argv[++i];
+        }
+        else if(strcmp(argv[i], "--out") == 0 && hasValue)
+        {
+            outPath = argv[++i];
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if(seconds <= 0.0 || repeat < 1 || loopUs < 1)
+    {
+        usage();
+        return 2;
+    }
+
+    //0x82だけ(100Hz～1kHz)、0x80を加えたもの、エラーを混ぜたもの
+    struct Mix
+    {
+        const char *name;
+        int filterHz;
+        int imuHz;
+        bool errors;
+    };
+    const Mix mixes[] = {
+        {"filter_100hz", 100, 0, false},
+        {"filter_200hz", 200, 0, false},
+        {"filter_500hz", 500, 0, false},
+        {"filter_1000hz", 1000, 0, false},
+        {"filter_200hz_imu_1000hz", 200, 1000, false},
+        {"filter_1000hz_imu_1000hz", 1000, 1000, false},
+        {"filter_200hz_imu_1000hz_errors", 200, 1000, true},
+        {"filter_1000hz_imu_1000hz_errors", 1000, 1000, true}
+    };
+
+    std::vector<Corpus> corpora;
+    for(const Mix &mix : mixes)
+    {
+        Corpus corpus;
+        corpus.name = mix.name;
+        corpus.filterHz = mix.filterHz;
+        corpus.imuHz = mix.imuHz;
+        corpus.garbage = mix.errors ? garbage : 0.0;
+        corpus.checksumError = mix.errors ? checksumError : 0.0;
+        corpus.loopUs = loopUs;
+        makeSynthetic(corpus, seconds);
+        corpora.push_back(corpus);
+    }
+    if(capture != nullptr)
+    {
+        Corpus corpus;
+        if(!loadCapture(corpus, capture))
+        {
+            printf("cannot read %s (or no Data records)\n", capture);
+            return 1;
+        }
+        corpora.push_back(corpus);
+    }
+
+    FILE *out = stdout;
+    if(outPath != nullptr)
+    {
+        out = fopen(outPath, "w");
+        if(out == nullptr)
+        {
+            printf("cannot write %s\n", outPath);
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"tool\": \"mip_bench\",\n");
+    fprintf(out, "  \"repeat\": %d,\n", repeat);
+    fprintf(out, "  \"timer_overhead_ns\": %.0f,\n", timerOverheadNs());
+    fprintf(out, "  \"corpora\": [\n");
+    for(size_t i = 0; i < corpora.size(); i++)
+    {
+        printCorpus(out, corpora[i], repeat, i + 1 == corpora.size());
+        fflush(out);
+    }
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+
+    if(out != stdout)
+    {
+        fclose(out);
+    }
+    return 0;
+}
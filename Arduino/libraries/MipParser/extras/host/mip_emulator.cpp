@@ -0,0 +1,829 @@
+/**
+* @file mip_emulator.cpp
+* @brief  Virtual 3DM-CV7 MIP device on a pseudo-terminal
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details 疑似端末(pty)の上で3DM-CV7のふりをするホスト用のプログラムです。実機がなくても、設定の手順・受信・復帰を確認できます。
+* @details * Ping, Idle, Resume, Get Device Info, Get Base Rate, Message Format, Enable Stream, Device Settingsに、実機と同じ形のACK/NACKを返します
+* @details * 0x80(IMU)と0x82(フィルター)を、Message Formatで設定したフィールド・分周比で出力します(基本周波数は1000Hz)
+* @details * データは合成した動き(正弦波の姿勢)か、MipCaptureWriterで記録したキャプチャ(--capture、受信時刻どおりに繰り返し)です
+* @details * チェックサムエラー(--checksum-error)、バイトの欠落(--drop)、出力時刻のジッタ(--jitter)、USBのまとめ送り(--batch)を混ぜられます
+* @details * mip_probeで接続すると、受信周波数・エラーからの復帰を計測できます
+*
+* g++ -std=gnu++11 -O2 -I../../src mip_emulator.cpp ../../src/Mip*.cpp -o mip_emulator
+*
+* ./mip_emulator [--link /tmp/cv7] [--capture session.mcap] [--checksum-error P] [--drop P] [--jitter US] [--batch MS] [--seed N] [--duration S] [--quiet]
+**/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "MipParser.h"
+
+namespace
+{
+    constexpr uint16_t BaseRate = 1000;     //どちらのディスクリプタセットも1000Hz
+    constexpr int MaxStreamField = 16;
+    constexpr double TwoPi = 6.283185307179586;
+    constexpr double Gravity = 9.80665;
+
+    /// @brief ディスクリプタセットごとの出力設定
+    struct Stream
+    {
+        uint8_t descSet;
+        bool enabled;
+        int count;
+        uint8_t field[MaxStreamField];
+        uint16_t decimation[MaxStreamField];
+    };
+
+    /// @brief 合成した動きの1時刻分
+    struct Motion
+    {
+        double euler[3];        //roll, pitch, yaw [rad]
+        double rate[3];         //[rad/s]
+        double quaternion[4];   //w, x, y, z
+        double accel[3];        //[g]
+        double linear[3];       //[m/s^2]
+        double mag[3];          //[Gauss]
+    };
+
+    struct Stats
+    {
+        uint64_t ticks = 0;
+        uint64_t skippedTicks = 0;     //処理が周期に間に合わずに飛ばした
+        uint64_t packets = 0;
+        uint64_t bytes = 0;
+        uint64_t commands = 0;
+        uint64_t acks = 0;
+        uint64_t nacks = 0;
+        uint64_t corrupted = 0;
+        uint64_t dropped = 0;
+        uint64_t droppedBytes = 0;
+        uint64_t overrunBytes = 0;     //ptyが一杯で書けなかった(読まれていない)
+    };
+
+    Stream streams[2];
+    bool idle = false;
+    int master = -1;
+    MipFramer framer;
+    Stats stats;
+    std::vector<uint8_t> pending;   //次に書き出すデータ(--batchでまとめる)
+
+    double checksumErrorRate = 0.0;
+    double dropRate = 0.0;
+    uint32_t jitterMicros = 0;
+    uint32_t batchMillis = 0;
+    bool quiet = false;
+    volatile sig_atomic_t running = 1;
+
+    void onSignal(int)
+    {
+        running = 0;
+    }
+
+    double nowNs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+    }
+
+    void sleepUntilNs(double targetNs)
+    {
+        timespec ts;
+        ts.tv_sec = (time_t)(targetNs / 1e9);
+        ts.tv_nsec = (long)(targetNs - (double)ts.tv_sec * 1e9);
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR && running)
+        {
+        }
+    }
+
+    double uniform()
+    {
+        return (double)rand() / ((double)RAND_MAX + 1.0);
+    }
+
+    bool readFile(const char *path, std::vector<uint8_t> &data)
+    {
+        FILE *fp = fopen(path, "rb");
+        if(fp == nullptr)
+        {
+            return false;
+        }
+        uint8_t buffer[65536];
+        size_t n;
+        while((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+        {
+            data.insert(data.end(), buffer, buffer + n);
+        }
+        fclose(fp);
+        return true;
+    }
+
+    Stream *findStream(uint8_t descSet)
+    {
+        for(Stream &stream : streams)
+        {
+            if(stream.descSet == descSet)
+            {
+                return &stream;
+            }
+        }
+        return nullptr;
+    }
+
+    bool isKnownField(uint8_t descSet, uint8_t field)
+    {
+        if(field == MIP::SharedField::GpsTimestamp || field == MIP::SharedField::ReferenceTime)
+        {
+            return true;
+        }
+        if(descSet == MIP::DescSet::Imu)
+        {
+            return field == MIP::ImuField::Accel || field == MIP::ImuField::Gyro || field == MIP::ImuField::Mag;
+        }
+        return field == MIP::FilterField::Quaternion || field == MIP::FilterField::Euler || field == MIP::FilterField::LinearAccel ||
+               field == MIP::FilterField::AngularRate || field == MIP::FilterField::Status || field == MIP::FilterField::CompAccel;
+    }
+
+
+    //---- 出力 ----
+
+    /// @brief ptyに書き出します(読まれずに一杯の場合は捨てて数えます)
+    void flushPending()
+    {
+        size_t offset = 0;
+        while(offset < pending.size())
+        {
+            ssize_t n = write(master, pending.data() + offset, pending.size() - offset);
+            if(n <= 0)
+            {
+                stats.overrunBytes += pending.size() - offset;
+                break;
+            }
+            offset += (size_t)n;
+        }
+        pending.clear();
+    }
+
+    /// @brief 完成したパケットを、設定した割合で壊してから出力待ちに加えます
+    void emit(const uint8_t *packet, int length, bool inject)
+    {
+        std::vector<uint8_t> data(packet, packet + length);
+
+        if(inject && checksumErrorRate > 0.0 && uniform() < checksumErrorRate)
+        {
+            //同期バイト以外の1bitを反転する
+            size_t pos = 2 + (size_t)(uniform() * (length - 2));
+            data[pos] ^= (uint8_t)(1 << (int)(uniform() * 8));
+            stats.corrupted++;
+        }
+        if(inject && dropRate > 0.0 && uniform() < dropRate)
+        {
+            //途中の1～8byteを抜く
+            size_t count = 1 + (size_t)(uniform() * 8);
+            if(count >= data.size())
+            {
+                count = data.size() - 1;
+            }
+            size_t pos = (size_t)(uniform() * (data.size() - count));
+            data.erase(data.begin() + pos, data.begin() + pos + count);
+            stats.dropped++;
+            stats.droppedBytes += count;
+        }
+
+        pending.insert(pending.end(), data.begin(), data.end());
+        stats.bytes += data.size();
+    }
+
+
+    //---- コマンド ----
+
+    void addU16(uint8_t *dst, uint16_t value)
+    {
+        dst[0] = (uint8_t)(value >> 8);
+        dst[1] = (uint8_t)value;
+    }
+
+    void addString(MipCommand &reply, const char *text)
+    {
+        char field[16];
+        memset(field, ' ', sizeof(field));
+        memcpy(field, text, strnlen(text, sizeof(field)));
+        reply.addBytes((const uint8_t *)field, sizeof(field));
+    }
+
+    /// @brief 1つのコマンドフィールドを実行し、ACK/NACKと返信のデータを加えます
+    void execute(MipCommand &reply, uint8_t descSet, const MipField &field)
+    {
+        uint8_t code = MIP::AckCode::Ok;
+        const uint8_t *data = field.data;
+        int length = field.length;
+        bool deviceInfo = false;
+        int baseRateSet = -1;
+
+        stats.commands++;
+
+        if(descSet == MIP::DescSet::Base)
+        {
+            switch(field.descriptor)
+            {
+                case MIP::BaseCmd::Ping:
+                    break;
+                case MIP::BaseCmd::Idle:
+                    idle = true;
+                    break;
+                case MIP::BaseCmd::Resume:
+                    idle = false;
+                    break;
+                case MIP::BaseCmd::GetDeviceInfo:
+                    deviceInfo = true;
+                    break;
+                default:
+                    code = MIP::AckCode::UnknownCommand;
+                    break;
+            }
+        }
+        else if(descSet == MIP::DescSet::ThreeDm)
+        {
+            switch(field.descriptor)
+            {
+                case MIP::ThreeDmCmd::GetBaseRate:
+                    if(length < 1 || findStream(data[0]) == nullptr)
+                    {
+                        code = MIP::AckCode::InvalidParameter;
+                    }
+                    else
+                    {
+                        baseRateSet = data[0];
+                    }
+                    break;
+                case MIP::ThreeDmCmd::MessageFormat:
+                {
+                    //[Function][DescSet][Count]{[Field][Decimation(2)]}
+                    Stream *stream = (length >= 3) ? findStream(data[1]) : nullptr;
+                    int count = (length >= 3) ? data[2] : 0;
+                    if(stream == nullptr || data[0] != MIP::Function::Apply || count > MaxStreamField || length < 3 + count * 3)
+                    {
+                        code = MIP::AckCode::InvalidParameter;
+                        break;
+                    }
+                    for(int i = 0; i < count; i++)
+                    {
+                        const uint8_t *entry = &data[3 + i * 3];
+                        if(!isKnownField(stream->descSet, entry[0]) || MipConv::toUint16(&entry[1]) == 0)
+                        {
+                            code = MIP::AckCode::InvalidParameter;
+                        }
+                    }
+                    if(code != MIP::AckCode::Ok)
+                    {
+                        break;
+                    }
+                    stream->count = count;
+                    for(int i = 0; i < count; i++)
+                    {
+                        stream->field[i] = data[3 + i * 3];
+                        stream->decimation[i] = MipConv::toUint16(&data[3 + i * 3 + 1]);
+                    }
+                    break;
+                }
+                case MIP::ThreeDmCmd::EnableStream:
+                {
+                    Stream *stream = (length >= 3) ? findStream(data[1]) : nullptr;
+                    if(stream == nullptr || data[0] != MIP::Function::Apply)
+                    {
+                        code = MIP::AckCode::InvalidParameter;
+                        break;
+                    }
+                    stream->enabled = (data[2] != 0);
+                    break;
+                }
+                case MIP::ThreeDmCmd::DeviceSettings:
+                    break;
+                default:
+                    code = MIP::AckCode::UnknownCommand;
+                    break;
+            }
+        }
+        else
+        {
+            code = MIP::AckCode::UnknownCommand;
+        }
+
+        uint8_t ack[2] = {field.descriptor, code};
+        reply.addField(MIP::ReplyField::AckNack, ack, 2);
+        if(code == MIP::AckCode::Ok)
+        {
+            stats.acks++;
+        }
+        else
+        {
+            stats.nacks++;
+        }
+
+        if(deviceInfo)
+        {
+            //Firmware(2) + Model, Model Number, Serial, Lot, Options(16文字ずつ)
+            uint8_t firmware[2];
+            addU16(firmware, 1008);
+            reply.beginField(MIP::ReplyField::DeviceInfo);
+            reply.addBytes(firmware, 2);
+            addString(reply, "3DM-CV7-AHRS");
+            addString(reply, "6284-4220");
+            addString(reply, "6284.00000");
+            addString(reply, "EMULATOR");
+            addString(reply, "8g,300dps");
+            reply.endField();
+        }
+        if(baseRateSet >= 0)
+        {
+            uint8_t rate[3] = {(uint8_t)baseRateSet, 0, 0};
+            addU16(&rate[1], BaseRate);
+            reply.addField(MIP::ReplyField::BaseRate, rate, 3);
+        }
+    }
+
+    /// @brief 受信したコマンドパケットに返信します(フィールドごとにACK/NACKを返します)
+    void onCommand(const uint8_t *packet, int length, void *context)
+    {
+        (void)length;
+        (void)context;
+        uint8_t descSet = packet[MIP::BuffPter::Descriptor];
+
+        MipCommand reply;
+        reply.begin(descSet);
+
+        MipFieldReader reader(packet);
+        MipField field;
+        while(reader.next(field))
+        {
+            execute(reply, descSet, field);
+        }
+
+        int replyLength = reply.finish();
+        if(replyLength > 0)
+        {
+            //返信は壊さない(設定の手順はmipExecutorの再送で確認する)
+            emit(reply.getData(), replyLength, false);
+            flushPending();
+        }
+    }
+
+    void pollCommands()
+    {
+        uint8_t buffer[512];
+        ssize_t n;
+        while((n = read(master, buffer, sizeof(buffer))) > 0)
+        {
+            framer.push(buffer, (size_t)n);
+        }
+    }
+
+
+    //---- 合成した動き ----
+
+    void makeMotion(double t, Motion &m)
+    {
+        const double rollAmp = 0.35, rollFreq = 0.5;
+        const double pitchAmp = 0.20, pitchFreq = 0.2;
+        const double yawRate = 0.3;
+
+        m.euler[0] = rollAmp * sin(TwoPi * rollFreq * t);
+        m.euler[1] = pitchAmp * sin(TwoPi * pitchFreq * t + 1.0);
+        m.euler[2] = fmod(yawRate * t + M_PI, TwoPi) - M_PI;
+
+        //オイラー角の微分から機体の角速度を求める
+        double dr = rollAmp * TwoPi * rollFreq * cos(TwoPi * rollFreq * t);
+        double dp = pitchAmp * TwoPi * pitchFreq * cos(TwoPi * pitchFreq * t + 1.0);
+        double dy = yawRate;
+        double sr = sin(m.euler[0]), cr = cos(m.euler[0]);
+        double sp = sin(m.euler[1]), cp = cos(m.euler[1]);
+        m.rate[0] = dr - sp * dy;
+        m.rate[1] = cr * dp + sr * cp * dy;
+        m.rate[2] = -sr * dp + cr * cp * dy;
+
+        double hr = m.euler[0] * 0.5, hp = m.euler[1] * 0.5, hy = m.euler[2] * 0.5;
+        m.quaternion[0] = cos(hr) * cos(hp) * cos(hy) + sin(hr) * sin(hp) * sin(hy);
+        m.quaternion[1] = sin(hr) * cos(hp) * cos(hy) - cos(hr) * sin(hp) * sin(hy);
+        m.quaternion[2] = cos(hr) * sin(hp) * cos(hy) + sin(hr) * cos(hp) * sin(hy);
+        m.quaternion[3] = cos(hr) * cos(hp) * sin(hy) - sin(hr) * sin(hp) * cos(hy);
+
+        //NED、静止時の加速度計は上向きの比力(z = -1g)
+        m.accel[0] = sp;
+        m.accel[1] = -sr * cp;
+        m.accel[2] = -cr * cp;
+
+        m.linear[0] = 0.05 * sin(TwoPi * 1.3 * t);
+        m.linear[1] = 0.05 * cos(TwoPi * 0.7 * t);
+        m.linear[2] = 0.0;
+
+        m.mag[0] = 0.3 * cos(m.euler[2]);
+        m.mag[1] = -0.3 * sin(m.euler[2]);
+        m.mag[2] = 0.4;
+    }
+
+    void addVector(MipCommand &packet, uint8_t field, const double *v, int count, double scale, bool flags)
+    {
+        packet.beginField(field);
+        for(int i = 0; i < count; i++)
+        {
+            packet.addFloat((float)(v[i] * scale));
+        }
+        if(flags)
+        {
+            packet.addU16(1);
+        }
+        packet.endField();
+    }
+
+    void addU64(MipCommand &packet, uint64_t value)
+    {
+        packet.addU32((uint32_t)(value >> 32));
+        packet.addU32((uint32_t)value);
+    }
+
+    void addField(MipCommand &packet, uint8_t descSet, uint8_t field, const Motion &m, uint64_t tick)
+    {
+        if(field == MIP::SharedField::ReferenceTime)
+        {
+            packet.beginField(field);
+            addU64(packet, tick * (1000000000ULL / BaseRate));
+            packet.endField();
+            return;
+        }
+        if(field == MIP::SharedField::GpsTimestamp)
+        {
+            //TOW(double) + Week(2) + valid flags(2)
+            double tow = (double)tick / BaseRate;
+            uint64_t bits;
+            memcpy(&bits, &tow, sizeof(bits));
+            packet.beginField(field);
+            addU64(packet, bits);
+            packet.addU16(2300);
+            packet.addU16(0x0003);
+            packet.endField();
+            return;
+        }
+
+        if(descSet == MIP::DescSet::Imu)
+        {
+            switch(field)
+            {
+                case MIP::ImuField::Accel:
+                    addVector(packet, field, m.accel, 3, 1.0, false);
+                    break;
+                case MIP::ImuField::Gyro:
+                    addVector(packet, field, m.rate, 3, 1.0, false);
+                    break;
+                case MIP::ImuField::Mag:
+                    addVector(packet, field, m.mag, 3, 1.0, false);
+                    break;
+            }
+            return;
+        }
+
+        switch(field)
+        {
+            case MIP::FilterField::Quaternion:
+                addVector(packet, field, m.quaternion, 4, 1.0, true);
+                break;
+            case MIP::FilterField::Euler:
+                addVector(packet, field, m.euler, 3, 1.0, true);
+                break;
+            case MIP::FilterField::AngularRate:
+                addVector(packet, field, m.rate, 3, 1.0, true);
+                break;
+            case MIP::FilterField::LinearAccel:
+                addVector(packet, field, m.linear, 3, 1.0, true);
+                break;
+            case MIP::FilterField::CompAccel:
+                addVector(packet, field, m.accel, 3, Gravity, true);
+                break;
+            case MIP::FilterField::Status:
+                //Filter State(2) + Dynamics Mode(2) + Status Flags(2)
+                packet.beginField(field);
+                packet.addU16(4);
+                packet.addU16(1);
+                packet.addU16(0);
+                packet.endField();
+                break;
+        }
+    }
+
+    /// @brief 基本周波数の1周期分の出力を作ります
+    void streamTick(uint64_t tick)
+    {
+        if(idle)
+        {
+            return;
+        }
+
+        Motion motion;
+        bool made = false;
+
+        for(Stream &stream : streams)
+        {
+            if(!stream.enabled || stream.count == 0)
+            {
+                continue;
+            }
+
+            MipCommand packet;
+            packet.begin(stream.descSet);
+            bool any = false;
+            for(int i = 0; i < stream.count; i++)
+            {
+                if(tick % stream.decimation[i] != 0)
+                {
+                    continue;
+                }
+                if(!made)
+                {
+                    makeMotion((double)tick / BaseRate, motion);
+                    made = true;
+                }
+                addField(packet, stream.descSet, stream.field[i], motion, tick);
+                any = true;
+            }
+
+            int length = any ? packet.finish() : 0;
+            if(length > 0)
+            {
+                emit(packet.getData(), length, true);
+                stats.packets++;
+            }
+        }
+    }
+
+
+    //---- pty ----
+
+    int openPty(const char *link)
+    {
+        int fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if(fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0)
+        {
+            perror("posix_openpt");
+            return -1;
+        }
+
+        const char *name = ptsname(fd);
+
+        //生のバイト列を通すように設定する
+        termios tio;
+        tcgetattr(fd, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        printf("device: %s\n", name);
+        if(link != nullptr)
+        {
+            unlink(link);
+            if(symlink(name, link) != 0)
+            {
+                perror("symlink");
+            }
+            else
+            {
+                printf("link: %s -> %s\n", link, name);
+            }
+        }
+        fflush(stdout);
+        return fd;
+    }
+
+    void printStats(double seconds)
+    {
+        if(quiet)
+        {
+            return;
+        }
+        fprintf(stderr, "[%7.1f s] %s ticks %llu (skipped %llu), packets %llu, bytes %llu, commands %llu (ack %llu, nack %llu), corrupted %llu, dropped %llu (%llu bytes), overrun %llu bytes\n",
+                seconds, idle ? "idle  " : "stream", (unsigned long long)stats.ticks, (unsigned long long)stats.skippedTicks, (unsigned long long)stats.packets,
+                (unsigned long long)stats.bytes, (unsigned long long)stats.commands, (unsigned long long)stats.acks,
+                (unsigned long long)stats.nacks, (unsigned long long)stats.corrupted, (unsigned long long)stats.dropped,
+                (unsigned long long)stats.droppedBytes, (unsigned long long)stats.overrunBytes);
+    }
+
+    void usage()
+    {
+        printf("usage: mip_emulator [--link PATH] [--capture FILE] [--checksum-error P] [--drop P] [--jitter US] [--batch MS] [--seed N] [--duration S] [--quiet]\n");
+        printf("  --link PATH         create a symlink to the pty (e.g. /tmp/cv7)\n");
+        printf("  --capture FILE      stream the Data records of a capture (looped) instead of the synthetic motion\n");
+        printf("  --checksum-error P  flip one bit in a fraction P of the data packets\n");
+        printf("  --drop P            remove 1-8 bytes from a fraction P of the data packets\n");
+        printf("  --jitter US         delay each output by a random 0..US microseconds\n");
+        printf("  --batch MS          hold the output and write it every MS milliseconds (USB host frames)\n");
+        printf("  --seed N            random seed for the faults (default 1)\n");
+        printf("  --duration S        exit after S seconds (default: until Ctrl-C)\n");
+        printf("  --quiet             do not print the statistics every second\n");
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    const char *link = nullptr;
+    const char *capturePath = nullptr;
+    unsigned seed = 1;
+    double duration = 0.0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--link") == 0 && i + 1 < argc)
+        {
+            link = argv[++i];
+        }
+        else if(strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+        {
+            capturePath = argv[++i];
+        }
+        else if(strcmp(argv[i], "--checksum-error") == 0 && i + 1 < argc)
+        {
+            checksumErrorRate = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--drop") == 0 && i + 1 < argc)
+        {
+            dropRate = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--jitter") == 0 && i + 1 < argc)
+        {
+            jitterMicros = (uint32_t)atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+        {
+            batchMillis = (uint32_t)atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = (unsigned)atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--duration") == 0 && i + 1 < argc)
+        {
+            duration = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--quiet") == 0)
+        {
+            quiet = true;
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    srand(seed);
+
+    std::vector<uint8_t> capture;
+    if(capturePath != nullptr && !readFile(capturePath, capture))
+    {
+        printf("cannot read %s\n", capturePath);
+        return 1;
+    }
+
+    //起動時の設定(SensorConnectで保存した状態): オイラー角・角速度を100Hz
+    streams[0] = Stream{MIP::DescSet::Imu, false, 0, {}, {}};
+    streams[1] = Stream{MIP::DescSet::Filter, true, 2, {MIP::FilterField::Euler, MIP::FilterField::AngularRate}, {10, 10}};
+
+    master = openPty(link);
+    if(master < 0)
+    {
+        return 1;
+    }
+    framer.setHandler(onCommand);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    MipCaptureReader reader(capture.data(), capture.size());
+    MipCaptureRecord record;
+    if(capturePath != nullptr)
+    {
+        uint32_t dataRecords = 0;
+        while(reader.next(record))
+        {
+            dataRecords += (record.type == MipCapture::Type::Data) ? 1 : 0;
+        }
+        reader.reset();
+        if(dataRecords == 0)
+        {
+            printf("no data records in %s\n", capturePath);
+            return 1;
+        }
+    }
+    bool haveRecord = false;
+    uint32_t firstStamp = 0;
+    double captureStart = 0.0;
+
+    const double periodNs = 1e9 / BaseRate;
+    double start = nowNs();
+    double nextStats = start + 1e9;
+    double nextBatch = start + batchMillis * 1e6;
+    uint64_t tick = 0;
+
+    while(running)
+    {
+        double tickNs = start + (double)tick * periodNs;
+        double target = tickNs;
+        if(jitterMicros > 0)
+        {
+            target += uniform() * jitterMicros * 1000.0;
+        }
+        sleepUntilNs(target);
+
+        pollCommands();
+
+        if(capturePath == nullptr)
+        {
+            streamTick(tick);
+        }
+        else if(!idle)
+        {
+            //記録した受信時刻どおりに、この周期までのDataレコードを出す(終わったら最初から)
+            double now = nowNs();
+            while(true)
+            {
+                if(!haveRecord)
+                {
+                    if(!reader.next(record))
+                    {
+                        reader.reset();
+                        if(!reader.next(record))
+                        {
+                            break;
+                        }
+                        captureStart = 0.0;
+                    }
+                    if(record.type != MipCapture::Type::Data)
+                    {
+                        continue;
+                    }
+                    haveRecord = true;
+                    if(captureStart == 0.0)
+                    {
+                        captureStart = now;
+                        firstStamp = record.stamp;
+                    }
+                }
+                if(captureStart + (double)(uint32_t)(record.stamp - firstStamp) * 1000.0 > now)
+                {
+                    break;
+                }
+                emit(record.data, (int)record.length, true);
+                stats.packets++;
+                haveRecord = false;
+            }
+        }
+        stats.ticks++;
+
+        double now = nowNs();
+        if(batchMillis == 0 || now >= nextBatch)
+        {
+            flushPending();
+            nextBatch += batchMillis * 1e6;
+        }
+        if(duration > 0.0 && now - start >= duration * 1e9)
+        {
+            break;
+        }
+        if(now >= nextStats)
+        {
+            printStats((now - start) * 1e-9);
+            nextStats += 1e9;
+        }
+
+        tick++;
+        //処理が周期に間に合わなかった場合は飛ばす(実機もサンプルを落とす)
+        if(start + (double)tick * periodNs < now - 10 * periodNs)
+        {
+            uint64_t current = (uint64_t)((now - start) / periodNs);
+            stats.skippedTicks += current - tick;
+            tick = current;
+        }
+    }
+
+    flushPending();
+    printStats((nowNs() - start) * 1e-9);
+    if(link != nullptr)
+    {
+        unlink(link);
+    }
+    close(master);
+    return 0;
+}
@@ -0,0 +1,392 @@
+/**
+* @file mip_probe.cpp
+* @brief  Host MIP client for measuring configuration, throughput and recovery
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details シリアルデバイス(mip_emulatorのpty、もしくは実機の/dev/ttyACM0)に接続し、スケッチと同じ手順で設定して受信を計測します。
+* @details * MipExecutor + MipRateConfigで、Idle → Get Device Info → 基本周波数の問い合わせ → Message Format → Enable Stream → Resumeを行います
+* @details * MipIngest → MipRing → MipFramer → MipDispatcher → MipAhrsDecoderで受信し、受信周波数・ジッタ・パーサーの処理時間を求めます
+* @details * チェックサムエラー・同期外れから次の正しいパケットまでの時間(復帰時間)と、Reference Timestampの飛びから失ったサンプル数を数えます
+*
+* g++ -std=gnu++11 -O2 -I../../src mip_probe.cpp ../../src/Mip*.cpp -o mip_probe
+*
+* ./mip_probe /tmp/cv7 [--rate HZ] [--duration S]
+**/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MipParser.h"
+
+namespace
+{
+    /// @brief POSIXのファイルをArduinoのStreamと同じ形で使うためのクラス(MipIngest・MipExecutorに渡します)
+    class PosixSerial
+    {
+        private:
+            int _fd;
+
+        public:
+            PosixSerial(int fd) : _fd(fd) {}
+
+            int available()
+            {
+                int n = 0;
+                return (ioctl(_fd, FIONREAD, &n) == 0) ? n : 0;
+            }
+
+            int read()
+            {
+                uint8_t data;
+                return (::read(_fd, &data, 1) == 1) ? data : -1;
+            }
+
+            size_t readBytes(char *buffer, size_t length)
+            {
+                ssize_t n = ::read(_fd, buffer, length);
+                return (n > 0) ? (size_t)n : 0;
+            }
+
+            size_t write(const uint8_t *data, size_t length)
+            {
+                ssize_t n = ::write(_fd, data, length);
+                return (n > 0) ? (size_t)n : 0;
+            }
+    };
+
+    MipRing<4096> ring;
+    MipIngest ingest;
+    MipFramer framer;
+    MipDispatcher dispatcher;
+    MipAhrsDecoder ahrsDecoder;
+    MipExecutor executor;
+    MipRateConfig rateConfig;
+    MipRateMonitor filterRate;
+
+    uint32_t ahrsSamples = 0;
+    uint64_t lastSensorNanos = 0;
+    uint64_t periodNanos = 0;
+    uint32_t missedSamples = 0;
+    bool configured = false;
+
+    //復帰時間(エラーを見つけてから次の正しいパケットまで)
+    uint32_t lastErrors = 0;
+    bool recovering = false;
+    uint32_t errorMicros = 0;
+    uint32_t recoveries = 0;
+    uint64_t recoverySum = 0;
+    uint32_t recoveryMax = 0;
+
+    uint64_t startNs = 0;
+
+    uint64_t monotonicNs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    }
+
+    uint32_t micros()
+    {
+        return (uint32_t)((monotonicNs() - startNs) / 1000ULL);
+    }
+
+    uint32_t millis()
+    {
+        return (uint32_t)((monotonicNs() - startNs) / 1000000ULL);
+    }
+
+    uint32_t errorCount()
+    {
+        return framer.getChecksumErrorCount() + framer.getSyncLossCount() + framer.getOversizeCount();
+    }
+
+    void onPacket(const uint8_t *packet, int length, void *context)
+    {
+        (void)length;
+        (void)context;
+        uint32_t stamp = ingest.getLastStamp();
+
+        if(recovering)
+        {
+            uint32_t recovery = stamp - errorMicros;
+            recovering = false;
+            recoveries++;
+            recoverySum += recovery;
+            if(recovery > recoveryMax)
+            {
+                recoveryMax = recovery;
+            }
+        }
+
+        if(executor.handlePacket(packet, millis()))
+        {
+            return;
+        }
+        if(packet[MIP::BuffPter::Descriptor] != MIP::DescSet::Filter)
+        {
+            return;
+        }
+
+        filterRate.record(stamp);
+        ahrsDecoder.begin();
+        dispatcher.dispatch(packet);
+        if(!ahrsDecoder.end(stamp))
+        {
+            return;
+        }
+        ahrsSamples++;
+
+        //Reference Timestampの飛びから失ったサンプルを数える(設定が終わってから)
+        const MipAhrsSample &sample = ahrsDecoder.sample();
+        if(configured && periodNanos > 0 && (sample.fields & MipAhrsDecoder::HasReferenceTime))
+        {
+            if(lastSensorNanos != 0 && sample.sensorNanos > lastSensorNanos)
+            {
+                uint64_t steps = (sample.sensorNanos - lastSensorNanos + periodNanos / 2) / periodNanos;
+                if(steps > 1)
+                {
+                    missedSamples += (uint32_t)(steps - 1);
+                }
+            }
+            lastSensorNanos = sample.sensorNanos;
+        }
+    }
+
+    void onResult(const MipExecutor::Result &result, const uint8_t *reply, void *context)
+    {
+        (void)context;
+        printf("command 0x%02X/0x%02X %s", result.descSet, result.fieldDesc, MipExecutor::statusName(result.status));
+        if(result.status == MipExecutor::Nacked)
+        {
+            printf(" code=0x%02X", result.code);
+        }
+        printf(" (%u ms, %u attempts)\n", result.latency, result.attempts);
+
+        if(reply != nullptr && result.descSet == MIP::DescSet::Base && result.fieldDesc == MIP::BaseCmd::GetDeviceInfo)
+        {
+            MipFieldReader reader(reply);
+            MipField field;
+            while(reader.next(field))
+            {
+                if(field.descriptor == MIP::ReplyField::DeviceInfo && field.length >= 2 + 16 * 3)
+                {
+                    printf("device: %.16s, serial %.16s, firmware %u\n",
+                           (const char *)&field.data[2], (const char *)&field.data[2 + 32], MipConv::toUint16(field.data));
+                }
+            }
+        }
+
+        bool wasDone = rateConfig.isDone();
+        rateConfig.handleResult(result, reply);
+        if(!wasDone && rateConfig.isDone())
+        {
+            float rate = rateConfig.getActualRate(MIP::DescSet::Filter, MIP::FilterField::Euler);
+            printf("configured: base %u Hz, decimation %u -> %.1f Hz\n",
+                   rateConfig.getBaseRate(MIP::DescSet::Filter), rateConfig.getDecimation(MIP::DescSet::Filter, MIP::FilterField::Euler), rate);
+            periodNanos = (rate > 0.0f) ? (uint64_t)(1e9f / rate) : 0;
+            configured = true;
+        }
+        else if(rateConfig.isFailed())
+        {
+            printf("configuration failed\n");
+        }
+    }
+
+    int openSerial(const char *path)
+    {
+        int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if(fd < 0)
+        {
+            perror(path);
+            return -1;
+        }
+        termios tio;
+        if(tcgetattr(fd, &tio) == 0)
+        {
+            cfmakeraw(&tio);
+            tcsetattr(fd, TCSANOW, &tio);
+        }
+        //接続前に溜まっていたデータを捨てる
+        tcflush(fd, TCIOFLUSH);
+        return fd;
+    }
+
+    void usage()
+    {
+        printf("usage: mip_probe DEVICE [--rate HZ] [--duration S]\n");
+        printf("  --rate HZ      filter output rate to configure (default 500)\n");
+        printf("  --duration S   measure for S seconds after the configuration (default 10)\n");
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        usage();
+        return 2;
+    }
+
+    const char *path = argv[1];
+    uint16_t rate = 500;
+    double duration = 10.0;
+
+    for(int i = 2; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--rate") == 0 && i + 1 < argc)
+        {
+            rate = (uint16_t)atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--duration") == 0 && i + 1 < argc)
+        {
+            duration = atof(argv[++i]);
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if(rate == 0 || duration <= 0.0)
+    {
+        usage();
+        return 2;
+    }
+
+    int fd = openSerial(path);
+    if(fd < 0)
+    {
+        return 1;
+    }
+    PosixSerial serial(fd);
+    startNs = monotonicNs();
+
+    framer.setHandler(onPacket);
+    ingest.setBulkRead(true);   //readBytesは1回のread(2)
+    executor.setHandler(onResult);
+    ahrsDecoder.attach(dispatcher);
+
+    rateConfig.addField(MIP::DescSet::Filter, MIP::FilterField::Euler, rate);
+    rateConfig.addField(MIP::DescSet::Filter, MIP::FilterField::AngularRate, rate);
+    rateConfig.addField(MIP::DescSet::Filter, MIP::FilterField::Quaternion, rate);
+    rateConfig.addField(MIP::DescSet::Filter, MIP::FilterField::Status, rate);
+    rateConfig.addField(MIP::DescSet::Filter, MIP::SharedField::ReferenceTime, rate);
+
+    MipCommand cmd;
+    cmd.buildIdle();
+    executor.enqueue(cmd);
+    cmd.buildGetDeviceInfo();
+    executor.enqueue(cmd);
+    if(!rateConfig.start(executor))
+    {
+        printf("cannot start the configuration\n");
+        return 1;
+    }
+
+    uint64_t parseNs = 0;
+    uint32_t lastReport = 0;
+    uint32_t measureStart = 0;
+    uint32_t baseBytes = 0;
+    uint32_t basePackets = 0;
+    uint32_t baseErrors = 0;
+
+    while(true)
+    {
+        uint32_t now = micros();
+        size_t got = ingest.read(serial, ring, now);
+        if(got > 0)
+        {
+            uint64_t t0 = monotonicNs();
+            framer.drain(ring);
+            parseNs += monotonicNs() - t0;
+        }
+        else
+        {
+            usleep(200);
+        }
+
+        uint32_t errors = errorCount();
+        if(errors != lastErrors)
+        {
+            lastErrors = errors;
+            if(!recovering)
+            {
+                recovering = true;
+                errorMicros = now;
+            }
+        }
+
+        executor.update(serial, millis());
+        filterRate.update(now);
+
+        if(rateConfig.isFailed())
+        {
+            return 1;
+        }
+        if(!configured)
+        {
+            if(now > 5000000)
+            {
+                printf("no reply from %s\n", path);
+                return 1;
+            }
+            continue;
+        }
+
+        if(measureStart == 0)
+        {
+            measureStart = now;
+            lastReport = now;
+            baseBytes = ingest.getByteCount();
+            basePackets = framer.getPacketCount();
+            baseErrors = errorCount();
+            parseNs = 0;
+            missedSamples = 0;
+            recoveries = 0;
+            recoverySum = 0;
+            recoveryMax = 0;
+            filterRate.reset();
+        }
+
+        if(now - lastReport >= 1000000)
+        {
+            lastReport = now;
+            printf("[%5.1f s] %.1f Hz, jitter %.0f us, interval %u..%u us, %u checksum errors, %u sync losses, %u missed samples\n",
+                   (now - measureStart) * 1e-6, filterRate.getRate(), filterRate.getJitter(), filterRate.getMinInterval(),
+                   filterRate.getMaxInterval(), framer.getChecksumErrorCount(), framer.getSyncLossCount(), missedSamples);
+        }
+        if(now - measureStart >= (uint32_t)(duration * 1e6))
+        {
+            break;
+        }
+    }
+
+    uint32_t elapsed = micros() - measureStart;
+    uint32_t bytes = ingest.getByteCount() - baseBytes;
+    uint32_t packets = framer.getPacketCount() - basePackets;
+
+    printf("received: %u bytes, %u packets (%.1f packets/s), %u ahrs samples, %u missed samples\n",
+           bytes, packets, packets / (elapsed * 1e-6), ahrsSamples, missedSamples);
+    printf("errors: %u (checksum %u, sync loss %u, discarded %u bytes), recovery mean %.0f us, max %u us over %u recoveries\n",
+           errorCount() - baseErrors, framer.getChecksumErrorCount(), framer.getSyncLossCount(), framer.getDiscardedBytes(),
+           recoveries ? (double)recoverySum / recoveries : 0.0, recoveryMax, recoveries);
+    printf("ingest: %u reads, max chunk %u bytes, ring high water %u bytes, %u overflows, parser %.2f ns/byte\n",
+           ingest.getReadCount(), ingest.getMaxChunk(), ring.getHighWater(), ring.getOverflowCount(),
+           bytes ? (double)parseNs / bytes : 0.0);
+    printf("commands: %u ack, %u nack, %u timeouts, %u retries\n",
+           executor.getAckCount(), executor.getNackCount(), executor.getTimeoutCount(), executor.getRetryCount());
+
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,263 @@
+/**
+* @file mip_replay.cpp
+* @brief  Host replay of a recorded MIP capture through the parser
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details MipCaptureWriterで記録したキャプチャ(sketch_aug28aのCAPTURE_MODE)を、MipFramer → MipDispatcher → MipAhrsDecoderへ流し直します。
+* @details * 受信時刻どおり(--speed 1、初期値)、N倍速(--speed N)、最高速度(--max)で流せます
+* @details * 最高速度ではパーサーの処理時間を計測します(--repeat で繰り返し)
+* @details * 実際のセッションで、パーサーの変更前後のパケット数・エラー数が変わらないことを確認できます
+*
+* g++ -std=gnu++11 -O2 -I../../src mip_replay.cpp ../../src/Mip*.cpp -o mip_replay
+*
+* ./mip_replay session.mcap [--speed N | --max] [--repeat K] [--text]
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "MipParser.h"
+
+namespace
+{
+    MipFramer framer;
+    MipDispatcher dispatcher;
+    MipAhrsDecoder ahrsDecoder;
+    MipClockSync sensorClock;
+    uint32_t currentStamp = 0;     //流しているレコードの受信時刻
+    uint32_t ahrsSamples = 0;
+
+    void onPacket(const uint8_t *packet, int length, void *context)
+    {
+        (void)length;
+        (void)context;
+        ahrsDecoder.begin();
+        dispatcher.dispatch(packet);
+        if(ahrsDecoder.end(currentStamp))
+        {
+            ahrsSamples++;
+        }
+    }
+
+    double nowNs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e9 + ts.tv_nsec;
+    }
+
+    void sleepUntilNs(double targetNs)
+    {
+        timespec ts;
+        ts.tv_sec = (time_t)(targetNs / 1e9);
+        ts.tv_nsec = (long)(targetNs - (double)ts.tv_sec * 1e9);
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) != 0)
+        {
+        }
+    }
+
+    bool readFile(const char *path, std::vector<uint8_t> &data)
+    {
+        FILE *fp = fopen(path, "rb");
+        if(fp == nullptr)
+        {
+            return false;
+        }
+        uint8_t buffer[65536];
+        size_t n;
+        while((n = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+        {
+            data.insert(data.end(), buffer, buffer + n);
+        }
+        fclose(fp);
+        return true;
+    }
+
+    void usage()
+    {
+        printf("usage: mip_replay capture.mcap [--speed N | --max] [--repeat K] [--text]\n");
+        printf("  --speed N  replay at N times the recorded speed (default 1)\n");
+        printf("  --max      replay as fast as possible and report parser throughput\n");
+        printf("  --repeat K replay the capture K times (default 1)\n");
+        printf("  --text     print Text records (connect/disconnect notes)\n");
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        usage();
+        return 2;
+    }
+
+    const char *path = argv[1];
+    double speed = 1.0;
+    bool maxSpeed = false;
+    int repeat = 1;
+    bool showText = false;
+
+    for(int i = 2; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+        {
+            speed = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--max") == 0)
+        {
+            maxSpeed = true;
+        }
+        else if(strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            repeat = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--text") == 0)
+        {
+            showText = true;
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if(speed <= 0.0 || repeat < 1)
+    {
+        usage();
+        return 2;
+    }
+
+    std::vector<uint8_t> file;
+    if(!readFile(path, file))
+    {
+        printf("cannot read %s\n", path);
+        return 1;
+    }
+
+    framer.setHandler(onPacket);
+    ahrsDecoder.attach(dispatcher);
+    ahrsDecoder.setClock(&sensorClock);
+
+    uint64_t dataBytes = 0;
+    uint32_t dataRecords = 0;
+    uint32_t gapBytes = 0;
+    uint32_t gapRecords = 0;
+    uint32_t starts = 0;
+    double parseNs = 0.0;
+    double lateSumNs = 0.0;
+    double lateMaxNs = 0.0;
+    uint64_t recordedUs = 0;
+    MipCaptureReader reader(file.data(), file.size());
+
+    double wallStart = nowNs();
+
+    for(int pass = 0; pass < repeat; pass++)
+    {
+        reader.reset();
+
+        //受信時刻(32bit、約71分で桁あふれ)を流し始めからの時間に直す
+        bool first = true;
+        uint32_t lastStamp = 0;
+        uint64_t elapsedUs = 0;
+        double passStart = nowNs();
+
+        MipCaptureRecord record;
+        while(reader.next(record))
+        {
+            if(first)
+            {
+                first = false;
+                lastStamp = record.stamp;
+            }
+            elapsedUs += (uint32_t)(record.stamp - lastStamp);
+            lastStamp = record.stamp;
+
+            switch(record.type)
+            {
+                case MipCapture::Type::Data:
+                {
+                    if(!maxSpeed)
+                    {
+                        double target = passStart + (double)elapsedUs * 1000.0 / speed;
+                        double now = nowNs();
+                        if(now < target)
+                        {
+                            sleepUntilNs(target);
+                            now = nowNs();
+                        }
+                        double late = now - target;
+                        lateSumNs += late;
+                        if(late > lateMaxNs)
+                        {
+                            lateMaxNs = late;
+                        }
+                    }
+
+                    currentStamp = record.stamp;
+                    double start = nowNs();
+                    framer.push(record.data, record.length);
+                    parseNs += nowNs() - start;
+
+                    dataBytes += record.length;
+                    dataRecords++;
+                    break;
+                }
+                case MipCapture::Type::Gap:
+                    if(record.length >= 4)
+                    {
+                        gapBytes += MipConv::toUint32(record.data);
+                    }
+                    gapRecords++;
+                    break;
+                case MipCapture::Type::Start:
+                    starts++;
+                    break;
+                case MipCapture::Type::Text:
+                    if(showText && pass == 0)
+                    {
+                        printf("[%10.3f s] %.*s\n", (double)elapsedUs * 1e-6, (int)record.length, (const char *)record.data);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        recordedUs = elapsedUs;
+    }
+
+    double wallNs = nowNs() - wallStart;
+
+    printf("capture: %zu bytes, %u records (%u data, %u start, %u gap = %u bytes lost), skipped %u bytes, %u record checksum errors, %zu truncated bytes\n",
+           file.size(), reader.getRecordCount(), dataRecords / repeat, starts / repeat, gapRecords / repeat, gapBytes / repeat,
+           reader.getSkippedBytes(), reader.getChecksumErrorCount(), reader.getRemaining());
+    printf("recorded: %.3f s, %llu MIP bytes per pass\n", (double)recordedUs * 1e-6, (unsigned long long)(dataBytes / repeat));
+    printf("parser: %u packets, %u checksum errors, %u sync losses, %u oversize, %u unknown fields, %u ahrs samples\n",
+           framer.getPacketCount(), framer.getChecksumErrorCount(), framer.getSyncLossCount(), framer.getOversizeCount(),
+           dispatcher.getUnknownFieldCount(), ahrsSamples);
+    if(sensorClock.isValid())
+    {
+        printf("clock: drift %.1f ppm, latency mean %.0f us, jitter %.0f us, max %.0f us, %u resyncs\n",
+               sensorClock.getDriftPpm(), sensorClock.getMeanLatency(), sensorClock.getLatencyJitter(),
+               sensorClock.getMaxLatency(), sensorClock.getResetCount());
+    }
+    if(maxSpeed)
+    {
+        printf("throughput: %.2f ns/byte in parser, %.1f MB/s, %.0f ns/packet, wall %.3f s for %d pass(es)\n",
+               parseNs / (double)dataBytes, (double)dataBytes / (parseNs * 1e-9) / 1e6,
+               parseNs / (double)framer.getPacketCount(), wallNs * 1e-9, repeat);
+    }
+    else
+    {
+        printf("replay: speed %.2fx, wall %.3f s, lateness mean %.1f us, max %.1f us\n",
+               speed, wallNs * 1e-9, lateSumNs / (dataRecords ? dataRecords : 1) / 1000.0, lateMaxNs / 1000.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+
+/**
+* @file MipAhrs.cpp
+* @brief  MIP AHRS sample record source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include <string.h>
+#include "MipAhrs.h"
+
+
+/**
+ * @brief Construct a new Mip Ahrs Decoder:: Mip Ahrs Decoder object
+ */
+MipAhrsDecoder::MipAhrsDecoder()
+{
+    this->reset();
+}
+
+
+/**
+ * @brief MipDispatcherに各フィールドのハンドラを登録します。
+ *
+ * @param [in] dispatcher 登録するMipDispatcher
+ * @param [in] descSet フィルターデータのディスクリプタセット
+ *
+ * @return true 登録した
+ * @return false MipDispatcherに登録できる数を超えた
+ *
+ * @note 同じフィールドに登録済みのハンドラは置き換えられます。
+ */
+bool MipAhrsDecoder::attach(MipDispatcher &dispatcher, uint8_t descSet)
+{
+    bool ok = true;
+    ok &= dispatcher.on(descSet, MIP::FilterField::Quaternion, __onQuaternion, this);
+    ok &= dispatcher.on(descSet, MIP::FilterField::Euler, __onEuler, this);
+    ok &= dispatcher.on(descSet, MIP::FilterField::AngularRate, __onAngularRate, this);
+    ok &= dispatcher.on(descSet, MIP::FilterField::LinearAccel, __onLinearAccel, this);
+    ok &= dispatcher.on(descSet, MIP::FilterField::Status, __onStatus, this);
+    ok &= dispatcher.on(descSet, MIP::SharedField::ReferenceTime, __onReferenceTime, this);
+    ok &= dispatcher.on(descSet, MIP::SharedField::GpsTimestamp, __onGpsTimestamp, this);
+    return ok;
+}
+
+/**
+ * @brief パケットの振り分けの後に呼び出し、サンプルを確定します。
+ *
+ * @param [in] arrivalMicros パケットの受信時刻[us](MipIngest::getLastStamp)
+ *
+ * @return true フィルターのフィールドがあり、サンプルを更新した
+ * @return false 更新するフィールドがなかった
+ *
+ * @note Reference TimestampとGPSタイムスタンプが両方ある場合は、Reference Timestampを使います。
+ */
+bool MipAhrsDecoder::end(uint32_t arrivalMicros)
+{
+    if(_fields == 0)
+    {
+        return false;
+    }
+
+    _sample.fields = _fields;
+    _sample.arrivalMicros = arrivalMicros;
+    _sample.hostMicros = arrivalMicros;
+
+    bool hasTime = (_fields & (HasReferenceTime | HasGpsTime)) != 0;
+    if(hasTime)
+    {
+        _sample.sensorNanos = (_fields & HasReferenceTime) ? _referenceNanos : _gpsNanos;
+        if(_clock != nullptr)
+        {
+            if(_feedClock)
+            {
+                _clock->add(_sample.sensorNanos, arrivalMicros);
+            }
+            if(_clock->isValid())
+            {
+                _sample.hostMicros = _clock->toHostMicros(_sample.sensorNanos);
+            }
+        }
+    }
+
+    _sample.sequence++;
+    return true;
+}
+
+/**
+ * @brief サンプルを0に戻します(通し番号も0に戻します)。
+ */
+void MipAhrsDecoder::reset()
+{
+    memset(&_sample, 0, sizeof(_sample));
+    _sample.quaternion[0] = 1.0f;
+    _fields = 0;
+}
+
+
+void MipAhrsDecoder::__onQuaternion(const MipQuaternionView &view, void *context)
+{
+    MipAhrsDecoder *self = static_cast<MipAhrsDecoder *>(context);
+    view.get(self->_sample.quaternion);
+    self->_sample.quaternionValid = view.flags();
+    self->_fields |= HasQuaternion;
+}
+
+void MipAhrsDecoder::__onEuler(const MipEulerView &view, void *context)
+{
+    MipAhrsDecoder *self = static_cast<MipAhrsDecoder *>(context);
+    view.get(self->_sample.euler);
+    self->_sample.eulerValid = view.flags();
+    self->_fields |= HasEuler;
+}
+
+void MipAhrsDecoder::__onAngularRate(const MipVector3fView &view, void *context)
+{
+    MipAhrsDecoder *self = static_cast<MipAhrsDecoder *>(context);
+    view.get(self->_sample.angularRate);
+    self->_sample.angularRateValid = view.flags();
+    self->_fields |= HasAngularRate;
+}
+
+void MipAhrsDecoder::__onLinearAccel(const MipVector3fView &view, void *context)
+{
+    MipAhrsDecoder *self = static_cast<MipAhrsDecoder *>(context);
+    view.get(self->_sample.linearAccel);
+    self->_sample.linearAccelValid = view.flags();
+    self->_fields |= HasLinearAccel;
+}
+
+void MipAhrsDecoder::__onStatus(const MipFilterStatusView &view, void *context)
+{
+    MipAhrsDecoder *self = static_cast<MipAhrsDecoder *>(context);
+    self->_sample.filterState = view.filterState();
+    self->_sample.dynamicsMode = view.dynamicsMode();
+    self->_sample.statusFlags = view.statusFlags();
+    self->_fields |= HasStatus;
+}
+
+void MipAhrsDecoder::__onReferenceTime(const MipReferenceTimeView &view, void *context)
+{
+    MipAhrsDecoder *self = static_cast<MipAhrsDecoder *>(context);
+    self->_referenceNanos = view.nanoseconds();
+    self->_fields |= HasReferenceTime;
+}
+
+void MipAhrsDecoder::__onGpsTimestamp(const MipGpsTimestampView &view, void *context)
+{
+    MipAhrsDecoder *self = static_cast<MipAhrsDecoder *>(context);
+    self->_gpsNanos = MipClockSync::gpsToNanos(view);
+    self->_fields |= HasGpsTime;
+}
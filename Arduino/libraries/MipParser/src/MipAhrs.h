@@ -0,0 +1,119 @@
+
+/**
+* @file MipAhrs.h
+* @brief  MIP AHRS sample record header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details フィルターデータ(0x82)のパケットから、姿勢・角速度・線形加速度・フィルターの状態・時刻を1つのレコードにまとめるクラスです。
+**/
+
+#ifndef __Mip_Ahrs_h__
+#define __Mip_Ahrs_h__
+
+#include "MipDef.h"
+#include "MipView.h"
+#include "MipDispatcher.h"
+#include "MipClockSync.h"
+
+/// @brief AHRSの1サンプル分のデータ
+/// @details 大きい型から順に並べて、途中に詰め物(パディング)が入らないようにしています(88byte)。
+typedef struct
+{
+    uint64_t sensorNanos;       //!< センサー時刻[ns](Reference Timestamp、なければGPSタイムスタンプ)
+    uint32_t arrivalMicros;     //!< USBから読み出した時刻[us](micros()基準)
+    uint32_t hostMicros;        //!< センサーが計測した時刻[us](micros()基準、時刻の対応が取れるまではarrivalMicros)
+    float quaternion[4];        //!< クォータニオン q0(w), q1, q2, q3
+    float euler[3];             //!< オイラー角 Roll, Pitch, Yaw [rad]
+    float angularRate[3];       //!< 補正済み角速度 X, Y, Z [rad/s]
+    float linearAccel[3];       //!< 線形加速度(重力を除いたもの) X, Y, Z [m/s^2]
+    uint16_t filterState;       //!< フィルターの状態
+    uint16_t dynamicsMode;      //!< ダイナミクスモード
+    uint16_t statusFlags;       //!< フィルターのステータスフラグ
+    uint16_t quaternionValid;   //!< クォータニオンのvalid flags
+    uint16_t eulerValid;        //!< オイラー角のvalid flags
+    uint16_t angularRateValid;  //!< 角速度のvalid flags
+    uint16_t linearAccelValid;  //!< 線形加速度のvalid flags
+    uint16_t fields;            //!< このパケットで更新したフィールド(MipAhrsDecoder::Has～の組み合わせ)
+    uint32_t sequence;          //!< サンプルの通し番号
+} MipAhrsSample;
+
+static_assert(sizeof(MipAhrsSample) == 88, "MipAhrsSample must not contain padding");
+
+
+/// @brief フィルターデータのパケットをMipAhrsSampleにまとめるクラス
+/// @details
+/// * attachでMipDispatcherに各フィールドのハンドラを登録するので、パケットは1回の振り分けで読み終わります
+/// * パケットごとに begin → MipDispatcher::dispatch → end の順に呼び出します
+/// * パケットに含まれないフィールドは前の値のままです(fieldsで更新したフィールドが分かります)
+/// * setClockでMipClockSyncを渡すと、センサー時刻からhostMicrosを求めます
+///
+/// @code
+/// MipAhrsDecoder ahrsDecoder;
+/// MipHistory<MipAhrsSample, 16> ahrsHistory;
+///
+/// ahrsDecoder.attach(dispatcher);
+/// ahrsDecoder.setClock(&clock);
+///
+/// void onPacket(const uint8_t *packet, int length, void *context)
+/// {
+///     ahrsDecoder.begin();
+///     dispatcher.dispatch(packet);
+///     if(ahrsDecoder.end(ingest.getLastStamp()))
+///     {
+///         ahrsHistory.push(ahrsDecoder.sample());
+///     }
+/// }
+/// @endcode
+class MipAhrsDecoder
+{
+    public:
+        static constexpr uint16_t HasQuaternion = 0x0001;   //!< クォータニオンを更新した
+        static constexpr uint16_t HasEuler = 0x0002;        //!< オイラー角を更新した
+        static constexpr uint16_t HasAngularRate = 0x0004;  //!< 角速度を更新した
+        static constexpr uint16_t HasLinearAccel = 0x0008;  //!< 線形加速度を更新した
+        static constexpr uint16_t HasStatus = 0x0010;       //!< フィルターの状態を更新した
+        static constexpr uint16_t HasReferenceTime = 0x0020;//!< Reference Timestampを受け取った
+        static constexpr uint16_t HasGpsTime = 0x0040;      //!< GPSタイムスタンプを受け取った
+
+    private:
+        MipAhrsSample _sample;
+        MipClockSync *_clock = nullptr;
+        bool _feedClock = true;
+        uint16_t _fields = 0;
+        uint64_t _referenceNanos = 0;
+        uint64_t _gpsNanos = 0;
+
+    public:
+        MipAhrsDecoder();
+
+        bool attach(MipDispatcher &dispatcher, uint8_t descSet=MIP::DescSet::Filter);
+        /**
+         * @brief センサー時刻をホストの時刻に変換するMipClockSyncを設定します。
+         *
+         * @param [in] clock MipClockSync(nullptrで使用しない)
+         * @param [in] feed trueでこのクラスが時刻の組を追加する(falseは変換だけ行う)
+         */
+        void setClock(MipClockSync *clock, bool feed=true){_clock = clock; _feedClock = feed;}
+
+        /// @brief パケットの振り分けの前に呼び出します
+        void begin(){_fields = 0;}
+        bool end(uint32_t arrivalMicros);
+        void reset();
+
+        /// @brief 最新のサンプルを返します
+        const MipAhrsSample &sample() const {return _sample;}
+
+    private:
+        static void __onQuaternion(const MipQuaternionView &view, void *context);
+        static void __onEuler(const MipEulerView &view, void *context);
+        static void __onAngularRate(const MipVector3fView &view, void *context);
+        static void __onLinearAccel(const MipVector3fView &view, void *context);
+        static void __onStatus(const MipFilterStatusView &view, void *context);
+        static void __onReferenceTime(const MipReferenceTimeView &view, void *context);
+        static void __onGpsTimestamp(const MipGpsTimestampView &view, void *context);
+};
+
+#endif
@@ -0,0 +1,161 @@
+
+/**
+* @file MipCapture.cpp
+* @brief  MIP raw stream capture format source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include "MipCapture.h"
+#include "MipChecksum.h"
+#include "MipConvert.h"
+
+
+/**
+ * @brief レコードの先頭(同期バイトから受信時刻まで)を作ります。
+ *
+ * @param [out] header 先頭(HeaderSize byte)
+ * @param [in] type レコードの種類(MipCapture::Type)
+ * @param [in] length データのサイズ
+ * @param [in] stampMicros 受信時刻[us]
+ *
+ * @return size_t 先頭のサイズ(HeaderSize)
+ */
+size_t MipCapture::encodeHeader(uint8_t header[HeaderSize], uint8_t type, uint16_t length, uint32_t stampMicros)
+{
+    header[0] = Sync1;
+    header[1] = Sync2;
+    header[2] = type;
+    MipConv::fromUint16(length, &header[3]);
+    MipConv::fromUint32(stampMicros, &header[5]);
+    return HeaderSize;
+}
+
+/**
+ * @brief レコードのチェックサムを計算します。
+ *
+ * @param [in] header 先頭(HeaderSize byte)
+ * @param [in] data データ
+ * @param [in] length データのサイズ
+ *
+ * @return uint16_t チェックサム(種類からデータの最後まで)
+ */
+uint16_t MipCapture::getChecksum(const uint8_t header[HeaderSize], const uint8_t data[], size_t length)
+{
+    uint8_t sum1 = 0;
+    uint8_t sum2 = 0;
+
+    MipChecksum::update(sum1, sum2, &header[2], HeaderSize - 2);
+    MipChecksum::update(sum1, sum2, data, length);
+    return (uint16_t)((sum1 << 8) | sum2);
+}
+
+
+/**
+ * @brief Construct a new Mip Capture Reader:: Mip Capture Reader object
+ *
+ * @param [in] data 記録したキャプチャ
+ * @param [in] length サイズ
+ */
+MipCaptureReader::MipCaptureReader(const uint8_t *data, size_t length) : _data(data), _length(length)
+{
+}
+
+
+/**
+ * @brief 次のレコードを取り出します。
+ *
+ * @param [out] record 取り出したレコード
+ *
+ * @return true 取り出した
+ * @return false 最後まで読んだ
+ *
+ * @note サイズが残りより大きいレコードは、偽の同期バイトの場合があるので1byteずらして探し直します。
+ *       後ろにレコードが見つからない場合は、途中で切れたレコードとしてその先頭で終了します。
+ */
+bool MipCaptureReader::next(MipCaptureRecord &record)
+{
+    const size_t overhead = MipCapture::HeaderSize + MipCapture::ChecksumSize;
+
+    //最初に見つかった途中で切れたレコード(後ろにレコードがなければ、ここで終了したことにする)
+    bool truncated = false;
+    size_t truncatedIndex = 0;
+    uint32_t truncatedSkipped = 0;
+    uint32_t truncatedErrors = 0;
+
+    while(_index + overhead <= _length)
+    {
+        const uint8_t *p = &_data[_index];
+
+        if(p[0] != MipCapture::Sync1 || p[1] != MipCapture::Sync2)
+        {
+            _index++;
+            _skippedBytes++;
+            continue;
+        }
+
+        uint16_t length = MipConv::toUint16(&p[3]);
+        if(length > MipCapture::MaxData)
+        {
+            _index++;
+            _skippedBytes++;
+            continue;
+        }
+
+        if(_index + overhead + length > _length)
+        {
+            //途中で切れたレコード、もしくは偽の同期バイト
+            if(!truncated)
+            {
+                truncated = true;
+                truncatedIndex = _index;
+                truncatedSkipped = _skippedBytes;
+                truncatedErrors = _checksumErrorCount;
+            }
+            _index++;
+            _skippedBytes++;
+            continue;
+        }
+
+        const uint8_t *data = &p[MipCapture::HeaderSize];
+        uint16_t checksum = MipConv::toUint16(&data[length]);
+        if(checksum != MipCapture::getChecksum(p, data, length))
+        {
+            _checksumErrorCount++;
+            _index++;
+            _skippedBytes++;
+            continue;
+        }
+
+        record.type = p[2];
+        record.length = length;
+        record.stamp = MipConv::toUint32(&p[5]);
+        record.data = data;
+
+        _index += overhead + length;
+        _recordCount++;
+        return true;
+    }
+
+    if(truncated)
+    {
+        _index = truncatedIndex;
+        _skippedBytes = truncatedSkipped;
+        _checksumErrorCount = truncatedErrors;
+    }
+    return false;
+}
+
+/**
+ * @brief 先頭から読み直します(集計も0に戻します)。
+ */
+void MipCaptureReader::reset()
+{
+    _index = 0;
+    _recordCount = 0;
+    _skippedBytes = 0;
+    _checksumErrorCount = 0;
+}
@@ -0,0 +1,300 @@
+
+/**
+* @file MipCapture.h
+* @brief  MIP raw stream capture format header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details センサーから受信したbyte列を、受信時刻付きのレコードに区切ってPCへ送る(記録する)ための形式です。
+* @details 記録したファイルはextras/host/mip_replay.cppで、元の速度・N倍速・最高速度でMipFramerへ流し直せます。
+**/
+
+#ifndef __Mip_Capture_h__
+#define __Mip_Capture_h__
+
+#include "MipDef.h"
+#include "MipRing.h"
+
+/// @brief キャプチャの形式
+/// @details 1レコードは次の形です(数値はMIPと同じビッグエンディアン)。
+/// | byte | 内容 |
+/// |------|------|
+/// | 0-1  | 同期バイト 0xCA 0x9E |
+/// | 2    | レコードの種類(Type) |
+/// | 3-4  | データのサイズ uint16 |
+/// | 5-8  | 受信時刻[us] uint32(micros) |
+/// | 9～  | データ |
+/// | 最後の2byte | Fletcherチェックサム(種類からデータの最後まで、MIPと同じ計算) |
+///
+/// PC側はシリアルをそのまま記録します(例: stty -F /dev/ttyACM0 raw; cat /dev/ttyACM0 > session.mcap)。
+/// レコードの前に文字列等が混ざっていても、読み出し側は同期バイトとチェックサムで読み飛ばします。
+namespace MipCapture
+{
+    constexpr uint8_t Sync1 = 0xCA;         //!< 同期バイト1
+    constexpr uint8_t Sync2 = 0x9E;         //!< 同期バイト2
+    constexpr uint8_t Version = 1;          //!< 形式のバージョン
+    constexpr size_t HeaderSize = 9;        //!< 同期バイトから受信時刻まで[byte]
+    constexpr size_t ChecksumSize = 2;      //!< チェックサム[byte]
+    constexpr size_t MaxData = 1024;        //!< 1レコードのデータの最大サイズ[byte](これより大きい受信は分けます)
+
+    /// @brief レコードの種類
+    namespace Type
+    {
+        constexpr uint8_t Start = 0x01;     //!< キャプチャの開始 Version(1)
+        constexpr uint8_t Data = 0x02;      //!< センサーから受信したbyte列
+        constexpr uint8_t Gap = 0x03;       //!< 送信が間に合わず捨てたbyte数 uint32(この位置でデータが抜けています)
+        constexpr uint8_t Text = 0x04;      //!< 文字列(接続・切断等のメモ)
+    }
+
+    size_t encodeHeader(uint8_t header[HeaderSize], uint8_t type, uint16_t length, uint32_t stampMicros);
+    uint16_t getChecksum(const uint8_t header[HeaderSize], const uint8_t data[], size_t length);
+}
+
+/// @brief 読み出したレコード
+/// @note dataは読み出し元のデータの中を指しています。
+typedef struct
+{
+    uint8_t type;           //!< レコードの種類(MipCapture::Type)
+    uint16_t length;        //!< データのサイズ
+    uint32_t stamp;         //!< 受信時刻[us]
+    const uint8_t *data;    //!< データの先頭
+} MipCaptureRecord;
+
+
+/// @brief 受信したbyte列をキャプチャのレコードにして送るクラス
+/// @details
+/// * 送信側の空き(availableForWrite)が足りない時は待たずに捨て、次に送れた時にGapレコードで捨てたbyte数を送ります
+/// * リングバッファのデータはpeekで読むだけなので、この後でMipFramerが同じデータを処理できます
+///
+/// @code
+/// MipCaptureWriter capture;
+/// capture.begin(Serial, micros());
+/// mipIngest.read(userial, mipRing, micros());
+/// capture.writeRing(Serial, mipRing, mipIngest.getLastStamp());
+/// framer.drain(mipRing);
+/// @endcode
+///
+/// @note 送信のクラスはwrite(const uint8_t*, size_t)とavailableForWrite()を持っていれば使えます(Serial等)。
+class MipCaptureWriter
+{
+    private:
+        uint32_t _pendingGap = 0;       //まだ送っていない捨てたbyte数
+        uint32_t _ringSent = 0;         //writeRingで送り終えたリングバッファの書き込み位置(累計)
+        uint32_t _recordCount = 0;
+        uint32_t _byteCount = 0;
+        uint32_t _droppedBytes = 0;
+        uint32_t _droppedRecords = 0;
+
+    public:
+        /**
+         * @brief Startレコードを送ります。
+         *
+         * @param [in] out 送信先(Serial等)
+         * @param [in] nowMicros 現在時刻[us]
+         *
+         * @return true 送った
+         * @return false 送信先の空きが足りない
+         */
+        template<class Out>
+        bool begin(Out &out, uint32_t nowMicros)
+        {
+            const uint8_t version = MipCapture::Version;
+            return this->__record(out, MipCapture::Type::Start, &version, 1, nowMicros);
+        }
+
+        /**
+         * @brief 受信したbyte列をDataレコードで送ります(MaxDataごとに分けます)。
+         *
+         * @param [in] out 送信先(Serial等)
+         * @param [in] data 受信したデータ
+         * @param [in] length データ数
+         * @param [in] stampMicros 受信時刻[us](MipIngest::getLastStamp)
+         *
+         * @return size_t 送ったbyte数(送れなかった分は捨ててGapレコードで知らせます)
+         */
+        template<class Out>
+        size_t write(Out &out, const uint8_t *data, size_t length, uint32_t stampMicros)
+        {
+            size_t sent = 0;
+
+            while(length > 0)
+            {
+                size_t chunk = (length < MipCapture::MaxData) ? length : MipCapture::MaxData;
+
+                if(_pendingGap > 0)
+                {
+                    uint8_t gap[4] = {(uint8_t)(_pendingGap >> 24), (uint8_t)(_pendingGap >> 16), (uint8_t)(_pendingGap >> 8), (uint8_t)_pendingGap};
+                    size_t need = 2 * (MipCapture::HeaderSize + MipCapture::ChecksumSize) + sizeof(gap) + chunk;
+                    if((size_t)out.availableForWrite() >= need)
+                    {
+                        this->__record(out, MipCapture::Type::Gap, gap, sizeof(gap), stampMicros);
+                        _pendingGap = 0;
+                    }
+                }
+
+                if(_pendingGap == 0 && this->__record(out, MipCapture::Type::Data, data, chunk, stampMicros))
+                {
+                    sent += chunk;
+                }
+                else
+                {
+                    _pendingGap += (uint32_t)chunk;
+                    _droppedBytes += (uint32_t)chunk;
+                }
+
+                data += chunk;
+                length -= chunk;
+            }
+
+            return sent;
+        }
+
+        /**
+         * @brief リングバッファに前回から増えたデータをDataレコードで送ります(読み出し位置は進めません)。
+         *
+         * @param [in] out 送信先(Serial等)
+         * @param [in] ring 受信データのリングバッファ(MipRing)
+         * @param [in] stampMicros 受信時刻[us](MipIngest::getLastStamp)
+         *
+         * @return size_t 送ったbyte数
+         *
+         * @note 前回送ったデータは、まだconsumeされていなくても送りません(送れずに捨てたデータもGapレコードで知らせ済みです)。
+         * @note 前回の位置がリングバッファに残っていない場合(初回・consumeで追い越された場合)は、溜まっているデータをすべて送ります。
+         * @note MipFramer::drainの直前に呼び出します。
+         */
+        template<class Out, class Ring>
+        size_t writeRing(Out &out, const Ring &ring, uint32_t stampMicros)
+        {
+            //読み出し位置はこの後のdrainまで進まないので、peekの前に読んでおく
+            uint32_t tail = ring.getReadPosition();
+            MipSpan spans[2];
+            int count = ring.peek(spans);
+
+            size_t total = 0;
+            for(int i = 0; i < count; i++)
+            {
+                total += spans[i].length;
+            }
+
+            //前回送った位置までは送らない
+            size_t skip = (size_t)(uint32_t)(_ringSent - tail);
+            if(skip > total)
+            {
+                skip = 0;
+            }
+            _ringSent = tail + (uint32_t)total;
+
+            size_t sent = 0;
+            for(int i = 0; i < count; i++)
+            {
+                if(skip >= spans[i].length)
+                {
+                    skip -= spans[i].length;
+                    continue;
+                }
+                sent += this->write(out, spans[i].data + skip, spans[i].length - skip, stampMicros);
+                skip = 0;
+            }
+            return sent;
+        }
+
+        /**
+         * @brief 文字列をTextレコードで送ります。
+         *
+         * @param [in] out 送信先(Serial等)
+         * @param [in] text 文字列(終端文字は送りません)
+         * @param [in] stampMicros 現在時刻[us]
+         *
+         * @return true 送った
+         * @return false 送信先の空きが足りない
+         */
+        template<class Out>
+        bool text(Out &out, const char *text, uint32_t stampMicros)
+        {
+            size_t length = 0;
+            while(text[length] != '\0' && length < MipCapture::MaxData)
+            {
+                length++;
+            }
+            return this->__record(out, MipCapture::Type::Text, (const uint8_t *)text, length, stampMicros);
+        }
+
+        /// @brief 送ったレコードの数を返します
+        uint32_t getRecordCount(){return _recordCount;}
+        /// @brief 送ったbyte数(レコードの同期バイト・チェックサムを含む)を返します
+        uint32_t getByteCount(){return _byteCount;}
+        /// @brief 送信先の空きが足りずに捨てた受信データのbyte数を返します
+        uint32_t getDroppedBytes(){return _droppedBytes;}
+        /// @brief 送信先の空きが足りずに送らなかったレコードの数を返します
+        uint32_t getDroppedRecords(){return _droppedRecords;}
+
+    private:
+        template<class Out>
+        bool __record(Out &out, uint8_t type, const uint8_t *data, size_t length, uint32_t stampMicros)
+        {
+            size_t need = MipCapture::HeaderSize + length + MipCapture::ChecksumSize;
+            if((size_t)out.availableForWrite() < need)
+            {
+                _droppedRecords++;
+                return false;
+            }
+
+            uint8_t header[MipCapture::HeaderSize];
+            MipCapture::encodeHeader(header, type, (uint16_t)length, stampMicros);
+            uint16_t checksum = MipCapture::getChecksum(header, data, length);
+            uint8_t trailer[MipCapture::ChecksumSize] = {(uint8_t)(checksum >> 8), (uint8_t)(checksum & 0xFF)};
+
+            out.write(header, sizeof(header));
+            out.write(data, length);
+            out.write(trailer, sizeof(trailer));
+
+            _recordCount++;
+            _byteCount += (uint32_t)need;
+            return true;
+        }
+};
+
+
+/// @brief 記録したキャプチャからレコードを順番に取り出すクラス
+/// @details
+/// * 同期バイトが見つからない、サイズがMaxDataを超える、チェックサムが合わない、サイズが残りより大きい場合は1byteずつずらして探し直します
+/// * 途中で切れたレコードの後ろにレコードが見つからない場合は、そのレコードの先頭で終了します(getRemaining)
+///
+/// @code
+/// MipCaptureReader reader(file, fileLength);
+/// MipCaptureRecord record;
+/// while(reader.next(record))
+/// {
+///     if(record.type == MipCapture::Type::Data) framer.push(record.data, record.length);
+/// }
+/// @endcode
+class MipCaptureReader
+{
+    private:
+        const uint8_t *_data;
+        size_t _length;
+        size_t _index = 0;
+
+        uint32_t _recordCount = 0;
+        uint32_t _skippedBytes = 0;
+        uint32_t _checksumErrorCount = 0;
+
+    public:
+        MipCaptureReader(const uint8_t *data, size_t length);
+
+        bool next(MipCaptureRecord &record);
+        void reset();
+
+        /// @brief 取り出したレコードの数を返します
+        uint32_t getRecordCount(){return _recordCount;}
+        /// @brief レコードではないため読み飛ばしたbyte数を返します
+        uint32_t getSkippedBytes(){return _skippedBytes;}
+        /// @brief チェックサムが合わなかった回数を返します
+        uint32_t getChecksumErrorCount(){return _checksumErrorCount;}
+        /// @brief 読み残したbyte数(最後の途中で切れたレコード)を返します
+        size_t getRemaining(){return _length - _index;}
+};
+
+#endif
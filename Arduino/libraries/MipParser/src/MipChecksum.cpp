@@ -0,0 +1,189 @@
+
+/**
+* @file MipChecksum.cpp
+* @brief  MIP Fletcher checksum source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include <string.h>
+#include "MipChecksum.h"
+
+
+/**
+ * @brief 4byteをリトルエンディアンの1語として読み出します(アライメントは不要)。
+ *
+ * @param [in] data データ
+ *
+ * @return uint32_t data[0]が最下位byteの1語
+ */
+static inline uint32_t __load(const uint8_t data[])
+{
+    uint32_t word;
+
+    memcpy(&word, data, sizeof(word));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    word = __builtin_bswap32(word);
+#endif
+    return word;
+}
+
+
+/**
+ * @brief Fletcherチェックサムを計算します。
+ *
+ * @param [in] data 計算するデータ
+ * @param [in] length データ数
+ *
+ * @return uint16_t チェックサム(上位byte:sum1, 下位byte:sum2)
+ */
+uint16_t MipChecksum::getChecksum(const uint8_t data[], size_t length)
+{
+    uint8_t sum1 = 0;
+    uint8_t sum2 = 0;
+
+    update(sum1, sum2, data, length);
+
+    return (uint16_t)((sum1 << 8) | sum2);
+}
+
+/**
+ * @brief 計算途中のFletcherチェックサムにデータを追加します。
+ *
+ * @param [in,out] sum1 計算途中のsum1(最初は0)
+ * @param [in,out] sum2 計算途中のsum2(最初は0)
+ * @param [in] data 追加するデータ
+ * @param [in] length データ数
+ *
+ * @note データを分けて呼び出しても、まとめて計算した場合と同じ結果になります(MipFramerで受信しながら計算します)。
+ * @note 長さL、sum1の初期値をS1とすると、sum2 += L*S1 + Σ(L-j)*data[j]、sum1 += Σdata[j] です。
+ */
+void MipChecksum::update(uint8_t &sum1, uint8_t &sum2, const uint8_t data[], size_t length)
+{
+    //32bitで足し続け、最後に下位8bitを使う(mod 256は32bitの桁あふれと両立する)
+    uint32_t s1 = sum1;
+    uint32_t s2 = sum2;
+
+    //短いデータは1byteずつの方が速い
+    if(length >= MinWordLength)
+    {
+        size_t done = __updateWords(s1, s2, data, length);
+        data += done;
+        length -= done;
+    }
+
+    //残り(4byte未満、もしくは短いデータ)
+    for(size_t i = 0; i < length; i++)
+    {
+        s1 += data[i];
+        s2 += s1;
+    }
+
+    sum1 = (uint8_t)s1;
+    sum2 = (uint8_t)s2;
+}
+
+
+/**
+ * @brief 4byteずつ(1回のループで2語)sum1/sum2を計算します。
+ *
+ * @param [in,out] s1 計算途中のsum1(32bit、下位8bitが有効)
+ * @param [in,out] s2 計算途中のsum2(32bit、下位8bitが有効)
+ * @param [in] data 追加するデータ
+ * @param [in] length データ数
+ *
+ * @return size_t 計算したbyte数(残りはMinWordLength未満)
+ */
+size_t MipChecksum::__updateWords(uint32_t &s1, uint32_t &s2, const uint8_t data[], size_t length)
+{
+    size_t done = 0;
+
+    while(length >= MinWordLength)
+    {
+        size_t blockLength = (length < BlockLength) ? (length & ~(size_t)3) : BlockLength;
+        size_t words = blockLength / 4;
+
+        //1語 = data[0],data[1],data[2],data[3] を16bitのレーンに分ける
+        //  even : data[0] | data[2] << 16
+        //  odd  : data[1] | data[3] << 16
+        uint32_t even = 0;
+        uint32_t odd = 0;
+        uint32_t prefix = 0;    //各語より前の語のレーンの合計の合計(sum2の重み付けに使用)
+
+        //2語(8byte)ずつ処理する
+        size_t k = 0;
+        for(; k + 2 <= words; k += 2)
+        {
+            uint32_t word0 = __load(&data[k * 4]);
+            uint32_t word1 = __load(&data[k * 4 + 4]);
+            uint32_t even0 = word0 & 0x00FF00FFUL;
+            uint32_t odd0 = (word0 >> 8) & 0x00FF00FFUL;
+
+            prefix += 2 * (even + odd) + even0 + odd0;
+            even += even0 + (word1 & 0x00FF00FFUL);
+            odd += odd0 + ((word1 >> 8) & 0x00FF00FFUL);
+        }
+        if(k < words)
+        {
+            uint32_t word = __load(&data[k * 4]);
+
+            prefix += even + odd;
+            even += word & 0x00FF00FFUL;
+            odd += (word >> 8) & 0x00FF00FFUL;
+        }
+
+        //レーンの最大値 prefix:510*(0+1+…+15)=61200 < 65536 なので桁あふれしない
+        uint32_t e0 = even & 0xFFFF;        //data[4k+0]の合計
+        uint32_t e2 = even >> 16;           //data[4k+2]の合計
+        uint32_t o1 = odd & 0xFFFF;         //data[4k+1]の合計
+        uint32_t o3 = odd >> 16;            //data[4k+3]の合計
+        uint32_t blockSum = e0 + o1 + e2 + o3;
+        uint32_t prefixSum = (prefix & 0xFFFF) + (prefix >> 16);
+
+        //Σ(L-j)*data[j] = 4*Σ(words-k)*語の合計 - Σ(語の中の位置)*data[j]
+        s2 += (uint32_t)blockLength * s1 + 4 * (prefixSum + blockSum) - (o1 + 2 * e2 + 3 * o3);
+        s1 += blockSum;
+
+        data += blockLength;
+        length -= blockLength;
+        done += blockLength;
+    }
+
+
+    return done;
+}
+
+/**
+ * @brief パケットの最後にチェックサムを追加します。
+ *
+ * @param [in,out] packet Sync1からペイロードまで入っているパケット(チェックサム分の領域が必要)
+ *
+ * @note ペイロードのサイズはpacket[MIP::BuffPter::Length]を使用します。
+ */
+void MipChecksum::setChecksum(uint8_t packet[])
+{
+    int length = MIP::HeaderLength + packet[MIP::BuffPter::Length];
+    uint16_t checksum = getChecksum(packet, length);
+
+    packet[length] = (uint8_t)(checksum >> 8);
+    packet[length + 1] = (uint8_t)(checksum & 0xFF);
+}
+
+/**
+ * @brief 受信したパケットのチェックサムを確認します。
+ *
+ * @param [in] packet Sync1からチェックサムまでのパケット
+ *
+ * @return true チェックサムが一致した
+ * @return false チェックサムが一致しない
+ */
+bool MipChecksum::checkChecksum(const uint8_t packet[])
+{
+    int length = MIP::HeaderLength + packet[MIP::BuffPter::Length];
+    uint16_t checksum = getChecksum(packet, length);
+
+    return (packet[length] == (uint8_t)(checksum >> 8)) && (packet[length + 1] == (uint8_t)(checksum & 0xFF));
+}
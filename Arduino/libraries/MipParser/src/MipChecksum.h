@@ -0,0 +1,49 @@
+
+/**
+* @file MipChecksum.h
+* @brief  MIP Fletcher checksum header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details MIPパケットのFletcherチェックサムの計算・付加・確認を行います。
+**/
+
+#ifndef __Mip_Checksum_h__
+#define __Mip_Checksum_h__
+
+#include "MipDef.h"
+
+/// @brief MIPで使用するチェックサムの演算
+/// @details
+///  * 8bitのFletcherチェックサム(sum1 += byte, sum2 += sum1)
+///  * 計算範囲：Sync1からペイロードの最後まで
+///  * 格納順：sum1, sum2 の順にペイロードの直後へ格納
+///
+/// MIPのFletcherは256で割った余り(8bitの桁あふれ)なので、32bitで足し続けても下位8bitは同じ結果になります。
+/// updateは4byteを1語として読み、偶数/奇数番目のbyteを16bitのレーンで足し込みます(1byteずつの加算やマスクはしません)。
+/// レーンがあふれる前(64byteごと)にsum1/sum2へまとめます。
+class MipChecksum
+{
+    public:
+        static constexpr size_t BlockLength = 64;   //!< 16bitのレーンをsum1/sum2へまとめる間隔[byte]
+        static constexpr size_t MinWordLength = 34; //!< これより短いデータは1byteずつ計算します(4byteずつの計算は約33byte以下では準備の分だけ遅くなります)[byte]
+
+        //チェックサムを計算する(上位byte:sum1, 下位byte:sum2)
+        static uint16_t getChecksum(const uint8_t data[], size_t length);
+
+        //計算途中のsum1/sum2にデータを追加する
+        static void update(uint8_t &sum1, uint8_t &sum2, const uint8_t data[], size_t length);
+
+        //パケットにチェックサムを追加する
+        static void setChecksum(uint8_t packet[]);
+
+        //受信したパケットのチェックサムをチェックする
+        static bool checkChecksum(const uint8_t packet[]);
+
+    private:
+        static size_t __updateWords(uint32_t &s1, uint32_t &s2, const uint8_t data[], size_t length);
+};
+
+#endif
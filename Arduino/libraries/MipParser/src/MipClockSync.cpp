@@ -0,0 +1,237 @@
+
+/**
+* @file MipClockSync.cpp
+* @brief  MIP sensor clock tracking source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include <math.h>
+#include "MipClockSync.h"
+
+namespace
+{
+    constexpr double MaxDrift = 1e-3;       //傾きの範囲(水晶の誤差はこれより十分小さい)
+    constexpr uint64_t SecondsPerWeek = 604800ULL;
+}
+
+
+/**
+ * @brief Construct a new Mip Clock Sync:: Mip Clock Sync object
+ *
+ * @param [in] timeConstant 近似に使うサンプル数の目安(重みが1/eになるサンプル数、大きいほどなめらかで追従が遅い)
+ */
+MipClockSync::MipClockSync(float timeConstant)
+{
+    if(timeConstant < 2.0f)
+    {
+        timeConstant = 2.0f;
+    }
+    _lambda = 1.0 - 1.0 / timeConstant;
+}
+
+
+/**
+ * @brief センサー時刻と受信時刻の組を追加します。
+ *
+ * @param [in] sensorNanos パケットのセンサー時刻[ns](Reference Timestamp、もしくはgpsToNanos)
+ * @param [in] hostMicros パケットの受信時刻[us](MipIngest::getLastStamp)
+ *
+ * @return true 追加した
+ * @return false 前と同じセンサー時刻なので追加しない
+ *
+ * @note センサー時刻が戻った、もしくは近似からResetThreshold以上外れた場合は、このサンプルから近似をやり直します。
+ */
+bool MipClockSync::add(uint64_t sensorNanos, uint32_t hostMicros)
+{
+    if(!_started)
+    {
+        _started = true;
+        _host = hostMicros;
+        _lastMicros = hostMicros;
+        this->__restart(sensorNanos);
+    }
+    else
+    {
+        //micros()の桁あふれ(約71分)を戻す
+        _host += (uint32_t)(hostMicros - _lastMicros);
+        _lastMicros = hostMicros;
+
+        if(sensorNanos == _lastSensor)
+        {
+            return false;
+        }
+        if(sensorNanos < _lastSensor)
+        {
+            _resetCount++;
+            this->__restart(sensorNanos);
+        }
+    }
+
+    double x = (double)(sensorNanos - _originSensor) * 1e-9;
+    double y = (double)(_host - _originHost) * 1e-6;
+
+    //近似が有効であれば、追加する前の直線からの差で遅れを求める
+    if(this->isValid())
+    {
+        float residual = (float)((y - (_meanY + _slope * (x - _meanX))) * 1e6);
+
+        if(fabsf(residual) > (float)ResetThreshold)
+        {
+            _resetCount++;
+            this->__restart(sensorNanos);
+            x = 0.0;
+            y = (double)(_host - _originHost) * 1e-6;
+        }
+        else
+        {
+            if(_sampleCount == MinSamples)
+            {
+                _envelope = residual;
+            }
+            else
+            {
+                _envelope += _envelopeRise;
+                if(residual < _envelope)
+                {
+                    _envelope = residual;
+                }
+            }
+
+            const float alpha = 1.0f / LatencyTimeConstant;
+            float diff = residual - _envelope;
+            _latency = diff + _floor;
+            float delta = _latency - _latencyMean;
+            _latencyMean += alpha * delta;
+            _latencyVar = (1.0f - alpha) * (_latencyVar + alpha * delta * delta);
+            if(_latency > _latencyMax)
+            {
+                _latencyMax = _latency;
+            }
+        }
+    }
+
+    //指数重み付きの平均・共分散を更新する(古い重みをlambda倍してから重み1で追加)
+    _weight = _lambda * _weight + 1.0;
+    _covXX *= _lambda;
+    _covXY *= _lambda;
+
+    double dx = x - _meanX;
+    _meanX += dx / _weight;
+    _meanY += (y - _meanY) / _weight;
+    _covXX += dx * (x - _meanX);
+    _covXY += dx * (y - _meanY);
+
+    if(_covXX > 0.0)
+    {
+        _slope = _covXY / _covXX;
+        if(_slope > 1.0 + MaxDrift)
+        {
+            _slope = 1.0 + MaxDrift;
+        }
+        else if(_slope < 1.0 - MaxDrift)
+        {
+            _slope = 1.0 - MaxDrift;
+        }
+    }
+
+    _lastSensor = sensorNanos;
+    _sampleCount++;
+    return true;
+}
+
+/**
+ * @brief 近似と遅れの集計をすべて破棄します。
+ *
+ * @note センサーの切断時などに使用します。やり直した回数は0にしません。
+ */
+void MipClockSync::reset()
+{
+    _started = false;
+    _sampleCount = 0;
+    _latency = 0.0f;
+    _latencyMean = 0.0f;
+    _latencyVar = 0.0f;
+    _latencyMax = 0.0f;
+}
+
+
+/**
+ * @brief センサー時刻を、センサーが計測したホストの時刻に変換します。
+ *
+ * @param [in] sensorNanos センサー時刻[ns]
+ *
+ * @return uint32_t ホストの時刻[us](micros()と同じ基準)
+ *
+ * @note 最も早く届いたパケットの受信時刻から、setLatencyFloorの時間を引いた時刻です。
+ */
+uint32_t MipClockSync::toHostMicros(uint64_t sensorNanos) const
+{
+    double x = (double)(int64_t)(sensorNanos - _originSensor) * 1e-9;
+    double y = _meanY + _slope * (x - _meanX);
+    double micros = y * 1e6 + _envelope - _floor;
+
+    return (uint32_t)(_originHost + (int64_t)llround(micros));
+}
+
+/**
+ * @brief 直前のサンプルでの、ホストの時刻とセンサーの時刻の差[us]を返します。
+ *
+ * @return int64_t ホストの時刻[us] - センサーの時刻[us]
+ */
+int64_t MipClockSync::getOffsetMicros() const
+{
+    double x = (double)(_lastSensor - _originSensor) * 1e-9;
+    double y = _meanY + _slope * (x - _meanX);
+    int64_t host = (int64_t)_originHost + (int64_t)llround(y * 1e6 + _envelope - _floor);
+
+    return host - (int64_t)(_lastSensor / 1000);
+}
+
+/**
+ * @brief 計測から受信までの時間の標準偏差(ジッタ)[us]を返します。
+ *
+ * @return float 標準偏差[us]
+ */
+float MipClockSync::getLatencyJitter() const
+{
+    return (_latencyVar > 0.0f) ? sqrtf(_latencyVar) : 0.0f;
+}
+
+/**
+ * @brief GPSタイムスタンプ(週番号 + 週の始まりからの時間)をナノ秒に変換します。
+ *
+ * @param [in] timestamp GPSタイムスタンプのフィールド(0xD3)
+ *
+ * @return uint64_t GPS時刻の始まりからの時間[ns]
+ */
+uint64_t MipClockSync::gpsToNanos(const MipGpsTimestampView &timestamp)
+{
+    return (uint64_t)timestamp.week() * SecondsPerWeek * 1000000000ULL + (uint64_t)llround(timestamp.tow() * 1e9);
+}
+
+
+/**
+ * @brief このサンプルを基準にして近似をやり直します。
+ *
+ * @param [in] sensorNanos 基準にするセンサー時刻[ns]
+ */
+void MipClockSync::__restart(uint64_t sensorNanos)
+{
+    _originSensor = sensorNanos;
+    _originHost = _host;
+    _lastSensor = sensorNanos;
+
+    _weight = 0.0;
+    _meanX = 0.0;
+    _meanY = 0.0;
+    _covXX = 0.0;
+    _covXY = 0.0;
+    _slope = 1.0;
+
+    _envelope = 0.0f;
+    _sampleCount = 0;
+}
@@ -0,0 +1,110 @@
+
+/**
+* @file MipClockSync.h
+* @brief  MIP sensor clock tracking header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details センサーの時刻(Reference Timestamp / GPS Timestamp)とホストのmicrosの関係を直線で近似し、
+* @details センサーの時刻をホストの時刻に変換するクラスです。ずれ(オフセット)と進み方の違い(ドリフト)、受信までの遅れを求めます。
+**/
+
+#ifndef __Mip_Clock_Sync_h__
+#define __Mip_Clock_Sync_h__
+
+#include "MipDef.h"
+#include "MipView.h"
+
+/// @brief センサーの時刻とホストの時刻(micros)を対応付けるクラス
+/// @details
+/// * addにパケットのセンサー時刻[ns]と受信時刻[us](MipIngest::getLastStamp)を渡します
+/// * 受信時刻 = オフセット + 傾き × センサー時刻 を、指数重み付きの最小二乗法で求めます(古いサンプルほど重みが小さい)
+/// * 傾きからドリフト[ppm]を、近似直線からの受信時刻の差から受信までの遅れを求めます
+/// * 遅れは、最も早く届いたパケット(近似直線からの差の下限)を基準にした時間です。下限そのものの遅れ(USBの最小の転送時間)は
+///   分からないので、setLatencyFloorで指定します
+/// * センサーの時刻が戻った、もしくは大きく飛んだ場合(センサーの再起動等)は近似をやり直します
+///
+/// @code
+/// MipClockSync clock;
+/// clock.add(sensorNs, ingest.getLastStamp());
+/// uint32_t sampleMicros = clock.toHostMicros(sensorNs);   // センサーが計測した時刻(micros)
+/// float latency = clock.getLatency();                     // 計測から受信までの時間[us]
+/// @endcode
+class MipClockSync
+{
+    public:
+        static constexpr float DefaultTimeConstant = 10000.0f; //!< 近似に使うサンプル数の目安(重みが1/eになるサンプル数)
+        static constexpr float LatencyTimeConstant = 256.0f;   //!< 遅れの平均・ジッタに使うサンプル数の目安
+        static constexpr uint32_t MinSamples = 16;              //!< 近似が有効になるサンプル数
+        static constexpr uint32_t ResetThreshold = 100000;      //!< この時間[us]以上近似から外れたらやり直す
+
+    private:
+        //指数重み付きの平均・分散・共分散(x:センサー時刻[s]、y:受信時刻[s]、基準時刻からの差)
+        double _lambda;
+        double _weight = 0.0;
+        double _meanX = 0.0;
+        double _meanY = 0.0;
+        double _covXX = 0.0;
+        double _covXY = 0.0;
+        double _slope = 1.0;
+
+        uint64_t _originSensor = 0;     //センサー時刻の基準[ns]
+        uint64_t _originHost = 0;       //受信時刻の基準[us](桁あふれを戻した64bit)
+        uint64_t _lastSensor = 0;
+        uint64_t _host = 0;             //桁あふれを戻した受信時刻[us]
+        uint32_t _lastMicros = 0;
+        bool _started = false;
+
+        //受信までの遅れ
+        float _floor = 0.0f;
+        float _envelope = 0.0f;         //近似直線からの差の下限[us]
+        float _envelopeRise = 0.002f;   //下限を1サンプルごとに戻す量[us]
+        float _latency = 0.0f;
+        float _latencyMean = 0.0f;
+        float _latencyVar = 0.0f;
+        float _latencyMax = 0.0f;
+
+        uint32_t _sampleCount = 0;
+        uint32_t _resetCount = 0;
+
+    public:
+        MipClockSync(float timeConstant=DefaultTimeConstant);
+
+        bool add(uint64_t sensorNanos, uint32_t hostMicros);
+        void reset();
+
+        uint32_t toHostMicros(uint64_t sensorNanos) const;
+
+        /// @brief 近似が有効か返します
+        bool isValid() const {return _sampleCount >= MinSamples;}
+        /// @brief ドリフト(センサーの時刻に対するホストの時刻の進み方の違い)[ppm]を返します
+        float getDriftPpm() const {return (float)((_slope - 1.0) * 1e6);}
+        int64_t getOffsetMicros() const;
+
+        /// @brief 下限の遅れ(最も早く届いたパケットの遅れ)[us]を設定します(初期値0)
+        void setLatencyFloor(float floorMicros){_floor = floorMicros;}
+        /// @brief 直前のサンプルの、計測から受信までの時間[us]を返します
+        float getLatency() const {return _latency;}
+        /// @brief 計測から受信までの時間の平均[us]を返します
+        float getMeanLatency() const {return _latencyMean;}
+        /// @brief 計測から受信までの時間の標準偏差(ジッタ)[us]を返します
+        float getLatencyJitter() const;
+        /// @brief 計測から受信までの時間の最大値[us]を返します(resetLatencyMaxで0に戻します)
+        float getMaxLatency() const {return _latencyMax;}
+        /// @brief 計測から受信までの時間の最大値を0に戻します
+        void resetLatencyMax(){_latencyMax = 0.0f;}
+
+        /// @brief 近似に使ったサンプル数を返します(やり直すと0に戻ります)
+        uint32_t getSampleCount() const {return _sampleCount;}
+        /// @brief 近似をやり直した回数を返します
+        uint32_t getResetCount() const {return _resetCount;}
+
+        static uint64_t gpsToNanos(const MipGpsTimestampView &timestamp);
+
+    private:
+        void __restart(uint64_t sensorNanos);
+};
+
+#endif
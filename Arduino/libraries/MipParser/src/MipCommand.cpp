@@ -0,0 +1,369 @@
+
+/**
+* @file MipCommand.cpp
+* @brief  MIP command encoder source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include "MipCommand.h"
+#include "MipChecksum.h"
+#include "MipConvert.h"
+
+
+/**
+ * @brief Construct a new Mip Command:: Mip Command object
+ *
+ * @param [in] descSet ディスクリプタセット(MIP::DescSet参照)
+ */
+MipCommand::MipCommand(uint8_t descSet)
+{
+    this->begin(descSet);
+}
+
+
+/**
+ * @brief パケットの組み立てを始めます(組み立て中のデータは破棄します)。
+ *
+ * @param [in] descSet ディスクリプタセット(MIP::DescSet参照)
+ */
+void MipCommand::begin(uint8_t descSet)
+{
+    _packet[MIP::BuffPter::Sync1] = MIP::Sync1;
+    _packet[MIP::BuffPter::Sync2] = MIP::Sync2;
+    _packet[MIP::BuffPter::Descriptor] = descSet;
+    _packet[MIP::BuffPter::Length] = 0;
+    _index = MIP::HeaderLength;
+    _fieldStart = -1;
+    _error = false;
+    _finished = false;
+}
+
+
+/**
+ * @brief フィールドの組み立てを始めます。
+ *
+ * @param [in] fieldDesc フィールドディスクリプタ
+ *
+ * @return true 成功
+ * @return false パケットの最大サイズを超える、もしくは前のフィールドが終わっていない
+ */
+bool MipCommand::beginField(uint8_t fieldDesc)
+{
+    if(_fieldStart >= 0 || !this->__reserve(MIP::FieldHeaderLength))
+    {
+        _error = true;
+        return false;
+    }
+
+    _fieldStart = _index;
+    _packet[_index++] = 0;      //LengthはendFieldで書き込む
+    _packet[_index++] = fieldDesc;
+    return true;
+}
+
+/**
+ * @brief フィールドに1byte追加します。
+ *
+ * @param [in] value 追加する値
+ *
+ * @return true 成功
+ * @return false パケットの最大サイズを超える
+ */
+bool MipCommand::addU8(uint8_t value)
+{
+    if(!this->__reserve(1))
+    {
+        return false;
+    }
+    _packet[_index++] = value;
+    return true;
+}
+
+/**
+ * @brief フィールドに2byte(ビッグエンディアン)追加します。
+ *
+ * @param [in] value 追加する値
+ *
+ * @return true 成功
+ * @return false パケットの最大サイズを超える
+ */
+bool MipCommand::addU16(uint16_t value)
+{
+    if(!this->__reserve(2))
+    {
+        return false;
+    }
+    MipConv::fromUint16(value, &_packet[_index]);
+    _index += 2;
+    return true;
+}
+
+/**
+ * @brief フィールドに4byte(ビッグエンディアン)追加します。
+ *
+ * @param [in] value 追加する値
+ *
+ * @return true 成功
+ * @return false パケットの最大サイズを超える
+ */
+bool MipCommand::addU32(uint32_t value)
+{
+    if(!this->__reserve(4))
+    {
+        return false;
+    }
+    MipConv::fromUint32(value, &_packet[_index]);
+    _index += 4;
+    return true;
+}
+
+/**
+ * @brief フィールドにfloat(ビッグエンディアン)を追加します。
+ *
+ * @param [in] value 追加する値
+ *
+ * @return true 成功
+ * @return false パケットの最大サイズを超える
+ */
+bool MipCommand::addFloat(float value)
+{
+    if(!this->__reserve(4))
+    {
+        return false;
+    }
+    MipConv::fromFloat(value, &_packet[_index]);
+    _index += 4;
+    return true;
+}
+
+/**
+ * @brief フィールドにbyte列をそのまま追加します。
+ *
+ * @param [in] data 追加するデータ
+ * @param [in] length データ数
+ *
+ * @return true 成功
+ * @return false パケットの最大サイズを超える
+ */
+bool MipCommand::addBytes(const uint8_t data[], int length)
+{
+    if(length < 0 || !this->__reserve(length))
+    {
+        _error = true;
+        return false;
+    }
+    for(int i = 0; i < length; i++)
+    {
+        _packet[_index++] = data[i];
+    }
+    return true;
+}
+
+/**
+ * @brief フィールドを終了し、フィールドのLengthを書き込みます。
+ *
+ * @return true 成功
+ * @return false フィールドを始めていない
+ */
+bool MipCommand::endField()
+{
+    if(_fieldStart < 0)
+    {
+        _error = true;
+        return false;
+    }
+
+    _packet[_fieldStart + MIP::FieldPter::Length] = (uint8_t)(_index - _fieldStart);
+    _fieldStart = -1;
+    return true;
+}
+
+/**
+ * @brief フィールドを1つまとめて追加します。
+ *
+ * @param [in] fieldDesc フィールドディスクリプタ
+ * @param [in] data フィールドのデータ(nullptrでデータなし)
+ * @param [in] length データ数
+ *
+ * @return true 成功
+ * @return false パケットの最大サイズを超える、もしくは前のフィールドが終わっていない
+ */
+bool MipCommand::addField(uint8_t fieldDesc, const uint8_t data[], int length)
+{
+    if(!this->beginField(fieldDesc))
+    {
+        return false;
+    }
+    if(data != nullptr && !this->addBytes(data, length))
+    {
+        return false;
+    }
+    return this->endField();
+}
+
+
+/**
+ * @brief ペイロードのサイズとチェックサムを書き込み、パケットを完成させます。
+ *
+ * @return int パケットのサイズ(エラーの場合は0)
+ *
+ * @note 完成したパケットはgetDataで取得できます。何度呼び出しても同じパケットを返します。
+ */
+int MipCommand::finish()
+{
+    if(_finished)
+    {
+        return _index;
+    }
+    if(_error || _fieldStart >= 0 || _index == MIP::HeaderLength)
+    {
+        _error = true;
+        return 0;
+    }
+
+    _packet[MIP::BuffPter::Length] = (uint8_t)(_index - MIP::HeaderLength);
+    MipChecksum::setChecksum(_packet);
+    _index += MIP::ChecksumLength;
+    _finished = true;
+
+    return _index;
+}
+
+
+/**
+ * @brief Set to Idle(ストリームを止める)を組み立てます。
+ *
+ * @return int パケットのサイズ(エラーの場合は0)
+ */
+int MipCommand::buildIdle()
+{
+    this->begin(MIP::DescSet::Base);
+    this->addField(MIP::BaseCmd::Idle);
+    return this->finish();
+}
+
+/**
+ * @brief Resume(Idleの前の状態に戻す)を組み立てます。
+ *
+ * @return int パケットのサイズ(エラーの場合は0)
+ */
+int MipCommand::buildResume()
+{
+    this->begin(MIP::DescSet::Base);
+    this->addField(MIP::BaseCmd::Resume);
+    return this->finish();
+}
+
+/**
+ * @brief Get Device Informationを組み立てます。
+ *
+ * @return int パケットのサイズ(エラーの場合は0)
+ *
+ * @note 返信のReplyField::DeviceInfoはMipDeviceInfoViewで読めます。
+ */
+int MipCommand::buildGetDeviceInfo()
+{
+    this->begin(MIP::DescSet::Base);
+    this->addField(MIP::BaseCmd::GetDeviceInfo);
+    return this->finish();
+}
+
+/**
+ * @brief Get Data Base Rate(分周比1の時の出力周波数)を組み立てます。
+ *
+ * @param [in] descSet データのディスクリプタセット(MIP::DescSet::Imu、MIP::DescSet::Filter)
+ *
+ * @return int パケットのサイズ(エラーの場合は0)
+ *
+ * @note 返信はReplyField::BaseRate(ディスクリプタセット + 周波数[Hz])です。
+ */
+int MipCommand::buildGetBaseRate(uint8_t descSet)
+{
+    this->begin(MIP::DescSet::ThreeDm);
+    this->addField(MIP::ThreeDmCmd::GetBaseRate, &descSet, 1);
+    return this->finish();
+}
+
+/**
+ * @brief Message Format(ストリームに載せるフィールドと分周比)を組み立てます。
+ *
+ * @param [in] descSet データのディスクリプタセット(MIP::DescSet::Imu、MIP::DescSet::Filter)
+ * @param [in] fieldDesc フィールドディスクリプタ
+ * @param [in] decimation 分周比(基本周波数 / 分周比 が出力周波数になります)
+ * @param [in] count フィールドの数
+ *
+ * @return int パケットのサイズ(エラーの場合は0)
+ */
+int MipCommand::buildMessageFormat(uint8_t descSet, const uint8_t fieldDesc[], const uint16_t decimation[], int count)
+{
+    this->begin(MIP::DescSet::ThreeDm);
+    this->beginField(MIP::ThreeDmCmd::MessageFormat);
+    this->addU8(MIP::Function::Apply);
+    this->addU8(descSet);
+    this->addU8((uint8_t)count);
+    for(int i = 0; i < count; i++)
+    {
+        this->addU8(fieldDesc[i]);
+        this->addU16(decimation[i]);
+    }
+    this->endField();
+    return this->finish();
+}
+
+/**
+ * @brief Enable Data Streamを組み立てます。
+ *
+ * @param [in] descSet データのディスクリプタセット(MIP::DescSet::Imu、MIP::DescSet::Filter)
+ * @param [in] enable true:出力する false:出力しない
+ *
+ * @return int パケットのサイズ(エラーの場合は0)
+ */
+int MipCommand::buildEnableStream(uint8_t descSet, bool enable)
+{
+    this->begin(MIP::DescSet::ThreeDm);
+    this->beginField(MIP::ThreeDmCmd::EnableStream);
+    this->addU8(MIP::Function::Apply);
+    this->addU8(descSet);
+    this->addU8(enable ? 1 : 0);
+    this->endField();
+    return this->finish();
+}
+
+/**
+ * @brief Save Startup Settings(現在の設定を起動時の設定として保存する)を組み立てます。
+ *
+ * @return int パケットのサイズ(エラーの場合は0)
+ *
+ * @note センサーのフラッシュに書き込むので、設定を変えた時だけ使用してください。
+ */
+int MipCommand::buildSaveStartup()
+{
+    uint8_t function = MIP::Function::Save;
+
+    this->begin(MIP::DescSet::ThreeDm);
+    this->addField(MIP::ThreeDmCmd::DeviceSettings, &function, 1);
+    return this->finish();
+}
+
+
+/**
+ * @brief ペイロードに指定したサイズを追加できるか確認します。
+ *
+ * @param [in] length 追加するサイズ
+ *
+ * @return true 追加できる
+ * @return false ペイロードの最大サイズを超える、もしくは完成済み
+ */
+bool MipCommand::__reserve(int length)
+{
+    if(_finished || (_index - MIP::HeaderLength) + length > MIP::MaxPayload)
+    {
+        _error = true;
+        return false;
+    }
+    return true;
+}
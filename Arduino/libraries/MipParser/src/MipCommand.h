@@ -0,0 +1,102 @@
+
+/**
+* @file MipCommand.h
+* @brief  MIP command encoder header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details センサーへ送るMIPコマンドのパケットを組み立てるクラスです。
+* @details Length(パケット・フィールド)とFletcherチェックサムは自動で計算します。
+**/
+
+#ifndef __Mip_Command_h__
+#define __Mip_Command_h__
+
+#include "MipDef.h"
+
+/// @brief MIPコマンドのパケットを組み立てるクラス
+/// @details
+/// 1. begin : ディスクリプタセットを指定して組み立てを始めます
+/// 2. beginField → add～ → endField : フィールドを1つ追加します(addFieldでまとめて追加することもできます)
+/// 3. finish : ペイロードのサイズとチェックサムを書き込みます
+///
+/// 数値はビッグエンディアンで格納します。パケットの最大サイズを超えた場合はisErrorがtrueになり、finishは0を返します。
+///
+/// @code
+/// // Set to Idle
+/// MipCommand cmd(MIP::DescSet::Base);
+/// cmd.addField(MIP::BaseCmd::Idle);
+/// userial.write(cmd.getData(), cmd.finish());
+///
+/// // Enable Data Stream (0x82)
+/// cmd.begin(MIP::DescSet::ThreeDm);
+/// cmd.beginField(MIP::ThreeDmCmd::EnableStream);
+/// cmd.addU8(MIP::Function::Apply);
+/// cmd.addU8(MIP::DescSet::Filter);
+/// cmd.addU8(1);
+/// cmd.endField();
+/// userial.write(cmd.getData(), cmd.finish());
+/// @endcode
+///
+/// よく使うコマンドはbuild～でまとめて組み立てられます(finishまで行います)。
+///
+/// @code
+/// uint8_t fields[] = {MIP::FilterField::Euler, MIP::FilterField::AngularRate};
+/// uint16_t decimation[] = {1, 1};
+/// cmd.buildMessageFormat(MIP::DescSet::Filter, fields, decimation, 2);
+/// executor.enqueue(cmd);     // ACK/NACKはMipExecutorで待つ
+/// @endcode
+class MipCommand
+{
+    private:
+        uint8_t _packet[MIP::MaxPacket];
+        int _index = 0;
+        int _fieldStart = -1;
+        bool _error = false;
+        bool _finished = false;
+
+    public:
+        MipCommand(uint8_t descSet=MIP::DescSet::Base);
+
+        void begin(uint8_t descSet);
+
+        bool beginField(uint8_t fieldDesc);
+        bool addU8(uint8_t value);
+        bool addU16(uint16_t value);
+        bool addU32(uint32_t value);
+        bool addFloat(float value);
+        bool addBytes(const uint8_t data[], int length);
+        bool endField();
+        bool addField(uint8_t fieldDesc, const uint8_t data[]=nullptr, int length=0);
+
+        int finish();
+
+        //よく使うコマンド
+        int buildIdle();
+        int buildResume();
+        int buildGetDeviceInfo();
+        int buildGetBaseRate(uint8_t descSet);
+        int buildMessageFormat(uint8_t descSet, const uint8_t fieldDesc[], const uint16_t decimation[], int count);
+        int buildEnableStream(uint8_t descSet, bool enable);
+        int buildSaveStartup();
+
+        /// @brief 組み立てたパケットを返します(finishの後に使用します)
+        const uint8_t *getData() const {return _packet;}
+        /// @brief 組み立てたパケットのサイズを返します(finishの前はチェックサムを含みません)
+        int getLength() const {return _index;}
+        /// @brief パケットの最大サイズを超えた、もしくはフィールドの組み立て手順が正しくないか返します
+        bool isError() const {return _error;}
+        /// @brief finishでパケットが完成しているか返します
+        bool isFinished() const {return _finished;}
+        /// @brief ディスクリプタセットを返します
+        uint8_t getDescriptorSet() const {return _packet[MIP::BuffPter::Descriptor];}
+        /// @brief 最初のフィールドのディスクリプタ(ACK/NACKで返ってくるコマンド)を返します(フィールドがない場合は0)
+        uint8_t getFieldDescriptor() const {return (_index > MIP::HeaderLength + MIP::FieldPter::Descriptor) ? _packet[MIP::BuffPter::Payload + MIP::FieldPter::Descriptor] : 0;}
+
+    private:
+        bool __reserve(int length);
+};
+
+#endif
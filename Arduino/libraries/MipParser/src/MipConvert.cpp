@@ -0,0 +1,260 @@
+
+/**
+* @file MipConvert.cpp
+* @brief  MIP big-endian field decoder source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include <string.h>
+#include "MipConvert.h"
+
+
+/**
+ * @brief 4byte(ビッグエンディアン)を1語として読み出します(アライメントは不要)。
+ *
+ * @param [in] bytes Byte配列データ
+ *
+ * @return uint32_t bytes[0]が最上位byteの1語
+ */
+static inline uint32_t __loadBig32(const uint8_t bytes[])
+{
+#if defined(__BYTE_ORDER__)
+    uint32_t word;
+
+    memcpy(&word, bytes, sizeof(word));
+#if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    word = __builtin_bswap32(word);
+#endif
+    return word;
+#else
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+#endif
+}
+
+/**
+ * @brief 8byte(ビッグエンディアン)を1語として読み出します(アライメントは不要)。
+ *
+ * @param [in] bytes Byte配列データ
+ *
+ * @return uint64_t bytes[0]が最上位byteの1語
+ */
+static inline uint64_t __loadBig64(const uint8_t bytes[])
+{
+#if defined(__BYTE_ORDER__)
+    uint64_t word;
+
+    memcpy(&word, bytes, sizeof(word));
+#if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+#else
+    return ((uint64_t)__loadBig32(bytes) << 32) | __loadBig32(&bytes[4]);
+#endif
+}
+
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をUint16(符号なし2byte)に変換します
+ *
+ * @param [in] bytes Byte配列データ
+ * @return uint16_t 変換後のUint16(符号なし2byte)
+ */
+uint16_t MipConv::toUint16(const uint8_t bytes[])
+{
+    return (uint16_t)(((uint16_t)bytes[0] << 8) | bytes[1]);
+}
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をint16(符号あり2byte)に変換します
+ *
+ * @param [in] bytes Byte配列データ
+ * @return int16_t 変換後のint16(符号あり2byte)
+ */
+int16_t MipConv::toInt16(const uint8_t bytes[])
+{
+    return (int16_t)toUint16(bytes);
+}
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をUint32(符号なし4byte)に変換します
+ *
+ * @param [in] bytes Byte配列データ
+ * @return uint32_t 変換後のUint32(符号なし4byte)
+ */
+uint32_t MipConv::toUint32(const uint8_t bytes[])
+{
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+}
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をint32(符号あり4byte)に変換します
+ *
+ * @param [in] bytes Byte配列データ
+ * @return int32_t 変換後のint32(符号あり4byte)
+ */
+int32_t MipConv::toInt32(const uint8_t bytes[])
+{
+    return (int32_t)toUint32(bytes);
+}
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をfloat(IEEE754 単精度)に変換します
+ *
+ * @param [in] bytes Byte配列データ
+ * @return float 変換後のfloat
+ */
+float MipConv::toFloat(const uint8_t bytes[])
+{
+    uint32_t bits = toUint32(bytes);
+    float value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をdouble(IEEE754 倍精度)に変換します
+ *
+ * @param [in] bytes Byte配列データ
+ * @return double 変換後のdouble
+ */
+double MipConv::toDouble(const uint8_t bytes[])
+{
+    uint64_t bits = ((uint64_t)toUint32(bytes) << 32) | toUint32(&bytes[4]);
+    double value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をfloat x3(X,Y,Z等)に変換します
+ *
+ * @param [in] bytes Byte配列データ(12byte)
+ * @param [out] vector 変換後のfloat x3
+ */
+void MipConv::toVector3f(const uint8_t bytes[], float vector[3])
+{
+    toFloats(bytes, vector, 3);
+}
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をfloat x4(クォータニオン等)に変換します
+ *
+ * @param [in] bytes Byte配列データ(16byte)
+ * @param [out] vector 変換後のfloat x4
+ */
+void MipConv::toVector4f(const uint8_t bytes[], float vector[4])
+{
+    toFloats(bytes, vector, 4);
+}
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をdouble x3(緯度・経度・高さ等)に変換します
+ *
+ * @param [in] bytes Byte配列データ(24byte)
+ * @param [out] vector 変換後のdouble x3
+ */
+void MipConv::toVector3d(const uint8_t bytes[], double vector[3])
+{
+    toDoubles(bytes, vector, 3);
+}
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をfloatの配列にまとめて変換します
+ *
+ * @param [in] bytes Byte配列データ(count × 4byte)
+ * @param [out] values 変換後のfloat
+ * @param [in] count 要素数
+ */
+void MipConv::toFloats(const uint8_t bytes[], float values[], size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        uint32_t bits = __loadBig32(&bytes[i * 4]);
+        memcpy(&values[i], &bits, sizeof(bits));
+    }
+}
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をfloatの配列にまとめて変換し、単位を変換します
+ *
+ * @param [in] bytes Byte配列データ(count × 4byte)
+ * @param [out] values 変換後のfloat(× scale)
+ * @param [in] count 要素数
+ * @param [in] scale 掛ける値(MipConv::RadToDeg等)
+ *
+ * @note 掛け算はfloatで行います。
+ */
+void MipConv::toFloats(const uint8_t bytes[], float values[], size_t count, float scale)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        uint32_t bits = __loadBig32(&bytes[i * 4]);
+        float value;
+        memcpy(&value, &bits, sizeof(bits));
+        values[i] = value * scale;
+    }
+}
+
+/**
+ * @brief Byte配列データ(ビッグエンディアン)をdoubleの配列にまとめて変換します
+ *
+ * @param [in] bytes Byte配列データ(count × 8byte)
+ * @param [out] values 変換後のdouble
+ * @param [in] count 要素数
+ */
+void MipConv::toDoubles(const uint8_t bytes[], double values[], size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        uint64_t bits = __loadBig64(&bytes[i * 8]);
+        memcpy(&values[i], &bits, sizeof(bits));
+    }
+}
+
+
+/**
+ * @brief Uint16(符号なし2byte)をByte配列データ(ビッグエンディアン)に変換します
+ *
+ * @param [in] value 変換するUint16
+ * @param [out] bytes 変換後のByte配列データ(2byte)
+ */
+void MipConv::fromUint16(uint16_t value, uint8_t bytes[])
+{
+    bytes[0] = (uint8_t)(value >> 8);
+    bytes[1] = (uint8_t)(value & 0xFF);
+}
+
+/**
+ * @brief Uint32(符号なし4byte)をByte配列データ(ビッグエンディアン)に変換します
+ *
+ * @param [in] value 変換するUint32
+ * @param [out] bytes 変換後のByte配列データ(4byte)
+ */
+void MipConv::fromUint32(uint32_t value, uint8_t bytes[])
+{
+    bytes[0] = (uint8_t)(value >> 24);
+    bytes[1] = (uint8_t)((value >> 16) & 0xFF);
+    bytes[2] = (uint8_t)((value >> 8) & 0xFF);
+    bytes[3] = (uint8_t)(value & 0xFF);
+}
+
+/**
+ * @brief float(IEEE754 単精度)をByte配列データ(ビッグエンディアン)に変換します
+ *
+ * @param [in] value 変換するfloat
+ * @param [out] bytes 変換後のByte配列データ(4byte)
+ */
+void MipConv::fromFloat(float value, uint8_t bytes[])
+{
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    fromUint32(bits, bytes);
+}
@@ -0,0 +1,50 @@
+
+/**
+* @file MipConvert.h
+* @brief  MIP big-endian field decoder header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details MIPのフィールドはビッグエンディアンなので、CPUのエンディアンに関係なく変換できる関数をまとめています。
+**/
+
+#ifndef __Mip_Convert_h__
+#define __Mip_Convert_h__
+
+#include "MipDef.h"
+
+/// @brief MIPのデータ(ビッグエンディアン)と数値の変換
+/// @details
+///  * to～ : byte列から数値へ変換します(受信データの解析)
+///  * from～ : 数値からbyte列へ変換します(コマンドの作成)
+///  * byteの並べ替えはシフトで行うので、Teensy(リトルエンディアン)でもLinuxでも同じ結果になります
+///  * to～s(toFloats等)はベクトルをまとめて変換します。4byte/8byteずつ読み出してbyte swap命令(REV等)で並べ替えます
+///  * 単位の変換(ラジアン→度等)はfloatのまま行います(doubleの計算はFPUが単精度のみのCPUでは遅いため)
+class MipConv
+{
+    public:
+        static constexpr float RadToDeg = 57.29577951f;    //!< ラジアン → 度
+        static constexpr float DegToRad = 0.01745329252f;  //!< 度 → ラジアン
+
+        static uint16_t toUint16(const uint8_t bytes[]);
+        static int16_t toInt16(const uint8_t bytes[]);
+        static uint32_t toUint32(const uint8_t bytes[]);
+        static int32_t toInt32(const uint8_t bytes[]);
+        static float toFloat(const uint8_t bytes[]);
+        static double toDouble(const uint8_t bytes[]);
+        static void toVector3f(const uint8_t bytes[], float vector[3]);
+        static void toVector4f(const uint8_t bytes[], float vector[4]);
+        static void toVector3d(const uint8_t bytes[], double vector[3]);
+
+        static void toFloats(const uint8_t bytes[], float values[], size_t count);
+        static void toFloats(const uint8_t bytes[], float values[], size_t count, float scale);
+        static void toDoubles(const uint8_t bytes[], double values[], size_t count);
+
+        static void fromUint16(uint16_t value, uint8_t bytes[]);
+        static void fromUint32(uint32_t value, uint8_t bytes[]);
+        static void fromFloat(float value, uint8_t bytes[]);
+};
+
+#endif
@@ -0,0 +1,140 @@
+
+/**
+* @file MipDef.h
+* @brief  MIP protocol definition header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details 3DM-CV7-AHRSのMIPプロトコルで使用する定数の定義です。
+**/
+
+#ifndef __Mip_Def_h__
+#define __Mip_Def_h__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// @brief MIPプロトコルの定義
+namespace MIP
+{
+    constexpr uint8_t Sync1 = 0x75;     //!< 1byte目の同期バイト('u')
+    constexpr uint8_t Sync2 = 0x65;     //!< 2byte目の同期バイト('e')
+
+    constexpr int HeaderLength = 4;     //!< ヘッダのサイズ Sync1(1),Sync2(1),Descriptor(1),Length(1)
+    constexpr int ChecksumLength = 2;   //!< チェックサムのサイズ
+    constexpr int MaxPayload = 255;     //!< ペイロードの最大サイズ
+    constexpr int MaxPacket = HeaderLength + MaxPayload + ChecksumLength;   //!< パケットの最大サイズ
+
+#if defined(__arm__)
+    constexpr size_t CacheLine = 32;    //!< キャッシュラインのサイズ[byte](Cortex-M7)
+#else
+    constexpr size_t CacheLine = 64;    //!< キャッシュラインのサイズ[byte](PC)
+#endif
+
+    /// @brief パケット内の位置
+    namespace BuffPter
+    {
+        constexpr int Sync1 = 0;        //!< 同期バイト1
+        constexpr int Sync2 = 1;        //!< 同期バイト2
+        constexpr int Descriptor = 2;   //!< ディスクリプタセット
+        constexpr int Length = 3;       //!< ペイロードのサイズ
+        constexpr int Payload = 4;      //!< ペイロードの先頭
+    }
+
+    /// @brief ディスクリプタセット
+    namespace DescSet
+    {
+        constexpr uint8_t Base = 0x01;      //!< ベースコマンド(Ping, Idle, Resume等)
+        constexpr uint8_t ThreeDm = 0x0C;   //!< 3DMコマンド(Message Format, Enable Stream等)
+        constexpr uint8_t FilterCmd = 0x0D; //!< フィルターコマンド
+        constexpr uint8_t Imu = 0x80;       //!< センサーデータ(IMU)
+        constexpr uint8_t Filter = 0x82;    //!< フィルターデータ(AHRS)
+    }
+
+    /// @brief フィールドの中の位置
+    namespace FieldPter
+    {
+        constexpr int Length = 0;       //!< フィールドのサイズ(Length,Descriptorを含む)
+        constexpr int Descriptor = 1;   //!< フィールドディスクリプタ
+        constexpr int Data = 2;         //!< フィールドのデータの先頭
+    }
+    constexpr int FieldHeaderLength = 2;    //!< フィールドのヘッダのサイズ Length(1),Descriptor(1)
+
+    /// @brief ベースコマンド(DescSet::Base)のフィールドディスクリプタ
+    namespace BaseCmd
+    {
+        constexpr uint8_t Ping = 0x01;          //!< Ping
+        constexpr uint8_t Idle = 0x02;          //!< Set to Idle(ストリーム停止)
+        constexpr uint8_t GetDeviceInfo = 0x03; //!< Get Device Information(返信はReplyField::DeviceInfo)
+        constexpr uint8_t Resume = 0x06;        //!< Resume(Idleの前の状態に戻す)
+    }
+
+    /// @brief 3DMコマンド(DescSet::ThreeDm)のフィールドディスクリプタ
+    namespace ThreeDmCmd
+    {
+        constexpr uint8_t GetBaseRate = 0x0E;   //!< Get Data Base Rate(返信はReplyField::BaseRate)
+        constexpr uint8_t MessageFormat = 0x0F; //!< Message Format(ディスクリプタセットを指定)
+        constexpr uint8_t EnableStream = 0x11;  //!< Enable Data Stream
+        constexpr uint8_t DeviceSettings = 0x30;//!< Device Startup Settings(Function::Saveで現在の設定を起動時の設定にする)
+    }
+
+    /// @brief コマンドの返信のフィールドディスクリプタ(返信はコマンドと同じディスクリプタセットで届きます)
+    namespace ReplyField
+    {
+        constexpr uint8_t DeviceInfo = 0x81;    //!< Device Information(BaseCmd::GetDeviceInfoの返信)
+        constexpr uint8_t BaseRate = 0x8E;      //!< Data Base Rate DescSet(1) + Rate[Hz](2)(ThreeDmCmd::GetBaseRateの返信)
+        constexpr uint8_t AckNack = 0xF1;       //!< ACK/NACK Command Echo(1) + Error Code(1)
+    }
+
+    /// @brief ACK/NACKのエラーコード
+    namespace AckCode
+    {
+        constexpr uint8_t Ok = 0x00;                //!< ACK
+        constexpr uint8_t UnknownCommand = 0x01;    //!< 知らないコマンド
+        constexpr uint8_t InvalidChecksum = 0x02;   //!< チェックサムが正しくない
+        constexpr uint8_t InvalidParameter = 0x03;  //!< パラメータが正しくない
+        constexpr uint8_t Failed = 0x04;            //!< コマンドの実行に失敗した
+        constexpr uint8_t Timeout = 0x05;           //!< センサー内でタイムアウトした
+    }
+
+    /// @brief 設定コマンドの機能選択
+    namespace Function
+    {
+        constexpr uint8_t Apply = 0x01;     //!< 新しい設定を使用する
+        constexpr uint8_t Read = 0x02;      //!< 現在の設定を読む
+        constexpr uint8_t Save = 0x03;      //!< 現在の設定を起動時の設定として保存する
+        constexpr uint8_t Load = 0x04;      //!< 保存した設定を読み込む
+        constexpr uint8_t Default = 0x05;   //!< 出荷時の設定に戻す
+    }
+
+    /// @brief センサーデータ(DescSet::Imu)のフィールドディスクリプタ
+    namespace ImuField
+    {
+        constexpr uint8_t Accel = 0x04;     //!< Scaled Accelerometer [g] float x3
+        constexpr uint8_t Gyro = 0x05;      //!< Scaled Gyro [rad/s] float x3
+        constexpr uint8_t Mag = 0x06;       //!< Scaled Magnetometer [Gauss] float x3
+    }
+
+    /// @brief フィルターデータ(DescSet::Filter)のフィールドディスクリプタ
+    /// @note 同じ番号でもディスクリプタセットによって意味が違います(0x80の0x05はジャイロ、0x82の0x05はオイラー角)
+    namespace FilterField
+    {
+        constexpr uint8_t Quaternion = 0x03;    //!< Attitude Quaternion float x4 + valid flags(2)
+        constexpr uint8_t Euler = 0x05;         //!< Euler Angles [rad] float x3 + valid flags(2)
+        constexpr uint8_t LinearAccel = 0x0D;   //!< Linear Acceleration [m/s^2] float x3 + valid flags(2)
+        constexpr uint8_t AngularRate = 0x0E;   //!< Compensated Angular Rate [rad/s] float x3 + valid flags(2)
+        constexpr uint8_t Status = 0x10;        //!< Filter Status
+        constexpr uint8_t CompAccel = 0x1C;     //!< Compensated Acceleration [m/s^2] float x3 + valid flags(2)
+    }
+
+    /// @brief すべてのデータのディスクリプタセットで共通のフィールドディスクリプタ
+    namespace SharedField
+    {
+        constexpr uint8_t GpsTimestamp = 0xD3;  //!< GPS Timestamp TOW[s] double + Week uint16 + valid flags(2)
+        constexpr uint8_t ReferenceTime = 0xD5; //!< Reference Timestamp [ns] uint64
+    }
+}
+
+#endif
@@ -0,0 +1,278 @@
+
+/**
+* @file MipDevice.cpp
+* @brief  MIP per-device receive state source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include <string.h>
+#include "MipDevice.h"
+
+namespace
+{
+    void copySerialNumber(char *dst, const char *src)
+    {
+        if(src == nullptr)
+        {
+            src = "";
+        }
+        strncpy(dst, src, MipDevice::MaxSerialNumber - 1);
+        dst[MipDevice::MaxSerialNumber - 1] = '\0';
+    }
+}
+
+
+/**
+ * @brief Construct a new Mip Device:: Mip Device object
+ *
+ * @param [in] name 名前(表示用、文字列は保持しません)
+ * @param [in] serialNumber シリアル番号(nullptr・空はどのセンサーでもよい)
+ */
+MipDevice::MipDevice(const char *name, const char *serialNumber)
+{
+    _name = (name == nullptr) ? "" : name;
+    copySerialNumber(_expected, serialNumber);
+    _serialNumber[0] = '\0';
+
+    _framer.setHandler(__onPacket, this);
+    _decoder.attach(_dispatcher);
+    _decoder.setClock(&_clock);
+}
+
+
+/**
+ * @brief IMUデータ(0x80)から姿勢を求めるMipAttitudeEstimatorを追加します。
+ *
+ * @param [in] estimator MipAttitudeEstimator(nullptrで外す、外すと公開するサンプルは0x82に戻ります)
+ *
+ * @note MipDispatcherに0x80のジャイロ・加速度・Reference Timestampのハンドラを登録します(同じフィールドの登録済みのハンドラは置き換えられます)。
+ * @note センサーの時刻の近似には、公開しているサンプルの時刻だけを追加します。
+ */
+void MipDevice::setEstimator(MipAttitudeEstimator *estimator)
+{
+    _estimator = estimator;
+    if(_estimator != nullptr)
+    {
+        _estimator->attach(_dispatcher);
+    }
+    this->setSource((_estimator == nullptr) ? FilterSource : _source);
+}
+
+/**
+ * @brief 公開するサンプルの出どころを切り替えます。
+ *
+ * @param [in] source 出どころ
+ *
+ * @return true 切り替えた
+ * @return false MipAttitudeEstimatorを追加していない
+ */
+bool MipDevice::setSource(Source source)
+{
+    if(source == EstimatorSource && _estimator == nullptr)
+    {
+        return false;
+    }
+
+    _source = source;
+    _decoder.setClock(&_clock, source == FilterSource);
+    if(_estimator != nullptr)
+    {
+        _estimator->setClock(&_clock, source == EstimatorSource);
+    }
+    return true;
+}
+
+/**
+ * @brief このセンサーのシリアル番号を指定します。
+ *
+ * @param [in] serialNumber シリアル番号(nullptr・空はどのセンサーでもよい)
+ */
+void MipDevice::setSerialNumber(const char *serialNumber)
+{
+    copySerialNumber(_expected, serialNumber);
+}
+
+/**
+ * @brief シリアル番号が指定したものと一致するか返します。
+ *
+ * @param [in] serialNumber 接続したセンサーのシリアル番号
+ *
+ * @return true 一致した
+ * @return false 一致しない、もしくはシリアル番号を指定していない
+ *
+ * @note シリアル番号を指定していないセンサーは、一致するセンサーがない時にMipDeviceGroupが割り当てます。
+ */
+bool MipDevice::matches(const char *serialNumber) const
+{
+    if(_expected[0] == '\0' || serialNumber == nullptr)
+    {
+        return false;
+    }
+    return strncmp(_expected, serialNumber, MaxSerialNumber - 1) == 0;
+}
+
+
+/**
+ * @brief センサーが接続された時に呼び出します。
+ *
+ * @param [in] serialNumber 接続したセンサーのシリアル番号
+ */
+void MipDevice::connect(const char *serialNumber)
+{
+    copySerialNumber(_serialNumber, serialNumber);
+    _connected = true;
+    _connectCount++;
+}
+
+/**
+ * @brief センサーが切断された時に呼び出します。
+ *
+ * @note 受信途中のデータ・送信待ちのコマンド・時刻の近似を破棄します。公開した最後のサンプルは残します。
+ */
+void MipDevice::disconnect()
+{
+    _connected = false;
+    _ring.flush();
+    _chunks.flush();
+    _framer.reset();
+    _executor.cancel();
+    _rate.reset();
+    _clock.reset();
+    _decoder.reset();
+    if(_estimator != nullptr)
+    {
+        _estimator->reset();
+    }
+}
+
+
+/**
+ * @brief リングバッファに溜まっているデータからパケットを切り出して処理します。(読み出し側)
+ *
+ * @param [in] nowMicros 現在時刻[us](micros、受信周波数の集計と切り出しまでの時間に使います)
+ * @param [in] nowMillis 現在時刻[ms](millis、コマンドの返信の処理に使います)
+ *
+ * @return int 完成したパケットの数
+ *
+ * @note 受信したまとまりごとに、そのまとまりの受信時刻を付けて処理します。受信時刻がまだ記録されていないデータは次の呼び出しで処理します。
+ */
+int MipDevice::process(uint32_t nowMicros, uint32_t nowMillis)
+{
+    _nowMillis = nowMillis;
+    _nowMicros = nowMicros;
+    _rate.update(nowMicros);
+
+    int packets = 0;
+    Chunk chunk;
+    while(_chunks.peek(chunk))
+    {
+        _stamp = chunk.stamp;
+        int32_t length = (int32_t)(chunk.end - _ring.getReadPosition());
+        if(length > 0)
+        {
+            packets += _framer.drain(_ring, (size_t)length);
+        }
+        _chunks.drop();
+    }
+    return packets;
+}
+
+/**
+ * @brief 計測から切り出しまでの時間の集計を0にします。
+ */
+void MipDevice::resetLatency()
+{
+    for(int i = 0; i < SourceCount; i++)
+    {
+        _latencyCount[i] = 0;
+        _latencySum[i] = 0;
+        _latencyMax[i] = 0;
+    }
+    _queueDelayMax = 0;
+}
+
+
+/**
+ * @brief 完成したパケットを処理します(MipFramerのハンドラ)。
+ *
+ * @param [in] packet パケット
+ * @param [in] length パケットのサイズ
+ * @param [in] context MipDevice
+ */
+void MipDevice::__onPacket(const uint8_t *packet, int length, void *context)
+{
+    (void)length;
+    MipDevice *device = (MipDevice *)context;
+
+    if(device->_executor.handlePacket(packet, device->_nowMillis))
+    {
+        return;
+    }
+
+    uint32_t stamp = device->_stamp;
+    if(packet[MIP::BuffPter::Descriptor] == MIP::DescSet::Filter)
+    {
+        device->_rate.record(stamp);
+    }
+
+    MipAttitudeEstimator *estimator = device->_estimator;
+    device->_decoder.begin();
+    if(estimator != nullptr)
+    {
+        estimator->begin();
+    }
+    device->_dispatcher.dispatch(packet);
+
+    if(device->_decoder.end(stamp))
+    {
+        device->__output(device->_decoder.sample(), FilterSource, stamp);
+    }
+    if(estimator != nullptr && estimator->end(stamp))
+    {
+        device->__output(estimator->sample(), EstimatorSource, stamp);
+    }
+}
+
+/**
+ * @brief サンプルの切り出しまでの時間を集計し、公開している出どころであればサンプルを公開します。
+ *
+ * @param [in] sample サンプル
+ * @param [in] source サンプルの出どころ
+ * @param [in] stamp パケットの受信時刻[us]
+ */
+void MipDevice::__output(const MipAhrsSample &sample, Source source, uint32_t stamp)
+{
+    //計測から切り出しまで(時刻の対応が取れるまでは受信から切り出しまで)
+    uint32_t latency = _nowMicros - sample.hostMicros;
+    uint32_t queueDelay = _nowMicros - stamp;
+    if((int32_t)latency >= 0)
+    {
+        _latencyCount[source]++;
+        _latencySum[source] += latency;
+        if(latency > _latencyMax[source])
+        {
+            _latencyMax[source] = latency;
+        }
+    }
+    if((int32_t)queueDelay >= 0 && queueDelay > _queueDelayMax)
+    {
+        _queueDelayMax = queueDelay;
+    }
+
+    if(source != _source)
+    {
+        return;
+    }
+    if(sample.fields & _publishMask)
+    {
+        _snapshot.publish(sample);
+    }
+    if(_handler != nullptr)
+    {
+        _handler(sample, _context);
+    }
+}
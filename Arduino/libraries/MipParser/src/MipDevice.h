@@ -0,0 +1,233 @@
+
+/**
+* @file MipDevice.h
+* @brief  MIP per-device receive state header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details 1台のセンサーの受信に必要なもの(リングバッファ、MipIngest、MipFramer、MipDispatcher、MipAhrsDecoder、MipClockSync、
+* @details MipRateMonitor、MipExecutor、MipSnapshot)をまとめたクラスです。センサーごとに1つ作り、シリアル番号で区別します。
+* @details 受信(receive)と処理(process)は別の実行単位から呼び出せるので、受信だけをタイマー割り込みに移せます。
+* @details setEstimatorでMipAttitudeEstimatorを追加すると、0x82の姿勢とIMUデータからの姿勢のどちらを公開するか切り替えられます。
+**/
+
+#ifndef __Mip_Device_h__
+#define __Mip_Device_h__
+
+#include "MipDef.h"
+#include "MipDispatcher.h"
+#include "MipExecutor.h"
+#include "MipRateMonitor.h"
+#include "MipClockSync.h"
+#include "MipAhrs.h"
+#include "MipEstimator.h"
+#include "MipSnapshot.h"
+#include "MipRing.h"
+#include "MipFramer.h"
+#include "MipIngest.h"
+#include "MipQueue.h"
+
+/// @brief 1台のセンサーの受信状態
+/// @details
+/// * 受信データのリングバッファ・パケットの切り出し・振り分け・AHRSサンプルを、センサーごとに別々に持ちます
+/// * 完成したパケットは、コマンドの返信ならMipExecutorへ、それ以外はMipDispatcher → MipAhrsDecoderへ渡します
+/// * setPublishMaskのフィールドを含むサンプル(初期値はオイラー角)をMipSnapshotで公開し、制御側はreadSampleでコピーします
+/// * シリアル番号(setSerialNumber)を指定すると、USBのどのポートに接続してもこのセンサーとして扱います(MipDeviceGroup)
+/// * 使うフィールドのハンドラはgetDispatcherで追加できます(AHRSのフィールドは登録済み)
+/// * receiveは受信したまとまりごとに受信時刻をMipQueueに記録し、processはまとまりごとにその時刻でパケットを切り出します。
+///   receiveをタイマー割り込みで呼び出しても、処理が遅れたパケットに後の受信時刻が付くことはありません
+/// * processで、計測(hostMicros)から切り出しまでの時間(getParseLatency)と、受信から切り出しまでの時間(getMaxQueueDelay)を集計します
+/// * setEstimatorでMipAttitudeEstimatorを追加すると、setSourceで公開するサンプルを0x82(FilterSource)と
+///   IMUデータからの推定(EstimatorSource)で切り替えられます。切り出しまでの時間はそれぞれ集計するので、遅れを比べられます
+///
+/// @code
+/// MipDevice torsoImu("torso", "6284.12345");
+/// torsoImu.receive(userial, micros());    // USBからリングバッファへ(MipDeviceGroupが呼び出します、割り込みでもよい)
+/// torsoImu.process(micros(), millis());   // パケットの切り出しと振り分け(loop)
+///
+/// MipAhrsSample sample;
+/// uint32_t sequence;
+/// torsoImu.readSample(sample, sequence);  // 制御側
+/// @endcode
+class MipDevice
+{
+    public:
+        static constexpr int MaxSerialNumber = 32;  //!< シリアル番号の最大文字数(終端を含む)
+        static constexpr size_t RingSize = 4096;    //!< 受信データのリングバッファのサイズ[byte]
+        static constexpr size_t ChunkCount = 64;    //!< 受信時刻を記録できるまとまりの数(processまでに受信できる回数)
+
+        /// @brief 公開するサンプルの出どころ
+        enum Source
+        {
+            FilterSource,       //!< センサー内のフィルター(0x82、MipAhrsDecoder)
+            EstimatorSource,    //!< IMUデータ(0x80)からの推定(MipAttitudeEstimator)
+            SourceCount
+        };
+
+        /// @brief 受信したまとまりの終わりの位置と受信時刻
+        typedef struct
+        {
+            uint32_t end;       //!< まとまりの終わり(MipRing::getWritePosition)
+            uint32_t stamp;     //!< 受信時刻[us](micros)
+        } Chunk;
+
+        /// @brief 新しいAHRSサンプルを受け取る関数(受信側から呼び出されます)
+        /// @param sample 1パケット分をまとめたサンプル
+        /// @param context setSampleHandlerで指定したポインタ
+        typedef void (*SampleHandler)(const MipAhrsSample &sample, void *context);
+
+    private:
+        const char *_name;
+        char _expected[MaxSerialNumber];    //指定したシリアル番号(空は何でもよい)
+        char _serialNumber[MaxSerialNumber];//接続中のセンサーのシリアル番号
+        bool _connected = false;
+        uint32_t _connectCount = 0;
+        uint32_t _nowMillis = 0;
+        uint32_t _nowMicros = 0;
+        uint32_t _stamp = 0;                //処理中のまとまりの受信時刻
+
+        MipRing<RingSize> _ring;
+        MipQueue<Chunk, ChunkCount> _chunks;
+        uint32_t _chunkStallCount = 0;      //受信時刻を記録できず読み残した回数(書き込み側)
+        MipIngest _ingest;
+        MipFramer _framer;
+        MipDispatcher _dispatcher;
+        MipAhrsDecoder _decoder;
+        MipAttitudeEstimator *_estimator = nullptr;
+        Source _source = FilterSource;
+        MipClockSync _clock;
+        MipRateMonitor _rate;
+        MipExecutor _executor;
+        MipSnapshot<MipAhrsSample> _snapshot;
+
+        //計測から切り出しまでの時間(読み出し側、出どころごと)
+        uint32_t _latencyCount[SourceCount] = {0, 0};
+        uint64_t _latencySum[SourceCount] = {0, 0};
+        uint32_t _latencyMax[SourceCount] = {0, 0};
+        uint32_t _queueDelayMax = 0;
+
+        uint16_t _publishMask = MipAhrsDecoder::HasEuler;
+        SampleHandler _handler = nullptr;
+        void *_context = nullptr;
+
+    public:
+        MipDevice(const char *name, const char *serialNumber=nullptr);
+
+        void setSerialNumber(const char *serialNumber);
+        bool matches(const char *serialNumber) const;
+
+        void connect(const char *serialNumber);
+        void disconnect();
+
+        /**
+         * @brief シリアルに溜まっているデータをリングバッファへ移し、受信時刻を記録します。(書き込み側)
+         *
+         * @param [in] serial センサーのシリアル(USBSerial等)
+         * @param [in] nowMicros 現在時刻[us](micros)
+         *
+         * @return size_t 移したbyte数
+         *
+         * @note リングバッファとMipQueueの書き込み側だけを使うので、タイマー割り込みから呼び出せます。
+         */
+        template<class Serial>
+        size_t receive(Serial &serial, uint32_t nowMicros)
+        {
+            //受信時刻を記録できなければ、USB側に残す
+            if(_chunks.full())
+            {
+                _chunkStallCount++;
+                return 0;
+            }
+
+            size_t got = _ingest.read(serial, _ring, nowMicros);
+            if(got > 0)
+            {
+                Chunk chunk = {_ring.getWritePosition(), nowMicros};
+                _chunks.push(chunk);
+            }
+            return got;
+        }
+
+        int process(uint32_t nowMicros, uint32_t nowMillis);
+
+        /**
+         * @brief 設定コマンドの送信・再送をします。
+         *
+         * @param [in] serial センサーのシリアル
+         * @param [in] nowMillis 現在時刻[ms](millis)
+         *
+         * @return true コマンドを送信した
+         */
+        template<class Serial>
+        bool updateCommands(Serial &serial, uint32_t nowMillis)
+        {
+            return _executor.update(serial, nowMillis);
+        }
+
+        /// @brief 公開した最新のサンプルをコピーします(MipSnapshot::read)
+        bool readSample(MipAhrsSample &sample, uint32_t &sequence){return _snapshot.read(sample, sequence);}
+        /// @brief 公開するサンプルに含まれるフィールド(MipAhrsDecoder::Has～の組み合わせ、どれか1つを含めば公開)を設定します
+        void setPublishMask(uint16_t mask){_publishMask = mask;}
+        /// @brief 新しいAHRSサンプルを受け取る関数を設定します(履歴等に使います)
+        void setSampleHandler(SampleHandler handler, void *context=nullptr){_handler = handler; _context = context;}
+
+        void setEstimator(MipAttitudeEstimator *estimator);
+        bool setSource(Source source);
+        /// @brief 公開するサンプルの出どころを返します
+        Source getSource() const {return _source;}
+        /// @brief 追加したMipAttitudeEstimatorを返します(なければnullptr)
+        MipAttitudeEstimator *getEstimator(){return _estimator;}
+
+        /// @brief 公開しているサンプルの、計測(hostMicros)から切り出しまでの時間の平均[us]を返します(resetLatencyから)
+        float getParseLatency() const {return this->getParseLatency(_source);}
+        /// @brief 指定した出どころのサンプルの、計測(hostMicros)から切り出しまでの時間の平均[us]を返します(resetLatencyから)
+        float getParseLatency(Source source) const {return (_latencyCount[source] == 0) ? 0.0f : (float)_latencySum[source] / _latencyCount[source];}
+        /// @brief 公開しているサンプルの、計測(hostMicros)から切り出しまでの時間の最大値[us]を返します(resetLatencyから)
+        uint32_t getMaxParseLatency() const {return _latencyMax[_source];}
+        /// @brief 指定した出どころのサンプルの、計測(hostMicros)から切り出しまでの時間の最大値[us]を返します(resetLatencyから)
+        uint32_t getMaxParseLatency(Source source) const {return _latencyMax[source];}
+        /// @brief 受信(receive)から切り出しまでの時間の最大値[us]を返します(resetLatencyから)
+        uint32_t getMaxQueueDelay() const {return _queueDelayMax;}
+        /// @brief 受信時刻を記録できずにUSB側に読み残した回数を返します
+        uint32_t getChunkStallCount() const {return _chunkStallCount;}
+        void resetLatency();
+
+        /// @brief 名前を返します
+        const char *getName() const {return _name;}
+        /// @brief 指定したシリアル番号を返します(空は何でもよい)
+        const char *getExpectedSerialNumber() const {return _expected;}
+        /// @brief 接続中のセンサーのシリアル番号を返します
+        const char *getSerialNumber() const {return _serialNumber;}
+        /// @brief 接続しているか返します
+        bool isConnected() const {return _connected;}
+        /// @brief 接続した回数を返します
+        uint32_t getConnectCount() const {return _connectCount;}
+
+        /// @brief 受信データのリングバッファを返します
+        MipRing<RingSize> &getRing(){return _ring;}
+        /// @brief USBからの読み出しの集計を返します
+        MipIngest &getIngest(){return _ingest;}
+        /// @brief パケットの切り出しを返します
+        MipFramer &getFramer(){return _framer;}
+        /// @brief フィールドの振り分けを返します(ハンドラの追加に使います)
+        MipDispatcher &getDispatcher(){return _dispatcher;}
+        /// @brief AHRSサンプルのデコーダーを返します
+        MipAhrsDecoder &getDecoder(){return _decoder;}
+        /// @brief センサーの時刻を返します
+        MipClockSync &getClock(){return _clock;}
+        /// @brief 0x82パケットの受信周波数を返します
+        MipRateMonitor &getRateMonitor(){return _rate;}
+        /// @brief 設定コマンドの送信を返します
+        MipExecutor &getExecutor(){return _executor;}
+        /// @brief 公開したサンプルを返します
+        MipSnapshot<MipAhrsSample> &getSnapshot(){return _snapshot;}
+
+    private:
+        void __output(const MipAhrsSample &sample, Source source, uint32_t stamp);
+
+        static void __onPacket(const uint8_t *packet, int length, void *context);
+};
+
+#endif
@@ -0,0 +1,412 @@
+
+/**
+* @file MipDeviceGroup.h
+* @brief  MIP multi-device manager header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details USBハブにつないだ複数のセンサー(USBSerial)を、シリアル番号でMipDeviceに割り当てて受信するクラスです。
+* @details 制御側には、すべてのセンサーの最新サンプルをまとめてコピーするreadを用意します。
+* @details 受信(ingest)だけをタイマー割り込みに移し、loopでは処理(service)だけを行う使い方もできます。
+**/
+
+#ifndef __Mip_Device_Group_h__
+#define __Mip_Device_Group_h__
+
+#include "MipDef.h"
+#include "MipDevice.h"
+
+/// @brief 複数のセンサーの接続管理と受信
+/// @details
+/// * addPortでUSBSerialを、addDeviceでMipDeviceを登録します
+/// * ポートに接続したセンサーは、シリアル番号(serialNumber())が一致するMipDeviceに割り当てます。
+///   一致するものがなければ、シリアル番号を指定していないMipDeviceに登録順で割り当てます
+/// * updateでは、先にすべてのポートからリングバッファへ移してから(受信時刻を記録)、センサーごとにパケットを処理します。
+///   1つのセンサーの処理時間が、他のセンサーの受信時刻を遅らせません
+/// * センサーごとに別のMipSnapshotで公開するので、制御側のreadが受信側を待たせることはありません
+/// * updateの代わりに、ingest(USBからリングバッファへ、割り込みから呼び出せます)とservice(接続の確認・パケットの処理・コマンドの送信、loop)に分けて呼び出せます。
+///   PMXの通信待ち等でloopが遅れても、受信時刻は割り込みの周期の精度で記録されます
+///
+/// @tparam Serial ポートの型(USBSerial_BigBuffer等、operator bool・begin・serialNumberを持つもの)
+/// @tparam MaxCount ポートとセンサーの最大数
+///
+/// @code
+/// USBSerial_BigBuffer userial1(myusb, 1);
+/// USBSerial_BigBuffer userial2(myusb, 1);
+/// MipDevice torsoImu("torso", "6284.12345");
+/// MipDevice legImu("leg", "6284.67890");
+/// MipDeviceGroup<USBSerial_BigBuffer, 2> sensors;
+///
+/// sensors.addPort(userial1);
+/// sensors.addPort(userial2);
+/// sensors.addDevice(torsoImu);     // 番号0
+/// sensors.addDevice(legImu);       // 番号1
+///
+/// sensors.update(micros(), millis());
+///
+/// MipDeviceGroup<USBSerial_BigBuffer, 2>::Frame frame;
+/// sensors.read(frame);             // frame.sample[0]が胴体、frame.sample[1]が脚
+/// @endcode
+///
+/// タイマー割り込みで受信する場合
+/// @code
+/// IntervalTimer sensorTimer;
+/// void onSensorTimer(){sensors.ingest(micros());}
+///
+/// sensorTimer.begin(onSensorTimer, 250);   // setup
+///
+/// NVIC_DISABLE_IRQ(IRQ_PIT);               // loop
+/// sensors.checkPorts();
+/// NVIC_ENABLE_IRQ(IRQ_PIT);
+/// sensors.process(micros(), millis());
+/// NVIC_DISABLE_IRQ(IRQ_PIT);
+/// sensors.sendCommands(millis());
+/// NVIC_ENABLE_IRQ(IRQ_PIT);
+/// @endcode
+///
+/// @attention ingestを割り込みで呼び出す場合、checkPorts・sendCommandsとUSBHost::Taskの間はその割り込みを止めてください。
+/// checkPortsはbeginで、sendCommandsはコマンドの送信でUSBへ書き込みますが、USBホストのドライバは割り込みからの同時呼び出しを想定していません。
+/// processはUSBに触れないので、割り込みを止めずに呼び出します(パケットの処理の間も受信時刻を記録できます)。
+template<class Serial, int MaxCount = 4>
+class MipDeviceGroup
+{
+    static_assert(MaxCount > 0 && MaxCount <= 32, "MaxCount must be 1 to 32 (bit masks)");
+
+    public:
+        /// @brief すべてのセンサーの最新サンプルをまとめたもの
+        typedef struct
+        {
+            MipAhrsSample sample[MaxCount]; //!< センサーごとの最新サンプル(addDeviceの順)
+            uint32_t sequence[MaxCount];    //!< サンプルの番号(MipSnapshotでpublishした回数、0はまだない)
+            uint32_t validMask;             //!< bit i: 接続中で、sample[i]が読めた
+            uint32_t connectedMask;         //!< bit i: 接続中
+            uint32_t skewMicros;            //!< 読めたサンプルの計測時刻(hostMicros)の差の最大[us]
+        } Frame;
+
+    private:
+        Serial *_port[MaxCount];
+        volatile int _portDevice[MaxCount]; //ポートに割り当てたセンサーの番号(-1はなし、ingestが割り込みで読みます)
+        bool _portOpen[MaxCount];           //接続を確認済み
+        int _portCount = 0;
+
+        MipDevice *_device[MaxCount];
+        int _deviceCount = 0;
+
+        uint32_t _baudRate;
+        uint32_t _unmatchedCount = 0;
+
+    public:
+        /**
+         * @brief Construct a new Mip Device Group object
+         *
+         * @param [in] baudRate 接続した時にbeginに渡すボーレート
+         */
+        MipDeviceGroup(uint32_t baudRate=115200) : _baudRate(baudRate)
+        {
+            for(int i = 0; i < MaxCount; i++)
+            {
+                _port[i] = nullptr;
+                _portDevice[i] = -1;
+                _portOpen[i] = false;
+                _device[i] = nullptr;
+            }
+        }
+
+        /**
+         * @brief ポートを登録します。
+         *
+         * @param [in] serial ポート(USBSerial等)
+         *
+         * @return true 登録した
+         * @return false 登録できる数を超えた
+         */
+        bool addPort(Serial &serial)
+        {
+            if(_portCount >= MaxCount)
+            {
+                return false;
+            }
+            _port[_portCount++] = &serial;
+            return true;
+        }
+
+        /**
+         * @brief センサーを登録します。
+         *
+         * @param [in] device センサー
+         *
+         * @return int センサーの番号(Frameの添字)、登録できない場合は-1
+         */
+        int addDevice(MipDevice &device)
+        {
+            if(_deviceCount >= MaxCount)
+            {
+                return -1;
+            }
+            _device[_deviceCount] = &device;
+            return _deviceCount++;
+        }
+
+        /**
+         * @brief 接続・切断の確認と、すべてのセンサーの受信をします(loopで毎回呼び出します)。
+         *
+         * @param [in] nowMicros 現在時刻[us](micros、受信時刻に使います)
+         * @param [in] nowMillis 現在時刻[ms](millis、コマンドの再送に使います)
+         */
+        void update(uint32_t nowMicros, uint32_t nowMillis)
+        {
+            this->__checkPorts();
+            this->ingest(nowMicros);
+            this->process(nowMicros, nowMillis);
+            this->sendCommands(nowMillis);
+        }
+
+        /**
+         * @brief 接続中のすべてのポートから、リングバッファへ移します。(書き込み側)
+         *
+         * @param [in] nowMicros 現在時刻[us](micros、受信時刻に使います)
+         *
+         * @note タイマー割り込みから呼び出せます(その場合はupdateの代わりにserviceをloopで呼び出します)。
+         * @note 先にすべてのポートから移すので、どのセンサーの受信時刻も他のセンサーの処理で遅れません。
+         */
+        void ingest(uint32_t nowMicros)
+        {
+            for(int p = 0; p < _portCount; p++)
+            {
+                int index = _portDevice[p];
+                if(index >= 0)
+                {
+                    _device[index]->receive(*_port[p], nowMicros);
+                }
+            }
+        }
+
+        /**
+         * @brief 接続・切断の確認と、リングバッファに溜まったパケットの処理・コマンドの送信をします。(読み出し側、loop)
+         *
+         * @param [in] nowMicros 現在時刻[us](micros)
+         * @param [in] nowMillis 現在時刻[ms](millis、コマンドの再送に使います)
+         *
+         * @note ingestを割り込みで呼び出す場合に、updateの代わりに使います。
+         * @note checkPorts → process → sendCommands の順に呼び出すのと同じです。
+         *       USBに触れるcheckPorts・sendCommandsの間だけ割り込みを止める場合は、分けて呼び出します。
+         */
+        void service(uint32_t nowMicros, uint32_t nowMillis)
+        {
+            this->checkPorts();
+            this->process(nowMicros, nowMillis);
+            this->sendCommands(nowMillis);
+        }
+
+        /**
+         * @brief すべてのポートの接続・切断を確認し、センサーを割り当てます。(loop)
+         *
+         * @note 接続時にUSBSerial::beginを呼び出すので、ingestを割り込みで呼び出す場合はその割り込みを止めて呼び出します。
+         */
+        void checkPorts()
+        {
+            this->__checkPorts();
+        }
+
+        /**
+         * @brief 割り当てたすべてのセンサーの、リングバッファに溜まったパケットを処理します。(読み出し側、loop)
+         *
+         * @param [in] nowMicros 現在時刻[us](micros)
+         * @param [in] nowMillis 現在時刻[ms](millis)
+         *
+         * @note USBには触れないので、ingestの割り込みを止めずに呼び出せます(切り出し・振り分け・姿勢推定の間も受信時刻を記録できます)。
+         */
+        void process(uint32_t nowMicros, uint32_t nowMillis)
+        {
+            for(int p = 0; p < _portCount; p++)
+            {
+                int index = _portDevice[p];
+                if(index >= 0)
+                {
+                    _device[index]->process(nowMicros, nowMillis);
+                }
+            }
+        }
+
+        /**
+         * @brief 割り当てたすべてのセンサーのコマンドを送信・再送します。(loop)
+         *
+         * @param [in] nowMillis 現在時刻[ms](millis、コマンドの再送に使います)
+         *
+         * @note USBへ書き込むので、ingestを割り込みで呼び出す場合はその割り込みを止めて呼び出します。
+         */
+        void sendCommands(uint32_t nowMillis)
+        {
+            for(int p = 0; p < _portCount; p++)
+            {
+                int index = _portDevice[p];
+                if(index >= 0)
+                {
+                    _device[index]->updateCommands(*_port[p], nowMillis);
+                }
+            }
+        }
+
+        /**
+         * @brief すべてのセンサーの最新サンプルをコピーします。(制御側)
+         *
+         * @param [out] frame コピー先
+         *
+         * @return true 登録したすべてのセンサーのサンプルが読めた
+         * @return false 読めないセンサーがある(未接続、まだサンプルがない等、validMaskで確認します)
+         */
+        bool read(Frame &frame)
+        {
+            frame.validMask = 0;
+            frame.connectedMask = 0;
+            frame.skewMicros = 0;
+
+            bool first = true;
+            uint32_t earliest = 0;
+            uint32_t latest = 0;
+
+            for(int i = 0; i < _deviceCount; i++)
+            {
+                MipDevice *device = _device[i];
+                if(!device->isConnected())
+                {
+                    frame.sequence[i] = device->getSnapshot().getSequence();
+                    continue;
+                }
+                frame.connectedMask |= (1UL << i);
+
+                if(!device->readSample(frame.sample[i], frame.sequence[i]) || frame.sequence[i] == 0)
+                {
+                    continue;
+                }
+                frame.validMask |= (1UL << i);
+
+                //micros()の桁あふれを考えて、最初のサンプルとの差で比べる
+                uint32_t stamp = frame.sample[i].hostMicros;
+                if(first)
+                {
+                    first = false;
+                    earliest = stamp;
+                    latest = stamp;
+                }
+                else if((int32_t)(stamp - earliest) < 0)
+                {
+                    earliest = stamp;
+                }
+                else if((int32_t)(stamp - latest) > 0)
+                {
+                    latest = stamp;
+                }
+            }
+
+            frame.skewMicros = latest - earliest;
+            uint32_t all = (_deviceCount >= 32) ? 0xFFFFFFFFUL : (uint32_t)((1UL << _deviceCount) - 1);
+            return _deviceCount > 0 && frame.validMask == all;
+        }
+
+        /// @brief 登録したセンサーの数を返します
+        int getDeviceCount() const {return _deviceCount;}
+        /// @brief センサーを返します(addDeviceの順)
+        MipDevice &getDevice(int index){return *_device[index];}
+        /// @brief 登録したポートの数を返します
+        int getPortCount() const {return _portCount;}
+        /**
+         * @brief ポートに割り当てたセンサーを返します。
+         *
+         * @param [in] port ポートの番号(addPortの順)
+         *
+         * @return MipDevice* センサー(割り当てていない場合はnullptr)
+         */
+        MipDevice *getPortDevice(int port){return (_portDevice[port] < 0) ? nullptr : _device[_portDevice[port]];}
+        /// @brief どのセンサーにも割り当てられなかった接続の数を返します
+        uint32_t getUnmatchedCount() const {return _unmatchedCount;}
+
+    private:
+        /**
+         * @brief すべてのポートの接続・切断を確認します。
+         */
+        void __checkPorts()
+        {
+            for(int p = 0; p < _portCount; p++)
+            {
+                this->__checkPort(p);
+            }
+        }
+
+        /**
+         * @brief ポートの接続・切断を確認し、センサーを割り当てます。
+         *
+         * @param [in] p ポートの番号
+         */
+        void __checkPort(int p)
+        {
+            Serial &serial = *_port[p];
+            bool present = (bool)serial;
+
+            if(present && !_portOpen[p])
+            {
+                _portOpen[p] = true;
+                serial.begin(_baudRate);
+
+                const char *serialNumber = (const char *)serial.serialNumber();
+                if(serialNumber == nullptr)
+                {
+                    serialNumber = "";
+                }
+
+                int index = this->__assign(serialNumber);
+                if(index < 0)
+                {
+                    _unmatchedCount++;
+                    return;
+                }
+                _device[index]->connect(serialNumber);
+
+                //接続の準備ができてから、ingestに割り当てを見せる
+                __sync_synchronize();
+                _portDevice[p] = index;
+            }
+            else if(!present && _portOpen[p])
+            {
+                _portOpen[p] = false;
+                int index = _portDevice[p];
+                if(index >= 0)
+                {
+                    //先にingestから外してから破棄する
+                    _portDevice[p] = -1;
+                    __sync_synchronize();
+                    _device[index]->disconnect();
+                }
+            }
+        }
+
+        /**
+         * @brief 接続したセンサーを割り当てるMipDeviceを選びます。
+         *
+         * @param [in] serialNumber 接続したセンサーのシリアル番号
+         *
+         * @return int センサーの番号(割り当てられない場合は-1)
+         */
+        int __assign(const char *serialNumber)
+        {
+            for(int i = 0; i < _deviceCount; i++)
+            {
+                if(!_device[i]->isConnected() && _device[i]->matches(serialNumber))
+                {
+                    return i;
+                }
+            }
+            for(int i = 0; i < _deviceCount; i++)
+            {
+                if(!_device[i]->isConnected() && _device[i]->getExpectedSerialNumber()[0] == '\0')
+                {
+                    return i;
+                }
+            }
+            return -1;
+        }
+};
+
+#endif
@@ -0,0 +1,193 @@
+
+/**
+* @file MipDispatcher.cpp
+* @brief  MIP table-driven field dispatcher source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include <string.h>
+#include "MipDispatcher.h"
+
+
+/**
+ * @brief Construct a new Mip Dispatcher:: Mip Dispatcher object
+ */
+MipDispatcher::MipDispatcher()
+{
+    this->clear();
+}
+
+
+/**
+ * @brief フィールドをそのまま受け取るハンドラを登録します。
+ *
+ * @param [in] descSet ディスクリプタセット
+ * @param [in] fieldDesc フィールドディスクリプタ
+ * @param [in] handler ハンドラ
+ * @param [in] context ハンドラに渡すポインタ
+ * @param [in] minLength 必要なデータのサイズ(これより短いフィールドはハンドラに渡しません)
+ *
+ * @return true 登録した(同じフィールドに登録済みの場合は置き換えます)
+ * @return false 登録できる数を超えた
+ */
+bool MipDispatcher::onField(uint8_t descSet, uint8_t fieldDesc, FieldHandler handler, void *context, uint8_t minLength)
+{
+    return this->__register(descSet, fieldDesc, minLength, &MipDispatcher::__invokeField, reinterpret_cast<AnyHandler>(handler), context);
+}
+
+/**
+ * @brief 登録したハンドラをすべて削除します。
+ */
+void MipDispatcher::clear()
+{
+    memset(_setSlot, NoEntry, sizeof(_setSlot));
+    memset(_fieldEntry, NoEntry, sizeof(_fieldEntry));
+    _setCount = 0;
+    _entryCount = 0;
+}
+
+
+/**
+ * @brief パケットのフィールドを登録したハンドラに振り分けます。
+ *
+ * @param [in] packet Sync1から始まるパケット(チェックサム確認済みのもの)
+ *
+ * @return int ハンドラに渡したフィールドの数
+ */
+int MipDispatcher::dispatch(const uint8_t packet[])
+{
+    uint8_t slot = _setSlot[packet[MIP::BuffPter::Descriptor]];
+
+    if(slot == NoEntry)
+    {
+        _unknownSetCount++;
+        return 0;
+    }
+
+    const uint8_t *table = _fieldEntry[slot];
+    MipFieldReader reader(packet);
+    MipField field;
+    int dispatched = 0;
+
+    while(reader.next(field))
+    {
+        uint8_t index = table[field.descriptor];
+
+        if(index == NoEntry)
+        {
+            _unknownFieldCount++;
+            continue;
+        }
+
+        const Entry &entry = _entry[index];
+
+        if(field.length < entry.minLength)
+        {
+            _shortCount++;
+            continue;
+        }
+
+        entry.invoke(field, entry.handler, entry.context);
+        dispatched++;
+    }
+
+    if(reader.isMalformed())
+    {
+        _malformedCount++;
+    }
+
+    _dispatchCount += dispatched;
+    return dispatched;
+}
+
+/**
+ * @brief MipFramerのハンドラとして使用する関数です。
+ *
+ * @param [in] packet 完成したパケット
+ * @param [in] length パケットのサイズ
+ * @param [in] context MipDispatcherのポインタ
+ *
+ * @code
+ * framer.setHandler(MipDispatcher::onPacket, &dispatcher);
+ * @endcode
+ */
+void MipDispatcher::onPacket(const uint8_t *packet, int length, void *context)
+{
+    (void)length;
+    static_cast<MipDispatcher *>(context)->dispatch(packet);
+}
+
+/**
+ * @brief 集計をすべて0にします。
+ */
+void MipDispatcher::resetCounters()
+{
+    _dispatchCount = 0;
+    _unknownFieldCount = 0;
+    _unknownSetCount = 0;
+    _shortCount = 0;
+    _malformedCount = 0;
+}
+
+
+/**
+ * @brief 表にハンドラを登録します。
+ *
+ * @param [in] descSet ディスクリプタセット
+ * @param [in] fieldDesc フィールドディスクリプタ
+ * @param [in] minLength 必要なデータのサイズ
+ * @param [in] invoke ハンドラを呼び出す関数
+ * @param [in] handler ハンドラ
+ * @param [in] context ハンドラに渡すポインタ
+ *
+ * @return true 登録した
+ * @return false 登録できる数を超えた
+ */
+bool MipDispatcher::__register(uint8_t descSet, uint8_t fieldDesc, uint8_t minLength, Invoker invoke, AnyHandler handler, void *context)
+{
+    uint8_t slot = _setSlot[descSet];
+
+    if(slot == NoEntry)
+    {
+        if(_setCount >= MaxSet)
+        {
+            return false;
+        }
+        slot = (uint8_t)_setCount++;
+        _setSlot[descSet] = slot;
+    }
+
+    uint8_t index = _fieldEntry[slot][fieldDesc];
+
+    if(index == NoEntry)
+    {
+        if(_entryCount >= MaxHandler)
+        {
+            return false;
+        }
+        index = (uint8_t)_entryCount++;
+        _fieldEntry[slot][fieldDesc] = index;
+    }
+
+    _entry[index].minLength = minLength;
+    _entry[index].invoke = invoke;
+    _entry[index].handler = handler;
+    _entry[index].context = context;
+    return true;
+}
+
+/**
+ * @brief フィールドをそのままハンドラに渡します。
+ *
+ * @param [in] field フィールド
+ * @param [in] handler 登録したハンドラ(FieldHandler)
+ * @param [in] context ハンドラに渡すポインタ
+ */
+void MipDispatcher::__invokeField(const MipField &field, AnyHandler handler, void *context)
+{
+    reinterpret_cast<FieldHandler>(handler)(field, context);
+}
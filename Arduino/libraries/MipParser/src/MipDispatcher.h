@@ -0,0 +1,132 @@
+
+/**
+* @file MipDispatcher.h
+* @brief  MIP table-driven field dispatcher header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details (ディスクリプタセット, フィールドディスクリプタ)の表から、フィールドごとに登録したハンドラを呼び出すクラスです。
+**/
+
+#ifndef __Mip_Dispatcher_h__
+#define __Mip_Dispatcher_h__
+
+#include "MipDef.h"
+#include "MipField.h"
+#include "MipView.h"
+
+/// @brief (ディスクリプタセット, フィールドディスクリプタ)の表でフィールドを振り分けるクラス
+/// @details
+/// * ディスクリプタセット → 表の番号 → フィールドディスクリプタ → ハンドラ の2回の配列参照で探します(if/elseの連続はありません)
+/// * 登録していないフィールドはLengthだけ読んで読み飛ばします(O(1))
+/// * ハンドラにはフィールドのデータをコピーせずに、型付きのビュー(MipView.h)で渡します
+/// * ビューのSizeより短いフィールドはハンドラに渡さず、getShortCountで数えます
+///
+/// フィールドを増やす時(クォータニオン、線形加速度、タイムスタンプ等)は、onでハンドラを登録するだけです。
+///
+/// @code
+/// MipDispatcher dispatcher;
+///
+/// void onEuler(const MipEulerView &euler, void *context)
+/// {
+///     roll = euler.roll();
+/// }
+///
+/// void setup()
+/// {
+///     dispatcher.on(MIP::DescSet::Filter, MIP::FilterField::Euler, onEuler);
+///     framer.setHandler(MipDispatcher::onPacket, &dispatcher);
+/// }
+/// @endcode
+class MipDispatcher
+{
+    public:
+        static constexpr int MaxSet = 4;        //!< 登録できるディスクリプタセットの数
+        static constexpr int MaxHandler = 32;   //!< 登録できるハンドラの数
+
+        /// @brief フィールドをそのまま受け取るハンドラ
+        typedef void (*FieldHandler)(const MipField &field, void *context);
+
+    private:
+        static constexpr uint8_t NoEntry = 0xFF;
+
+        typedef void (*AnyHandler)();
+        typedef void (*Invoker)(const MipField &field, AnyHandler handler, void *context);
+
+        /// @brief 登録したハンドラ
+        typedef struct
+        {
+            uint8_t minLength;      //!< 必要なデータのサイズ
+            Invoker invoke;         //!< ビューを作ってハンドラを呼び出す関数
+            AnyHandler handler;     //!< 登録したハンドラ
+            void *context;          //!< ハンドラに渡すポインタ
+        } Entry;
+
+        uint8_t _setSlot[256];                  //ディスクリプタセット → 表の番号
+        uint8_t _fieldEntry[MaxSet][256];       //フィールドディスクリプタ → ハンドラの番号
+        int _setCount = 0;
+
+        Entry _entry[MaxHandler];
+        int _entryCount = 0;
+
+        //集計
+        uint32_t _dispatchCount = 0;
+        uint32_t _unknownFieldCount = 0;
+        uint32_t _unknownSetCount = 0;
+        uint32_t _shortCount = 0;
+        uint32_t _malformedCount = 0;
+
+    public:
+        MipDispatcher();
+
+        /**
+         * @brief 型付きのビューを受け取るハンドラを登録します。
+         *
+         * @tparam View フィールドのビュー(MipVector3fView、MipEulerView等)
+         * @param [in] descSet ディスクリプタセット
+         * @param [in] fieldDesc フィールドディスクリプタ
+         * @param [in] handler ハンドラ
+         * @param [in] context ハンドラに渡すポインタ
+         *
+         * @return true 登録した(同じフィールドに登録済みの場合は置き換えます)
+         * @return false 登録できる数を超えた
+         */
+        template<class View>
+        bool on(uint8_t descSet, uint8_t fieldDesc, void (*handler)(const View &view, void *context), void *context=nullptr)
+        {
+            return this->__register(descSet, fieldDesc, View::Size, &MipDispatcher::__invokeView<View>, reinterpret_cast<AnyHandler>(handler), context);
+        }
+
+        bool onField(uint8_t descSet, uint8_t fieldDesc, FieldHandler handler, void *context=nullptr, uint8_t minLength=0);
+        void clear();
+
+        int dispatch(const uint8_t packet[]);
+        static void onPacket(const uint8_t *packet, int length, void *context);
+
+        /// @brief ハンドラに渡したフィールドの数を返します
+        uint32_t getDispatchCount(){return _dispatchCount;}
+        /// @brief 登録していないため読み飛ばしたフィールドの数を返します
+        uint32_t getUnknownFieldCount(){return _unknownFieldCount;}
+        /// @brief 登録していないディスクリプタセットのパケットの数を返します
+        uint32_t getUnknownSetCount(){return _unknownSetCount;}
+        /// @brief ビューのサイズより短かったフィールドの数を返します
+        uint32_t getShortCount(){return _shortCount;}
+        /// @brief フィールドのLengthが壊れていたパケットの数を返します
+        uint32_t getMalformedCount(){return _malformedCount;}
+
+        void resetCounters();
+
+    private:
+        bool __register(uint8_t descSet, uint8_t fieldDesc, uint8_t minLength, Invoker invoke, AnyHandler handler, void *context);
+        static void __invokeField(const MipField &field, AnyHandler handler, void *context);
+
+        template<class View>
+        static void __invokeView(const MipField &field, AnyHandler handler, void *context)
+        {
+            reinterpret_cast<void (*)(const View &, void *)>(handler)(View(field), context);
+        }
+};
+
+#endif
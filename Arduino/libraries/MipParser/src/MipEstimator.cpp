@@ -0,0 +1,593 @@
+
+/**
+* @file MipEstimator.cpp
+* @brief  On-board attitude estimator source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include <math.h>
+#include <string.h>
+#include "MipEstimator.h"
+
+namespace
+{
+    constexpr float Gravity = 9.80665f;         //重力加速度[m/s^2]
+    constexpr float InitAttitudeVar = 0.01f;    //初期化直後のクォータニオンの分散
+    constexpr float InitBiasVar = 1.0e-4f;      //初期化直後のバイアスの分散[(rad/s)^2]
+
+    void normalize(float q[4])
+    {
+        float norm = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        if(norm > 0.0f)
+        {
+            float inv = 1.0f / norm;
+            q[0] *= inv; q[1] *= inv; q[2] *= inv; q[3] *= inv;
+        }
+    }
+
+    //姿勢から求めた重力の向き(機体座標、NEDの下向き)
+    void downFromQuaternion(const float q[4], float v[3])
+    {
+        v[0] = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+        v[1] = 2.0f * (q[2] * q[3] + q[0] * q[1]);
+        v[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+    }
+
+    //q⊗[0,w] = Xi(q)w
+    void xiMatrix(const float q[4], float xi[4][3])
+    {
+        xi[0][0] = -q[1]; xi[0][1] = -q[2]; xi[0][2] = -q[3];
+        xi[1][0] =  q[0]; xi[1][1] = -q[3]; xi[1][2] =  q[2];
+        xi[2][0] =  q[3]; xi[2][1] =  q[0]; xi[2][2] = -q[1];
+        xi[3][0] = -q[2]; xi[3][1] =  q[1]; xi[3][2] =  q[0];
+    }
+
+    //q ← q + 0.5dt q⊗[0,w]
+    void integrate(float q[4], const float w[3], float dt)
+    {
+        float xi[4][3];
+        xiMatrix(q, xi);
+        float half = 0.5f * dt;
+        for(int i = 0; i < 4; i++)
+        {
+            q[i] += half * (xi[i][0] * w[0] + xi[i][1] * w[1] + xi[i][2] * w[2]);
+        }
+        normalize(q);
+    }
+}
+
+
+/**
+ * @brief Construct a new Mip Attitude Estimator:: Mip Attitude Estimator object
+ */
+MipAttitudeEstimator::MipAttitudeEstimator()
+{
+    this->reset();
+}
+
+
+/**
+ * @brief MipDispatcherにジャイロ・加速度・Reference Timestampのハンドラを登録します。
+ *
+ * @param [in] dispatcher 登録するMipDispatcher
+ * @param [in] descSet センサーデータのディスクリプタセット
+ *
+ * @return true 登録した
+ * @return false MipDispatcherに登録できる数を超えた
+ *
+ * @note 同じフィールドに登録済みのハンドラは置き換えられます。
+ */
+bool MipAttitudeEstimator::attach(MipDispatcher &dispatcher, uint8_t descSet)
+{
+    bool ok = true;
+    ok &= dispatcher.on(descSet, MIP::ImuField::Accel, __onAccel, this);
+    ok &= dispatcher.on(descSet, MIP::ImuField::Gyro, __onGyro, this);
+    ok &= dispatcher.on(descSet, MIP::SharedField::ReferenceTime, __onReferenceTime, this);
+    return ok;
+}
+
+/**
+ * @brief 推定の方法を設定します。
+ *
+ * @param [in] mode 推定の方法
+ *
+ * @note 予算を超えて相補フィルターに切り替えた状態も解除します。EKFにする場合は共分散を初期化します。
+ */
+void MipAttitudeEstimator::setMode(Mode mode)
+{
+    _mode = mode;
+    _fallback = false;
+    _overrunRun = 0;
+    this->__resetCovariance();
+}
+
+
+/**
+ * @brief パケットの振り分けの後に呼び出し、ジャイロがあれば1ステップ進めます。
+ *
+ * @param [in] arrivalMicros パケットの受信時刻[us](MipIngest::getLastStamp)
+ *
+ * @return true サンプルを更新した
+ * @return false ジャイロがない、もしくは初期化前(加速度がない・大きさが1gから離れている)
+ *
+ * @note 間隔がMaxStepより空いた場合・時刻が戻った場合は、加速度からロール・ピッチを初期化し直します(ヨーは残します)。
+ */
+bool MipAttitudeEstimator::end(uint32_t arrivalMicros)
+{
+    if(!_hasGyro)
+    {
+        return false;
+    }
+
+    uint32_t start = (_counter != nullptr) ? _counter() : 0;
+
+    //加速度の向き(下向き)と、補正に使えるか
+    float down[3] = {0.0f, 0.0f, 0.0f};
+    bool useAccel = false;
+    if(_hasAccel)
+    {
+        float norm = sqrtf(_accel[0] * _accel[0] + _accel[1] * _accel[1] + _accel[2] * _accel[2]);
+        if(norm > 0.0f && fabsf(norm - 1.0f) <= _accelTolerance)
+        {
+            float inv = -1.0f / norm;
+            down[0] = _accel[0] * inv;
+            down[1] = _accel[1] * inv;
+            down[2] = _accel[2] * inv;
+            useAccel = true;
+        }
+    }
+
+    //前のステップからの時間
+    bool hasReference = (_fields & MipAhrsDecoder::HasReferenceTime) != 0;
+    float dt = -1.0f;
+    if(_initialized)
+    {
+        if(hasReference && _lastHasReference)
+        {
+            dt = (float)(int64_t)(_referenceNanos - _lastNanos) * 1.0e-9f;
+        }
+        else
+        {
+            dt = (float)(int32_t)(arrivalMicros - _lastMicros) * 1.0e-6f;
+        }
+    }
+
+    if(dt <= 0.0f || dt > MaxStep)
+    {
+        if(!useAccel)
+        {
+            //初期化できないので、時刻だけ進める(初期化前はサンプルを出さない)
+            if(_initialized)
+            {
+                _lastHasReference = hasReference;
+                _lastNanos = _referenceNanos;
+                _lastMicros = arrivalMicros;
+            }
+            return false;
+        }
+        this->__initialize(down);
+    }
+    else if(this->getMode() == Ekf)
+    {
+        this->__stepEkf(_gyro, down, useAccel, dt);
+    }
+    else
+    {
+        this->__stepComplementary(_gyro, down, useAccel, dt);
+    }
+
+    _lastHasReference = hasReference;
+    _lastNanos = _referenceNanos;
+    _lastMicros = arrivalMicros;
+    _stepCount++;
+    if(!useAccel)
+    {
+        _rejectCount++;
+    }
+
+    this->__output(useAccel);
+
+    _sample.arrivalMicros = arrivalMicros;
+    _sample.hostMicros = arrivalMicros;
+    if(hasReference)
+    {
+        _sample.sensorNanos = _referenceNanos;
+        if(_clock != nullptr)
+        {
+            if(_feedClock)
+            {
+                _clock->add(_sample.sensorNanos, arrivalMicros);
+            }
+            if(_clock->isValid())
+            {
+                _sample.hostMicros = _clock->toHostMicros(_sample.sensorNanos);
+            }
+        }
+    }
+    _sample.sequence++;
+
+    if(_counter != nullptr)
+    {
+        this->__measureCycles(_counter() - start);
+    }
+    return true;
+}
+
+/**
+ * @brief 姿勢・バイアス・サンプルを初期化します(通し番号も0に戻します)。
+ *
+ * @note 次に加速度を受け取った時に、ロール・ピッチを加速度から、ヨーを0として初期化します。
+ */
+void MipAttitudeEstimator::reset()
+{
+    memset(&_sample, 0, sizeof(_sample));
+    _sample.quaternion[0] = 1.0f;
+    _sample.filterState = StateInit;
+
+    _initialized = false;
+    _fields = 0;
+    _hasGyro = false;
+    _hasAccel = false;
+    _lastHasReference = false;
+    _q[0] = 1.0f; _q[1] = 0.0f; _q[2] = 0.0f; _q[3] = 0.0f;
+    _bias[0] = 0.0f; _bias[1] = 0.0f; _bias[2] = 0.0f;
+    this->__resetCovariance();
+}
+
+
+/**
+ * @brief 加速度の向きからロール・ピッチを求めて、クォータニオンを初期化します。
+ *
+ * @param [in] down 加速度から求めた下向きの単位ベクトル(機体座標)
+ *
+ * @note 初期化済みの場合はヨーを残します(初回は0)。
+ */
+void MipAttitudeEstimator::__initialize(const float down[3])
+{
+    float yaw = 0.0f;
+    if(_initialized)
+    {
+        yaw = atan2f(2.0f * (_q[0] * _q[3] + _q[1] * _q[2]), 1.0f - 2.0f * (_q[2] * _q[2] + _q[3] * _q[3]));
+    }
+
+    float sinPitch = -down[0];
+    sinPitch = (sinPitch > 1.0f) ? 1.0f : ((sinPitch < -1.0f) ? -1.0f : sinPitch);
+    float roll = atan2f(down[1], down[2]);
+    float pitch = asinf(sinPitch);
+
+    float cr = cosf(0.5f * roll), sr = sinf(0.5f * roll);
+    float cp = cosf(0.5f * pitch), sp = sinf(0.5f * pitch);
+    float cy = cosf(0.5f * yaw), sy = sinf(0.5f * yaw);
+    _q[0] = cr * cp * cy + sr * sp * sy;
+    _q[1] = sr * cp * cy - cr * sp * sy;
+    _q[2] = cr * sp * cy + sr * cp * sy;
+    _q[3] = cr * cp * sy - sr * sp * cy;
+
+    this->__resetCovariance();
+    _initialized = true;
+}
+
+/**
+ * @brief 相補フィルター(Mahony)で1ステップ進めます。
+ *
+ * @param [in] gyro 角速度[rad/s]
+ * @param [in] down 加速度から求めた下向きの単位ベクトル
+ * @param [in] useAccel 加速度で補正する
+ * @param [in] dt 時間間隔[s]
+ */
+void MipAttitudeEstimator::__stepComplementary(const float gyro[3], const float down[3], bool useAccel, float dt)
+{
+    float w[3] = {gyro[0] - _bias[0], gyro[1] - _bias[1], gyro[2] - _bias[2]};
+
+    if(useAccel)
+    {
+        //計測した重力の向きと、姿勢から求めた向きの外積
+        float v[3];
+        downFromQuaternion(_q, v);
+        float e[3] = {
+            down[1] * v[2] - down[2] * v[1],
+            down[2] * v[0] - down[0] * v[2],
+            down[0] * v[1] - down[1] * v[0]
+        };
+
+        for(int i = 0; i < 3; i++)
+        {
+            _bias[i] -= _ki * e[i] * dt;
+            w[i] += _kp * e[i];
+        }
+    }
+
+    integrate(_q, w, dt);
+}
+
+/**
+ * @brief EKF(状態: クォータニオン4 + ジャイロバイアス3)で1ステップ進めます。
+ *
+ * @param [in] gyro 角速度[rad/s]
+ * @param [in] down 加速度から求めた下向きの単位ベクトル
+ * @param [in] useAccel 加速度で更新する
+ * @param [in] dt 時間間隔[s]
+ *
+ * @details 状態遷移行列 F = [[I + 0.5dtΩ(w), -0.5dtΞ(q)], [0, I]] の形を使い、7x7の積を4行・4列分だけ計算します。
+ */
+void MipAttitudeEstimator::__stepEkf(const float gyro[3], const float down[3], bool useAccel, float dt)
+{
+    float w[3] = {gyro[0] - _bias[0], gyro[1] - _bias[1], gyro[2] - _bias[2]};
+    float half = 0.5f * dt;
+
+    //予測(ヤコビアンは進める前のクォータニオンで求める)
+    float xi[4][3];
+    xiMatrix(_q, xi);
+
+    float a[4][4] = {
+        {1.0f,           -half * w[0],   -half * w[1],   -half * w[2]},
+        {half * w[0],    1.0f,           half * w[2],    -half * w[1]},
+        {half * w[1],    -half * w[2],   1.0f,           half * w[0]},
+        {half * w[2],    half * w[1],    -half * w[0],   1.0f}
+    };
+    float b[4][3];
+    for(int i = 0; i < 4; i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            b[i][j] = -half * xi[i][j];
+        }
+    }
+
+    integrate(_q, w, dt);
+
+    //FP(バイアスの行はそのまま)
+    float fp[StateSize][StateSize];
+    for(int i = 0; i < 4; i++)
+    {
+        for(int j = 0; j < StateSize; j++)
+        {
+            float sum = 0.0f;
+            for(int k = 0; k < 4; k++)
+            {
+                sum += a[i][k] * _p[k][j];
+            }
+            for(int k = 0; k < 3; k++)
+            {
+                sum += b[i][k] * _p[4 + k][j];
+            }
+            fp[i][j] = sum;
+        }
+    }
+    for(int i = 4; i < StateSize; i++)
+    {
+        for(int j = 0; j < StateSize; j++)
+        {
+            fp[i][j] = _p[i][j];
+        }
+    }
+
+    //FPF^T(バイアスの列はそのまま)
+    for(int i = 0; i < StateSize; i++)
+    {
+        for(int j = 0; j < 4; j++)
+        {
+            float sum = 0.0f;
+            for(int k = 0; k < 4; k++)
+            {
+                sum += fp[i][k] * a[j][k];
+            }
+            for(int k = 0; k < 3; k++)
+            {
+                sum += fp[i][4 + k] * b[j][k];
+            }
+            _p[i][j] = sum;
+        }
+        for(int j = 4; j < StateSize; j++)
+        {
+            _p[i][j] = fp[i][j];
+        }
+    }
+
+    //プロセスノイズ
+    float gyroVar = (_gyroNoise * half) * (_gyroNoise * half);
+    for(int i = 0; i < 4; i++)
+    {
+        for(int j = 0; j < 4; j++)
+        {
+            _p[i][j] += gyroVar * (xi[i][0] * xi[j][0] + xi[i][1] * xi[j][1] + xi[i][2] * xi[j][2]);
+        }
+    }
+    float biasVar = _biasNoise * _biasNoise * dt;
+    for(int i = 4; i < StateSize; i++)
+    {
+        _p[i][i] += biasVar;
+    }
+
+    if(!useAccel)
+    {
+        return;
+    }
+
+    //更新: 観測は重力の向き h(q)、H = [dh/dq, 0]
+    float v[3];
+    downFromQuaternion(_q, v);
+    const float *q = _q;
+    float h[3][4] = {
+        {-2.0f * q[2],  2.0f * q[3], -2.0f * q[0], 2.0f * q[1]},
+        { 2.0f * q[1],  2.0f * q[0],  2.0f * q[3], 2.0f * q[2]},
+        { 2.0f * q[0], -2.0f * q[1], -2.0f * q[2], 2.0f * q[3]}
+    };
+
+    //PH^T (7x3)
+    float pht[StateSize][3];
+    for(int i = 0; i < StateSize; i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            pht[i][j] = _p[i][0] * h[j][0] + _p[i][1] * h[j][1] + _p[i][2] * h[j][2] + _p[i][3] * h[j][3];
+        }
+    }
+
+    //S = HPH^T + R と、その逆行列(余因子)
+    float accelVar = _accelNoise * _accelNoise;
+    float s[3][3];
+    for(int i = 0; i < 3; i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            s[i][j] = h[i][0] * pht[0][j] + h[i][1] * pht[1][j] + h[i][2] * pht[2][j] + h[i][3] * pht[3][j];
+        }
+        s[i][i] += accelVar;
+    }
+    float c00 = s[1][1] * s[2][2] - s[1][2] * s[2][1];
+    float c01 = s[1][2] * s[2][0] - s[1][0] * s[2][2];
+    float c02 = s[1][0] * s[2][1] - s[1][1] * s[2][0];
+    float det = s[0][0] * c00 + s[0][1] * c01 + s[0][2] * c02;
+    if(fabsf(det) < 1.0e-12f)
+    {
+        return;
+    }
+    float invDet = 1.0f / det;
+    float si[3][3] = {
+        {c00 * invDet, (s[0][2] * s[2][1] - s[0][1] * s[2][2]) * invDet, (s[0][1] * s[1][2] - s[0][2] * s[1][1]) * invDet},
+        {c01 * invDet, (s[0][0] * s[2][2] - s[0][2] * s[2][0]) * invDet, (s[0][2] * s[1][0] - s[0][0] * s[1][2]) * invDet},
+        {c02 * invDet, (s[0][1] * s[2][0] - s[0][0] * s[2][1]) * invDet, (s[0][0] * s[1][1] - s[0][1] * s[1][0]) * invDet}
+    };
+
+    //K = PH^T S^-1、x ← x + K(z - h)
+    float y[3] = {down[0] - v[0], down[1] - v[1], down[2] - v[2]};
+    float k[StateSize][3];
+    for(int i = 0; i < StateSize; i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            k[i][j] = pht[i][0] * si[0][j] + pht[i][1] * si[1][j] + pht[i][2] * si[2][j];
+        }
+        float dx = k[i][0] * y[0] + k[i][1] * y[1] + k[i][2] * y[2];
+        if(i < 4)
+        {
+            _q[i] += dx;
+        }
+        else
+        {
+            _bias[i - 4] += dx;
+        }
+    }
+    normalize(_q);
+
+    //P ← P - K(PH^T)^T、対称にそろえる
+    for(int i = 0; i < StateSize; i++)
+    {
+        for(int j = i; j < StateSize; j++)
+        {
+            float pij = _p[i][j] - (k[i][0] * pht[j][0] + k[i][1] * pht[j][1] + k[i][2] * pht[j][2]);
+            float pji = _p[j][i] - (k[j][0] * pht[i][0] + k[j][1] * pht[i][1] + k[j][2] * pht[i][2]);
+            _p[i][j] = _p[j][i] = 0.5f * (pij + pji);
+        }
+    }
+}
+
+/**
+ * @brief EKFの共分散を初期値にします。
+ */
+void MipAttitudeEstimator::__resetCovariance()
+{
+    memset(_p, 0, sizeof(_p));
+    for(int i = 0; i < 4; i++)
+    {
+        _p[i][i] = InitAttitudeVar;
+    }
+    for(int i = 4; i < StateSize; i++)
+    {
+        _p[i][i] = InitBiasVar;
+    }
+}
+
+/**
+ * @brief 状態からサンプル(時刻以外)を作ります。
+ *
+ * @param [in] useAccel このステップで加速度による補正をした
+ */
+void MipAttitudeEstimator::__output(bool useAccel)
+{
+    const float *q = _q;
+    for(int i = 0; i < 4; i++)
+    {
+        _sample.quaternion[i] = q[i];
+    }
+
+    float sinPitch = 2.0f * (q[0] * q[2] - q[3] * q[1]);
+    sinPitch = (sinPitch > 1.0f) ? 1.0f : ((sinPitch < -1.0f) ? -1.0f : sinPitch);
+    _sample.euler[0] = atan2f(2.0f * (q[0] * q[1] + q[2] * q[3]), 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2]));
+    _sample.euler[1] = asinf(sinPitch);
+    _sample.euler[2] = atan2f(2.0f * (q[0] * q[3] + q[1] * q[2]), 1.0f - 2.0f * (q[2] * q[2] + q[3] * q[3]));
+
+    //加速度(比力)に重力の向きを足したものが線形加速度
+    float v[3];
+    downFromQuaternion(q, v);
+    for(int i = 0; i < 3; i++)
+    {
+        _sample.angularRate[i] = _gyro[i] - _bias[i];
+        _sample.linearAccel[i] = _hasAccel ? (_accel[i] + v[i]) * Gravity : 0.0f;
+    }
+
+    _sample.filterState = StateVerticalGyro;
+    _sample.dynamicsMode = 0;
+    _sample.statusFlags = (_fallback ? StatusFallback : 0) | (useAccel ? 0 : StatusNoAccel);
+    _sample.quaternionValid = 1;
+    _sample.eulerValid = 1;
+    _sample.angularRateValid = 1;
+    _sample.linearAccelValid = _hasAccel ? 1 : 0;
+    _sample.fields = MipAhrsDecoder::HasQuaternion | MipAhrsDecoder::HasEuler | MipAhrsDecoder::HasAngularRate
+                   | MipAhrsDecoder::HasStatus | (_fields & MipAhrsDecoder::HasReferenceTime)
+                   | (_hasAccel ? MipAhrsDecoder::HasLinearAccel : 0);
+}
+
+/**
+ * @brief 1ステップのサイクル数を記録し、EKFが続けて予算を超えたら相補フィルターに切り替えます。
+ *
+ * @param [in] cycles 1ステップのサイクル数
+ */
+void MipAttitudeEstimator::__measureCycles(uint32_t cycles)
+{
+    _lastCycles = cycles;
+    if(cycles > _maxCycles)
+    {
+        _maxCycles = cycles;
+    }
+
+    if(_budget == 0 || cycles <= _budget)
+    {
+        _overrunRun = 0;
+        return;
+    }
+
+    _overrunCount++;
+    _overrunRun++;
+    if(_mode == Ekf && !_fallback && _overrunRun >= MaxOverrun)
+    {
+        _fallback = true;
+    }
+}
+
+
+void MipAttitudeEstimator::__onAccel(const MipVector3fView &view, void *context)
+{
+    MipAttitudeEstimator *self = static_cast<MipAttitudeEstimator *>(context);
+    view.get(self->_accel);
+    self->_hasAccel = true;
+}
+
+void MipAttitudeEstimator::__onGyro(const MipVector3fView &view, void *context)
+{
+    MipAttitudeEstimator *self = static_cast<MipAttitudeEstimator *>(context);
+    view.get(self->_gyro);
+    self->_hasGyro = true;
+}
+
+void MipAttitudeEstimator::__onReferenceTime(const MipReferenceTimeView &view, void *context)
+{
+    MipAttitudeEstimator *self = static_cast<MipAttitudeEstimator *>(context);
+    self->_referenceNanos = view.nanoseconds();
+    self->_fields |= MipAhrsDecoder::HasReferenceTime;
+}
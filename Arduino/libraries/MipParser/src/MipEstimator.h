@@ -0,0 +1,198 @@
+
+/**
+* @file MipEstimator.h
+* @brief  On-board attitude estimator header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details IMUデータ(0x80)のジャイロ・加速度から、Teensy側で姿勢を求めるクラスです(相補フィルター、もしくは軽量なEKF)。
+* @details センサー内のフィルター(0x82)の遅れを含まない姿勢を、0x82と同じMipAhrsSampleで出力します。
+**/
+
+#ifndef __Mip_Estimator_h__
+#define __Mip_Estimator_h__
+
+#include "MipDef.h"
+#include "MipView.h"
+#include "MipDispatcher.h"
+#include "MipClockSync.h"
+#include "MipAhrs.h"
+
+/// @brief IMUデータからの姿勢推定
+/// @details
+/// * attachでMipDispatcherに0x80のScaled Accelerometer・Scaled Gyro・Reference Timestampのハンドラを登録します
+/// * MipAhrsDecoderと同じく、パケットごとに begin → MipDispatcher::dispatch → end の順に呼び出します。
+///   ジャイロを含むパケットで1ステップ進めます(時間間隔はReference Timestamp、なければ受信時刻から求めます)
+/// * 計算はすべてfloat、行列は固定サイズ(EKFは状態7: クォータニオン4 + ジャイロバイアス3)で、メモリの確保はしません
+/// * 出力はMipAhrsSample(クォータニオン・オイラー角・バイアスを除いた角速度・線形加速度・時刻)で、0x82の出力と入れ替えられます
+/// * 磁気を使わないので、ヨーはジャイロの積分です(ロール・ピッチだけを加速度で補正します、filterStateはStateVerticalGyro)
+/// * setCycleCounterで1ステップのサイクル数を計ります。EKFが予算を続けて超えた場合は相補フィルターに切り替えます
+///
+/// 相補フィルター(Mahony)
+/// * 加速度から求めた重力の向きと、姿勢から求めた重力の向きの外積を誤差として、比例(Kp)・積分(Ki、ジャイロバイアス)で角速度を補正します
+///
+/// EKF
+/// * 予測: ジャイロ(バイアスを除く)でクォータニオンを進め、共分散にジャイロのノイズ・バイアスのランダムウォークを加えます
+/// * 更新: 加速度の向き(正規化)を観測として、クォータニオンとバイアスを補正します
+///
+/// 加速度の大きさが1gからsetAccelToleranceの割合以上ずれている間(運動・衝撃)は、加速度による補正をしません。
+///
+/// @code
+/// MipAttitudeEstimator estimator;
+/// estimator.attach(dispatcher);
+/// estimator.setClock(&clock, false);
+///
+/// void onPacket(const uint8_t *packet, int length, void *context)
+/// {
+///     estimator.begin();
+///     dispatcher.dispatch(packet);
+///     if(estimator.end(stamp))
+///     {
+///         const MipAhrsSample &sample = estimator.sample();
+///     }
+/// }
+/// @endcode
+class MipAttitudeEstimator
+{
+    public:
+        /// @brief 推定の方法
+        enum Mode
+        {
+            Complementary,  //!< 相補フィルター(Mahony)
+            Ekf             //!< 拡張カルマンフィルター(状態7)
+        };
+
+        static constexpr uint16_t StateInit = 1;            //!< filterState: 加速度による初期化待ち
+        static constexpr uint16_t StateVerticalGyro = 2;    //!< filterState: ロール・ピッチを加速度で補正中(ヨーは積分)
+        static constexpr uint16_t StatusFallback = 0x0001;  //!< statusFlags: EKFが予算を超えたため相補フィルターで計算中
+        static constexpr uint16_t StatusNoAccel = 0x0002;   //!< statusFlags: 加速度による補正をしなかった
+
+        static constexpr float DefaultKp = 1.0f;            //!< 相補フィルターの比例ゲイン[rad/s]
+        static constexpr float DefaultKi = 0.02f;           //!< 相補フィルターの積分ゲイン(ジャイロバイアス)[rad/s^2]
+        static constexpr float DefaultAccelTolerance = 0.1f;//!< 加速度で補正する大きさの範囲(1gに対する割合)
+        static constexpr float DefaultGyroNoise = 0.005f;   //!< EKFのジャイロのノイズ[rad/s]
+        static constexpr float DefaultBiasNoise = 0.0001f;  //!< EKFのバイアスのランダムウォーク[rad/s/√s]
+        static constexpr float DefaultAccelNoise = 0.05f;   //!< EKFの加速度の向きのノイズ(正規化した値)
+        static constexpr float MaxStep = 0.1f;              //!< これより長い間隔[s]が空いたら初期化し直す
+        static constexpr int MaxOverrun = 3;                //!< EKFがこの回数続けて予算を超えたら相補フィルターにする
+        static constexpr int StateSize = 7;                 //!< EKFの状態の数
+
+        /// @brief サイクル数を返す関数(TeensyではARM_DWT_CYCCNT)
+        typedef uint32_t (*CycleCounter)();
+
+    private:
+        MipAhrsSample _sample;
+        MipClockSync *_clock = nullptr;
+        bool _feedClock = false;
+
+        Mode _mode = Complementary;
+        bool _fallback = false;
+        bool _initialized = false;
+
+        //パケットから受け取った値
+        uint16_t _fields = 0;
+        bool _hasGyro = false;
+        bool _hasAccel = false;
+        float _gyro[3] = {0.0f, 0.0f, 0.0f};
+        float _accel[3] = {0.0f, 0.0f, 0.0f};
+        uint64_t _referenceNanos = 0;
+
+        //前のステップの時刻
+        bool _lastHasReference = false;
+        uint64_t _lastNanos = 0;
+        uint32_t _lastMicros = 0;
+
+        //状態
+        float _q[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+        float _bias[3] = {0.0f, 0.0f, 0.0f};
+        float _p[StateSize][StateSize];
+
+        //パラメータ
+        float _kp = DefaultKp;
+        float _ki = DefaultKi;
+        float _accelTolerance = DefaultAccelTolerance;
+        float _gyroNoise = DefaultGyroNoise;
+        float _biasNoise = DefaultBiasNoise;
+        float _accelNoise = DefaultAccelNoise;
+
+        //計算時間
+        CycleCounter _counter = nullptr;
+        uint32_t _budget = 0;
+        uint32_t _lastCycles = 0;
+        uint32_t _maxCycles = 0;
+        uint32_t _overrunCount = 0;
+        int _overrunRun = 0;
+        uint32_t _stepCount = 0;
+        uint32_t _rejectCount = 0;
+
+    public:
+        MipAttitudeEstimator();
+
+        bool attach(MipDispatcher &dispatcher, uint8_t descSet=MIP::DescSet::Imu);
+        /**
+         * @brief センサー時刻をホストの時刻に変換するMipClockSyncを設定します。
+         *
+         * @param [in] clock MipClockSync(nullptrで使用しない)
+         * @param [in] feed trueでこのクラスが時刻の組を追加する(0x82のMipAhrsDecoderも同じclockに追加する場合はfalse)
+         */
+        void setClock(MipClockSync *clock, bool feed=true){_clock = clock; _feedClock = feed;}
+
+        void setMode(Mode mode);
+        /// @brief 推定の方法を返します(予算を超えて相補フィルターに切り替えた場合はComplementary)
+        Mode getMode() const {return _fallback ? Complementary : _mode;}
+        /// @brief EKFが予算を超えたため相補フィルターに切り替えたか返します
+        bool isFallback() const {return _fallback;}
+
+        /// @brief 相補フィルターのゲインを設定します
+        void setGains(float kp, float ki){_kp = kp; _ki = ki;}
+        /// @brief 加速度で補正する大きさの範囲(1gに対する割合)を設定します
+        void setAccelTolerance(float tolerance){_accelTolerance = tolerance;}
+        /// @brief EKFのノイズ(ジャイロ[rad/s]、バイアス[rad/s/√s]、加速度の向き)を設定します
+        void setNoise(float gyro, float bias, float accel){_gyroNoise = gyro; _biasNoise = bias; _accelNoise = accel;}
+        /**
+         * @brief 1ステップのサイクル数を計る関数と予算を設定します。
+         *
+         * @param [in] counter サイクル数を返す関数(nullptrで計らない)
+         * @param [in] budget 1ステップの予算[cycle](0は予算なし)
+         */
+        void setCycleCounter(CycleCounter counter, uint32_t budget){_counter = counter; _budget = budget;}
+
+        /// @brief パケットの振り分けの前に呼び出します
+        void begin(){_fields = 0; _hasGyro = false; _hasAccel = false;}
+        bool end(uint32_t arrivalMicros);
+        void reset();
+
+        /// @brief 最新のサンプルを返します
+        const MipAhrsSample &sample() const {return _sample;}
+        /// @brief 推定したジャイロバイアス[rad/s]を返します
+        void getBias(float bias[3]) const {bias[0] = _bias[0]; bias[1] = _bias[1]; bias[2] = _bias[2];}
+
+        /// @brief 進めたステップの数を返します
+        uint32_t getStepCount() const {return _stepCount;}
+        /// @brief 加速度による補正をしなかったステップの数を返します
+        uint32_t getRejectCount() const {return _rejectCount;}
+        /// @brief 直前のステップのサイクル数を返します
+        uint32_t getLastCycles() const {return _lastCycles;}
+        /// @brief ステップのサイクル数の最大値を返します(resetCyclesで0に戻します)
+        uint32_t getMaxCycles() const {return _maxCycles;}
+        /// @brief 予算を超えたステップの数を返します
+        uint32_t getOverrunCount() const {return _overrunCount;}
+        /// @brief サイクル数の最大値を0にします
+        void resetCycles(){_maxCycles = 0;}
+
+    private:
+        void __initialize(const float down[3]);
+        void __stepComplementary(const float gyro[3], const float down[3], bool useAccel, float dt);
+        void __stepEkf(const float gyro[3], const float down[3], bool useAccel, float dt);
+        void __resetCovariance();
+        void __output(bool useAccel);
+        void __measureCycles(uint32_t cycles);
+
+        static void __onAccel(const MipVector3fView &view, void *context);
+        static void __onGyro(const MipVector3fView &view, void *context);
+        static void __onReferenceTime(const MipReferenceTimeView &view, void *context);
+};
+
+#endif
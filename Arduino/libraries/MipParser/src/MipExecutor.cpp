@@ -0,0 +1,261 @@
+
+/**
+* @file MipExecutor.cpp
+* @brief  MIP non-blocking command executor source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include <string.h>
+#include "MipExecutor.h"
+#include "MipField.h"
+
+
+/**
+ * @brief Construct a new Mip Executor:: Mip Executor object
+ */
+MipExecutor::MipExecutor()
+{
+}
+
+
+/**
+ * @brief 結果を受け取る関数を設定します。
+ *
+ * @param [in] handler 結果を受け取る関数(nullptrで呼び出さない)
+ * @param [in] context ハンドラに渡すポインタ
+ */
+void MipExecutor::setHandler(ResultHandler handler, void *context)
+{
+    _handler = handler;
+    _context = context;
+}
+
+
+/**
+ * @brief コマンドを登録します(送信はupdateで行います)。
+ *
+ * @param [in] cmd finishで完成させたコマンド(パケットはコピーするので、登録後は再利用できます)
+ * @param [in] timeout 返信を待つ時間[ms]
+ * @param [in] retries 返信がない時に再送する回数
+ *
+ * @return uint16_t コマンドの番号(Result::idと同じ)、登録できない場合は0
+ */
+uint16_t MipExecutor::enqueue(const MipCommand &cmd, uint16_t timeout, uint8_t retries)
+{
+    if(_count >= MaxQueue || !cmd.isFinished() || cmd.isError())
+    {
+        return 0;
+    }
+
+    Entry &entry = _queue[(_head + _count) % MaxQueue];
+    memcpy(entry.packet, cmd.getData(), (size_t)cmd.getLength());
+    entry.length = (uint16_t)cmd.getLength();
+    entry.id = _nextId;
+    entry.timeout = timeout;
+    entry.retries = retries;
+    _count++;
+
+    _nextId++;
+    if(_nextId == 0)
+    {
+        _nextId = 1;
+    }
+
+    return entry.id;
+}
+
+/**
+ * @brief 送信待ち・返信待ちのコマンドをすべて中止します。
+ *
+ * @note センサーの切断時などに使用します。中止したコマンドはAbortedとしてハンドラに渡します。
+ */
+void MipExecutor::cancel()
+{
+    while(_count > 0)
+    {
+        this->__finish(Aborted, 0, nullptr, _sentAt);
+    }
+}
+
+
+/**
+ * @brief 今送信するパケットを返し、返信のタイムアウトを処理します。
+ *
+ * @param [in] nowMillis 現在時刻[ms](millis)
+ * @param [out] length 送信するパケットのサイズ
+ *
+ * @return const uint8_t* 送信するパケット(送信するものがない場合はnullptr)
+ *
+ * @note 返したパケットは必ず送信してください(送信した時刻として記録します)。通常はupdateを使用します。
+ */
+const uint8_t *MipExecutor::poll(uint32_t nowMillis, int &length)
+{
+    if(_count == 0)
+    {
+        return nullptr;
+    }
+
+    Entry &entry = _queue[_head];
+
+    if(_sent)
+    {
+        if(nowMillis - _sentAt < entry.timeout)
+        {
+            return nullptr;
+        }
+
+        //再送しても返信がなかった
+        if(_attempts > entry.retries)
+        {
+            _timeoutCount++;
+            this->__finish(TimedOut, 0, nullptr, nowMillis);
+            return this->poll(nowMillis, length);
+        }
+        _retryCount++;
+    }
+
+    _sent = true;
+    _attempts++;
+    _sentAt = nowMillis;
+
+    length = entry.length;
+    return entry.packet;
+}
+
+/**
+ * @brief 受信したパケットから返信待ちのコマンドのACK/NACKを探します。
+ *
+ * @param [in] packet 受信したパケット(MipFramerのハンドラに渡されたもの)
+ * @param [in] nowMillis 現在時刻[ms](millis)
+ *
+ * @return true 返信待ちのコマンドが終わった
+ * @return false 関係のないパケット
+ *
+ * @note データのパケット(0x80、0x82等)はディスクリプタセットが違うので、フィールドを読まずにすぐ戻ります。
+ */
+bool MipExecutor::handlePacket(const uint8_t packet[], uint32_t nowMillis)
+{
+    if(_count == 0 || !_sent)
+    {
+        return false;
+    }
+
+    const Entry &entry = _queue[_head];
+    if(packet[MIP::BuffPter::Descriptor] != entry.packet[MIP::BuffPter::Descriptor])
+    {
+        return false;
+    }
+
+    uint8_t command = entry.packet[MIP::BuffPter::Payload + MIP::FieldPter::Descriptor];
+    MipFieldReader reader(packet);
+    MipField field;
+
+    while(reader.next(field))
+    {
+        if(field.descriptor != MIP::ReplyField::AckNack || field.length < 2 || field.data[0] != command)
+        {
+            continue;
+        }
+
+        uint8_t code = field.data[1];
+        if(code == MIP::AckCode::Ok)
+        {
+            _ackCount++;
+            this->__finish(Acked, code, packet, nowMillis);
+        }
+        else
+        {
+            _nackCount++;
+            this->__finish(Nacked, code, packet, nowMillis);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief 集計をすべて0にします。
+ */
+void MipExecutor::resetCounters()
+{
+    _ackCount = 0;
+    _nackCount = 0;
+    _timeoutCount = 0;
+    _retryCount = 0;
+    _maxLatency = 0;
+}
+
+/**
+ * @brief 結果の名前を返します(表示用)。
+ *
+ * @param [in] status 結果
+ *
+ * @return const char* 名前
+ */
+const char *MipExecutor::statusName(Status status)
+{
+    switch(status)
+    {
+        case Pending: return "Pending";
+        case Sent: return "Sent";
+        case Acked: return "ACK";
+        case Nacked: return "NACK";
+        case TimedOut: return "Timeout";
+        case Aborted: return "Aborted";
+        default: return "Unknown";
+    }
+}
+
+
+/**
+ * @brief 先頭のコマンドを終わらせ、ハンドラに結果を渡します。
+ *
+ * @param [in] status 結果
+ * @param [in] code ACK/NACKのエラーコード
+ * @param [in] reply 返信パケット(返信がない場合はnullptr)
+ * @param [in] nowMillis 現在時刻[ms]
+ *
+ * @note 失敗した時にsetAbortOnError(true)であれば、残りのコマンドも中止します。
+ */
+void MipExecutor::__finish(Status status, uint8_t code, const uint8_t *reply, uint32_t nowMillis)
+{
+    const Entry &entry = _queue[_head];
+
+    _last.id = entry.id;
+    _last.descSet = entry.packet[MIP::BuffPter::Descriptor];
+    _last.fieldDesc = entry.packet[MIP::BuffPter::Payload + MIP::FieldPter::Descriptor];
+    _last.status = status;
+    _last.code = code;
+    _last.attempts = _attempts;
+    _last.latency = (reply != nullptr) ? (nowMillis - _sentAt) : 0;
+
+    if(_last.latency > _maxLatency)
+    {
+        _maxLatency = _last.latency;
+    }
+
+    _head = (_head + 1) % MaxQueue;
+    _count--;
+    _sent = false;
+    _attempts = 0;
+
+    if(_handler != nullptr)
+    {
+        _handler(_last, reply, _context);
+    }
+
+    //失敗したら残りのコマンドは送らない
+    if(_abortOnError && (status == Nacked || status == TimedOut))
+    {
+        while(_count > 0)
+        {
+            this->__finish(Aborted, 0, nullptr, nowMillis);
+        }
+    }
+}
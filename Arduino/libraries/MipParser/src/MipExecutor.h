@@ -0,0 +1,173 @@
+
+/**
+* @file MipExecutor.h
+* @brief  MIP non-blocking command executor header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details MipCommandで組み立てたコマンドを順番に送信し、返信のACK/NACKを待つクラスです。
+* @details delayで待たないので、返信を待っている間も制御ループは止まりません。
+**/
+
+#ifndef __Mip_Executor_h__
+#define __Mip_Executor_h__
+
+#include "MipDef.h"
+#include "MipCommand.h"
+
+/// @brief コマンドを1つずつ送信し、ACK/NACKを待つクラス
+/// @details
+/// * enqueueで登録したコマンドを登録した順に送信します(MIPのACK/NACKには番号がないため、同時に送るのは1つだけです)
+/// * 返信パケットのACK/NACKフィールド(ReplyField::AckNack)のコマンドエコーが一致したら、すぐに次のコマンドを送信します
+/// * 返信がない場合はtimeout[ms]ごとにretries回まで再送し、それでも返信がなければタイムアウトにします
+/// * NACK・タイムアウトの時は、残りのコマンドを中止します(setAbortOnErrorで変更できます)
+/// * 結果はsetHandlerで登録した関数に渡します(返信パケットも渡すので、Get Device Info等の返信データも読めます)
+///
+/// @code
+/// MipExecutor executor;
+/// MipCommand cmd;
+/// cmd.buildIdle();
+/// executor.enqueue(cmd);
+/// cmd.buildEnableStream(MIP::DescSet::Filter, true);
+/// executor.enqueue(cmd);
+///
+/// void loop()
+/// {
+///     executor.update(userial, millis());     // 送信・再送・タイムアウト
+///     framer.drain(ring);                     // 返信はハンドラの中でexecutor.handlePacketへ
+/// }
+/// @endcode
+class MipExecutor
+{
+    public:
+        static constexpr int MaxQueue = 8;                  //!< 登録できるコマンドの数
+        static constexpr uint16_t DefaultTimeout = 300;     //!< 返信を待つ時間の初期値[ms]
+        static constexpr uint8_t DefaultRetries = 1;        //!< 再送回数の初期値
+
+        /// @brief コマンドの結果
+        enum Status : uint8_t
+        {
+            Pending = 0,    //!< 送信待ち
+            Sent,           //!< 返信待ち
+            Acked,          //!< ACKを受信した
+            Nacked,         //!< NACKを受信した(codeにエラーコード)
+            TimedOut,       //!< 再送しても返信がなかった
+            Aborted         //!< 前のコマンドが失敗したため中止した
+        };
+
+        /// @brief 1つのコマンドの結果
+        typedef struct
+        {
+            uint16_t id;            //!< enqueueが返した番号
+            uint8_t descSet;        //!< コマンドのディスクリプタセット
+            uint8_t fieldDesc;      //!< コマンドのフィールドディスクリプタ
+            Status status;          //!< 結果
+            uint8_t code;           //!< ACK/NACKのエラーコード(MIP::AckCode参照)
+            uint8_t attempts;       //!< 送信した回数
+            uint32_t latency;       //!< 最後の送信から返信までの時間[ms]
+        } Result;
+
+        /// @brief 結果を受け取る関数
+        /// @param result 結果
+        /// @param reply 返信パケット(タイムアウト・中止の場合はnullptr)
+        /// @param context setHandlerで指定したポインタ
+        typedef void (*ResultHandler)(const Result &result, const uint8_t *reply, void *context);
+
+    private:
+        /// @brief 登録したコマンド
+        typedef struct
+        {
+            uint8_t packet[MIP::MaxPacket];     //!< 完成したパケット
+            uint16_t length;                    //!< パケットのサイズ
+            uint16_t id;                        //!< 番号
+            uint16_t timeout;                   //!< 返信を待つ時間[ms]
+            uint8_t retries;                    //!< 再送回数
+        } Entry;
+
+        Entry _queue[MaxQueue];
+        int _head = 0;
+        int _count = 0;
+        uint16_t _nextId = 1;
+
+        //先頭のコマンドの状態
+        bool _sent = false;
+        uint8_t _attempts = 0;
+        uint32_t _sentAt = 0;
+
+        bool _abortOnError = true;
+        ResultHandler _handler = nullptr;
+        void *_context = nullptr;
+        Result _last = {0, 0, 0, Pending, 0, 0, 0};
+
+        //集計
+        uint32_t _ackCount = 0;
+        uint32_t _nackCount = 0;
+        uint32_t _timeoutCount = 0;
+        uint32_t _retryCount = 0;
+        uint32_t _maxLatency = 0;
+
+    public:
+        MipExecutor();
+
+        void setHandler(ResultHandler handler, void *context=nullptr);
+        /// @brief NACK・タイムアウトの時に残りのコマンドを中止するか設定します(初期値true)
+        void setAbortOnError(bool abort){_abortOnError = abort;}
+
+        uint16_t enqueue(const MipCommand &cmd, uint16_t timeout=DefaultTimeout, uint8_t retries=DefaultRetries);
+        void cancel();
+
+        /**
+         * @brief 送信・再送・タイムアウトの処理をします(loopで毎回呼び出します)。
+         *
+         * @param [in] serial センサーのシリアル(USBSerial等、write(const uint8_t*, size_t)を持っていれば使えます)
+         * @param [in] nowMillis 現在時刻[ms](millis)
+         *
+         * @return true コマンドを送信した
+         * @return false 送信していない(返信待ち、もしくはコマンドがない)
+         */
+        template<class Serial>
+        bool update(Serial &serial, uint32_t nowMillis)
+        {
+            int length = 0;
+            const uint8_t *packet = this->poll(nowMillis, length);
+
+            if(packet == nullptr)
+            {
+                return false;
+            }
+            serial.write(packet, (size_t)length);
+            return true;
+        }
+
+        const uint8_t *poll(uint32_t nowMillis, int &length);
+        bool handlePacket(const uint8_t packet[], uint32_t nowMillis);
+
+        /// @brief 送信待ち・返信待ちのコマンドがあるか返します
+        bool isBusy() const {return _count > 0;}
+        /// @brief 送信待ち・返信待ちのコマンドの数を返します
+        int getPendingCount() const {return _count;}
+        /// @brief 最後に終わったコマンドの結果を返します
+        const Result &getLastResult() const {return _last;}
+
+        /// @brief ACKを受信した数を返します
+        uint32_t getAckCount(){return _ackCount;}
+        /// @brief NACKを受信した数を返します
+        uint32_t getNackCount(){return _nackCount;}
+        /// @brief タイムアウトした数を返します
+        uint32_t getTimeoutCount(){return _timeoutCount;}
+        /// @brief 再送した数を返します
+        uint32_t getRetryCount(){return _retryCount;}
+        /// @brief 送信から返信までの時間の最大値[ms]を返します
+        uint32_t getMaxLatency(){return _maxLatency;}
+
+        void resetCounters();
+
+        static const char *statusName(Status status);
+
+    private:
+        void __finish(Status status, uint8_t code, const uint8_t *reply, uint32_t nowMillis);
+};
+
+#endif
@@ -0,0 +1,67 @@
+
+/**
+* @file MipField.cpp
+* @brief  MIP field reader source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include "MipField.h"
+
+
+/**
+ * @brief Construct a new Mip Field Reader:: Mip Field Reader object
+ *
+ * @param [in] packet Sync1から始まるパケット(MipFramerのハンドラに渡されたもの)
+ */
+MipFieldReader::MipFieldReader(const uint8_t packet[])
+{
+    _payload = &packet[MIP::BuffPter::Payload];
+    _payloadLength = packet[MIP::BuffPter::Length];
+    _descSet = packet[MIP::BuffPter::Descriptor];
+}
+
+
+/**
+ * @brief 次のフィールドを取り出します。
+ *
+ * @param [out] field 取り出したフィールド
+ *
+ * @return true フィールドを取り出した
+ * @return false これ以上フィールドがない、もしくは壊れたフィールドがあった
+ */
+bool MipFieldReader::next(MipField &field)
+{
+    if(_malformed || _index >= _payloadLength)
+    {
+        return false;
+    }
+
+    const uint8_t *p = &_payload[_index];
+    int fieldLength = p[MIP::FieldPter::Length];
+
+    if(fieldLength < MIP::FieldHeaderLength || fieldLength > _payloadLength - _index)
+    {
+        _malformed = true;
+        return false;
+    }
+
+    field.descriptor = p[MIP::FieldPter::Descriptor];
+    field.length = (uint8_t)(fieldLength - MIP::FieldHeaderLength);
+    field.data = &p[MIP::FieldPter::Data];
+
+    _index += fieldLength;
+    return true;
+}
+
+/**
+ * @brief 最初のフィールドに戻ります。
+ */
+void MipFieldReader::reset()
+{
+    _index = 0;
+    _malformed = false;
+}
@@ -0,0 +1,65 @@
+
+/**
+* @file MipField.h
+* @brief  MIP field reader header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details MIPパケットのペイロードに並んでいるフィールドを先頭から順番に取り出すクラスです。
+**/
+
+#ifndef __Mip_Field_h__
+#define __Mip_Field_h__
+
+#include "MipDef.h"
+
+/// @brief 取り出したフィールド
+/// @note dataはパケットの中を指しているので、パケットが有効な間だけ使用できます。
+typedef struct
+{
+    uint8_t descriptor;     //!< フィールドディスクリプタ
+    uint8_t length;         //!< データのサイズ(Length,Descriptorを含まない)
+    const uint8_t *data;    //!< データの先頭
+} MipField;
+
+/// @brief ペイロードのフィールドを順番に取り出すクラス
+/// @details
+/// * フィールドのLengthが2未満、もしくはペイロードをはみ出す場合はそこで終了し、isMalformedがtrueになります
+/// * データはコピーしません(MipField::dataはパケットの中を指します)
+///
+/// @code
+/// MipFieldReader reader(packet);
+/// MipField field;
+/// while(reader.next(field))
+/// {
+///     if(field.descriptor == MIP::FilterField::Euler && field.length >= 12)
+///     {
+///         float rpy[3];
+///         MipConv::toVector3f(field.data, rpy);
+///     }
+/// }
+/// @endcode
+class MipFieldReader
+{
+    private:
+        const uint8_t *_payload;
+        int _payloadLength;
+        int _index = 0;
+        uint8_t _descSet;
+        bool _malformed = false;
+
+    public:
+        MipFieldReader(const uint8_t packet[]);
+
+        bool next(MipField &field);
+        void reset();
+
+        /// @brief パケットのディスクリプタセットを返します
+        uint8_t getDescriptorSet(){return _descSet;}
+        /// @brief 壊れたフィールドがあって途中で終了したか返します
+        bool isMalformed(){return _malformed;}
+};
+
+#endif
@@ -0,0 +1,363 @@
+
+/**
+* @file MipFramer.cpp
+* @brief  MIP streaming packet framer source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include <string.h>
+#include "MipFramer.h"
+#include "MipChecksum.h"
+
+
+/**
+ * @brief Construct a new Mip Framer:: Mip Framer object
+ */
+MipFramer::MipFramer()
+{
+}
+
+
+/**
+ * @brief 完成したパケットを受け取る関数を設定します。
+ *
+ * @param [in] handler パケットを受け取る関数(nullptrで呼び出さない)
+ * @param [in] context ハンドラに渡すポインタ
+ */
+void MipFramer::setHandler(PacketHandler handler, void *context)
+{
+    _handler = handler;
+    _context = context;
+}
+
+/**
+ * @brief 受け付けるペイロードサイズの上限を設定します。
+ *
+ * @param [in] maxPayload ペイロードサイズの上限(2～MIP::MaxPayload)
+ *
+ * @note 上限を超えるLengthを受信した場合は壊れたヘッダとして読み捨て、getOversizeCountを増やします。
+ */
+void MipFramer::setMaxPayload(int maxPayload)
+{
+    if(maxPayload < 2)
+    {
+        maxPayload = 2;
+    }
+    if(maxPayload > MIP::MaxPayload)
+    {
+        maxPayload = MIP::MaxPayload;
+    }
+    _maxPayload = maxPayload;
+}
+
+
+/**
+ * @brief 1byteを処理します。
+ *
+ * @param [in] data 受信した1byte
+ *
+ * @return true このbyteでパケットが完成した(getPacketで取得できます)
+ * @return false パケットの途中、もしくはエラー
+ *
+ * @note チェックサムエラーの後は、組み立て中だったbyteを探し直してから戻ります(この時は複数のパケットが完成することがあります)。
+ */
+bool MipFramer::push(uint8_t data)
+{
+    bool completed = this->__step(data);
+
+    //チェックサムエラー・サイズ異常で探し直すbyteを、次の入力より先に処理する
+    while(_pendingIndex < _pendingLength)
+    {
+        if(this->__step(_pending[_pendingIndex++]))
+        {
+            completed = true;
+        }
+    }
+    _pendingIndex = 0;
+    _pendingLength = 0;
+
+    return completed;
+}
+
+/**
+ * @brief 状態遷移で1byteを処理します。
+ *
+ * @param [in] data 処理する1byte
+ *
+ * @return true このbyteでパケットが完成した
+ * @return false パケットの途中、もしくはエラー
+ */
+bool MipFramer::__step(uint8_t data)
+{
+    switch(_state)
+    {
+        case WaitSync1:
+            if(data == MIP::Sync1)
+            {
+                _index = 0;
+                _sum1 = 0;
+                _sum2 = 0;
+                this->__add(data);
+                _state = WaitSync2;
+            }
+            else
+            {
+                this->__lostSync(1);
+            }
+            return false;
+
+        case WaitSync2:
+            if(data == MIP::Sync2)
+            {
+                this->__add(data);
+                _state = WaitDescriptor;
+            }
+            else if(data == MIP::Sync1)
+            {
+                //前のSync1を捨てて、このbyteを新しいSync1にする
+                this->__lostSync(1);
+                _index = 0;
+                _sum1 = 0;
+                _sum2 = 0;
+                this->__add(data);
+            }
+            else
+            {
+                this->__lostSync(2);
+                _state = WaitSync1;
+            }
+            return false;
+
+        case WaitDescriptor:
+            this->__add(data);
+            _state = WaitLength;
+            return false;
+
+        case WaitLength:
+            //ペイロードには最低1つのフィールド(Length,Descriptor)が入る
+            if(data < 2 || data > _maxPayload)
+            {
+                _oversizeCount++;
+                _packet[_index++] = data;
+                _state = WaitSync1;
+                this->__lostSync(this->__rescan());
+                return false;
+            }
+            this->__add(data);
+            _payloadLength = data;
+            _state = WaitPayload;
+            return false;
+
+        case WaitPayload:
+            this->__add(data);
+            if(_index >= MIP::HeaderLength + _payloadLength)
+            {
+                _state = WaitChecksum1;
+            }
+            return false;
+
+        case WaitChecksum1:
+            _packet[_index++] = data;
+            _state = WaitChecksum2;
+            return false;
+
+        case WaitChecksum2:
+        default:
+            _state = WaitSync1;
+            return this->__complete(data);
+    }
+}
+
+/**
+ * @brief 複数byteをまとめて処理します。
+ *
+ * @param [in] data 受信したデータ
+ * @param [in] length データ数
+ *
+ * @return int 完成したパケットの数
+ *
+ * @note 完成したパケットはその都度ハンドラに渡します。
+ */
+int MipFramer::push(const uint8_t *data, size_t length)
+{
+    uint32_t packets = _packetCount;
+    size_t i = 0;
+
+    while(i < length)
+    {
+        //ペイロードの途中は残りのサイズ分をまとめてコピーする
+        if(_state == WaitPayload)
+        {
+            size_t need = (size_t)(MIP::HeaderLength + _payloadLength - _index);
+            size_t run = (length - i < need) ? (length - i) : need;
+
+            this->__addRun(&data[i], run);
+            i += run;
+
+            if(_index >= MIP::HeaderLength + _payloadLength)
+            {
+                _state = WaitChecksum1;
+            }
+            continue;
+        }
+
+        this->push(data[i++]);
+    }
+
+    //探し直したbyteから複数のパケットが完成することがあるので、完成した数で数える
+    return (int)(_packetCount - packets);
+}
+
+/**
+ * @brief 組み立て中のパケットを捨て、同期バイト待ちに戻します。
+ *
+ * @note センサーの切断時などに使用します。集計は0にしません。
+ */
+void MipFramer::reset()
+{
+    _state = WaitSync1;
+    _index = 0;
+    _payloadLength = 0;
+    _pendingIndex = 0;
+    _pendingLength = 0;
+    _synced = false;
+}
+
+/**
+ * @brief 集計をすべて0にします。
+ */
+void MipFramer::resetCounters()
+{
+    _packetCount = 0;
+    _syncLossCount = 0;
+    _discardedBytes = 0;
+    _checksumErrorCount = 0;
+    _oversizeCount = 0;
+    _rescanCount = 0;
+}
+
+
+/**
+ * @brief 組み立て中のbyteから、次の同期バイトの候補を探し直します。
+ *
+ * @note 先頭のSync1の次から探し、見つかった位置からのbyteを、まだ処理していないbyteの前に入れます(pushで次の入力より先に処理します)。
+ * @note 偽の同期バイトで始まったパケットが、後ろにある正しいパケットを偽のLengthの分まとめて捨てないようにするためです。
+ * @note 探し直すbyteは組み立て中のbyteの一部なので、合計はMIP::MaxPacketを超えません。
+ *
+ * @return int 探し直さずに捨てたbyte数
+ */
+int MipFramer::__rescan()
+{
+    int start = 1;
+    while(start < _index && _packet[start] != MIP::Sync1)
+    {
+        start++;
+    }
+
+    int length = _index - start;
+    int remain = _pendingLength - _pendingIndex;
+    _index = 0;
+
+    if(length == 0)
+    {
+        return start;
+    }
+
+    //処理し直している途中のエラーは、残りのbyteを後ろにずらしてから入れる
+    memmove(&_pending[length], &_pending[_pendingIndex], remain);
+    memcpy(_pending, &_packet[start], length);
+    _pendingIndex = 0;
+    _pendingLength = length + remain;
+    _rescanCount++;
+
+    return start;
+}
+
+/**
+ * @brief パケットに1byte追加し、チェックサムを更新します。
+ *
+ * @param [in] data 追加するbyte
+ */
+void MipFramer::__add(uint8_t data)
+{
+    _packet[_index++] = data;
+    _sum1 += data;
+    _sum2 += _sum1;
+}
+
+/**
+ * @brief パケットに複数byte追加し、チェックサムを更新します。
+ *
+ * @param [in] data 追加するデータ
+ * @param [in] length データ数
+ *
+ * @note チェックサムは4byteずつ計算します(MipChecksum::update)。
+ */
+void MipFramer::__addRun(const uint8_t *data, size_t length)
+{
+    memcpy(&_packet[_index], data, length);
+    MipChecksum::update(_sum1, _sum2, data, length);
+
+    _index += (int)length;
+}
+
+/**
+ * @brief 読み捨てたbyteを記録します。
+ *
+ * @param [in] discarded 読み捨てたbyte数
+ *
+ * @note 同期している状態から読み捨てが始まった時だけ同期外れとして数えます。
+ */
+void MipFramer::__lostSync(int discarded)
+{
+    if(_synced)
+    {
+        _syncLossCount++;
+        _synced = false;
+    }
+    _discardedBytes += discarded;
+}
+
+/**
+ * @brief チェックサムを確認してパケットを完成させます。
+ *
+ * @param [in] checksum2 チェックサムの2byte目
+ *
+ * @return true パケット完成
+ * @return false チェックサムエラー
+ */
+bool MipFramer::__complete(uint8_t checksum2)
+{
+    _packet[_index++] = checksum2;
+
+    bool valid = (_packet[_index - 2] == _sum1 && checksum2 == _sum2);
+
+    if(!valid)
+    {
+        _checksumErrorCount++;
+        _synced = false;
+
+        if(_verifyChecksum)
+        {
+            this->__rescan();
+            return false;
+        }
+    }
+    else
+    {
+        _synced = true;
+    }
+
+    _packetCount++;
+
+    if(_handler != nullptr)
+    {
+        _handler(_packet, _index, _context);
+    }
+
+    return true;
+}
@@ -0,0 +1,161 @@
+
+/**
+* @file MipFramer.h
+* @brief  MIP streaming packet framer header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details 受信したbyte列を1byteずつ状態遷移で処理し、MIPパケットを切り出すクラスです。
+* @details 受信済みのデータを先頭から探し直したり、memmoveで詰め直したりしません(チェックサムエラー・サイズ異常の時だけ、組み立て中のbyteから同期バイトを探し直します)。
+**/
+
+#ifndef __Mip_Framer_h__
+#define __Mip_Framer_h__
+
+#include "MipDef.h"
+#include "MipRing.h"
+
+/// @brief MIPパケットを1byteずつ組み立てる状態遷移のクラス
+/// @details
+/// Sync1 → Sync2 → Descriptor → Length → Payload → Checksum1 → Checksum2 の順に遷移します。
+/// * 各byteは1回しか処理しません(O(1)/byte)、まとめて渡されたペイロードは一度にコピーします
+/// * Fletcherチェックサムは受け取るたびに更新する(ペイロードはMipChecksum::updateで4byteずつ)ので、最後のbyteでパケットの判定が終わります
+/// * チェックサムが正しいパケットのみハンドラに渡します
+/// * チェックサムエラー・サイズ異常の時は、組み立て中のbyteのSync1の次から同期バイトを探し直して、新しい入力より先に処理し直します
+///   (偽の同期バイトの後ろにある正しいパケットを、偽のLengthの分まとめて捨てないようにするため)
+///
+/// @code
+/// MipFramer framer;
+/// framer.setHandler(onPacket);
+/// while(userial.available()) framer.push(userial.read());
+/// @endcode
+///
+/// @code
+/// MipRing<4096> ring;
+/// ring.write(data, length);
+/// framer.drain(ring);     // 溜まっているデータを処理する
+/// @endcode
+class MipFramer
+{
+    public:
+        /// @brief パケットを受け取る関数
+        /// @param packet Sync1からチェックサムまでのパケット
+        /// @param length パケットのサイズ
+        /// @param context setHandlerで指定したポインタ
+        typedef void (*PacketHandler)(const uint8_t *packet, int length, void *context);
+
+        /// @brief 状態
+        enum State : uint8_t
+        {
+            WaitSync1 = 0,  //!< 同期バイト1待ち
+            WaitSync2,      //!< 同期バイト2待ち
+            WaitDescriptor, //!< ディスクリプタセット待ち
+            WaitLength,     //!< ペイロードサイズ待ち
+            WaitPayload,    //!< ペイロード受信中
+            WaitChecksum1,  //!< チェックサム1byte目待ち
+            WaitChecksum2   //!< チェックサム2byte目待ち
+        };
+
+    private:
+        uint8_t _packet[MIP::MaxPacket];
+        int _index = 0;
+
+        //チェックサムエラーなどで処理し直すbyte
+        uint8_t _pending[MIP::MaxPacket];
+        int _pendingIndex = 0;
+        int _pendingLength = 0;
+        int _payloadLength = 0;
+        State _state = WaitSync1;
+
+        uint8_t _sum1 = 0;
+        uint8_t _sum2 = 0;
+
+        int _maxPayload = MIP::MaxPayload;
+        bool _verifyChecksum = true;
+        bool _synced = false;
+
+        PacketHandler _handler = nullptr;
+        void *_context = nullptr;
+
+        //集計
+        uint32_t _packetCount = 0;
+        uint32_t _syncLossCount = 0;
+        uint32_t _discardedBytes = 0;
+        uint32_t _checksumErrorCount = 0;
+        uint32_t _oversizeCount = 0;
+        uint32_t _rescanCount = 0;
+
+    public:
+        MipFramer();
+
+        void setHandler(PacketHandler handler, void *context=nullptr);
+        void setMaxPayload(int maxPayload);
+        /// @brief チェックサムを確認するか設定します(falseでチェックサムエラーのパケットもハンドラに渡します)
+        void setVerifyChecksum(bool verify){_verifyChecksum = verify;}
+
+        bool push(uint8_t data);
+        int push(const uint8_t *data, size_t length);
+        void reset();
+
+        /**
+         * @brief リングバッファに溜まっているデータをすべて処理します。
+         *
+         * @param [in] ring 受信データのリングバッファ(MipRing)
+         * @param [in] maxLength 処理する最大のbyte数(受信したまとまりごとに処理する場合に指定します)
+         *
+         * @return int 完成したパケットの数
+         *
+         * @note 端をまたぐデータは2つの連続領域のまま処理するので、コピーや詰め直しはしません。
+         */
+        template<class Ring>
+        int drain(Ring &ring, size_t maxLength=(size_t)-1)
+        {
+            MipSpan spans[2];
+            int spanCount = ring.peek(spans);
+            int packets = 0;
+
+            for(int i = 0; i < spanCount && maxLength > 0; i++)
+            {
+                size_t length = (spans[i].length < maxLength) ? spans[i].length : maxLength;
+                packets += this->push(spans[i].data, length);
+                ring.consume(length);
+                maxLength -= length;
+            }
+
+            return packets;
+        }
+
+        /// @brief 現在の状態を返します
+        State getState(){return _state;}
+        /// @brief 最後に完成したパケットを返します(次のpushまで有効)
+        const uint8_t *getPacket(){return _packet;}
+        /// @brief 最後に完成したパケットのサイズを返します
+        int getPacketLength(){return MIP::HeaderLength + _payloadLength + MIP::ChecksumLength;}
+
+        /// @brief 正しく受信できたパケットの数を返します
+        uint32_t getPacketCount(){return _packetCount;}
+        /// @brief 同期が外れた(同期バイト以外を読み捨て始めた)回数を返します
+        uint32_t getSyncLossCount(){return _syncLossCount;}
+        /// @brief 同期を探す間に読み捨てたbyte数を返します
+        uint32_t getDiscardedBytes(){return _discardedBytes;}
+        /// @brief チェックサムエラー・サイズ異常の後に、組み立て中のbyteから同期バイトを探し直した回数を返します
+        uint32_t getRescanCount(){return _rescanCount;}
+        /// @brief チェックサムが一致しなかったパケットの数を返します
+        uint32_t getChecksumErrorCount(){return _checksumErrorCount;}
+        /// @brief ペイロードサイズが上限を超えた、もしくはフィールドを含まないパケットの数を返します
+        uint32_t getOversizeCount(){return _oversizeCount;}
+
+        void resetCounters();
+
+    private:
+        bool __step(uint8_t data);
+        int __rescan();
+        void __add(uint8_t data);
+        void __addRun(const uint8_t *data, size_t length);
+        void __lostSync(int discarded);
+        bool __complete(uint8_t checksum2);
+};
+
+#endif
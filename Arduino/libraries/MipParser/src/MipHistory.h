@@ -0,0 +1,91 @@
+
+/**
+* @file MipHistory.h
+* @brief  MIP sample history ring header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details 最新のN個のサンプルを保持する、容量固定のリングバッファです。
+* @details 新しい順の番号でO(1)で読み出せるので、差分やフィルターで過去のサンプルを計算し直さずに使えます。
+**/
+
+#ifndef __Mip_History_h__
+#define __Mip_History_h__
+
+#include "MipDef.h"
+
+/// @brief 最新のCapacity個のサンプルを保持するリングバッファ
+/// @details
+/// * いっぱいの時にpushすると、最も古いサンプルを上書きします
+/// * [0]が最新、[size()-1]が最も古いサンプルです(位置はCapacity-1のマスクで求めます)
+/// * MipRingと違い、書き込みと読み出しは同じ処理(loop)から行います
+///
+/// @tparam T サンプルの型(MipAhrsSample等)
+/// @tparam Capacity 保持する数(2のべき乗)
+///
+/// @code
+/// MipHistory<MipAhrsSample, 16> history;
+/// history.push(sample);
+/// float dPitch = history[0].euler[1] - history[1].euler[1];
+/// @endcode
+template<class T, size_t Capacity>
+class MipHistory
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MipHistory Capacity must be a power of two");
+
+    private:
+        static constexpr uint32_t Mask = (uint32_t)(Capacity - 1);
+
+        T _buffer[Capacity];
+        uint32_t _count = 0;    //pushした累計
+
+    public:
+        /// @brief 容量を返します
+        static constexpr size_t capacity(){return Capacity;}
+
+        /// @brief 保持しているサンプルの数を返します
+        size_t size() const {return (_count < Capacity) ? (size_t)_count : Capacity;}
+        /// @brief サンプルがないか返します
+        bool empty() const {return _count == 0;}
+        /// @brief 容量までサンプルが溜まっているか返します
+        bool full() const {return _count >= Capacity;}
+        /// @brief pushした数の累計を返します
+        uint32_t getTotalCount() const {return _count;}
+
+        /**
+         * @brief サンプルを追加します。
+         *
+         * @param [in] sample 追加するサンプル
+         */
+        void push(const T &sample)
+        {
+            _buffer[_count & Mask] = sample;
+            _count++;
+        }
+
+        /**
+         * @brief 新しい順の番号でサンプルを返します。
+         *
+         * @param [in] index 0が最新(size()未満)
+         *
+         * @return const T& サンプル
+         *
+         * @note 範囲の確認はしません。sizeを確認してから使用します。
+         */
+        const T &operator[](size_t index) const
+        {
+            return _buffer[(_count - 1 - (uint32_t)index) & Mask];
+        }
+
+        /// @brief 最新のサンプルを返します(emptyでないこと)
+        const T &newest() const {return (*this)[0];}
+        /// @brief 最も古いサンプルを返します(emptyでないこと)
+        const T &oldest() const {return (*this)[this->size() - 1];}
+
+        /// @brief すべてのサンプルを削除します
+        void clear(){_count = 0;}
+};
+
+#endif
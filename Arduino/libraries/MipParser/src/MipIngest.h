@@ -0,0 +1,155 @@
+
+/**
+* @file MipIngest.h
+* @brief  MIP bulk ingest header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details USBSerial等に溜まっている受信データを、1回の呼び出しでまとめてリングバッファへ移すクラスです。
+**/
+
+#ifndef __Mip_Ingest_h__
+#define __Mip_Ingest_h__
+
+#include "MipDef.h"
+
+/// @brief 受信データをまとめてMipRingへ移すクラス
+/// @details
+/// * available()で分かっている分だけ、リングバッファの書き込み領域へ直接読み出します(途中のコピーはありません)
+/// * 標準ではread()を分かっている回数だけ呼び出します。USBHost_t36のUSBSerialはreadBytesを持たず(Streamの既定の処理)、
+///   readBytesは1byteごとにmillis()・read()を呼ぶtimedReadの繰り返しになるため、それを避けます
+///   (受信バッファはドライバの外から見えないので、直接コピーはできません)
+/// * readBytesをまとめて処理するシリアル(Teensyのデバイス側のSerial等)では、setBulkRead(true)でreadBytesを使います
+/// * 移したデータには1回だけ時刻(micros)を記録します
+/// * リングバッファに空きがない時は読み出さずにUSB側に残します(捨てません)
+///
+/// @code
+/// MipRing<4096> ring;
+/// MipIngest ingest;
+/// if(ingest.read(userial, ring, micros()) > 0) { /* 受信あり */ }
+/// framer.drain(ring);
+/// @endcode
+///
+/// @note シリアルのクラスはavailable()・read()・readBytes(char*, size_t)を持っていれば使えます(USBSerial、USBSerial_BigBuffer、HardwareSerial等)。
+class MipIngest
+{
+    private:
+        uint32_t _lastStamp = 0;
+        bool _stamped = false;
+        bool _bulkRead = false;
+
+        uint32_t _readCount = 0;
+        uint32_t _byteCount = 0;
+        uint32_t _maxChunk = 0;
+        uint32_t _stallCount = 0;
+
+    public:
+        /**
+         * @brief 受信済みのデータをすべてリングバッファへ移します。
+         *
+         * @param [in] serial 受信に使っているシリアル(USBSerial等)
+         * @param [in] ring 移し先のリングバッファ(MipRing)
+         * @param [in] nowMicros 現在時刻[us](micros)
+         *
+         * @return size_t 移したbyte数
+         */
+        template<class Serial, class Ring>
+        size_t read(Serial &serial, Ring &ring, uint32_t nowMicros)
+        {
+            size_t total = 0;
+            int pending = serial.available();
+
+            while(pending > 0)
+            {
+                uint8_t *dst;
+                size_t room = ring.getWriteSpan(&dst);
+
+                if(room == 0)
+                {
+                    //残りはUSB側に置いたままにする
+                    _stallCount++;
+                    break;
+                }
+
+                size_t want = ((size_t)pending < room) ? (size_t)pending : room;
+                size_t got = 0;
+                if(_bulkRead)
+                {
+                    got = serial.readBytes((char *)dst, want);
+                }
+                else
+                {
+                    //available()で分かっている分なので、タイムアウトを待たない
+                    while(got < want)
+                    {
+                        int data = serial.read();
+                        if(data < 0)
+                        {
+                            break;
+                        }
+                        dst[got++] = (uint8_t)data;
+                    }
+                }
+                ring.commit(got);
+                total += got;
+
+                if(got < want)
+                {
+                    break;
+                }
+
+                pending = serial.available();
+            }
+
+            if(total > 0)
+            {
+                _lastStamp = nowMicros;
+                _stamped = true;
+                _readCount++;
+                _byteCount += (uint32_t)total;
+                if(total > _maxChunk)
+                {
+                    _maxChunk = (uint32_t)total;
+                }
+            }
+
+            return total;
+        }
+
+        /**
+         * @brief readBytesでまとめて読み出すか設定します。
+         *
+         * @param [in] bulk trueでreadBytes、falseでread()を繰り返す(標準)
+         *
+         * @note readBytesをまとめて処理するシリアルの場合だけtrueにします(StreamのreadBytesは1byteごとにmillis()を呼びます)。
+         */
+        void setBulkRead(bool bulk){_bulkRead = bulk;}
+
+        /// @brief 最後にデータを受信した時刻[us]を返します
+        uint32_t getLastStamp(){return _lastStamp;}
+        /// @brief 一度でもデータを受信したか返します
+        bool hasData(){return _stamped;}
+        /// @brief データを受信した呼び出しの回数を返します
+        uint32_t getReadCount(){return _readCount;}
+        /// @brief 移したbyte数の累計を返します
+        uint32_t getByteCount(){return _byteCount;}
+        /// @brief 1回で移した最大のbyte数を返します
+        uint32_t getMaxChunk(){return _maxChunk;}
+        /// @brief リングバッファに空きがなく読み残した回数を返します
+        uint32_t getStallCount(){return _stallCount;}
+
+        /**
+         * @brief 集計を0にします。
+         */
+        void resetCounters()
+        {
+            _readCount = 0;
+            _byteCount = 0;
+            _maxChunk = 0;
+            _stallCount = 0;
+        }
+};
+
+#endif
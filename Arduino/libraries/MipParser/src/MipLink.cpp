@@ -0,0 +1,202 @@
+
+/**
+* @file MipLink.cpp
+* @brief  MIP sensor link state machine source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include "MipLink.h"
+#include "MipCommand.h"
+
+
+/**
+ * @brief Construct a new Mip Link:: Mip Link object
+ *
+ * @param [in] device センサー
+ * @param [in] rateConfig 接続した時に行う出力周波数の設定(nullptrは設定しない、センサーに保存した設定を使う)
+ */
+MipLink::MipLink(MipDevice &device, MipRateConfig *rateConfig) : _device(device), _rateConfig(rateConfig)
+{
+}
+
+
+/**
+ * @brief 接続状態を更新します(loopで毎回呼び出します)。
+ *
+ * @param [in] nowMillis 現在時刻[ms](millis)
+ */
+void MipLink::update(uint32_t nowMillis)
+{
+    //公開したサンプルの番号が変わっていれば、新しいサンプルが届いた
+    uint32_t sequence = _device.getSnapshot().getSequence();
+    bool fresh = (sequence != _lastSequence);
+    if(fresh)
+    {
+        _lastSequence = sequence;
+        _lastSampleMillis = nowMillis;
+    }
+
+    if(!_device.isConnected())
+    {
+        if(_state != Absent)
+        {
+            this->__lose();
+            this->__enter(Absent, nowMillis);
+        }
+        return;
+    }
+
+    switch(_state)
+    {
+        case Absent:
+            this->__enter(Enumerating, nowMillis);
+            break;
+
+        case Enumerating:
+            if(nowMillis - _stateMillis >= _settleTime)
+            {
+                this->__startConfig(nowMillis);
+            }
+            break;
+
+        case Configuring:
+            if(!_configDone && _rateConfig->isDone())
+            {
+                _configDone = true;
+                fresh = false;      //設定が終わる前のサンプルは数えない
+            }
+            if(_configDone && fresh)
+            {
+                this->__enter(Streaming, nowMillis);
+            }
+            else if(nowMillis - _stateMillis >= _configTimeout)
+            {
+                //NACK・タイムアウト・返信のないセンサーは、時間をおいてやり直す
+                _configFailCount++;
+                this->__startConfig(nowMillis);
+            }
+            break;
+
+        case Streaming:
+            if(_reconfigure)
+            {
+                this->__lose();
+                this->__startConfig(nowMillis);
+            }
+            else if(nowMillis - _lastSampleMillis >= _staleTimeout)
+            {
+                this->__lose();
+                _staleCount++;
+                this->__enter(Stale, nowMillis);
+            }
+            break;
+
+        case Stale:
+            if(_reconfigure || nowMillis - _stateMillis >= _reconfigureTimeout)
+            {
+                this->__startConfig(nowMillis);
+            }
+            else if(fresh)
+            {
+                this->__enter(Streaming, nowMillis);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief 設定をやり直します(次のupdateで始めます)。
+ *
+ * @note 受信中の場合は、設定が終わるまで制御に使えなくなります。
+ */
+void MipLink::reconfigure()
+{
+    _reconfigure = true;
+}
+
+
+/**
+ * @brief 接続状態の名前を返します(表示用)。
+ *
+ * @param [in] state 接続状態
+ *
+ * @return const char* 名前
+ */
+const char *MipLink::stateName(State state)
+{
+    switch(state)
+    {
+        case Absent:        return "Absent";
+        case Enumerating:   return "Enumerating";
+        case Configuring:   return "Configuring";
+        case Streaming:     return "Streaming";
+        case Stale:         return "Stale";
+    }
+    return "?";
+}
+
+
+/**
+ * @brief 状態を変えます。Streamingに戻った場合は復帰時間を記録します。
+ *
+ * @param [in] state 新しい状態
+ * @param [in] nowMillis 現在時刻[ms]
+ */
+void MipLink::__enter(State state, uint32_t nowMillis)
+{
+    if(state == Streaming && _lost)
+    {
+        _lost = false;
+        _lastRecovery = nowMillis - _lostMillis;
+        if(_lastRecovery > _maxRecovery)
+        {
+            _maxRecovery = _lastRecovery;
+        }
+        _recoveryCount++;
+    }
+
+    _state = state;
+    _stateMillis = nowMillis;
+}
+
+/**
+ * @brief 受信中のデータが途切れたことを記録します(最後のサンプルの時刻から復帰時間を数えます)。
+ */
+void MipLink::__lose()
+{
+    if(_state == Streaming && !_lost)
+    {
+        _lost = true;
+        _lostMillis = _lastSampleMillis;
+    }
+}
+
+/**
+ * @brief Idleと出力周波数の設定を登録し、Configuringにします。
+ *
+ * @param [in] nowMillis 現在時刻[ms]
+ */
+void MipLink::__startConfig(uint32_t nowMillis)
+{
+    _reconfigure = false;
+    _configDone = (_rateConfig == nullptr);
+    _configCount++;
+
+    if(_rateConfig != nullptr)
+    {
+        MipExecutor &executor = _device.getExecutor();
+        MipCommand cmd;
+
+        //前の設定の残りを取り消してから、Idle → 出力周波数の設定 → Resume
+        executor.cancel();
+        cmd.buildIdle();
+        executor.enqueue(cmd);
+        _rateConfig->start(executor);
+    }
+
+    this->__enter(Configuring, nowMillis);
+}
@@ -0,0 +1,135 @@
+
+/**
+* @file MipLink.h
+* @brief  MIP sensor link state machine header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details センサーの接続から、設定・受信・データの途切れまでを状態遷移で管理するクラスです。delayで待たないので、制御ループは止まりません。
+* @details データが途切れたことをすぐに制御側へ知らせ、再接続・再設定してから受信が戻るまでの時間(復帰時間)を求めます。
+**/
+
+#ifndef __Mip_Link_h__
+#define __Mip_Link_h__
+
+#include "MipDef.h"
+#include "MipDevice.h"
+#include "MipRateConfig.h"
+
+/// @brief センサーの接続状態の管理
+/// @details
+/// 状態は次のように変わります(updateをloopで毎回呼び出します)。
+/// * Absent : センサーが接続されていない
+/// * Enumerating : 接続された。センサーの起動を待つ(setSettleTime、delayの代わり)
+/// * Configuring : Idle → MipRateConfigの設定(ACK/NACKを確認)を行い、設定後の最初のサンプルを待つ。
+///   失敗、もしくはsetConfigTimeoutの時間内に終わらなければやり直します
+/// * Streaming : サンプルを受信している(制御に使える)
+/// * Stale : setStaleTimeoutの時間サンプルが届かない(制御側は安全な出力に切り替えます)。
+///   サンプルが届けばStreamingに戻り、setReconfigureTimeoutの時間届かなければ設定をやり直します
+///
+/// 途切れた(最後のサンプルの)時刻から、Streamingに戻って最初のサンプルを受信するまでの時間を復帰時間として記録します。
+///
+/// @code
+/// MipLink torsoLink(torsoImu, &sensorRate);
+/// torsoLink.setStaleTimeout(20);          // 20ms届かなければStale
+///
+/// torsoLink.update(millis());             // loop
+/// if(!torsoLink.isStreaming())
+/// {
+///     // 安全な出力(姿勢を使わない)
+/// }
+/// @endcode
+///
+/// @note MipRateConfig::handleResultは、MipExecutorのハンドラから呼び出してください(このクラスは状態を見るだけです)。
+class MipLink
+{
+    public:
+        /// @brief 接続状態
+        enum State
+        {
+            Absent,         //!< 接続されていない
+            Enumerating,    //!< 接続された(起動待ち)
+            Configuring,    //!< 設定中
+            Streaming,      //!< 受信中
+            Stale           //!< サンプルが途切れた
+        };
+
+        static constexpr uint32_t DefaultSettleTime = 20;           //!< 接続から設定を始めるまでの時間[ms]
+        static constexpr uint32_t DefaultConfigTimeout = 1000;      //!< 設定をやり直すまでの時間[ms]
+        static constexpr uint32_t DefaultStaleTimeout = 20;         //!< Staleにするまでの時間[ms]
+        static constexpr uint32_t DefaultReconfigureTimeout = 500;  //!< Staleから設定をやり直すまでの時間[ms]
+
+    private:
+        MipDevice &_device;
+        MipRateConfig *_rateConfig;
+
+        State _state = Absent;
+        uint32_t _stateMillis = 0;          //今の状態になった時刻
+        uint32_t _settleTime = DefaultSettleTime;
+        uint32_t _configTimeout = DefaultConfigTimeout;
+        uint32_t _staleTimeout = DefaultStaleTimeout;
+        uint32_t _reconfigureTimeout = DefaultReconfigureTimeout;
+
+        uint32_t _lastSequence = 0;
+        uint32_t _lastSampleMillis = 0;
+        bool _configDone = false;
+        bool _reconfigure = false;          //reconfigureで設定のやり直しを頼まれた
+
+        //復帰時間
+        bool _lost = false;                 //途切れてから戻っていない
+        uint32_t _lostMillis = 0;           //最後のサンプルの時刻
+        uint32_t _lastRecovery = 0;
+        uint32_t _maxRecovery = 0;
+        uint32_t _recoveryCount = 0;
+        uint32_t _staleCount = 0;
+        uint32_t _configCount = 0;
+        uint32_t _configFailCount = 0;
+
+    public:
+        MipLink(MipDevice &device, MipRateConfig *rateConfig=nullptr);
+
+        void update(uint32_t nowMillis);
+        void reconfigure();
+
+        /// @brief センサーの起動を待つ時間[ms]を設定します(初期値DefaultSettleTime)
+        void setSettleTime(uint32_t millis){_settleTime = millis;}
+        /// @brief 設定をやり直すまでの時間[ms]を設定します(初期値DefaultConfigTimeout)
+        void setConfigTimeout(uint32_t millis){_configTimeout = millis;}
+        /// @brief サンプルが届かない時にStaleにするまでの時間[ms]を設定します(初期値DefaultStaleTimeout、出力周期の数倍にします)
+        void setStaleTimeout(uint32_t millis){_staleTimeout = millis;}
+        /// @brief Staleから設定をやり直すまでの時間[ms]を設定します(初期値DefaultReconfigureTimeout)
+        void setReconfigureTimeout(uint32_t millis){_reconfigureTimeout = millis;}
+
+        /// @brief 接続状態を返します
+        State getState() const {return _state;}
+        /// @brief 受信中(制御に使える)か返します
+        bool isStreaming() const {return _state == Streaming;}
+        /// @brief 今の状態になった時刻[ms]を返します
+        uint32_t getStateMillis() const {return _stateMillis;}
+        /// @brief 最後にサンプルを受信した時刻[ms]を返します
+        uint32_t getLastSampleMillis() const {return _lastSampleMillis;}
+
+        /// @brief 直前の復帰時間(途切れてから最初のサンプルまで)[ms]を返します
+        uint32_t getLastRecovery() const {return _lastRecovery;}
+        /// @brief 復帰時間の最大値[ms]を返します
+        uint32_t getMaxRecovery() const {return _maxRecovery;}
+        /// @brief 復帰した回数を返します
+        uint32_t getRecoveryCount() const {return _recoveryCount;}
+        /// @brief Staleになった回数を返します
+        uint32_t getStaleCount() const {return _staleCount;}
+        /// @brief 設定を始めた回数を返します
+        uint32_t getConfigCount() const {return _configCount;}
+        /// @brief 設定に失敗した(タイムアウトを含む)回数を返します
+        uint32_t getConfigFailCount() const {return _configFailCount;}
+
+        static const char *stateName(State state);
+
+    private:
+        void __enter(State state, uint32_t nowMillis);
+        void __lose();
+        void __startConfig(uint32_t nowMillis);
+};
+
+#endif
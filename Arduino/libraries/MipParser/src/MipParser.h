@@ -0,0 +1,40 @@
+
+/**
+* @file MipParser.h
+* @brief  MIP protocol library header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details MipParserライブラリのすべてのクラスをincludeします。
+**/
+
+#ifndef __Mip_Parser_h__
+#define __Mip_Parser_h__
+
+#include "MipDef.h"
+#include "MipChecksum.h"
+#include "MipConvert.h"
+#include "MipField.h"
+#include "MipView.h"
+#include "MipDispatcher.h"
+#include "MipCommand.h"
+#include "MipExecutor.h"
+#include "MipRateConfig.h"
+#include "MipRateMonitor.h"
+#include "MipClockSync.h"
+#include "MipAhrs.h"
+#include "MipEstimator.h"
+#include "MipHistory.h"
+#include "MipSnapshot.h"
+#include "MipRing.h"
+#include "MipFramer.h"
+#include "MipIngest.h"
+#include "MipQueue.h"
+#include "MipCapture.h"
+#include "MipDevice.h"
+#include "MipDeviceGroup.h"
+#include "MipLink.h"
+
+#endif
@@ -0,0 +1,154 @@
+
+/**
+* @file MipQueue.h
+* @brief  MIP single-producer/single-consumer queue header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details 固定サイズの値を、1書き込み側/1読み出し側(SPSC)で受け渡すキューです。
+* @details タイマー割り込みで受信し、loopで処理する時の受信時刻の受け渡し等に使います。どちらの側も待ちません(wait-free)。
+**/
+
+#ifndef __Mip_Queue_h__
+#define __Mip_Queue_h__
+
+#include "MipDef.h"
+
+/// @brief 書き込み側と読み出し側が1つずつのロックフリーなキュー
+/// @details
+/// * 書き込み位置(_head)は書き込み側だけ、読み出し位置(_tail)は読み出し側だけが更新し、別のキャッシュライン(MIP::CacheLine)に置きます
+/// * 位置はラップしないカウンタで持ち、配列の位置は Capacity-1 のマスクで求めます
+/// * 一杯の時はpushが失敗します(書き込み側で、push前にfullで確認できます)
+///
+/// @tparam T 値の型(コピーできるもの)
+/// @tparam Capacity 容量[個](2のべき乗)
+///
+/// @code
+/// MipQueue<uint32_t, 16> queue;
+/// queue.push(micros());         // 書き込み側(割り込み)
+///
+/// uint32_t stamp;
+/// while(queue.pop(stamp)) { }   // 読み出し側(loop)
+/// @endcode
+template<class T, size_t Capacity>
+class MipQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MipQueue Capacity must be a power of two");
+
+    private:
+        static constexpr uint32_t Mask = (uint32_t)(Capacity - 1);
+
+        //書き込み側だけが書き換える
+        alignas(MIP::CacheLine) volatile uint32_t _head = 0;
+        uint32_t _overflowCount = 0;
+
+        //読み出し側だけが書き換える
+        alignas(MIP::CacheLine) volatile uint32_t _tail = 0;
+
+        alignas(MIP::CacheLine) T _items[Capacity];
+
+    public:
+        /// @brief 容量を返します
+        static constexpr size_t capacity(){return Capacity;}
+
+        /// @brief 溜まっている数を返します
+        size_t available() const {return (size_t)(_head - _tail);}
+        /// @brief 一杯か返します
+        bool full() const {return this->available() >= Capacity;}
+        /// @brief 一杯でpushできなかった回数を返します
+        uint32_t getOverflowCount() const {return _overflowCount;}
+
+        /**
+         * @brief 値を追加します。(書き込み側)
+         *
+         * @param [in] item 追加する値
+         *
+         * @return true 追加した
+         * @return false 一杯で追加できない
+         */
+        bool push(const T &item)
+        {
+            uint32_t head = _head;
+            if((size_t)(head - _tail) >= Capacity)
+            {
+                _overflowCount++;
+                return false;
+            }
+
+            _items[head & Mask] = item;
+
+            //値を書き終えてから位置を更新する
+            __sync_synchronize();
+            _head = head + 1;
+            return true;
+        }
+
+        /**
+         * @brief 先頭の値をコピーします(取り出しません)。(読み出し側)
+         *
+         * @param [out] item コピー先
+         *
+         * @return true コピーした
+         * @return false 空
+         */
+        bool peek(T &item) const
+        {
+            uint32_t tail = _tail;
+            if(_head == tail)
+            {
+                return false;
+            }
+
+            //位置を読んでから値を読む
+            __sync_synchronize();
+            item = _items[tail & Mask];
+            return true;
+        }
+
+        /**
+         * @brief 先頭の値を取り出します。(読み出し側)
+         *
+         * @param [out] item 取り出した値
+         *
+         * @return true 取り出した
+         * @return false 空
+         */
+        bool pop(T &item)
+        {
+            if(!this->peek(item))
+            {
+                return false;
+            }
+            this->drop();
+            return true;
+        }
+
+        /**
+         * @brief 先頭の値を捨てます。(読み出し側)
+         */
+        void drop()
+        {
+            uint32_t tail = _tail;
+            if(_head == tail)
+            {
+                return;
+            }
+
+            //値を読み終えてから位置を更新する
+            __sync_synchronize();
+            _tail = tail + 1;
+        }
+
+        /**
+         * @brief 溜まっている値をすべて捨てます。(読み出し側)
+         */
+        void flush()
+        {
+            __sync_synchronize();
+            _tail = _head;
+        }
+};
+
+#endif
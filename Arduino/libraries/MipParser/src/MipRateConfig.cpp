@@ -0,0 +1,385 @@
+
+/**
+* @file MipRateConfig.cpp
+* @brief  MIP stream rate configuration source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include "MipRateConfig.h"
+#include "MipField.h"
+#include "MipConvert.h"
+
+
+/**
+ * @brief Construct a new Mip Rate Config:: Mip Rate Config object
+ */
+MipRateConfig::MipRateConfig()
+{
+}
+
+
+/**
+ * @brief 出力するフィールドを登録します。
+ *
+ * @param [in] descSet データのディスクリプタセット(MIP::DescSet::Imu、MIP::DescSet::Filter)
+ * @param [in] fieldDesc フィールドディスクリプタ
+ * @param [in] rateHz 出力周波数[Hz](1～基本周波数)
+ *
+ * @return true 登録した(同じフィールドは周波数を置き換えます)
+ * @return false 登録できる数を超えた、もしくは周波数が0
+ */
+bool MipRateConfig::addField(uint8_t descSet, uint8_t fieldDesc, uint16_t rateHz)
+{
+    if(rateHz == 0)
+    {
+        return false;
+    }
+
+    for(int i = 0; i < _fieldCount; i++)
+    {
+        if(_field[i].descSet == descSet && _field[i].fieldDesc == fieldDesc)
+        {
+            _field[i].rate = rateHz;
+            return true;
+        }
+    }
+
+    if(_fieldCount >= MaxField)
+    {
+        return false;
+    }
+
+    if(this->__findSet(descSet) < 0)
+    {
+        if(_setCount >= MaxSet)
+        {
+            return false;
+        }
+        _set[_setCount] = descSet;
+        _baseRate[_setCount] = 0;
+        _setCount++;
+    }
+
+    _field[_fieldCount].descSet = descSet;
+    _field[_fieldCount].fieldDesc = fieldDesc;
+    _field[_fieldCount].rate = rateHz;
+    _fieldCount++;
+    return true;
+}
+
+/**
+ * @brief 登録したフィールドと基本周波数をすべて削除します。
+ */
+void MipRateConfig::clear()
+{
+    _fieldCount = 0;
+    _setCount = 0;
+    _state = Idle;
+    _lastId = 0;
+    _pendingQuery = 0;
+}
+
+
+/**
+ * @brief 基本周波数の問い合わせを登録し、設定を始めます。
+ *
+ * @param [in] executor コマンドを送信するMipExecutor(結果はhandleResultに渡してください)
+ *
+ * @return true 開始した
+ * @return false フィールドが登録されていない、もしくはコマンドを登録できない
+ *
+ * @note setBaseRateで基本周波数が分かっているディスクリプタセットは問い合わせません。
+ */
+bool MipRateConfig::start(MipExecutor &executor)
+{
+    if(_setCount == 0)
+    {
+        return false;
+    }
+
+    _executor = &executor;
+    _state = Querying;
+    _pendingQuery = 0;
+
+    MipCommand cmd;
+    bool queried = false;
+    for(int i = 0; i < _setCount; i++)
+    {
+        if(_baseRate[i] != 0)
+        {
+            continue;
+        }
+        cmd.buildGetBaseRate(_set[i]);
+        if(executor.enqueue(cmd) == 0)
+        {
+            _state = Failed;
+            return false;
+        }
+        _pendingQuery++;
+        queried = true;
+    }
+
+    //すべて分かっている場合はすぐに設定する
+    if(!queried)
+    {
+        return this->__apply();
+    }
+    return true;
+}
+
+/**
+ * @brief MipExecutorの結果を処理します(MipExecutorのハンドラから呼び出します)。
+ *
+ * @param [in] result コマンドの結果
+ * @param [in] reply 返信パケット(返信がない場合はnullptr)
+ *
+ * @note 関係のないコマンドの結果は無視します。
+ * @note 基本周波数の問い合わせのACKに基本周波数(0以外)のフィールドがない場合は、待ち続けずにFailedにします。
+ */
+void MipRateConfig::handleResult(const MipExecutor::Result &result, const uint8_t *reply)
+{
+    if(_state == Querying && result.descSet == MIP::DescSet::ThreeDm && result.fieldDesc == MIP::ThreeDmCmd::GetBaseRate)
+    {
+        if(result.status != MipExecutor::Acked || reply == nullptr)
+        {
+            _state = Failed;
+            return;
+        }
+
+        _pendingQuery--;
+
+        //返信: ディスクリプタセット(1) + 基本周波数(2)
+        bool found = false;
+        MipFieldReader reader(reply);
+        MipField field;
+        while(reader.next(field))
+        {
+            if(field.descriptor == MIP::ReplyField::BaseRate && field.length >= 3)
+            {
+                uint16_t baseRate = MipConv::toUint16(&field.data[1]);
+                if(baseRate != 0 && this->setBaseRate(field.data[0], baseRate))
+                {
+                    found = true;
+                }
+            }
+        }
+        if(!found)
+        {
+            _state = Failed;
+            return;
+        }
+
+        for(int i = 0; i < _setCount; i++)
+        {
+            if(_baseRate[i] == 0)
+            {
+                //他の問い合わせの返信を待つ(返信がすべて来ても分からない場合は失敗)
+                if(_pendingQuery <= 0)
+                {
+                    _state = Failed;
+                }
+                return;
+            }
+        }
+        this->__apply();
+        return;
+    }
+
+    if(_state == Applying && result.descSet == MIP::DescSet::ThreeDm)
+    {
+        if(result.status != MipExecutor::Acked)
+        {
+            _state = Failed;
+        }
+        return;
+    }
+
+    if(_state == Applying && result.id == _lastId)
+    {
+        _state = (result.status == MipExecutor::Acked) ? Done : Failed;
+    }
+}
+
+
+/**
+ * @brief 基本周波数を設定します(問い合わせずに使う場合、もしくは返信から)。
+ *
+ * @param [in] descSet データのディスクリプタセット
+ * @param [in] baseRate 基本周波数[Hz]
+ *
+ * @return true 設定した
+ * @return false 登録していないディスクリプタセット
+ */
+bool MipRateConfig::setBaseRate(uint8_t descSet, uint16_t baseRate)
+{
+    int slot = this->__findSet(descSet);
+    if(slot < 0)
+    {
+        return false;
+    }
+    _baseRate[slot] = baseRate;
+    return true;
+}
+
+/**
+ * @brief 基本周波数を返します。
+ *
+ * @param [in] descSet データのディスクリプタセット
+ *
+ * @return uint16_t 基本周波数[Hz](分からない場合は0)
+ */
+uint16_t MipRateConfig::getBaseRate(uint8_t descSet)
+{
+    int slot = this->__findSet(descSet);
+    return (slot < 0) ? 0 : _baseRate[slot];
+}
+
+/**
+ * @brief フィールドの分周比を返します。
+ *
+ * @param [in] descSet データのディスクリプタセット
+ * @param [in] fieldDesc フィールドディスクリプタ
+ *
+ * @return uint16_t 分周比(基本周波数が分からない、もしくは登録していない場合は0)
+ */
+uint16_t MipRateConfig::getDecimation(uint8_t descSet, uint8_t fieldDesc)
+{
+    const Field *field = this->__findField(descSet, fieldDesc);
+    if(field == nullptr)
+    {
+        return 0;
+    }
+    return decimation(this->getBaseRate(descSet), field->rate);
+}
+
+/**
+ * @brief 分周比から求めた実際の出力周波数を返します。
+ *
+ * @param [in] descSet データのディスクリプタセット
+ * @param [in] fieldDesc フィールドディスクリプタ
+ *
+ * @return float 出力周波数[Hz](分からない場合は0)
+ */
+float MipRateConfig::getActualRate(uint8_t descSet, uint8_t fieldDesc)
+{
+    uint16_t dec = this->getDecimation(descSet, fieldDesc);
+    if(dec == 0)
+    {
+        return 0.0f;
+    }
+    return (float)this->getBaseRate(descSet) / dec;
+}
+
+/**
+ * @brief 基本周波数と出力周波数から分周比を求めます。
+ *
+ * @param [in] baseRate 基本周波数[Hz]
+ * @param [in] rateHz 出力周波数[Hz]
+ *
+ * @return uint16_t 分周比(四捨五入、1以上)、基本周波数が0の場合は0
+ */
+uint16_t MipRateConfig::decimation(uint16_t baseRate, uint16_t rateHz)
+{
+    if(baseRate == 0 || rateHz == 0)
+    {
+        return 0;
+    }
+    uint32_t dec = ((uint32_t)baseRate + rateHz / 2) / rateHz;
+    return (dec < 1) ? 1 : (uint16_t)dec;
+}
+
+
+/**
+ * @brief ディスクリプタセットの番号を探します。
+ *
+ * @param [in] descSet データのディスクリプタセット
+ *
+ * @return int 番号(登録していない場合は-1)
+ */
+int MipRateConfig::__findSet(uint8_t descSet)
+{
+    for(int i = 0; i < _setCount; i++)
+    {
+        if(_set[i] == descSet)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 登録したフィールドを探します。
+ *
+ * @param [in] descSet データのディスクリプタセット
+ * @param [in] fieldDesc フィールドディスクリプタ
+ *
+ * @return const Field* フィールド(登録していない場合はnullptr)
+ */
+const MipRateConfig::Field *MipRateConfig::__findField(uint8_t descSet, uint8_t fieldDesc)
+{
+    for(int i = 0; i < _fieldCount; i++)
+    {
+        if(_field[i].descSet == descSet && _field[i].fieldDesc == fieldDesc)
+        {
+            return &_field[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Message Format・Enable Stream(ディスクリプタセットごと)とResumeを登録します。
+ *
+ * @return true 登録した
+ * @return false コマンドを登録できない
+ */
+bool MipRateConfig::__apply()
+{
+    MipCommand cmd;
+    uint8_t fields[MaxField];
+    uint16_t decimations[MaxField];
+
+    _state = Applying;
+
+    for(int s = 0; s < _setCount; s++)
+    {
+        int count = 0;
+        for(int i = 0; i < _fieldCount; i++)
+        {
+            if(_field[i].descSet == _set[s])
+            {
+                fields[count] = _field[i].fieldDesc;
+                decimations[count] = decimation(_baseRate[s], _field[i].rate);
+                count++;
+            }
+        }
+
+        cmd.buildMessageFormat(_set[s], fields, decimations, count);
+        if(_executor->enqueue(cmd) == 0)
+        {
+            _state = Failed;
+            return false;
+        }
+        cmd.buildEnableStream(_set[s], true);
+        if(_executor->enqueue(cmd) == 0)
+        {
+            _state = Failed;
+            return false;
+        }
+    }
+
+    //Idleの後はResumeでストリームを再開する
+    cmd.buildResume();
+    _lastId = _executor->enqueue(cmd);
+    if(_lastId == 0)
+    {
+        _state = Failed;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,110 @@
+
+/**
+* @file MipRateConfig.h
+* @brief  MIP stream rate configuration header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details センサーの基本周波数を問い合わせ、フィールドごとの出力周波数から分周比を求めてストリームを設定するクラスです。
+**/
+
+#ifndef __Mip_Rate_Config_h__
+#define __Mip_Rate_Config_h__
+
+#include "MipDef.h"
+#include "MipExecutor.h"
+
+/// @brief 出力周波数[Hz]でストリームを設定するクラス
+/// @details
+/// 1. addField : (ディスクリプタセット, フィールド, 出力周波数[Hz])を登録します
+/// 2. start : 使用するディスクリプタセットの基本周波数(Get Data Base Rate)をMipExecutorで問い合わせます
+/// 3. handleResult : MipExecutorの結果を渡します。基本周波数がすべて分かったら、分周比 = 基本周波数 / 出力周波数 で
+///    Message Format → Enable Stream → Resume を登録します
+///    ACKの返信に基本周波数のフィールドがない場合や、すべての返信を受け取っても分からない基本周波数がある場合はFailedになります
+///
+/// 分周比は四捨五入するので、基本周波数で割り切れない周波数はgetActualRateの周波数になります。
+/// 基本周波数(3DM-CV7-AHRSは1000Hz)を超える周波数は分周比1になります。
+///
+/// @code
+/// MipRateConfig rateConfig;
+/// rateConfig.addField(MIP::DescSet::Filter, MIP::FilterField::Euler, 500);
+/// rateConfig.addField(MIP::DescSet::Filter, MIP::FilterField::AngularRate, 500);
+///
+/// cmd.buildIdle();
+/// executor.enqueue(cmd);
+/// rateConfig.start(executor);
+///
+/// void onResult(const MipExecutor::Result &result, const uint8_t *reply, void *context)
+/// {
+///     rateConfig.handleResult(result, reply);
+/// }
+/// @endcode
+class MipRateConfig
+{
+    public:
+        static constexpr int MaxField = 16;     //!< 登録できるフィールドの数
+        static constexpr int MaxSet = 4;        //!< 使用できるディスクリプタセットの数
+
+        /// @brief 設定の状態
+        enum State : uint8_t
+        {
+            Idle = 0,       //!< 開始前
+            Querying,       //!< 基本周波数の問い合わせ中
+            Applying,       //!< Message Format等の返信待ち
+            Done,           //!< 設定完了
+            Failed          //!< NACK・タイムアウト・基本周波数が返ってこない
+        };
+
+    private:
+        /// @brief 登録したフィールド
+        typedef struct
+        {
+            uint8_t descSet;        //!< ディスクリプタセット
+            uint8_t fieldDesc;      //!< フィールドディスクリプタ
+            uint16_t rate;          //!< 出力周波数[Hz]
+        } Field;
+
+        Field _field[MaxField];
+        int _fieldCount = 0;
+
+        uint8_t _set[MaxSet];
+        uint16_t _baseRate[MaxSet];
+        int _setCount = 0;
+
+        MipExecutor *_executor = nullptr;
+        State _state = Idle;
+        uint16_t _lastId = 0;
+        int _pendingQuery = 0;      //返信待ちの基本周波数の問い合わせの数
+
+    public:
+        MipRateConfig();
+
+        bool addField(uint8_t descSet, uint8_t fieldDesc, uint16_t rateHz);
+        void clear();
+
+        bool start(MipExecutor &executor);
+        void handleResult(const MipExecutor::Result &result, const uint8_t *reply);
+
+        bool setBaseRate(uint8_t descSet, uint16_t baseRate);
+        uint16_t getBaseRate(uint8_t descSet);
+        uint16_t getDecimation(uint8_t descSet, uint8_t fieldDesc);
+        float getActualRate(uint8_t descSet, uint8_t fieldDesc);
+
+        /// @brief 設定の状態を返します
+        State getState(){return _state;}
+        /// @brief 設定が終わったか返します
+        bool isDone(){return _state == Done;}
+        /// @brief 設定に失敗したか返します
+        bool isFailed(){return _state == Failed;}
+
+        static uint16_t decimation(uint16_t baseRate, uint16_t rateHz);
+
+    private:
+        int __findSet(uint8_t descSet);
+        const Field *__findField(uint8_t descSet, uint8_t fieldDesc);
+        bool __apply();
+};
+
+#endif
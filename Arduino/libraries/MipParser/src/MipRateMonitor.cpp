@@ -0,0 +1,131 @@
+
+/**
+* @file MipRateMonitor.cpp
+* @brief  MIP packet rate and jitter monitor source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+*/
+
+#include <math.h>
+#include "MipRateMonitor.h"
+
+
+/**
+ * @brief Construct a new Mip Rate Monitor:: Mip Rate Monitor object
+ *
+ * @param [in] windowMicros 値を確定する間隔[us]
+ */
+MipRateMonitor::MipRateMonitor(uint32_t windowMicros)
+{
+    _window = (windowMicros == 0) ? 1 : windowMicros;
+}
+
+
+/**
+ * @brief パケットの受信を記録します。
+ *
+ * @param [in] nowMicros 受信時刻[us]
+ */
+void MipRateMonitor::record(uint32_t nowMicros)
+{
+    if(!_started)
+    {
+        _started = true;
+        _windowStart = nowMicros;
+    }
+    else
+    {
+        this->update(nowMicros);
+
+        uint32_t interval = nowMicros - _last;
+        _intervals++;
+        _sum += interval;
+        _sumSq += (uint64_t)interval * interval;
+        if(interval < _min)
+        {
+            _min = interval;
+        }
+        if(interval > _max)
+        {
+            _max = interval;
+        }
+    }
+
+    _last = nowMicros;
+    _packets++;
+    _totalCount++;
+}
+
+/**
+ * @brief windowが終わっていれば値を確定します(受信がない時のためにloopでも呼び出します)。
+ *
+ * @param [in] nowMicros 現在時刻[us]
+ */
+void MipRateMonitor::update(uint32_t nowMicros)
+{
+    if(_started && nowMicros - _windowStart >= _window)
+    {
+        this->__publish(nowMicros);
+    }
+}
+
+/**
+ * @brief 集計と確定した値をすべて0にします。
+ */
+void MipRateMonitor::reset()
+{
+    _started = false;
+    _packets = 0;
+    _intervals = 0;
+    _sum = 0;
+    _sumSq = 0;
+    _min = 0xFFFFFFFF;
+    _max = 0;
+    _rate = 0.0f;
+    _mean = 0.0f;
+    _jitter = 0.0f;
+    _minInterval = 0;
+    _maxInterval = 0;
+    _totalCount = 0;
+}
+
+
+/**
+ * @brief 集計中のwindowの値を確定し、次のwindowを始めます。
+ *
+ * @param [in] nowMicros 現在時刻[us]
+ */
+void MipRateMonitor::__publish(uint32_t nowMicros)
+{
+    uint32_t elapsed = nowMicros - _windowStart;
+
+    _rate = (float)_packets * 1000000.0f / (float)elapsed;
+
+    if(_intervals > 0)
+    {
+        double mean = (double)_sum / _intervals;
+        double variance = (double)_sumSq / _intervals - mean * mean;
+        _mean = (float)mean;
+        _jitter = (variance > 0.0) ? (float)sqrt(variance) : 0.0f;
+        _minInterval = _min;
+        _maxInterval = _max;
+    }
+    else
+    {
+        _mean = 0.0f;
+        _jitter = 0.0f;
+        _minInterval = 0;
+        _maxInterval = 0;
+    }
+
+    _windowStart = nowMicros;
+    _packets = 0;
+    _intervals = 0;
+    _sum = 0;
+    _sumSq = 0;
+    _min = 0xFFFFFFFF;
+    _max = 0;
+}
@@ -0,0 +1,83 @@
+
+/**
+* @file MipRateMonitor.h
+* @brief  MIP packet rate and jitter monitor header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details パケットの受信時刻から、一定時間ごとの受信周波数と受信間隔のばらつき(ジッタ)を求めるクラスです。
+**/
+
+#ifndef __Mip_Rate_Monitor_h__
+#define __Mip_Rate_Monitor_h__
+
+#include "MipDef.h"
+
+/// @brief 受信周波数と受信間隔のジッタを求めるクラス
+/// @details
+/// * recordにパケットの受信時刻[us]を渡します(MipIngest::getLastStampを使うと、USBから読み出した時刻になります)
+/// * window[us]ごとに、その間の受信周波数・平均間隔・間隔の標準偏差(ジッタ)・最小/最大間隔を確定します
+/// * 確定した値はgetRate等で取得できます(次のwindowが終わるまで変わりません)
+///
+/// @code
+/// MipRateMonitor filterRate;
+/// void onPacket(const uint8_t *packet, int length, void *context)
+/// {
+///     filterRate.record(ingest.getLastStamp());
+/// }
+/// filterRate.update(micros());   // 受信が止まった時も0Hzにするため、loopでも呼び出します
+/// @endcode
+///
+/// @note USBホストはデータをまとめて渡すので、同じ時刻のパケットが続くことがあります(間隔0として数えます)。
+class MipRateMonitor
+{
+    private:
+        uint32_t _window;
+        uint32_t _windowStart = 0;
+        uint32_t _last = 0;
+        bool _started = false;
+
+        //集計中のwindow
+        uint32_t _packets = 0;
+        uint32_t _intervals = 0;
+        uint64_t _sum = 0;
+        uint64_t _sumSq = 0;
+        uint32_t _min = 0xFFFFFFFF;
+        uint32_t _max = 0;
+
+        //確定した値
+        float _rate = 0.0f;
+        float _mean = 0.0f;
+        float _jitter = 0.0f;
+        uint32_t _minInterval = 0;
+        uint32_t _maxInterval = 0;
+
+        uint32_t _totalCount = 0;
+
+    public:
+        MipRateMonitor(uint32_t windowMicros=1000000);
+
+        void record(uint32_t nowMicros);
+        void update(uint32_t nowMicros);
+        void reset();
+
+        /// @brief 受信周波数[Hz]を返します
+        float getRate(){return _rate;}
+        /// @brief 平均の受信間隔[us]を返します
+        float getMeanInterval(){return _mean;}
+        /// @brief 受信間隔の標準偏差(ジッタ)[us]を返します
+        float getJitter(){return _jitter;}
+        /// @brief 最小の受信間隔[us]を返します
+        uint32_t getMinInterval(){return _minInterval;}
+        /// @brief 最大の受信間隔[us]を返します
+        uint32_t getMaxInterval(){return _maxInterval;}
+        /// @brief 受信したパケットの数の累計を返します
+        uint32_t getCount(){return _totalCount;}
+
+    private:
+        void __publish(uint32_t nowMicros);
+};
+
+#endif
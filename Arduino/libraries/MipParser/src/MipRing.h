@@ -0,0 +1,241 @@
+
+/**
+* @file MipRing.h
+* @brief  MIP ingest ring buffer header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details 受信データを溜めておく、1書き込み側/1読み出し側(SPSC)のリングバッファです。
+* @details 容量を2のべき乗にしてマスクで位置を計算するので、詰め直し(memmove)は発生しません。
+* @details 書き込み側はタイマー割り込み等、読み出し側はloopのように、別々の実行単位から待たずに使えます(wait-free)。
+**/
+
+#ifndef __Mip_Ring_h__
+#define __Mip_Ring_h__
+
+#include "MipDef.h"
+#include <string.h>
+
+/// @brief リングバッファ上の連続した領域
+typedef struct
+{
+    const uint8_t *data;    //!< 先頭
+    size_t length;          //!< サイズ
+} MipSpan;
+
+/// @brief 書き込み側と読み出し側が1つずつのロックフリーなリングバッファ
+/// @details
+/// * 書き込み位置(_head)は書き込み側だけ、読み出し位置(_tail)は読み出し側だけが更新します
+/// * 位置はラップしないカウンタで持ち、配列の位置は Capacity-1 のマスクで求めます
+/// * 書き込み側が書き換える値と読み出し側が書き換える値は、別のキャッシュライン(MIP::CacheLine)に置きます
+/// * 読み出せるデータは最大2つの連続領域(peek)で渡すので、端をまたぐパケットもコピーせずにMipFramerへ渡せます
+/// * 空きが足りない時は入りきらない分だけを捨てて数えます(溜まっているデータは捨てません)
+///
+/// @tparam Capacity 容量[byte](2のべき乗)
+///
+/// @code
+/// MipRing<4096> ring;
+/// ring.write(data, length);     // 書き込み側(USB受信)
+/// framer.drain(ring);           // 読み出し側(パケットの切り出し)
+/// @endcode
+template<size_t Capacity>
+class MipRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MipRing Capacity must be a power of two");
+
+    private:
+        static constexpr uint32_t Mask = (uint32_t)(Capacity - 1);
+
+        //書き込み側だけが書き換える
+        alignas(MIP::CacheLine) volatile uint32_t _head = 0;    //書き込んだ累計
+        uint32_t _overflowBytes = 0;
+        uint32_t _overflowCount = 0;
+        uint32_t _highWater = 0;
+
+        //読み出し側だけが書き換える
+        alignas(MIP::CacheLine) volatile uint32_t _tail = 0;    //読み出した累計
+
+        alignas(MIP::CacheLine) uint8_t _buffer[Capacity];
+
+    public:
+        /// @brief 容量を返します
+        static constexpr size_t capacity(){return Capacity;}
+
+        /// @brief 読み出せるbyte数を返します
+        size_t available() const {return (size_t)(_head - _tail);}
+        /// @brief 書き込めるbyte数を返します
+        size_t space() const {return Capacity - this->available();}
+
+        /// @brief 書き込んだ累計[byte]を返します(書き込み位置)
+        uint32_t getWritePosition() const {return _head;}
+        /// @brief 読み出した累計[byte]を返します(読み出し位置)
+        uint32_t getReadPosition() const {return _tail;}
+
+        /// @brief 入りきらずに捨てたbyte数を返します
+        uint32_t getOverflowBytes() const {return _overflowBytes;}
+        /// @brief 入りきらないデータがあった回数を返します
+        uint32_t getOverflowCount() const {return _overflowCount;}
+        /// @brief 溜まっていたbyte数の最大値を返します
+        uint32_t getHighWater() const {return _highWater;}
+
+        /**
+         * @brief 1byte書き込みます。(書き込み側)
+         *
+         * @param [in] data 書き込むデータ
+         *
+         * @return true 書き込み成功
+         * @return false 空きがない(捨てたbyteとして数えます)
+         */
+        bool put(uint8_t data)
+        {
+            return this->write(&data, 1) == 1;
+        }
+
+        /**
+         * @brief データを書き込みます。(書き込み側)
+         *
+         * @param [in] data 書き込むデータ
+         * @param [in] length データ数
+         *
+         * @return size_t 書き込めたbyte数(入りきらない分は捨てて数えます)
+         */
+        size_t write(const uint8_t *data, size_t length)
+        {
+            uint32_t head = _head;
+            size_t room = Capacity - (size_t)(head - _tail);
+            size_t count = (length < room) ? length : room;
+
+            size_t offset = head & Mask;
+            size_t first = Capacity - offset;
+            if(first > count)
+            {
+                first = count;
+            }
+            memcpy(&_buffer[offset], data, first);
+            memcpy(&_buffer[0], data + first, count - first);
+
+            this->commit(count);
+
+            if(count < length)
+            {
+                _overflowBytes += (uint32_t)(length - count);
+                _overflowCount++;
+            }
+
+            return count;
+        }
+
+        /**
+         * @brief 書き込める連続領域を返します。(書き込み側)
+         *
+         * @param [out] data 書き込み先
+         *
+         * @return size_t 連続して書き込めるbyte数
+         *
+         * @note 受信処理が直接書き込む場合に使用し、書き込んだ後にcommitを呼びます。
+         */
+        size_t getWriteSpan(uint8_t **data)
+        {
+            uint32_t head = _head;
+            size_t room = Capacity - (size_t)(head - _tail);
+            size_t offset = head & Mask;
+            size_t first = Capacity - offset;
+
+            *data = &_buffer[offset];
+            return (first < room) ? first : room;
+        }
+
+        /**
+         * @brief getWriteSpanで書き込んだデータを読み出し側に公開します。(書き込み側)
+         *
+         * @param [in] length 書き込んだbyte数
+         */
+        void commit(size_t length)
+        {
+            //データを書き終えてから位置を更新する
+            __sync_synchronize();
+            _head = _head + (uint32_t)length;
+
+            uint32_t used = (uint32_t)this->available();
+            if(used > _highWater)
+            {
+                _highWater = used;
+            }
+        }
+
+        /**
+         * @brief 読み出せるデータを最大2つの連続領域で返します。(読み出し側)
+         *
+         * @param [out] spans 連続領域(2つ分)
+         *
+         * @return int 連続領域の数(0～2)
+         *
+         * @note 読み終えたらconsumeで読み出し位置を進めます。
+         */
+        int peek(MipSpan spans[2]) const
+        {
+            uint32_t tail = _tail;
+            size_t count = (size_t)(_head - tail);
+
+            if(count == 0)
+            {
+                return 0;
+            }
+
+            //位置を読んでからデータを読む
+            __sync_synchronize();
+
+            size_t offset = tail & Mask;
+            size_t first = Capacity - offset;
+
+            spans[0].data = &_buffer[offset];
+            if(count <= first)
+            {
+                spans[0].length = count;
+                return 1;
+            }
+
+            spans[0].length = first;
+            spans[1].data = &_buffer[0];
+            spans[1].length = count - first;
+            return 2;
+        }
+
+        /**
+         * @brief 読み出し位置を進めます。(読み出し側)
+         *
+         * @param [in] length 読み終えたbyte数
+         */
+        void consume(size_t length)
+        {
+            size_t count = this->available();
+            if(length > count)
+            {
+                length = count;
+            }
+            __sync_synchronize();
+            _tail = _tail + (uint32_t)length;
+        }
+
+        /**
+         * @brief 溜まっているデータをすべて捨てます。(読み出し側)
+         */
+        void flush()
+        {
+            this->consume(this->available());
+        }
+
+        /**
+         * @brief 集計を0にします。
+         */
+        void resetCounters()
+        {
+            _overflowBytes = 0;
+            _overflowCount = 0;
+            _highWater = 0;
+        }
+};
+
+#endif
@@ -0,0 +1,125 @@
+
+/**
+* @file MipSnapshot.h
+* @brief  MIP seqlock snapshot header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details 受信側(書き込み)が確定した1サンプルを、制御側(読み出し)が途中で書き換えられていない状態でコピーするためのクラスです。
+* @details 書き込み側は待たず、読み出し側も割り込みを止めずに読めます(シーケンスロック)。
+**/
+
+#ifndef __Mip_Snapshot_h__
+#define __Mip_Snapshot_h__
+
+#include "MipDef.h"
+#include <string.h>
+
+/// @brief 1書き込み側/複数読み出し側のシーケンスロック
+/// @details
+/// * publishは番号を奇数にしてからデータを書き、書き終えたら偶数にします(書き込み側は待ちません)
+/// * readは番号が偶数で、コピーの前後で変わっていない時だけ成功します(途中で書き換えられたら読み直します)
+/// * 受信を割り込みやコールバックに移しても、ピッチと角速度が別のパケットの値になることはありません
+/// * 書き込み側は1つだけにします(割り込みの中で書く場合は、その割り込みの中だけで書きます)
+/// * 番号(getSequence)はpublishした回数なので、前回読んだ番号と比べると新しいサンプルか・読み飛ばした数が分かります
+///
+/// @tparam T サンプルの型(MipAhrsSample等、memcpyでコピーできるもの)
+///
+/// @code
+/// MipSnapshot<MipAhrsSample> snapshot;
+/// snapshot.publish(sample);                 // 受信側
+///
+/// MipAhrsSample state;                      // 制御側
+/// uint32_t sequence;
+/// if(snapshot.read(state, sequence) && sequence != lastSequence)
+/// {
+///     missed += sequence - lastSequence - 1;
+///     lastSequence = sequence;
+/// }
+/// @endcode
+template<class T>
+class MipSnapshot
+{
+    public:
+        static constexpr int MaxRetry = 8;  //!< readで読み直す回数(書き込み側が割り込みの場合、続けて書き換わることはほぼない)
+
+    private:
+        T _data;
+        volatile uint32_t _sequence = 0;    //偶数: 書き終えた、奇数: 書き込み中
+        uint32_t _retryCount = 0;
+        uint32_t _failCount = 0;
+
+    public:
+        MipSnapshot()
+        {
+            memset(&_data, 0, sizeof(_data));
+        }
+
+        /**
+         * @brief サンプルを公開します。(書き込み側)
+         *
+         * @param [in] sample 公開するサンプル
+         */
+        void publish(const T &sample)
+        {
+            uint32_t sequence = _sequence;
+
+            _sequence = sequence + 1;
+            //番号を奇数にしてからデータを書く
+            __sync_synchronize();
+            memcpy(&_data, &sample, sizeof(T));
+            //データを書き終えてから番号を偶数にする
+            __sync_synchronize();
+            _sequence = sequence + 2;
+        }
+
+        /**
+         * @brief 最新のサンプルをコピーします。(読み出し側)
+         *
+         * @param [out] sample コピー先
+         * @param [out] sequence コピーしたサンプルの番号(publishした回数、0はまだ公開されていない)
+         *
+         * @return true 途中で書き換えられていないサンプルをコピーした
+         * @return false MaxRetry回読み直しても書き込み中だった(sampleは変更しません)
+         */
+        bool read(T &sample, uint32_t &sequence)
+        {
+            T copy;
+
+            for(int retry = 0; retry < MaxRetry; retry++)
+            {
+                uint32_t before = _sequence;
+                if(before & 1)
+                {
+                    _retryCount++;
+                    continue;
+                }
+                //番号を読んでからデータを読む
+                __sync_synchronize();
+                memcpy(&copy, &_data, sizeof(T));
+                //データを読み終えてから番号を読み直す
+                __sync_synchronize();
+                if(_sequence == before)
+                {
+                    memcpy(&sample, &copy, sizeof(T));
+                    sequence = before / 2;
+                    return true;
+                }
+                _retryCount++;
+            }
+
+            _failCount++;
+            return false;
+        }
+
+        /// @brief 最新のサンプルの番号を返します(publishした回数)
+        uint32_t getSequence() const {return _sequence / 2;}
+        /// @brief 書き込み中だったため読み直した回数を返します
+        uint32_t getRetryCount() const {return _retryCount;}
+        /// @brief 読み直しても読めなかった回数を返します
+        uint32_t getFailCount() const {return _failCount;}
+};
+
+#endif
@@ -0,0 +1,190 @@
+
+/**
+* @file MipView.h
+* @brief  MIP typed field view header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.0
+* @copyright SagaraLab 2026
+*
+* @details フィールドのデータをコピーせずに、型に合わせて読み出すためのクラスです。
+* @details MipDispatcherに登録したハンドラには、これらのクラスでフィールドが渡されます。
+**/
+
+#ifndef __Mip_View_h__
+#define __Mip_View_h__
+
+#include "MipDef.h"
+#include "MipField.h"
+#include "MipConvert.h"
+
+/// @brief フィールドのデータを指すだけのクラス(すべてのビューの基本)
+/// @details データはパケットの中を指しているので、ハンドラの中でだけ使用できます。
+class MipFieldView
+{
+    public:
+        static constexpr uint8_t Size = 0;  //!< 必要なデータのサイズ(これより短いフィールドはハンドラに渡しません)
+
+    protected:
+        const uint8_t *_data;
+        uint8_t _length;
+        uint8_t _descriptor;
+
+    public:
+        MipFieldView(const MipField &field) : _data(field.data), _length(field.length), _descriptor(field.descriptor) {}
+
+        /// @brief データの先頭を返します
+        const uint8_t *data() const {return _data;}
+        /// @brief データのサイズを返します(Length,Descriptorを含まない)
+        uint8_t length() const {return _length;}
+        /// @brief フィールドディスクリプタを返します
+        uint8_t descriptor() const {return _descriptor;}
+};
+
+/// @brief float x3のフィールド(加速度、角速度、磁気、オイラー角等)
+/// @details フィルターデータ(0x82)では、float x3の後ろにvalid flags(2byte)が付きます。
+class MipVector3fView : public MipFieldView
+{
+    public:
+        static constexpr uint8_t Size = 12;     //!< float x3
+
+        MipVector3fView(const MipField &field) : MipFieldView(field) {}
+
+        /// @brief X成分を返します
+        float x() const {return MipConv::toFloat(&_data[0]);}
+        /// @brief Y成分を返します
+        float y() const {return MipConv::toFloat(&_data[4]);}
+        /// @brief Z成分を返します
+        float z() const {return MipConv::toFloat(&_data[8]);}
+        /// @brief 3成分をまとめて返します
+        void get(float vector[3]) const {MipConv::toVector3f(_data, vector);}
+        /// @brief 3成分をまとめて、scaleを掛けて返します(floatで計算します)
+        void get(float vector[3], float scale) const {MipConv::toFloats(_data, vector, 3, scale);}
+
+        /// @brief valid flagsが付いているか返します
+        bool hasFlags() const {return _length >= Size + 2;}
+        /// @brief valid flagsを返します(付いていない場合は0)
+        uint16_t flags() const {return this->hasFlags() ? MipConv::toUint16(&_data[Size]) : 0;}
+};
+
+/// @brief オイラー角のフィールド(0x82 0x05) Roll, Pitch, Yaw [rad]
+class MipEulerView : public MipVector3fView
+{
+    public:
+        MipEulerView(const MipField &field) : MipVector3fView(field) {}
+
+        /// @brief Roll[rad]を返します
+        float roll() const {return this->x();}
+        /// @brief Pitch[rad]を返します
+        float pitch() const {return this->y();}
+        /// @brief Yaw[rad]を返します
+        float yaw() const {return this->z();}
+        /// @brief Roll, Pitch, Yawを度に変換して返します
+        void getDegrees(float rpy[3]) const {this->get(rpy, MipConv::RadToDeg);}
+};
+
+/// @brief クォータニオンのフィールド(0x82 0x03) q0(w), q1, q2, q3
+class MipQuaternionView : public MipFieldView
+{
+    public:
+        static constexpr uint8_t Size = 16;     //!< float x4
+
+        MipQuaternionView(const MipField &field) : MipFieldView(field) {}
+
+        /// @brief 成分を返します(0:w, 1:x, 2:y, 3:z)
+        float q(int index) const {return MipConv::toFloat(&_data[index * 4]);}
+        /// @brief 4成分をまとめて返します
+        void get(float quaternion[4]) const {MipConv::toVector4f(_data, quaternion);}
+
+        /// @brief valid flagsが付いているか返します
+        bool hasFlags() const {return _length >= Size + 2;}
+        /// @brief valid flagsを返します(付いていない場合は0)
+        uint16_t flags() const {return this->hasFlags() ? MipConv::toUint16(&_data[Size]) : 0;}
+};
+
+/// @brief フィルターの状態のフィールド(0x82 0x10) Filter State, Dynamics Mode, Status Flags
+class MipFilterStatusView : public MipFieldView
+{
+    public:
+        static constexpr uint8_t Size = 6;      //!< uint16 x3
+
+        MipFilterStatusView(const MipField &field) : MipFieldView(field) {}
+
+        /// @brief フィルターの状態を返します(初期化中、実行中等)
+        uint16_t filterState() const {return MipConv::toUint16(&_data[0]);}
+        /// @brief ダイナミクスモードを返します
+        uint16_t dynamicsMode() const {return MipConv::toUint16(&_data[2]);}
+        /// @brief ステータスフラグを返します
+        uint16_t statusFlags() const {return MipConv::toUint16(&_data[4]);}
+};
+
+/// @brief GPSタイムスタンプのフィールド(0xD3) TOW[s], Week, valid flags
+class MipGpsTimestampView : public MipFieldView
+{
+    public:
+        static constexpr uint8_t Size = 12;     //!< double + uint16 + uint16
+
+        MipGpsTimestampView(const MipField &field) : MipFieldView(field) {}
+
+        /// @brief 週の始まりからの時間[s]を返します
+        double tow() const {return MipConv::toDouble(&_data[0]);}
+        /// @brief GPS週番号を返します
+        uint16_t week() const {return MipConv::toUint16(&_data[8]);}
+        /// @brief valid flagsを返します
+        uint16_t flags() const {return MipConv::toUint16(&_data[10]);}
+};
+
+/// @brief 基準タイムスタンプのフィールド(0xD5) センサー起動からの時間[ns]
+class MipReferenceTimeView : public MipFieldView
+{
+    public:
+        static constexpr uint8_t Size = 8;      //!< uint64
+
+        MipReferenceTimeView(const MipField &field) : MipFieldView(field) {}
+
+        /// @brief センサー起動からの時間[ns]を返します
+        uint64_t nanoseconds() const {return ((uint64_t)MipConv::toUint32(&_data[0]) << 32) | MipConv::toUint32(&_data[4]);}
+};
+
+
+/// @brief デバイス情報のフィールド(0x01の0x81) ファームウェアバージョン + 16文字の文字列 x5
+/// @details 文字列は後ろが空白で埋められています。取り出す時は後ろの空白を除き、終端文字を付けます。
+class MipDeviceInfoView : public MipFieldView
+{
+    public:
+        static constexpr uint8_t StringLength = 16;                 //!< 1つの文字列のサイズ
+        static constexpr uint8_t Size = 2 + StringLength * 5;       //!< uint16 + 文字列 x5
+
+        MipDeviceInfoView(const MipField &field) : MipFieldView(field) {}
+
+        /// @brief ファームウェアバージョンを返します(例: 1234 → 1.2.34)
+        uint16_t firmwareVersion() const {return MipConv::toUint16(&_data[0]);}
+        /// @brief モデル名を取り出します(text[StringLength + 1]以上)
+        void modelName(char text[]) const {this->__copyString(0, text);}
+        /// @brief モデル番号を取り出します(text[StringLength + 1]以上)
+        void modelNumber(char text[]) const {this->__copyString(1, text);}
+        /// @brief シリアル番号を取り出します(text[StringLength + 1]以上)
+        void serialNumber(char text[]) const {this->__copyString(2, text);}
+        /// @brief ロット番号を取り出します(text[StringLength + 1]以上)
+        void lotNumber(char text[]) const {this->__copyString(3, text);}
+        /// @brief デバイスオプションを取り出します(text[StringLength + 1]以上)
+        void deviceOptions(char text[]) const {this->__copyString(4, text);}
+
+    private:
+        void __copyString(int index, char text[]) const
+        {
+            const uint8_t *src = &_data[2 + index * StringLength];
+            int length = StringLength;
+            while(length > 0 && (src[length - 1] == ' ' || src[length - 1] == 0))
+            {
+                length--;
+            }
+            for(int i = 0; i < length; i++)
+            {
+                text[i] = (char)src[i];
+            }
+            text[length] = '\0';
+        }
+};
+
+#endif
@@ -0,0 +1,157 @@
+//
+//  @file BusPlanner_Sample20261018.ino
+//  @brief Bus bandwidth planner sample code
+//  @author SagaraLab
+//  @date 2026/10/18
+//  @copyright SagaraLab 2026
+//
+
+//
+//   BusPlanner_Sample20261018.inoは1周期に発行するコマンドの通信時間を見積もり、
+//   制御周期に収まるか確認してから、実際のバス使用率と空き時間を表示するサンプルコードです。
+//   BusPlanner_Sample20261018.ino is a sample code that estimates the wire time of the commands
+//   sent in one cycle, checks that they fit in the control period, and reports the measured
+//   bus utilization and idle time.
+//
+
+//
+//  Sample Board : ArduinoNanoEvery
+//  NanoEvery <=> RS-485Board
+//  RX(PC5)   <=  R  (Serial1)
+//  TX(PC4)    => D  (Serial1)
+//  D2(PA0)    => EN_IN
+//  VIN       <=  VOUT
+//  GND       <=> GND
+//  +5V        => IOREF
+//
+
+
+#include <Arduino.h>
+
+#include <PmxHardSerialClass.h>
+#include <PmxBusPlanner.h>
+
+// サーボとArduino間の通信設定
+const byte EN_PIN = 2;        // EN(enable)ピンのピン番号
+const long BAUDRATE = 115200; // 通信速度[bps]
+const int TIMEOUT = 10;       // タイムアウトまでの時間[ms]
+
+// インスタンス＋ENピン(2番ピン)およびUARTの指定
+PmxHardSerial pmx(&Serial1,EN_PIN,BAUDRATE,TIMEOUT);
+
+const byte ServoCount = 2;    // サーボの数(IDは0から順番)
+const unsigned long PeriodMicros = 10000;   // 制御周期[us]
+
+// 位置と電流を応答で受け取る
+const byte receiveMode = PMX::ReceiveDataOption::Position + PMX::ReceiveDataOption::Current;
+
+// 接続しているバスの見積もり
+PmxBusPlanner planner(BAUDRATE);
+
+unsigned long lastBusy = 0;
+unsigned long nextCycle = 0;
+
+
+// 見積もり結果を表示します
+void printPlan(PmxBusPlanner &plan, unsigned long periodMicros)
+{
+  Serial.print("WorstCycleTime=");
+  Serial.print(plan.getWorstCycleTime());
+  Serial.print("us Utilization=");
+  Serial.print(plan.getUtilization(periodMicros));
+  Serial.print("% Fits=");
+  Serial.println(plan.fits(periodMicros) ? "Yes" : "No");
+}
+
+
+void setup() {
+
+  Serial.begin(115200);   // PCと通信を開始する
+
+  delay(500);   // サーボが起動するまで少し待つ
+  pmx.begin();  // サーボモータの通信初期設定
+
+  // 例: 1Mbpsで8軸、位置+電流の応答を500Hz(2000us)で回せるか
+  PmxBusPlanner question(1000000);
+  question.addMotorWRITE(8, 1, receiveMode);
+  Serial.println("8 servos / 500Hz / 1Mbps / Position+Current");
+  printPlan(question, 2000);
+  Serial.print("MoreServos=");
+  Serial.println(question.countMotorWRITEFit(2000, 1, receiveMode));
+
+  // 接続しているバスの見積もり(サーボの応答時間を読み出して使う)
+  uint16_t flag;
+  byte respTime = 0;
+  flag = pmx.getResponseTime(0, &respTime);
+  Serial.print("getResponseTime=");
+  Serial.print(flag, HEX);
+  Serial.print(" ");
+  Serial.print(respTime);
+  Serial.println("us");
+
+  planner = PmxBusPlanner(BAUDRATE, false, respTime);
+  planner.addMotorREAD(ServoCount, receiveMode);
+  // 10周期に1回、全サーボの温度を読む
+  planner.addMemREAD(ServoCount, 2, 10);
+
+  Serial.println("This bus");
+  printPlan(planner, PeriodMicros);
+
+  for(byte id = 0; id < ServoCount; id++)
+  {
+    flag = pmx.setMotorReceive(id, receiveMode);
+    Serial.print("setMotorReceive=");
+    Serial.println(flag, HEX);
+  }
+
+  lastBusy = pmx.getBusyMicros();
+  nextCycle = micros();
+}
+
+
+void loop() {
+
+  long receiveData[8];
+  static unsigned long cycle = 0;
+
+  // 制御周期まで待つ
+  while((long)(micros() - nextCycle) < 0){}
+  nextCycle += PeriodMicros;
+
+  for(byte id = 0; id < ServoCount; id++)
+  {
+    pmx.MotorREAD(id, receiveMode, receiveData, PMX::ControlMode::Position);
+  }
+  if((cycle % 10) == 0)
+  {
+    for(byte id = 0; id < ServoCount; id++)
+    {
+      short motorTemp;
+      pmx.getMotorTemp(id, &motorTemp);
+    }
+  }
+
+  // この周期のバス使用時間を記録する
+  unsigned long busy = pmx.getBusyMicros();
+  planner.measure(busy - lastBusy, PeriodMicros);
+  lastBusy = busy;
+
+  // 1秒に1回、見積もりと実測を表示します
+  if((cycle % 100) == 0)
+  {
+    Serial.print("Busy=");
+    Serial.print(planner.getLastBusy());
+    Serial.print("us Idle=");
+    Serial.print(planner.getLastIdle());
+    Serial.print("us MaxBusy=");
+    Serial.print(planner.getMaxBusy());
+    Serial.print("us (Plan ");
+    Serial.print(planner.getWorstCycleTime());
+    Serial.print("us) Utilization=");
+    Serial.print(planner.getMeasuredUtilization());
+    Serial.print("% Overrun=");
+    Serial.println(planner.getOverrunCount());
+  }
+
+  cycle++;
+}
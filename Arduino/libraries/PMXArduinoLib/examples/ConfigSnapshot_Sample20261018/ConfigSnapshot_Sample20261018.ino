@@ -0,0 +1,107 @@
+//
+//  @file ConfigSnapshot_Sample20261018.ino
+//  @brief Servo configuration snapshot / restore sample code
+//  @author SagaraLab
+//  @date 2026/10/18
+//  @copyright SagaraLab 2026
+//
+
+//
+//   ConfigSnapshot_Sample20261018.inoは設定済みのサーボからSAVE対象のRAM領域をまとめて読み出し、
+//   交換したサーボに差分だけを書き込んでSAVEするサンプルコードです。
+//   ConfigSnapshot_Sample20261018.ino is a sample code that captures the saved RAM area of a configured servo
+//   and writes only the changed spans to a replaced servo before one SAVE.
+//
+
+//
+//  Sample Board : ArduinoNanoEvery
+//  NanoEvery <=> RS-485Board
+//  RX(PC5)   <=  R  (Serial1)
+//  TX(PC4)    => D  (Serial1)
+//  D2(PA0)    => EN_IN
+//  VIN       <=  VOUT
+//  GND       <=> GND
+//  +5V        => IOREF
+//
+
+
+#include <Arduino.h>
+
+#include <PmxHardSerialClass.h>
+#include <PmxConfigSnapshot.h>
+#include <DataConvert.h>
+
+// サーボとArduino間の通信設定
+const byte EN_PIN = 2;        // EN(enable)ピンのピン番号
+const long BAUDRATE = 115200; // 通信速度[bps]
+const int TIMEOUT = 1000;      // タイムアウトまでの時間[ms]
+
+// インスタンス＋ENピン(2番ピン)およびUARTの指定
+PmxHardSerial pmx(&Serial1,EN_PIN,BAUDRATE,TIMEOUT);
+
+const byte MasterID = 0;    // 設定済みのサーボのID番号
+const byte ReplaceID = 1;   // 交換したサーボのID番号
+
+byte targetImage[PmxConfigSnapshot::ImageBytes];  // 目標の設定イメージ
+
+
+void setup() {
+
+  Serial.begin(115200);   // PCと通信を開始する
+
+  delay(500);   // サーボが起動するまで少し待つ
+  pmx.begin();  // サーボモータの通信初期設定
+
+  uint16_t flag;
+
+  // 設定済みのサーボからイメージを取得します(MemREAD 2回)
+  flag = PmxConfigSnapshot::capture(&pmx, MasterID, targetImage);
+  Serial.print("capture=");
+  Serial.println(flag, HEX);
+
+  if(PmxConfigSnapshot::isValid(targetImage) == false)
+  {
+    Serial.println("image error");
+    return;
+  }
+
+  // イメージの一部を書き換えることもできます(例:電流制限値を1500mAにする)
+  byte limitBytes[2];
+  DataConv::uint16ToBytes(1500, limitBytes);
+  PmxConfigSnapshot::writeData(targetImage, PMX::RamAddrList::CurrentLimit, limitBytes, 2);
+
+  // 交換したサーボとの差分を確認します
+  byte current[PmxConfigSnapshot::ImageBytes];
+  PmxConfigSnapshot::Span spans[PmxConfigSnapshot::MaxSpans];
+  PmxConfigSnapshot::capture(&pmx, ReplaceID, current);
+  int spanCount = PmxConfigSnapshot::diff(current, targetImage, spans, PmxConfigSnapshot::MaxSpans);
+  Serial.print("diff spans=");
+  Serial.println(spanCount);
+  for(int i = 0; i < spanCount; i++)
+  {
+    Serial.print("  addr=");
+    Serial.print(spans[i].addr);
+    Serial.print(" size=");
+    Serial.println(spans[i].size);
+  }
+
+  // 差分のみ書き込み、変更があった場合のみSAVEします
+  int writeCount;
+  flag = PmxConfigSnapshot::restore(&pmx, ReplaceID, targetImage, 0, &writeCount);
+  Serial.print("restore=");
+  Serial.print(flag, HEX);
+  Serial.print(" MemWRITE count=");
+  Serial.println(writeCount);
+
+  // 2回目は変更がないのでMemWRITEもSAVEも発行されません
+  flag = PmxConfigSnapshot::restore(&pmx, ReplaceID, targetImage, 0, &writeCount);
+  Serial.print("restore(2nd)=");
+  Serial.print(flag, HEX);
+  Serial.print(" MemWRITE count=");
+  Serial.println(writeCount);
+}
+
+
+void loop() {
+
+}
@@ -0,0 +1,137 @@
+//
+//  @file Provisioning_Sample20261018.ino
+//  @brief Fleet provisioning (ID / baudrate assignment) sample code
+//  @author SagaraLab
+//  @date 2026/10/18
+//  @copyright SagaraLab 2026
+//
+
+//
+//   Provisioning_Sample20261018.inoは複数のバスに接続されたPMXサーボのシリアル番号を調べ、
+//   計画表に従ってID・通信速度をまとめて書き換えて確認するサンプルコードです。
+//   Provisioning_Sample20261018.ino is a sample code that discovers PMX servos on several buses
+//   and assigns ID / baudrate from a plan table by serial number.
+//
+//   USE_SIMULATORを1にすると、サーボを接続せずに仮想バス(PmxSim)で動作を確認できます。
+//   Set USE_SIMULATOR to 1 to run against the virtual servo bus (PmxSim) without servos.
+//
+
+//
+//  Sample Board : Teensy4.1
+//  Teensy4.1 <=> RS-485Board x2
+//  RX1/TX1 (Serial1) , 2pin  => Bus0 EN_IN
+//  RX2/TX2 (Serial2) , 3pin  => Bus1 EN_IN
+//
+
+
+#include <Arduino.h>
+
+#include <PmxHardSerialClass.h>
+#include <PmxProvisioner.h>
+#include <PmxSim.h>
+
+#define USE_SIMULATOR 1
+
+const long BAUDRATE = 115200;       // 書き換え前の通信速度[bps]
+const long NEW_BAUDRATE = 1000000;  // 書き換え後の通信速度[bps]
+const int SCAN_TIMEOUT = 20;        // 走査時のタイムアウト[ms](応答がないIDで待つ時間)
+
+#if USE_SIMULATOR
+PmxSim bus0;
+PmxSim bus1;
+#else
+PmxHardSerial bus0(&Serial1, 2, BAUDRATE, SCAN_TIMEOUT);
+PmxHardSerial bus1(&Serial2, 3, BAUDRATE, SCAN_TIMEOUT);
+#endif
+
+PmxProvisioner provisioner;
+
+
+// ホスト側の通信速度を切り替える
+void setHostBaudrate(long baudrate, byte baudrateVal)
+{
+#if USE_SIMULATOR
+  (void)baudrate;
+  bus0.setHostSerial(baudrateVal);
+  bus1.setHostSerial(baudrateVal);
+#else
+  (void)baudrateVal;
+  bus0.begin(baudrate);
+  bus1.begin(baudrate);
+#endif
+}
+
+
+void setup() {
+
+  Serial.begin(115200);   // PCと通信を開始する
+  while(!Serial && millis() < 3000);
+
+#if USE_SIMULATOR
+  // 仮想サーボを接続します(新品のサーボはすべてID0)
+  bus0.addServo(0x00A10001, 0);
+  bus0.addServo(0x00A10002, 1);
+  bus1.addServo(0x00B20001, 0);
+#else
+  delay(500);   // サーボが起動するまで少し待つ
+  bus0.begin();
+  bus1.begin();
+#endif
+
+  provisioner.addBus(&bus0);
+  provisioner.addBus(&bus1);
+
+  // 計画表: シリアル番号 → 新しいID、通信速度
+  provisioner.addPlan(0x00A10001, 1, PMX::EditBaudrate::_1000000);
+  provisioner.addPlan(0x00A10002, 2, PMX::EditBaudrate::_1000000);
+  provisioner.addPlan(0x00B20001, 3, PMX::EditBaudrate::_1000000);
+
+  unsigned long startTime = millis();
+
+  // 1. シリアル番号を集めます
+  int found = provisioner.discover(0, 15);
+  Serial.print("found=");
+  Serial.print(found);
+  Serial.print(" collision=");
+  Serial.println(provisioner.getCollisionCount());
+
+  // 2. シリアル番号指定のSystemWRITEで書き換えます
+  Serial.print("written=");
+  Serial.println(provisioner.apply());
+
+  // 3. ReBootをまとめて送ります
+  Serial.print("rebooted=");
+  Serial.println(provisioner.rebootAll());
+
+  // 通信速度を変えたのでホスト側も切り替えてから確認します
+  setHostBaudrate(NEW_BAUDRATE, PMX::EditBaudrate::_1000000);
+
+  // 4. 新しいIDで応答を確認します(起動待ちを含めて最大2秒)
+  Serial.print("verified=");
+  Serial.println(provisioner.verify(2000));
+
+  Serial.print("time[ms]=");
+  Serial.println(millis() - startTime);
+
+  for(int i = 0; i < provisioner.getServoCount(); i++)
+  {
+    const PmxProvisioner::ServoRecord &servo = provisioner.getServo(i);
+    Serial.print("bus");
+    Serial.print(servo.bus);
+    Serial.print(" serial=");
+    Serial.print(servo.serialNum, HEX);
+    Serial.print(" id ");
+    Serial.print(servo.foundId);
+    Serial.print("->");
+    Serial.print(servo.id);
+    Serial.print(" state=");
+    Serial.print(servo.state);
+    Serial.print(" flag=");
+    Serial.println(servo.flag, HEX);
+  }
+}
+
+
+void loop() {
+
+}
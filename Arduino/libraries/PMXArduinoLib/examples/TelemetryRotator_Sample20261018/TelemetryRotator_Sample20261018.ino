@@ -0,0 +1,118 @@
+//
+//  @file TelemetryRotator_Sample20261018.ino
+//  @brief MotorWRITE telemetry rotation sample code
+//  @author SagaraLab
+//  @date 2026/10/18
+//  @copyright SagaraLab 2026
+//
+
+//
+//   TelemetryRotator_Sample20261018.inoはMotorWRITEの応答データ指定を周期的に切り替えて、
+//   位置を毎回取得しながら温度・電圧・電流を追加のMemREADなしで取得するサンプルコードです。
+//   TelemetryRotator_Sample20261018.ino is a sample code that rotates the MotorWRITE receive mode
+//   so that temperature, voltage and current are obtained without extra MemREAD commands.
+//
+
+//
+//  Sample Board : ArduinoNanoEvery
+//  NanoEvery <=> RS-485Board
+//  RX(PC5)   <=  R  (Serial1)
+//  TX(PC4)    => D  (Serial1)
+//  D2(PA0)    => EN_IN
+//  VIN       <=  VOUT
+//  GND       <=> GND
+//  +5V        => IOREF
+//
+
+
+#include <Arduino.h>
+
+#include <PmxHardSerialClass.h>
+#include <PmxTelemetryRotator.h>
+
+// サーボとArduino間の通信設定
+const byte EN_PIN = 2;        // EN(enable)ピンのピン番号
+const long BAUDRATE = 115200; // 通信速度[bps]
+const int TIMEOUT = 1000;      // タイムアウトまでの時間[ms]
+
+// インスタンス＋ENピン(2番ピン)およびUARTの指定
+PmxHardSerial pmx(&Serial1,EN_PIN,BAUDRATE,TIMEOUT);
+
+const byte ServoID = 0;   //サーボのID番号
+
+byte controlMode = PMX::ControlMode::Position;    // 位置制御モード値
+
+// 毎サイクル必要な応答データ(位置)を指定してインスタンスを作成する
+PmxTelemetryRotator rotator(&pmx, ServoID, PMX::ReceiveDataOption::Position, controlMode);
+
+const int LoopPeriod = 10;  // 制御周期[ms]
+
+
+void setup() {
+
+  Serial.begin(115200);   // PCと通信を開始する
+
+  delay(500);   // サーボが起動するまで少し待つ
+  pmx.begin();  // サーボモータの通信初期設定
+
+  uint16_t flag;
+
+  // 制御モードの設定します
+  byte writeOpt = 1;
+  flag = pmx.setControlMode(ServoID, controlMode, writeOpt);
+  Serial.print("setControlMode=");
+  Serial.println(flag, HEX);
+
+  // 応答データのスケジュールを設定します
+  // 温度と電圧は100サイクル(1秒)に1回まとめて取得します(応答モードの切り替えは1秒に2回)
+  rotator.addSchedule(PMX::ReceiveDataOption::MotorTemp + PMX::ReceiveDataOption::CpuTemp + PMX::ReceiveDataOption::Voltage, 100);
+  // 電流は10サイクル(100ms)に1回取得します(phaseを温度とそろえると、温度は電流と同じサイクルで取得します)
+  rotator.addSchedule(PMX::ReceiveDataOption::Current, 10);
+  // 9サイクル以内に再び取得する電流は応答モードに残し、戻して切り替えるsetMotorReceiveを省きます
+  rotator.setHoldCycles(9);
+
+  // サーボのトルクをオンにします
+  long receiveData[8];
+  flag = pmx.setMotorTorqueOn(ServoID, PMX::ReceiveDataOption::Position, receiveData, controlMode);
+  Serial.print("setMotorTorqueOn=");
+  Serial.println(flag, HEX);
+}
+
+
+void loop() {
+
+  uint16_t flag;
+  long receiveData[8];
+
+  // 目標位置を±30度で往復させる
+  long pos = ((millis() / 2000) % 2) ? 3000 : -3000;
+  long writeDatas[1] = {pos};
+
+  // 応答モードは必要な時だけ自動で切り替わります
+  flag = rotator.MotorWRITE(writeDatas, 1, receiveData);
+
+  // 1秒に1回、最新値と何サイクル前の値かを表示します
+  if((rotator.getCycle() % 100) == 0)
+  {
+    Serial.print("MotorWRITE=");
+    Serial.println(flag, HEX);
+    Serial.print("NowPosition=");
+    Serial.println(receiveData[0]);
+    Serial.print("NowCurrent=");
+    Serial.print(rotator.getLatest(2));
+    Serial.print(" age=");
+    Serial.println(rotator.getAge(2));
+    Serial.print("NowMotorTemp=");
+    Serial.print(rotator.getLatest(5));
+    Serial.print(" age=");
+    Serial.println(rotator.getAge(5));
+    Serial.print("NowCpuTemp=");
+    Serial.println(rotator.getLatest(6));
+    Serial.print("NowVoltage=");
+    Serial.println(rotator.getLatest(7));
+    Serial.print("ModeChangeCount=");
+    Serial.println(rotator.getModeChangeCount());
+  }
+
+  delay(LoopPeriod);
+}
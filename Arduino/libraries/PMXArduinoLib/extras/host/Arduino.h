@@ -0,0 +1,99 @@
+/**
+* @file Arduino.h
+* @brief  Minimal Arduino API for building the PMX library on a host PC
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+* @details ホストのプログラム(extras/host)からPmxBase・PmxSim等をビルドするための、Arduinoの最小限の定義です。
+* @details 時間(millis/micros/delay)はホストの時計、Serialの出力は標準出力です。受信はしません。
+* @details Arduino環境ではこのファイルは使いません(-Iでextras/hostを指定した時だけ読み込まれます)。
+**/
+
+#ifndef __Pmx_Host_Arduino_h__
+#define __Pmx_Host_Arduino_h__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define HEX 16
+#define DEC 10
+#define SERIAL_8N1 0x06
+#define SERIAL_8E1 0x26
+#define SERIAL_8O1 0x36
+
+namespace PmxHost
+{
+    /// @brief プログラム開始時刻
+    inline std::chrono::steady_clock::time_point start()
+    {
+        static const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        return t0;
+    }
+}
+
+inline unsigned long millis(){return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - PmxHost::start()).count();}
+inline unsigned long micros(){return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - PmxHost::start()).count();}
+inline void delay(unsigned long ms){std::this_thread::sleep_for(std::chrono::milliseconds(ms));}
+inline void delayMicroseconds(unsigned int us){std::this_thread::sleep_for(std::chrono::microseconds(us));}
+inline void pinMode(uint8_t, uint8_t){}
+inline void digitalWrite(uint8_t, uint8_t){}
+inline int digitalRead(uint8_t){return LOW;}
+
+/// @brief 標準出力へ書き出すPrint
+class Print
+{
+    public:
+        virtual ~Print(){}
+        virtual size_t write(uint8_t c){return (fputc(c, stdout) == EOF) ? 0 : 1;}
+        size_t write(const uint8_t *buffer, size_t size){return fwrite(buffer, 1, size, stdout);}
+        virtual int availableForWrite(){return 0;}
+
+        size_t print(const char *s){return (size_t)printf("%s", s);}
+        size_t print(char c){return (size_t)printf("%c", c);}
+        size_t print(int n, int base=DEC){return (base == HEX) ? (size_t)printf("%X", n) : (size_t)printf("%d", n);}
+        size_t print(unsigned int n, int base=DEC){return (base == HEX) ? (size_t)printf("%X", n) : (size_t)printf("%u", n);}
+        size_t print(long n, int base=DEC){return (base == HEX) ? (size_t)printf("%lX", n) : (size_t)printf("%ld", n);}
+        size_t print(unsigned long n, int base=DEC){return (base == HEX) ? (size_t)printf("%lX", n) : (size_t)printf("%lu", n);}
+        size_t print(double n, int digits=2){return (size_t)printf("%.*f", digits, n);}
+        size_t println(){return (size_t)printf("\n");}
+        template <typename T> size_t println(T value){size_t n = print(value); return n + println();}
+        template <typename T> size_t println(T value, int format){size_t n = print(value, format); return n + println();}
+};
+
+/// @brief 受信しないStream
+class Stream : public Print
+{
+    public:
+        virtual int available(){return 0;}
+        virtual int read(){return -1;}
+        virtual int peek(){return -1;}
+        virtual void flush(){}
+        void setTimeout(unsigned long){}
+        size_t readBytes(uint8_t *, size_t){return 0;}
+        size_t readBytes(char *, size_t){return 0;}
+};
+
+/// @brief 標準出力へ書き出すHardwareSerial
+class HardwareSerial : public Stream
+{
+    public:
+        void begin(unsigned long, uint16_t=SERIAL_8N1){}
+        void end(){}
+        operator bool(){return true;}
+};
+
+static HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,12 @@
+/**
+* @file HardwareSerial.h
+* @brief  Host stand-in for the Arduino HardwareSerial header
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+* @details HardwareSerialは同じフォルダのArduino.hで定義しています。
+**/
+
+#include "Arduino.h"
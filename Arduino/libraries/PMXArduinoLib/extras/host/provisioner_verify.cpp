@@ -0,0 +1,216 @@
+/**
+* @file provisioner_verify.cpp
+* @brief  Host verification of PmxProvisioner against the PmxSim virtual bus
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+* @details PmxSimの仮想バスにサーボを並べ、PmxProvisionerのdiscover・apply・rebootAll・verifyの結果を確認します。
+* @details * IDの入れ替え・巡回・連鎖(0→1、1→2)で、書き換えの途中に同じIDのサーボが2台にならないこと
+* @details * 空いているIDがない入れ替えや、衝突したID・計画表にないサーボと重なる計画はErrorにし、サーボを書き換えないこと
+* @details * 2本のバスで、ID衝突したサーボは見つからず、他のバスの書き換えは進むこと
+* @details * 通信速度の変更はホストの通信設定を変えてから確認できること
+* @details Arduinoの代わりに同じフォルダのArduino.hを使います。PmxBaseの仮想関数は派生クラスだけで定義しているので、Arduinoのビルドと同じく-O2 -fno-rttiでビルドしてください。
+*
+* g++ -std=gnu++11 -O2 -fno-rtti -I. -I../../src provisioner_verify.cpp ../../src/PmxBaseClass.cpp ../../src/PmxCRC.cpp ../../src/DataConvert.cpp ../../src/PmxSim.cpp ../../src/PmxConfigSnapshot.cpp ../../src/PmxProvisioner.cpp -o provisioner_verify
+**/
+
+#include <stdio.h>
+
+#include "PmxSim.h"
+#include "PmxProvisioner.h"
+
+namespace
+{
+    constexpr unsigned long VerifyTimeout = 500;   //verifyの待ち時間[ms]
+
+    int failed = 0;
+
+    /// @brief 条件を確認し、結果を表示します
+    void expect(const char *name, bool ok)
+    {
+        printf("  %-52s %s\n", name, ok ? "ok" : "FAIL");
+        if(!ok)
+        {
+            failed++;
+        }
+    }
+
+    /// @brief シリアル番号のサーボの状態とIDを確認します
+    bool hasState(PmxProvisioner &provisioner, unsigned long serialNum, byte id, byte state)
+    {
+        for(int i = 0; i < provisioner.getServoCount(); i++)
+        {
+            const PmxProvisioner::ServoRecord &servo = provisioner.getServo(i);
+            if(servo.serialNum == serialNum)
+            {
+                return servo.id == id && servo.state == state;
+            }
+        }
+        return false;
+    }
+
+    /// @brief 仮想バスのIDで、そのシリアル番号のサーボが応答するか確認します
+    bool answers(PmxSim &sim, byte id, unsigned long serialNum)
+    {
+        unsigned long readSerial = 0;
+        unsigned short flag = sim.getSerialNumber(id, &readSerial);
+        return flag == PMX::ComError::OK && readSerial == serialNum;
+    }
+}
+
+
+int main()
+{
+    //IDの入れ替え(0↔1)
+    {
+        printf("swap\n");
+        PmxSim bus;
+        bus.addServo(0xA, 0);
+        bus.addServo(0xB, 1);
+        PmxProvisioner provisioner;
+        provisioner.addBus(&bus);
+        provisioner.addPlan(0xA, 1);
+        provisioner.addPlan(0xB, 0);
+
+        provisioner.discover(0, 5);
+        expect("apply writes both", provisioner.apply() == 2);
+        expect("rebootAll sends both", provisioner.rebootAll() == 2);
+        expect("verify confirms both", provisioner.verify(VerifyTimeout) == 2);
+        expect("0xA verified at ID1", hasState(provisioner, 0xA, 1, PmxProvisionState::Verified));
+        expect("0xB verified at ID0", hasState(provisioner, 0xB, 0, PmxProvisionState::Verified));
+        expect("bus answers 0xA at ID1, 0xB at ID0", answers(bus, 1, 0xA) && answers(bus, 0, 0xB));
+    }
+
+    //巡回(0→1→2→0)と、巡回に含まれない書き換え
+    {
+        printf("rotate3\n");
+        PmxSim bus;
+        bus.addServo(0xA, 0);
+        bus.addServo(0xB, 1);
+        bus.addServo(0xC, 2);
+        bus.addServo(0xD, 3);
+        PmxProvisioner provisioner;
+        provisioner.addBus(&bus);
+        provisioner.addPlan(0xA, 1);
+        provisioner.addPlan(0xB, 2);
+        provisioner.addPlan(0xC, 0);
+        provisioner.addPlan(0xD, 4);
+
+        provisioner.discover(0, 5);
+        expect("apply writes all four", provisioner.apply() == 4);
+        provisioner.rebootAll();
+        expect("verify confirms all four", provisioner.verify(VerifyTimeout) == 4);
+        expect("bus answers 0xA..0xD at 1,2,0,4", answers(bus, 1, 0xA) && answers(bus, 2, 0xB) && answers(bus, 0, 0xC) && answers(bus, 4, 0xD));
+    }
+
+    //連鎖(0→1、1→2)は1→2を先に書く
+    {
+        printf("chain\n");
+        PmxSim bus;
+        bus.addServo(0xA, 0);
+        bus.addServo(0xB, 1);
+        PmxProvisioner provisioner;
+        provisioner.addBus(&bus);
+        provisioner.addPlan(0xA, 1);
+        provisioner.addPlan(0xB, 2);
+
+        provisioner.discover(0, 5);
+        expect("apply writes both", provisioner.apply() == 2);
+        provisioner.rebootAll();
+        expect("verify confirms both", provisioner.verify(VerifyTimeout) == 2);
+        expect("bus answers 0xA at ID1, 0xB at ID2", answers(bus, 1, 0xA) && answers(bus, 2, 0xB));
+    }
+
+    //走査した範囲に空いているIDがない入れ替えは書き換えない
+    {
+        printf("swap without a free ID\n");
+        PmxSim bus;
+        bus.addServo(0xA, 0);
+        bus.addServo(0xB, 1);
+        PmxProvisioner provisioner;
+        provisioner.addBus(&bus);
+        provisioner.addPlan(0xA, 1);
+        provisioner.addPlan(0xB, 0);
+
+        provisioner.discover(0, 1);
+        expect("apply writes nothing", provisioner.apply() == 0);
+        expect("both marked Error at their old IDs", hasState(provisioner, 0xA, 0, PmxProvisionState::Error) && hasState(provisioner, 0xB, 1, PmxProvisionState::Error));
+        expect("bus still answers 0xA at ID0, 0xB at ID1", answers(bus, 0, 0xA) && answers(bus, 1, 0xB));
+    }
+
+    //一時的なIDに、衝突して見つからなかったIDを使わない
+    {
+        printf("temporary ID avoids a collided ID\n");
+        PmxSim bus;
+        bus.addServo(0xA, 0);
+        bus.addServo(0xB, 1);
+        bus.addServo(0xE, 3);
+        bus.addServo(0xF, 3);
+        PmxProvisioner provisioner;
+        provisioner.addBus(&bus);
+        provisioner.addPlan(0xA, 1);
+        provisioner.addPlan(0xB, 0);
+
+        provisioner.discover(0, 3);
+        expect("collision counted", provisioner.getCollisionCount() == 1);
+        expect("apply writes both through ID2", provisioner.apply() == 2);
+        expect("bus answers 0xA at ID1, 0xB at ID0", answers(bus, 1, 0xA) && answers(bus, 0, 0xB));
+    }
+
+    //衝突したID・計画表にないサーボのIDへの書き換えはError
+    {
+        printf("target taken by a collided ID / a servo not in plan\n");
+        PmxSim bus;
+        bus.addServo(0xA, 0);
+        bus.addServo(0xE, 3);
+        bus.addServo(0xF, 3);
+        bus.addServo(0x9, 4);
+        bus.addServo(0xB, 5);
+        PmxProvisioner provisioner;
+        provisioner.addBus(&bus);
+        provisioner.addPlan(0xA, 3);
+        provisioner.addPlan(0xB, 4);
+
+        provisioner.discover(0, 6);
+        expect("apply writes nothing", provisioner.apply() == 0);
+        expect("0xA and 0xB marked Error", hasState(provisioner, 0xA, 0, PmxProvisionState::Error) && hasState(provisioner, 0xB, 5, PmxProvisionState::Error));
+        expect("0x9 marked NotInPlan", hasState(provisioner, 0x9, 4, PmxProvisionState::NotInPlan));
+    }
+
+    //2本のバス(片方はID衝突)と通信速度の変更
+    {
+        printf("two buses, collision and baudrate change\n");
+        PmxSim bus0;
+        PmxSim bus1;
+        bus0.addServo(0x1001, 0);
+        bus0.addServo(0x1002, 1);
+        bus1.addServo(0x2001, 0);
+        bus1.addServo(0x2002, 0);
+        bus1.addServo(0x2003, 1);
+        PmxProvisioner provisioner;
+        provisioner.addBus(&bus0);
+        provisioner.addBus(&bus1);
+        provisioner.addPlan(0x1001, 10);
+        provisioner.addPlan(0x1002, 11, PMX::EditBaudrate::_1000000);
+        provisioner.addPlan(0x2001, 20);
+        provisioner.addPlan(0x2003, 21);
+
+        expect("discover finds 3 (the collided pair is hidden)", provisioner.discover(0, 5) == 3);
+        expect("collision counted", provisioner.getCollisionCount() == 1);
+        expect("apply writes 3", provisioner.apply() == 3);
+        expect("rebootAll sends 3", provisioner.rebootAll() == 3);
+        expect("verify confirms the two at 115200", provisioner.verify(VerifyTimeout) == 2);
+        expect("bus1 answers 0x2003 at ID21", answers(bus1, 21, 0x2003));
+
+        byte baudrate = 0;
+        byte parity = 0;
+        expect("0x1002 stores 1Mbps", bus0.getServoSerial(1, &baudrate, &parity) && baudrate == PMX::EditBaudrate::_1000000);
+        bus0.setHostSerial(PMX::EditBaudrate::_1000000);
+        expect("bus0 answers 0x1002 at ID11 after host switches to 1Mbps", answers(bus0, 11, 0x1002));
+    }
+
+    printf("verify: %d failed\n", failed);
+    return (failed == 0) ? 0 : 1;
+}
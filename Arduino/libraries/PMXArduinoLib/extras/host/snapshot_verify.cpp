@@ -0,0 +1,139 @@
+/**
+* @file snapshot_verify.cpp
+* @brief  Host verification of PmxConfigSnapshot diff/restore against the PmxSim virtual bus
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+* @details PmxSimのサーボの設定を書き換えたイメージをrestoreし、書き込み回数とサーボのRAMが目標と一致するか確認します。
+* @details * 少ない変更は変更した場所だけを書き込むこと
+* @details * MaxSpansを超える数の離れた変更も、まとめ直して失敗せずに書き込めること
+* @details * 変更がない場合はMemWRITE・SAVEをしないこと
+* @details provisioner_verify.cppと同じく、同じフォルダのArduino.hを使い-O2 -fno-rttiでビルドしてください。
+*
+* g++ -std=gnu++11 -O2 -fno-rtti -I. -I../../src snapshot_verify.cpp ../../src/PmxBaseClass.cpp ../../src/PmxCRC.cpp ../../src/DataConvert.cpp ../../src/PmxSim.cpp ../../src/PmxConfigSnapshot.cpp -o snapshot_verify
+**/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "PmxSim.h"
+#include "PmxConfigSnapshot.h"
+
+namespace
+{
+    int failed = 0;
+
+    /// @brief 条件を確認し、結果を表示します
+    void expect(const char *name, bool ok)
+    {
+        printf("  %-52s %s\n", name, ok ? "ok" : "FAIL");
+        if(!ok)
+        {
+            failed++;
+        }
+    }
+
+    /// @brief targetと同じ設定になったか、サーボから読み直して確認します
+    bool matches(PmxSim &sim, byte id, const byte target[])
+    {
+        byte image[PmxConfigSnapshot::ImageBytes];
+        unsigned short flag = PmxConfigSnapshot::capture(&sim, id, image);
+        return flag == PMX::ComError::OK && memcmp(image, target, PmxConfigSnapshot::ImageBytes) == 0;
+    }
+
+    /// @brief 書き込めるアドレスのstep個ごとに1byteずつ書き換えます
+    int scatter(byte image[], int step)
+    {
+        int changed = 0;
+        int writable = 0;
+        for(unsigned short addr = PmxConfigSnapshot::StartAddr; addr < PmxConfigSnapshot::StartAddr + PmxConfigSnapshot::DataSize; addr++)
+        {
+            if(PmxConfigSnapshot::isWritable(addr) == false)
+            {
+                continue;
+            }
+            if((writable++ % step) == 0)
+            {
+                byte data;
+                PmxConfigSnapshot::readData(image, addr, &data, 1);
+                data ^= 0x01;
+                PmxConfigSnapshot::writeData(image, addr, &data, 1);
+                changed++;
+            }
+        }
+        return changed;
+    }
+}
+
+
+int main()
+{
+    const byte Id = 0;
+
+    //変更が2か所
+    {
+        printf("two changes\n");
+        PmxSim sim;
+        sim.addServo(0x1234, Id);
+        byte target[PmxConfigSnapshot::ImageBytes];
+        PmxConfigSnapshot::capture(&sim, Id, target);
+        byte current[PmxConfigSnapshot::ImageBytes];
+        memcpy(current, target, sizeof(current));
+
+        byte data[2] = {0x10, 0x27};
+        PmxConfigSnapshot::writeData(target, PMX::RamAddrList::CurrentLimit, data, 2);
+        PmxConfigSnapshot::writeData(target, 200, data, 1);
+
+        PmxConfigSnapshot::Span spans[PmxConfigSnapshot::MaxSpans];
+        int count = PmxConfigSnapshot::diff(current, target, spans, PmxConfigSnapshot::MaxSpans);
+        expect("diff returns 2 spans", count == 2);
+
+        int writeCount = 0;
+        unsigned short flag = PmxConfigSnapshot::restore(&sim, Id, target, 0, &writeCount);
+        expect("restore succeeds with 2 MemWRITEs", flag == PMX::ComError::OK && writeCount == 2);
+        expect("servo matches target", matches(sim, Id, target));
+        expect("one SAVE", sim.getSaveCount(0) == 1);
+    }
+
+    //MaxSpansを超える数の離れた変更
+    const int steps[] = {20, 12, 10, 2, 1};
+    for(int step : steps)
+    {
+        printf("scattered changes, every %d writable byte\n", step);
+        PmxSim sim;
+        sim.addServo(0x1234, Id);
+        byte target[PmxConfigSnapshot::ImageBytes];
+        PmxConfigSnapshot::capture(&sim, Id, target);
+        byte current[PmxConfigSnapshot::ImageBytes];
+        memcpy(current, target, sizeof(current));
+        int changed = scatter(target, step);
+
+        PmxConfigSnapshot::Span spans[PmxConfigSnapshot::MaxSpans];
+        int count = PmxConfigSnapshot::diff(current, target, spans, PmxConfigSnapshot::MaxSpans);
+        printf("  %d bytes changed -> %d spans\n", changed, count);
+        expect("diff fits in MaxSpans", count > 0 && count <= PmxConfigSnapshot::MaxSpans);
+
+        int writeCount = 0;
+        unsigned short flag = PmxConfigSnapshot::restore(&sim, Id, target, 0, &writeCount);
+        expect("restore succeeds", flag == PMX::ComError::OK && writeCount == count);
+        expect("servo matches target", matches(sim, Id, target));
+    }
+
+    //変更なし
+    {
+        printf("no change\n");
+        PmxSim sim;
+        sim.addServo(0x1234, Id);
+        byte target[PmxConfigSnapshot::ImageBytes];
+        PmxConfigSnapshot::capture(&sim, Id, target);
+
+        int writeCount = -1;
+        unsigned short flag = PmxConfigSnapshot::restore(&sim, Id, target, 0, &writeCount);
+        expect("restore writes nothing and skips SAVE", flag == PMX::ComError::OK && writeCount == 0 && sim.getSaveCount(0) == 0);
+    }
+
+    printf("verify: %d failed\n", failed);
+    return (failed == 0) ? 0 : 1;
+}
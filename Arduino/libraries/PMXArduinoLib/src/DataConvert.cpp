@@ -65,6 +65,7 @@ long DataConv::bytesToInt32(unsigned char byteDatas[])
 unsigned long DataConv::bytesToUint32(unsigned char byteDatas[])
 {
     Uint32Byte dbyte;
+    dbyte.uint32 = 0;   //unsigned longが4byteより大きい環境(ホストPC)でも上位を0にする
     dbyte.byte[0] = byteDatas[0];
     dbyte.byte[1] = byteDatas[1];
     dbyte.byte[2] = byteDatas[2];
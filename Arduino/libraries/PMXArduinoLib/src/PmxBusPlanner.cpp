@@ -0,0 +1,486 @@
+
+/**
+* @file PmxBusPlanner.cpp
+* @brief  PMX bus bandwidth planner source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+*/
+
+#include "PmxBusPlanner.h"
+
+
+/**
+ * @brief Construct a new Pmx Bus Planner:: Pmx Bus Planner object
+ *
+ * @param [in] baudrate 通信速度[bps]
+ * @param [in] parity パリティを使用しているか(trueで1byteを11bitとして計算)
+ * @param [in] responseTime サーボの応答時間[us](getResponseTimeで取得した値)
+ * @param [in] turnaround ホスト側の送受信の切り替えや処理にかかる時間[us]
+ */
+PmxBusPlanner::PmxBusPlanner(long baudrate, bool parity, unsigned int responseTime, unsigned int turnaround)
+{
+    _baudrate = baudrate;
+    _parity = parity;
+    _responseTime = responseTime;
+    _turnaround = turnaround;
+}
+
+
+/**
+ * @brief MotorWRITEの送信データ数を返します。
+ *
+ * @param [in] writeDataCount 指令値の数
+ *
+ * @return byte 送信データ数
+ */
+byte PmxBusPlanner::motorWriteTxLen(int writeDataCount)
+{
+    return PMX::MinimumLength::Send + (writeDataCount * 2);
+}
+
+/**
+ * @brief MotorWRITE/MotorREADの返信データ数を返します。
+ *
+ * @param [in] receiveMode 応答モード(PMX::ReceiveDataOption)
+ *
+ * @return byte 返信データ数(トルクスイッチの1byteを含む)
+ */
+byte PmxBusPlanner::motorReplyLen(byte receiveMode)
+{
+    int bits = 0;
+
+    for(int i = 0; i < 8; i++)
+    {
+        if((receiveMode >> i) & 0x01)
+        {
+            bits++;
+        }
+    }
+
+    return PMX::MinimumLength::Receive + 1 + (bits * 2);
+}
+
+/**
+ * @brief MemREADの返信データ数を返します。
+ *
+ * @param [in] readDataSize 読み出すデータ数
+ *
+ * @return byte 返信データ数
+ */
+byte PmxBusPlanner::memReadRxLen(int readDataSize)
+{
+    return PMX::MinimumLength::Receive + readDataSize;
+}
+
+/**
+ * @brief MemWRITEの送信データ数を返します。
+ *
+ * @param [in] writeDataSize 書き込むデータ数
+ *
+ * @return byte 送信データ数
+ */
+byte PmxBusPlanner::memWriteTxLen(int writeDataSize)
+{
+    return PMX::MinimumLength::Send + 2 + writeDataSize;
+}
+
+
+/**
+ * @brief 1フレームの通信時間を計算します。
+ *
+ * @param [in] len データ数
+ *
+ * @return unsigned long 通信時間[us](切り上げ)
+ */
+unsigned long PmxBusPlanner::frameTime(byte len)
+{
+    unsigned long bitsPerByte = _parity ? 11 : 10;
+    unsigned long bits = (unsigned long)len * bitsPerByte;
+
+    return (bits * 1000000UL + (unsigned long)_baudrate - 1) / (unsigned long)_baudrate;
+}
+
+/**
+ * @brief 1コマンドの通信時間を計算します。
+ *
+ * @param [in] txLen 送信データ数
+ * @param [in] rxLen 返信データ数(返信がない場合は0)
+ *
+ * @return unsigned long 通信時間[us]
+ *
+ * @note 返信がない場合はサーボの応答時間を含めません。
+ */
+unsigned long PmxBusPlanner::commandTime(byte txLen, byte rxLen)
+{
+    unsigned long time = this->frameTime(txLen) + _turnaround;
+
+    if(rxLen > 0)
+    {
+        time += _responseTime + this->frameTime(rxLen);
+    }
+
+    return time;
+}
+
+
+/**
+ * @brief 1サイクルのスケジュールにコマンドを登録します。
+ *
+ * @param [in] txLen 送信データ数(0は既存の返信に増えるデータとして扱います、addReplyBytes参照)
+ * @param [in] rxLen 返信データ数(返信がない場合は0)
+ * @param [in] count 1回に発行する数(サーボの数)
+ * @param [in] period 何サイクルに1回発行するか(1で毎サイクル)
+ * @param [in] phase 発行するサイクルのずらし量(0～period-1)
+ *
+ * @return true 登録成功
+ * @return false 登録数がいっぱい、もしくは値が範囲外
+ */
+bool PmxBusPlanner::addCommand(byte txLen, byte rxLen, byte count, unsigned int period, unsigned int phase)
+{
+    if(_entryCount >= MaxEntry || period == 0 || phase >= period || count == 0)
+    {
+        return false;
+    }
+
+    _entry[_entryCount].txLen = txLen;
+    _entry[_entryCount].rxLen = rxLen;
+    _entry[_entryCount].count = count;
+    _entry[_entryCount].period = period;
+    _entry[_entryCount].phase = phase;
+    _entryCount++;
+
+    return true;
+}
+
+/**
+ * @brief MotorWRITEをスケジュールに登録します。
+ *
+ * @param [in] servoCount サーボの数
+ * @param [in] writeDataCount 指令値の数
+ * @param [in] receiveMode 応答モード(PMX::ReceiveDataOption)
+ * @param [in] period 何サイクルに1回発行するか
+ * @param [in] phase 発行するサイクルのずらし量
+ *
+ * @return true 登録成功
+ * @return false 登録失敗
+ */
+bool PmxBusPlanner::addMotorWRITE(byte servoCount, int writeDataCount, byte receiveMode, unsigned int period, unsigned int phase)
+{
+    return this->addCommand(motorWriteTxLen(writeDataCount), motorReplyLen(receiveMode), servoCount, period, phase);
+}
+
+/**
+ * @brief MotorREADをスケジュールに登録します。
+ *
+ * @param [in] servoCount サーボの数
+ * @param [in] receiveMode 応答モード(PMX::ReceiveDataOption)
+ * @param [in] period 何サイクルに1回発行するか
+ * @param [in] phase 発行するサイクルのずらし量
+ *
+ * @return true 登録成功
+ * @return false 登録失敗
+ */
+bool PmxBusPlanner::addMotorREAD(byte servoCount, byte receiveMode, unsigned int period, unsigned int phase)
+{
+    return this->addCommand(PMX::MinimumLength::Send, motorReplyLen(receiveMode), servoCount, period, phase);
+}
+
+/**
+ * @brief MemREADをスケジュールに登録します。
+ *
+ * @param [in] servoCount サーボの数
+ * @param [in] readDataSize 読み出すデータ数
+ * @param [in] period 何サイクルに1回発行するか
+ * @param [in] phase 発行するサイクルのずらし量
+ *
+ * @return true 登録成功
+ * @return false 登録失敗
+ */
+bool PmxBusPlanner::addMemREAD(byte servoCount, int readDataSize, unsigned int period, unsigned int phase)
+{
+    return this->addCommand(PMX::MinimumLength::Send + 3, memReadRxLen(readDataSize), servoCount, period, phase);
+}
+
+/**
+ * @brief MemWRITEをスケジュールに登録します。
+ *
+ * @param [in] servoCount サーボの数
+ * @param [in] writeDataSize 書き込むデータ数
+ * @param [in] period 何サイクルに1回発行するか
+ * @param [in] phase 発行するサイクルのずらし量
+ *
+ * @return true 登録成功
+ * @return false 登録失敗
+ *
+ * @note PmxTelemetryRotatorが応答モードを切り替える時のsetMotorReceiveは1byteのMemWRITEです。
+ */
+bool PmxBusPlanner::addMemWRITE(byte servoCount, int writeDataSize, unsigned int period, unsigned int phase)
+{
+    return this->addCommand(memWriteTxLen(writeDataSize), PMX::MinimumLength::Receive, servoCount, period, phase);
+}
+
+/**
+ * @brief 既存の返信に増えるデータをスケジュールに登録します。
+ *
+ * @param [in] servoCount サーボの数
+ * @param [in] bytes 増える返信データ数(1項目2byte)
+ * @param [in] period 何サイクルに1回増えるか
+ * @param [in] phase 増えるサイクルのずらし量
+ *
+ * @return true 登録成功
+ * @return false 登録失敗
+ *
+ * @note PmxTelemetryRotatorが応答モードに項目を追加した時のMotorWRITEの返信などに使います。
+ * @note 新しいコマンドではないので、送信フレーム・サーボの応答時間・切り替え時間は加えず、返信フレームが長くなる時間だけを加えます。
+ */
+bool PmxBusPlanner::addReplyBytes(byte servoCount, byte bytes, unsigned int period, unsigned int phase)
+{
+    if(bytes == 0)
+    {
+        return false;
+    }
+
+    return this->addCommand(0, bytes, servoCount, period, phase);
+}
+
+/**
+ * @brief 登録したコマンドをすべて削除します。
+ */
+void PmxBusPlanner::clear()
+{
+    _entryCount = 0;
+}
+
+
+/**
+ * @brief 登録したコマンド1回分(count台分)の通信時間を計算します。
+ *
+ * @param [in] entry 登録したコマンド
+ *
+ * @return unsigned long 通信時間[us]
+ *
+ * @note 送信データ数が0の場合(addReplyBytes)は、増える返信データのフレーム時間のみです。
+ */
+unsigned long PmxBusPlanner::entryTime(const Entry *entry)
+{
+    if(entry->txLen == 0)
+    {
+        return this->frameTime(entry->rxLen) * entry->count;
+    }
+
+    return this->commandTime(entry->txLen, entry->rxLen) * entry->count;
+}
+
+
+/**
+ * @brief 指定したサイクルの通信時間を計算します。
+ *
+ * @param [in] cycle サイクル番号
+ *
+ * @return unsigned long 通信時間[us]
+ */
+unsigned long PmxBusPlanner::getCycleTime(unsigned long cycle)
+{
+    unsigned long time = 0;
+
+    for(int i = 0; i < _entryCount; i++)
+    {
+        const Entry *entry = &_entry[i];
+
+        if((cycle % entry->period) == entry->phase)
+        {
+            time += this->entryTime(entry);
+        }
+    }
+
+    return time;
+}
+
+/**
+ * @brief 最も通信が多いサイクルの通信時間を計算します。
+ *
+ * @return unsigned long 通信時間[us]
+ *
+ * @note 全コマンドの周期の最小公倍数がMaxHyperPeriodを超える場合は、全コマンドが同じサイクルに重なるものとして計算します。
+ */
+unsigned long PmxBusPlanner::getWorstCycleTime()
+{
+    unsigned long hyperPeriod = 1;
+
+    for(int i = 0; i < _entryCount; i++)
+    {
+        unsigned long period = _entry[i].period;
+        hyperPeriod = hyperPeriod / gcd(hyperPeriod, period) * period;
+
+        if(hyperPeriod > MaxHyperPeriod)
+        {
+            //すべて重なる場合で見積もる
+            unsigned long time = 0;
+            for(int j = 0; j < _entryCount; j++)
+            {
+                time += this->entryTime(&_entry[j]);
+            }
+            return time;
+        }
+    }
+
+    unsigned long worst = 0;
+
+    for(unsigned long cycle = 0; cycle < hyperPeriod; cycle++)
+    {
+        unsigned long time = this->getCycleTime(cycle);
+        if(time > worst)
+        {
+            worst = time;
+        }
+    }
+
+    return worst;
+}
+
+/**
+ * @brief 1サイクルあたりの平均の通信時間を計算します。
+ *
+ * @return unsigned long 通信時間[us]
+ */
+unsigned long PmxBusPlanner::getAverageCycleTime()
+{
+    unsigned long time = 0;
+
+    for(int i = 0; i < _entryCount; i++)
+    {
+        time += this->entryTime(&_entry[i]) / _entry[i].period;
+    }
+
+    return time;
+}
+
+/**
+ * @brief 最も通信が多いサイクルのバス使用率を計算します。
+ *
+ * @param [in] periodMicros 制御周期[us]
+ *
+ * @return float バス使用率[%]
+ */
+float PmxBusPlanner::getUtilization(unsigned long periodMicros)
+{
+    if(periodMicros == 0)
+    {
+        return 0.0f;
+    }
+
+    return (float)this->getWorstCycleTime() * 100.0f / (float)periodMicros;
+}
+
+/**
+ * @brief 登録したコマンドが制御周期に収まるか判定します。
+ *
+ * @param [in] periodMicros 制御周期[us]
+ * @param [in] maxUtilization 許容するバス使用率[%](制御の計算時間などを残す場合は100より小さくします)
+ *
+ * @return true 最も通信が多いサイクルでも収まる
+ * @return false 収まらないサイクルがある
+ */
+bool PmxBusPlanner::fits(unsigned long periodMicros, float maxUtilization)
+{
+    return this->getUtilization(periodMicros) <= maxUtilization;
+}
+
+/**
+ * @brief 登録したコマンドの残り時間で、あと何回MotorWRITEを発行できるか計算します。
+ *
+ * @param [in] periodMicros 制御周期[us]
+ * @param [in] writeDataCount 指令値の数
+ * @param [in] receiveMode 応答モード(PMX::ReceiveDataOption)
+ *
+ * @return int 発行できる回数(すでに収まっていない場合は0)
+ */
+int PmxBusPlanner::countMotorWRITEFit(unsigned long periodMicros, int writeDataCount, byte receiveMode)
+{
+    unsigned long worst = this->getWorstCycleTime();
+
+    if(worst >= periodMicros)
+    {
+        return 0;
+    }
+
+    return (periodMicros - worst) / this->commandTime(motorWriteTxLen(writeDataCount), motorReplyLen(receiveMode));
+}
+
+
+/**
+ * @brief 1サイクル分のバス使用時間を記録します。
+ *
+ * @param [in] busyMicros このサイクルでバスを使用した時間[us](PmxHardSerial::getBusyMicrosの差分)
+ * @param [in] periodMicros 制御周期[us]
+ */
+void PmxBusPlanner::measure(unsigned long busyMicros, unsigned long periodMicros)
+{
+    _lastBusy = busyMicros;
+    _lastIdle = (busyMicros < periodMicros) ? (periodMicros - busyMicros) : 0;
+
+    if(busyMicros > _maxBusy)
+    {
+        _maxBusy = busyMicros;
+    }
+    if(_lastIdle < _minIdle)
+    {
+        _minIdle = _lastIdle;
+    }
+    if(busyMicros > periodMicros)
+    {
+        _overrunCount++;
+    }
+
+    _measureBusy += busyMicros;
+    _measurePeriod += periodMicros;
+    _measureCycles++;
+}
+
+/**
+ * @brief 計測した値をすべて0にします。
+ */
+void PmxBusPlanner::resetMeasure()
+{
+    _measureCycles = 0;
+    _measureBusy = 0;
+    _measurePeriod = 0;
+    _lastBusy = 0;
+    _lastIdle = 0;
+    _maxBusy = 0;
+    _minIdle = 0xFFFFFFFF;
+    _overrunCount = 0;
+}
+
+/**
+ * @brief 計測したバス使用率を返します。
+ *
+ * @return float 計測開始からのバス使用率[%]
+ */
+float PmxBusPlanner::getMeasuredUtilization()
+{
+    if(_measurePeriod == 0)
+    {
+        return 0.0f;
+    }
+
+    return (float)_measureBusy * 100.0f / (float)_measurePeriod;
+}
+
+
+/**
+ * @brief 最大公約数を計算します。
+ */
+unsigned long PmxBusPlanner::gcd(unsigned long a, unsigned long b)
+{
+    while(b != 0)
+    {
+        unsigned long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
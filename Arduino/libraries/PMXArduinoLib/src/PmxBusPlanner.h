@@ -0,0 +1,134 @@
+
+/**
+* @file PmxBusPlanner.h
+* @brief  PMX bus bandwidth planner header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+* @details 1サイクルに発行するコマンドの通信時間を通信速度・パリティ・返信待ち時間から見積もり、
+* @details 制御周期に収まるか判定します。また、実際のバス使用時間を集計して使用率と空き時間を求めます。
+**/
+
+#ifndef __Pmx_Bus_Planner_h__
+#define __Pmx_Bus_Planner_h__
+
+#include "PmxBaseClass.h"
+
+/// @brief 1本のバスの通信時間を見積もり、制御周期に収まるか判定するクラス
+/// @details
+/// * 1コマンドの時間 = 送信フレーム + 返信待ち(サーボの応答時間) + 返信フレーム + ホストの切り替え時間
+/// * フレームの時間は1byteあたり10bit(パリティありは11bit)で計算します
+/// * コマンドはperiodサイクルに1回(phaseでずらす)発行するものとして登録できます(PmxTelemetryRotatorのスケジュールと同じ考え方)
+/// * 応答モードの切り替えで既存の返信に増えるデータはaddReplyBytesで登録します(返信フレームが長くなる時間だけを加えます)
+/// * 最も通信が多いサイクルの時間(getWorstCycleTime)が制御周期に収まるか判定します
+///
+/// @code
+/// // 1Mbpsで8軸、位置+電流の返信を500Hz(2000us)で回せるか
+/// PmxBusPlanner planner(1000000);
+/// planner.addMotorWRITE(8, 1, PMX::ReceiveDataOption::Position + PMX::ReceiveDataOption::Current);
+/// if(planner.fits(2000)) { /* OK */ }
+/// @endcode
+///
+/// @code
+/// // 実行中のバス使用率(PmxHardSerial::getBusyMicrosの差分を1サイクルごとに渡す)
+/// unsigned long busy = pmx.getBusyMicros();
+/// planner.measure(busy - lastBusy, 2000);
+/// lastBusy = busy;
+/// @endcode
+class PmxBusPlanner
+{
+    public:
+        static constexpr int MaxEntry = 16;             //!< 登録できるコマンドの最大数
+        static constexpr unsigned long MaxHyperPeriod = 10000;  //!< 最悪サイクルを調べる最大のサイクル数
+
+        /// @brief 登録したコマンド
+        typedef struct
+        {
+            byte txLen;             //!< 送信データ数(0は既存の返信に増えるデータ)
+            byte rxLen;             //!< 返信データ数(返信がない場合は0)
+            byte count;             //!< 1回に発行する数(サーボの数)
+            unsigned int period;    //!< 何サイクルに1回発行するか
+            unsigned int phase;     //!< 発行するサイクルのずらし量
+        } Entry;
+
+    private:
+        long _baudrate;
+        bool _parity;
+        unsigned int _responseTime;
+        unsigned int _turnaround;
+
+        Entry _entry[MaxEntry];
+        int _entryCount = 0;
+
+        //実行中の計測
+        unsigned long _measureCycles = 0;
+        uint64_t _measureBusy = 0;
+        uint64_t _measurePeriod = 0;
+        unsigned long _lastBusy = 0;
+        unsigned long _lastIdle = 0;
+        unsigned long _maxBusy = 0;
+        unsigned long _minIdle = 0xFFFFFFFF;
+        unsigned long _overrunCount = 0;
+
+    public:
+        PmxBusPlanner(long baudrate, bool parity=false, unsigned int responseTime=0, unsigned int turnaround=50);
+
+        //フレーム長
+        static byte motorWriteTxLen(int writeDataCount);
+        static byte motorReplyLen(byte receiveMode);
+        static byte memReadRxLen(int readDataSize);
+        static byte memWriteTxLen(int writeDataSize);
+
+        //通信時間の見積もり
+        unsigned long frameTime(byte len);
+        unsigned long commandTime(byte txLen, byte rxLen);
+
+        //スケジュールの登録
+        bool addCommand(byte txLen, byte rxLen, byte count=1, unsigned int period=1, unsigned int phase=0);
+        bool addMotorWRITE(byte servoCount, int writeDataCount, byte receiveMode, unsigned int period=1, unsigned int phase=0);
+        bool addMotorREAD(byte servoCount, byte receiveMode, unsigned int period=1, unsigned int phase=0);
+        bool addMemREAD(byte servoCount, int readDataSize, unsigned int period=1, unsigned int phase=0);
+        bool addMemWRITE(byte servoCount, int writeDataSize, unsigned int period=1, unsigned int phase=0);
+        bool addReplyBytes(byte servoCount, byte bytes, unsigned int period=1, unsigned int phase=0);
+        void clear();
+
+        /// @brief 登録したコマンドの数を返します
+        int getEntryCount(){return _entryCount;}
+        /// @brief 登録したコマンドを返します
+        const Entry &getEntry(int index){return _entry[index];}
+
+        //見積もり結果
+        unsigned long getCycleTime(unsigned long cycle);
+        unsigned long getWorstCycleTime();
+        unsigned long getAverageCycleTime();
+        float getUtilization(unsigned long periodMicros);
+        bool fits(unsigned long periodMicros, float maxUtilization=100.0f);
+        int countMotorWRITEFit(unsigned long periodMicros, int writeDataCount, byte receiveMode);
+
+        //実行中の計測
+        void measure(unsigned long busyMicros, unsigned long periodMicros);
+        void resetMeasure();
+
+        /// @brief 計測したサイクル数を返します
+        unsigned long getMeasureCycles(){return _measureCycles;}
+        /// @brief 直前のサイクルのバス使用時間[us]を返します
+        unsigned long getLastBusy(){return _lastBusy;}
+        /// @brief 直前のサイクルのバスの空き時間[us]を返します
+        unsigned long getLastIdle(){return _lastIdle;}
+        /// @brief バス使用時間の最大値[us]を返します
+        unsigned long getMaxBusy(){return _maxBusy;}
+        /// @brief バスの空き時間の最小値[us]を返します
+        unsigned long getMinIdle(){return (_measureCycles == 0) ? 0 : _minIdle;}
+        /// @brief バス使用時間が制御周期を超えたサイクル数を返します
+        unsigned long getOverrunCount(){return _overrunCount;}
+
+        float getMeasuredUtilization();
+
+    private:
+        unsigned long entryTime(const Entry *entry);
+        static unsigned long gcd(unsigned long a, unsigned long b);
+};
+
+#endif
@@ -0,0 +1,403 @@
+
+/**
+* @file PmxConfigSnapshot.cpp
+* @brief  PMX configuration snapshot source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+*/
+
+#include "PmxConfigSnapshot.h"
+#include "PmxCRC.h"
+#include "DataConvert.h"
+
+
+/// @brief SAVE対象領域内の予約領域(書き込み不可)の一覧 [先頭アドレス, サイズ]
+static const unsigned short ReservedArea[][2] =
+{
+    {28, 4}, {44, 4}, {60, 4}, {122, 2}, {152, 4}, {168, 4}, {184, 4}, {216, 4}, {232, 4}
+};
+
+/// @brief MemWRITEの書き込みが拒否されたと判定するステータス
+static const byte WriteRejectStatus = PMX::PmxStatusErrorList::CommandError
+                                    | PMX::PmxStatusErrorList::RamAccessError
+                                    | PMX::PmxStatusErrorList::ModeError
+                                    | PMX::PmxStatusErrorList::DataError;
+
+
+/**
+ * @brief サーボのSAVE対象領域を読み出してイメージを作成します。
+ *
+ * @param [in] pmx 通信に使用するPMXのインスタンス(PmxHardSerial等)
+ * @param [in] id PMXサーボモータのID番号
+ * @param [out] image 作成したイメージ(ImageBytesバイト)
+ *
+ * @return unsigned short 通信の状態とステータス(送信結果(PMX::ComError参照) + PMXのstatus)
+ *
+ * @note MemREADの最大サイズ(243バイト)を超えるため、2回に分けて読み出します。
+ * @attention 通信エラーの場合はイメージが不正になり、isValidでfalseになります。
+ */
+unsigned short PmxConfigSnapshot::capture(PmxBase *pmx, byte id, byte image[])
+{
+    const int firstSize = DataSize / 2;
+    const int secondSize = DataSize - firstSize;
+
+    setHeader(image);
+
+    unsigned short flag = pmx->MemREAD(id, StartAddr, firstSize, &image[HeaderSize]);
+
+    if((flag & PMX::ComError::ErrorMask) == PMX::ComError::OK)
+    {
+        flag = pmx->MemREAD(id, StartAddr + firstSize, secondSize, &image[HeaderSize + firstSize]);
+    }
+
+    if((flag & PMX::ComError::ErrorMask) != PMX::ComError::OK)
+    {
+        //マジックナンバーを消して不正なイメージにしておく
+        image[0] = 0x00;
+        return flag;
+    }
+
+    setCrc(image);
+
+    return flag;
+}
+
+
+/**
+ * @brief イメージのヘッダとCRCが正しいか確認します。
+ *
+ * @param [in] image 確認するイメージ
+ *
+ * @return true 正しいイメージ
+ * @return false マジックナンバー、バージョン、アドレス範囲、CRCのいずれかが不正
+ */
+bool PmxConfigSnapshot::isValid(const byte image[])
+{
+    if(image[0] != 'P' || image[1] != 'M' || image[2] != 'X' || image[3] != 'C')
+    {
+        return false;
+    }
+
+    byte *header = (byte *)image;
+    if(DataConv::bytesToUint16(&header[4]) != FormatVersion
+        || DataConv::bytesToUint16(&header[6]) != StartAddr
+        || DataConv::bytesToUint16(&header[8]) != DataSize)
+    {
+        return false;
+    }
+
+    unsigned short crc = PmxCrc16::getCrc16(header, HeaderSize + DataSize);
+
+    return crc == DataConv::bytesToUint16(&header[HeaderSize + DataSize]);
+}
+
+
+/**
+ * @brief 指定したアドレスがMemWRITEで書き込める(予約領域でない)か判定します。
+ *
+ * @param [in] addr RAMのアドレス
+ *
+ * @return true 書き込み可能
+ * @return false SAVE対象領域外、もしくは予約領域
+ */
+bool PmxConfigSnapshot::isWritable(unsigned short addr)
+{
+    if(addr < StartAddr || addr >= StartAddr + DataSize)
+    {
+        return false;
+    }
+
+    for(unsigned int i = 0; i < sizeof(ReservedArea) / sizeof(ReservedArea[0]); i++)
+    {
+        if(addr >= ReservedArea[i][0] && addr < ReservedArea[i][0] + ReservedArea[i][1])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief イメージからRAMアドレスを指定してデータを取り出します。
+ *
+ * @param [in] image 読み出すイメージ
+ * @param [in] addr RAMの先頭アドレス(PMX::RamAddrList参照)
+ * @param [out] data 取り出したデータ
+ * @param [in] size 取り出すサイズ
+ *
+ * @return true 成功
+ * @return false アドレス範囲外
+ */
+bool PmxConfigSnapshot::readData(const byte image[], unsigned short addr, byte data[], int size)
+{
+    if(size <= 0 || addr < StartAddr || addr + size > StartAddr + DataSize)
+    {
+        return false;
+    }
+
+    for(int i = 0; i < size; i++)
+    {
+        data[i] = image[HeaderSize + addr - StartAddr + i];
+    }
+
+    return true;
+}
+
+/**
+ * @brief イメージのRAMアドレスを指定してデータを書き換え、CRCを更新します。
+ *
+ * @param [in,out] image 書き換えるイメージ
+ * @param [in] addr RAMの先頭アドレス(PMX::RamAddrList参照)
+ * @param [in] data 書き込むデータ
+ * @param [in] size 書き込むサイズ
+ *
+ * @return true 成功
+ * @return false アドレス範囲外、もしくは予約領域を含む
+ *
+ * @note 交換用の目標イメージを作る時に、取得したイメージの一部(ゲイン等)を書き換える用途を想定しています。
+ */
+bool PmxConfigSnapshot::writeData(byte image[], unsigned short addr, const byte data[], int size)
+{
+    if(size <= 0 || addr < StartAddr || addr + size > StartAddr + DataSize)
+    {
+        return false;
+    }
+
+    for(int i = 0; i < size; i++)
+    {
+        if(isWritable(addr + i) == false)
+        {
+            return false;
+        }
+    }
+
+    for(int i = 0; i < size; i++)
+    {
+        image[HeaderSize + addr - StartAddr + i] = data[i];
+    }
+
+    setCrc(image);
+
+    return true;
+}
+
+
+/**
+ * @brief 2つのイメージを比較し、書き込みが必要な連続領域を求めます。
+ *
+ * @param [in] current 現在のサーボのイメージ
+ * @param [in] target 目標のイメージ
+ * @param [out] spans 書き込みが必要な領域
+ * @param [in] maxSpans spans配列の要素数
+ * @param [in] mergeGap この数以下の未変更バイトをはさむ領域は1つにまとめます
+ *
+ * @return int 書き込みが必要な領域の数(0:変更なし、-1:イメージ不正もしくはspansが予約領域で分かれる数より少ない)
+ *
+ * @note 予約領域をまたぐ領域はまとめずに分割します。
+ * @note まとめた領域に含まれる未変更バイトは現在と同じ値を書き込むだけなので設定は変わりません。
+ * @note 領域がmaxSpansを超える場合は、mergeGapを倍にしながらまとめ直します。
+ *       最後は予約領域の間ごとに1回の書き込みになるので、変更が多くてもmaxSpans(MaxSpans)を超えて失敗することはありません。
+ */
+int PmxConfigSnapshot::diff(const byte current[], const byte target[], Span spans[], int maxSpans, int mergeGap)
+{
+    if(isValid(current) == false || isValid(target) == false)
+    {
+        return -1;
+    }
+
+    int gap = (mergeGap < 0) ? 0 : mergeGap;
+
+    while(true)
+    {
+        int count = collectSpans(current, target, spans, maxSpans, gap);
+
+        //予約領域の間ごとにまとめても足りない場合はspansが少なすぎる
+        if(count >= 0 || gap >= DataSize)
+        {
+            return count;
+        }
+
+        gap = (gap == 0) ? 1 : gap * 2;
+    }
+}
+
+/**
+ * @brief 未変更バイトをmergeGapまではさんでまとめながら、書き込みが必要な連続領域を求めます。
+ *
+ * @param [in] current 現在のサーボのイメージ
+ * @param [in] target 目標のイメージ
+ * @param [out] spans 書き込みが必要な領域
+ * @param [in] maxSpans spans配列の要素数
+ * @param [in] mergeGap この数以下の未変更バイトをはさむ領域は1つにまとめます
+ *
+ * @return int 書き込みが必要な領域の数(-1:spansが足りない)
+ */
+int PmxConfigSnapshot::collectSpans(const byte current[], const byte target[], Span spans[], int maxSpans, int mergeGap)
+{
+    int count = 0;
+    int spanStart = -1;
+    int spanEnd = -1;
+
+    for(int addr = StartAddr; addr < StartAddr + DataSize; addr++)
+    {
+        int index = HeaderSize + addr - StartAddr;
+
+        if(current[index] == target[index] || isWritable(addr) == false)
+        {
+            continue;
+        }
+
+        //直前の領域とまとめられるか(間が短く、予約領域をまたがない)
+        bool merge = false;
+        if(spanStart >= 0 && (addr - spanEnd - 1) <= mergeGap)
+        {
+            merge = true;
+            for(int gap = spanEnd + 1; gap < addr; gap++)
+            {
+                if(isWritable(gap) == false)
+                {
+                    merge = false;
+                    break;
+                }
+            }
+        }
+
+        if(merge)
+        {
+            spanEnd = addr;
+            continue;
+        }
+
+        if(spanStart >= 0)
+        {
+            if(count >= maxSpans)
+            {
+                return -1;
+            }
+            spans[count].addr = spanStart;
+            spans[count].size = spanEnd - spanStart + 1;
+            count++;
+        }
+
+        spanStart = addr;
+        spanEnd = addr;
+    }
+
+    if(spanStart >= 0)
+    {
+        if(count >= maxSpans)
+        {
+            return -1;
+        }
+        spans[count].addr = spanStart;
+        spans[count].size = spanEnd - spanStart + 1;
+        count++;
+    }
+
+    return count;
+}
+
+
+/**
+ * @brief サーボの設定を目標のイメージに合わせます(差分のみ書き込み、変更があった場合のみSAVE)。
+ *
+ * @param [in] pmx 通信に使用するPMXのインスタンス(PmxHardSerial等)
+ * @param [in] id PMXサーボモータのID番号
+ * @param [in] target 目標のイメージ
+ * @param [in] writeOpt MemWRITEのオプション(トルクON中に書き込む場合は1)
+ * @param [out] writeCount 実行したMemWRITEの回数(nullptrの場合は返しません)
+ *
+ * @return unsigned short 通信の状態とステータス(送信結果(PMX::ComError参照) + PMXのstatus)
+ *
+ * @note 通信はMemREAD 2回 + 差分の領域数分のMemWRITE + SAVE 1回(変更がない場合は実行しません)です。
+ * @attention MemWRITEがエラーもしくは拒否(ステータスのコマンド/RAMアクセス/モード/データエラー)された場合はSAVEせずに終了します。
+ * @attention 目標のイメージが不正な場合はPMX::ComError::FormatErrorを返します。
+ */
+unsigned short PmxConfigSnapshot::restore(PmxBase *pmx, byte id, const byte target[], byte writeOpt, int *writeCount)
+{
+    if(writeCount != nullptr)
+    {
+        *writeCount = 0;
+    }
+
+    if(isValid(target) == false)
+    {
+        return PMX::ComError::FormatError;
+    }
+
+    byte current[ImageBytes];
+    unsigned short flag = capture(pmx, id, current);
+
+    if((flag & PMX::ComError::ErrorMask) != PMX::ComError::OK)
+    {
+        return flag;
+    }
+
+    Span spans[MaxSpans];
+    int spanCount = diff(current, target, spans, MaxSpans);
+
+    if(spanCount < 0)
+    {
+        return PMX::ComError::FormatError;
+    }
+
+    byte writeBuff[DataSize];
+
+    for(int i = 0; i < spanCount; i++)
+    {
+        readData(target, spans[i].addr, writeBuff, spans[i].size);
+
+        flag = pmx->MemWRITE(id, spans[i].addr, writeBuff, spans[i].size, writeOpt);
+
+        if((flag & PMX::ComError::ErrorMask) != PMX::ComError::OK || (flag & WriteRejectStatus) != 0)
+        {
+            return flag;
+        }
+
+        if(writeCount != nullptr)
+        {
+            (*writeCount)++;
+        }
+    }
+
+    //変更がない場合はフラッシュを書き換えないようにSAVEしない
+    if(spanCount > 0)
+    {
+        flag = pmx->SAVE(id);
+    }
+
+    return flag;
+}
+
+
+/**
+ * @brief イメージのヘッダを設定します。
+ *
+ * @param [out] image ヘッダを設定するイメージ
+ */
+void PmxConfigSnapshot::setHeader(byte image[])
+{
+    image[0] = 'P';
+    image[1] = 'M';
+    image[2] = 'X';
+    image[3] = 'C';
+    DataConv::uint16ToBytes(FormatVersion, &image[4]);
+    DataConv::uint16ToBytes(StartAddr, &image[6]);
+    DataConv::uint16ToBytes(DataSize, &image[8]);
+}
+
+/**
+ * @brief イメージのCRCを計算して最後に付け加えます。
+ *
+ * @param [in,out] image CRCを設定するイメージ
+ */
+void PmxConfigSnapshot::setCrc(byte image[])
+{
+    unsigned short crc = PmxCrc16::getCrc16(image, HeaderSize + DataSize);
+    DataConv::uint16ToBytes(crc, &image[HeaderSize + DataSize]);
+}
@@ -0,0 +1,74 @@
+
+/**
+* @file PmxConfigSnapshot.h
+* @brief  PMX configuration snapshot header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+* @details SAVE対象のRAM領域(アドレス0～247)をまとめて読み出してイメージ化し、
+* @details 目標のイメージとの差分だけを書き戻すためのクラスです。
+**/
+
+#ifndef __Pmx_Config_Snapshot_h__
+#define __Pmx_Config_Snapshot_h__
+
+#include "PmxBaseClass.h"
+
+/// @brief サーボの設定値(SAVE対象のRAM領域)のスナップショットを扱うクラス
+/// @details
+/// * capture : 大きめのMemREAD 2回で設定領域を読み出し、バージョン付きのイメージを作成します
+/// * diff : 2つのイメージを比較し、書き込みが必要な連続領域(Span)を求めます(多すぎる場合は間の未変更バイトごとまとめます)
+/// * restore : 差分の領域のみMemWRITEし、書き込みがあった場合のみSAVEします
+///
+/// イメージのフォーマット(リトルエンディアン、合計ImageBytesバイト)
+/// | オフセット | サイズ | 内容 |
+/// | 0 | 4 | マジックナンバー "PMXC" |
+/// | 4 | 2 | フォーマットバージョン |
+/// | 6 | 2 | 先頭アドレス |
+/// | 8 | 2 | データ長 |
+/// | 10 | DataSize | RAMデータ |
+/// | 10+DataSize | 2 | CRC16(先頭からRAMデータの最後まで) |
+///
+/// @code
+/// byte image[PmxConfigSnapshot::ImageBytes];
+/// PmxConfigSnapshot::capture(&pmx, 0, image);      // 設定済みのサーボから取得
+/// PmxConfigSnapshot::restore(&pmx, 1, image);      // 交換したサーボへ差分だけ書き込む
+/// @endcode
+class PmxConfigSnapshot
+{
+    public:
+        static constexpr byte FormatVersion = 1;            //!< イメージのフォーマットバージョン
+        static constexpr unsigned short StartAddr = 0;      //!< SAVE対象領域の先頭アドレス
+        static constexpr unsigned short DataSize = 248;     //!< SAVE対象領域のサイズ(アドレス0～247)
+        static constexpr int HeaderSize = 10;               //!< イメージのヘッダサイズ
+        static constexpr int ImageBytes = HeaderSize + DataSize + 2;   //!< イメージ全体のサイズ
+        static constexpr int DefaultMergeGap = 8;           //!< この数以下の未変更バイトをはさむ領域は1回で書き込む
+        static constexpr int MaxSpans = 16;                 //!< restoreで扱う書き込み領域の最大数
+
+        /// @brief 書き込みが必要な連続領域
+        typedef struct
+        {
+            unsigned short addr;    //!< 先頭アドレス
+            unsigned short size;    //!< 書き込みサイズ
+        } Span;
+
+    public:
+        static unsigned short capture(PmxBase *pmx, byte id, byte image[]);
+        static bool isValid(const byte image[]);
+        static bool isWritable(unsigned short addr);
+
+        static bool readData(const byte image[], unsigned short addr, byte data[], int size);
+        static bool writeData(byte image[], unsigned short addr, const byte data[], int size);
+
+        static int diff(const byte current[], const byte target[], Span spans[], int maxSpans, int mergeGap=DefaultMergeGap);
+        static unsigned short restore(PmxBase *pmx, byte id, const byte target[], byte writeOpt=0, int *writeCount=nullptr);
+
+    private:
+        static void setHeader(byte image[]);
+        static void setCrc(byte image[]);
+        static int collectSpans(const byte current[], const byte target[], Span spans[], int maxSpans, int mergeGap);
+};
+
+#endif
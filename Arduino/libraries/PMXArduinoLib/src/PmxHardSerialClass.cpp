@@ -4,14 +4,15 @@
 * @brief PMX arduino (HardwareSerial) library source file
 * @author Kondo Kagaku Co.,Ltd.
 * @author T.Nobuhara Gotanda
-* @date 2024/02/22
-* @version 1.0.2
+* @date 2026/10/18
+* @version 1.0.4
 * @copyright Kondo Kagaku Co.,Ltd. 2024
 *
 */
 
 #include "PmxBaseClass.h"
 #include "PmxHardSerialClass.h"
+#include "PmxCRC.h"
 #include <Arduino.h>
 
 
@@ -148,22 +149,44 @@ bool PmxHardSerial::synchronize(byte *txBuf, byte txLen, byte *rxBuf, byte rxLen
 
     //通信中にする
     _isSynchronize = true;
+    unsigned long busyStart = micros();
 
-    //送信のみをする
-    this->__synchronizeWrite(txBuf,txLen);
+    for(byte attempt = 0; ; attempt++)
+    {
+        //送信のみをする
+        this->__synchronizeWrite(txBuf,txLen);
 
 
-    //受信データを初期化しておく
-    for(int i = 0; i < rxLen; i++)
-    {
-        receiveBuff[i] = 0xFF;
+        //受信データを初期化しておく
+        for(int i = 0; i < rxLen; i++)
+        {
+            receiveBuff[i] = 0xFF;
+        }
+
+        //上位のバッファに影響しないように内部の受信バッファに入れておく
+        this->__applyDeadlineTimeout();
+        rxSize = pmxSerial->readBytes(receiveBuff, rxLen);
+
+        if(rxSize == rxLen && this->__isValidReply(receiveBuff, rxLen))
+        {
+            if(attempt > 0)
+            {
+                g_recoveredCount++;
+            }
+            break;
+        }
+
+        //期限内に再送できなければ最後の受信結果で判定する
+        if(this->__canRetry(txBuf, attempt, txLen, rxLen) == false)
+        {
+            break;
+        }
     }
 
-    //上位のバッファに影響しないように内部の受信バッファに入れておく
-	rxSize = pmxSerial->readBytes(receiveBuff, rxLen);
     memcpy(rxBuf, receiveBuff, rxLen);
 
     //通信中を解除する
+    g_busyMicros += micros() - busyStart;
     _isSynchronize = false;
 
 	if (rxSize != rxLen) //受信数確認
@@ -210,44 +233,83 @@ bool PmxHardSerial::synchronizeVariableRead(byte *txBuf, byte txLen, byte *rxBuf
 
     //通信中にする
     _isSynchronize = true;
+    unsigned long busyStart = micros();
 
-    //送信のみをする
-    this->__synchronizeWrite(txBuf,txLen);
+    byte minRxSize = PMX::MinimumLength::Receive - 2 ;//CRCを除く
+    byte allRxSize = 0;
+    bool received = false;
 
-    //受信データを初期化しておく
-    for(int i = 0; i < 256; i++)
+    for(byte attempt = 0; ; attempt++)
     {
-        receiveBuff[i] = 0xFF;
-    }
+        //送信のみをする
+        this->__synchronizeWrite(txBuf,txLen);
 
-    //データ数まで受信する
-    byte minRxSize = PMX::MinimumLength::Receive - 2 ;//CRCを除く
-    byte firstRxBuffSize = pmxSerial->readBytes(receiveBuff, minRxSize);
+        //受信データを初期化しておく
+        for(int i = 0; i < 256; i++)
+        {
+            receiveBuff[i] = 0xFF;
+        }
 
-    //そもそもデータが返ってこなかった
-    if(firstRxBuffSize != minRxSize)
-    {
-        *rxLen = 0;
+        //データ数まで受信する
+        this->__applyDeadlineTimeout();
+        byte firstRxBuffSize = pmxSerial->readBytes(receiveBuff, minRxSize);
 
-        //通信中を解除する
-        _isSynchronize = false;
-        
-        return false;
-    }
+        //そもそもデータが返ってこなかった
+        if(firstRxBuffSize != minRxSize)
+        {
+            *rxLen = 0;
+        }
+        else
+        {
+            //　長さを取得する
+            allRxSize = receiveBuff[PMX::BuffPter::Length];
+
+            //長さが壊れている場合は残りを受信しない
+            if(allRxSize < PMX::MinimumLength::Receive)
+            {
+                *rxLen = minRxSize;
+            }
+            else
+            {
+                byte secondRxBuffSize = allRxSize - minRxSize;
+
+                //上位のバッファに影響しないように内部の受信バッファに入れておく
+                byte sBuffSize = pmxSerial->readBytes(&(receiveBuff[minRxSize]), secondRxBuffSize);
+
+                //そもそもデータが返ってこなかった
+                if(secondRxBuffSize != sBuffSize)
+                {
+                    *rxLen = minRxSize;
+                }
+                else
+                {
+                    received = true;
+
+                    if(this->__isValidReply(receiveBuff, allRxSize))
+                    {
+                        if(attempt > 0)
+                        {
+                            g_recoveredCount++;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
 
-    //　長さを取得する
-    byte allRxSize = receiveBuff[PMX::BuffPter::Length];
-    byte secondRxBuffSize = allRxSize - minRxSize;
+        //期限内に再送できなければ最後の受信結果で判定する
+        if(this->__canRetry(txBuf, attempt, txLen, (allRxSize > minRxSize) ? allRxSize : PMX::MinimumLength::Receive) == false)
+        {
+            break;
+        }
 
-    //上位のバッファに影響しないように内部の受信バッファに入れておく
-	byte sBuffSize = pmxSerial->readBytes(&(receiveBuff[minRxSize]), secondRxBuffSize);
+        received = false;
+    }
 
-    //そもそもデータが返ってこなかった
-    if(secondRxBuffSize != sBuffSize)
+    if(received == false)
     {
-        *rxLen = minRxSize;
-
         //通信中を解除する
+        g_busyMicros += micros() - busyStart;
         _isSynchronize = false;
 
         return false;
@@ -259,6 +321,7 @@ bool PmxHardSerial::synchronizeVariableRead(byte *txBuf, byte txLen, byte *rxBuf
     memcpy(rxBuf, receiveBuff, allRxSize);
 
     //通信中を解除する
+    g_busyMicros += micros() - busyStart;
     _isSynchronize = false;
 
 	return true;
@@ -289,10 +352,12 @@ bool PmxHardSerial::synchronizeNoRead(byte *txBuf, byte txLen)
 
     //通信中にする
     _isSynchronize = true;
+    unsigned long busyStart = micros();
 
     //送信のみをする
     this->__synchronizeWrite(txBuf,txLen);
 
+    g_busyMicros += micros() - busyStart;
     _isSynchronize = false;
 
     return true;
@@ -341,6 +406,173 @@ void PmxHardSerial::__synchronizeWrite(byte *txBuf, byte txLen)
 }
 
 
+/**
+ * @brief 再送の設定をします。
+ *
+ * @param [in] maxRetries 再送の最大回数(0で再送しない)
+ * @param [in] responseAllowance サーボがコマンドを受け取ってから返信を始めるまでの見込み時間[us]
+ *
+ * @note 返信がない、途中で切れた、ヘッダ/長さ/CRCが不正な場合に同じコマンドを再送します。
+ * @note 期限(setDeadline)が設定されている場合は、残り時間で1往復できる時だけ再送します。
+ * @note 再送するのは読み込み(MemREAD, MotorREAD, SystemREAD)とMotorWRITEだけです。
+ * @note MemWRITE, LOAD, SAVE, SystemWRITE, ReBoot, FactoryResetは、返信が失われても実行されている可能性があるので再送しません(結果を確認して呼び出し側で判断してください)。
+ */
+void PmxHardSerial::setRetryPolicy(byte maxRetries, unsigned int responseAllowance)
+{
+    g_maxRetries = maxRetries;
+    g_responseAllowance = responseAllowance;
+}
+
+/**
+ * @brief 送受信を終えなければならない時刻を設定します。
+ *
+ * @param [in] deadlineMicros 期限の時刻[us](micros()基準)
+ *
+ * @note 制御周期の始めに「micros() + 通信に使える時間」を設定する使い方を想定しています。
+ * @note 期限が設定されている間は受信タイムアウトも残り時間に合わせて短くします。
+ */
+void PmxHardSerial::setDeadline(unsigned long deadlineMicros)
+{
+    g_deadline = deadlineMicros;
+    g_deadlineEnable = true;
+}
+
+/**
+ * @brief 期限の設定を解除します。
+ */
+void PmxHardSerial::clearDeadline()
+{
+    g_deadlineEnable = false;
+    if(pmxSerial != nullptr)
+    {
+        pmxSerial->setTimeout(g_timeout);
+    }
+}
+
+/**
+ * @brief 1往復の送受信にかかる時間を見積もります。
+ *
+ * @param [in] txLen 送信データ数
+ * @param [in] rxLen 受信データ数
+ *
+ * @return unsigned long 見積もり時間[us]
+ *
+ * @note 1byteあたりスタート/ストップビットを含めて10bit(パリティありは11bit)で計算し、返信までの見込み時間を加えます。
+ */
+unsigned long PmxHardSerial::estimateRoundTrip(byte txLen, byte rxLen)
+{
+    unsigned long bitsPerByte = (g_SerialConfig == SERIAL_8N1) ? 10 : 11;
+    unsigned long wireTime = ((unsigned long)(txLen + rxLen) * bitsPerByte * 1000000UL) / (unsigned long)g_baudrate;
+
+    return wireTime + g_responseAllowance;
+}
+
+
+/**
+ * @brief 受信したデータのヘッダ、長さ、CRCを確認します。
+ *
+ * @param [in] rxBuf 受信データ
+ * @param [in] rxLen 受信データ数
+ *
+ * @return true 正しい返信
+ * @return false 不正な返信
+ */
+bool PmxHardSerial::__isValidReply(byte *rxBuf, byte rxLen)
+{
+    if(rxLen < PMX::MinimumLength::Receive)
+    {
+        return false;
+    }
+    if(rxBuf[PMX::BuffPter::Header] != 0xFE || rxBuf[PMX::BuffPter::Header1] != 0xFE)
+    {
+        return false;
+    }
+    if(rxBuf[PMX::BuffPter::Length] != rxLen)
+    {
+        return false;
+    }
+    return PmxCrc16::checkCrc16(rxBuf);
+}
+
+/**
+ * @brief 返信が失われた時に再送してよいコマンドか判定します。
+ *
+ * @param [in] cmd コマンド(PMX::SendCmd)
+ *
+ * @return true 再送してよい(読み込みとMotorWRITE)
+ * @return false 再送しない(返信が失われても実行されている可能性がある)
+ */
+bool PmxHardSerial::__isRetryable(byte cmd)
+{
+    switch(cmd)
+    {
+        case PMX::SendCmd::MemREAD:
+        case PMX::SendCmd::MotorREAD:
+        case PMX::SendCmd::SystemREAD:
+        case PMX::SendCmd::MotorWRITE:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief 再送できるか判定し、再送する場合は回数を数えます。
+ *
+ * @param [in] txBuf 送信データ
+ * @param [in] attempt 今回の送信が何回目の再送か(最初の送信は0)
+ * @param [in] txLen 送信データ数
+ * @param [in] rxLen 受信データ数
+ *
+ * @return true 再送する
+ * @return false 再送しない
+ */
+bool PmxHardSerial::__canRetry(byte *txBuf, byte attempt, byte txLen, byte rxLen)
+{
+    if(attempt >= g_maxRetries || this->__isRetryable(txBuf[PMX::BuffPter::CMD]) == false)
+    {
+        return false;
+    }
+
+    if(g_deadlineEnable)
+    {
+        long remaining = (long)(g_deadline - micros());
+        if(remaining < (long)this->estimateRoundTrip(txLen, rxLen))
+        {
+            g_retrySkipCount++;
+            return false;
+        }
+    }
+
+    g_retryCount++;
+    return true;
+}
+
+/**
+ * @brief 期限が設定されている場合、受信タイムアウトを残り時間に合わせます。
+ *
+ * @note タイムアウトはms単位なので切り上げ、最低1msにします。
+ */
+void PmxHardSerial::__applyDeadlineTimeout()
+{
+    if(g_deadlineEnable == false)
+    {
+        return;
+    }
+
+    long remaining = (long)(g_deadline - micros());
+    long timeout = (remaining <= 0) ? 1 : (remaining + 999) / 1000;
+
+    if(timeout > g_timeout)
+    {
+        timeout = g_timeout;
+    }
+
+    pmxSerial->setTimeout(timeout);
+}
+
+
 /**
  * @brief Pmxで送信したデータ配列を表示する関数
  * 
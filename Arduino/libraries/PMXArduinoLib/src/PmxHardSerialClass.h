@@ -4,8 +4,8 @@
 * @brief  PMX arduino (HardwareSerial) library header file
 * @author Kondo Kagaku Co.,Ltd.
 * @author kedtn(T.Nobuhara) Gotanda
-* @date 2024/02/22
-* @version 1.0.1
+* @date 2026/10/18
+* @version 1.0.4
 * @copyright Kondo Kagaku Co.,Ltd. 2024
 **/	
 
@@ -43,6 +43,17 @@ class PmxHardSerial : public PmxBase
         byte sendBuff[256];   //!< 送信バッファ
         byte receiveBuff[256];   //!< 受信バッファ
 
+        byte g_maxRetries = 0;                  //    再送の最大回数(0で再送しない)
+        unsigned int g_responseAllowance = 300; //    サーボが返信を始めるまでの見込み時間[us]
+        bool g_deadlineEnable = false;          //    期限が設定されているか
+        unsigned long g_deadline = 0;           //    送受信を終えなければならない時刻[us](micros)
+
+        unsigned long g_retryCount = 0;         //    再送した回数
+        unsigned long g_retrySkipCount = 0;     //    期限が足りず再送しなかった回数
+        unsigned long g_recoveredCount = 0;     //    再送で正常な返信を受け取れた回数
+
+        unsigned long g_busyMicros = 0;         //    送受信に使った時間の累計[us]
+
 
 
 
@@ -68,6 +79,22 @@ class PmxHardSerial : public PmxBase
         //他の物が通信中かどうか
         bool isSynchronize();
 
+        //再送と期限の設定
+        void setRetryPolicy(byte maxRetries, unsigned int responseAllowance=300);
+        void setDeadline(unsigned long deadlineMicros);
+        void clearDeadline();
+        unsigned long estimateRoundTrip(byte txLen, byte rxLen);
+
+        /// @brief 再送した回数を返します
+        unsigned long getRetryCount(){return g_retryCount;}
+        /// @brief 期限が足りず再送しなかった回数を返します
+        unsigned long getRetrySkipCount(){return g_retrySkipCount;}
+        /// @brief 再送で正常な返信を受け取れた回数を返します
+        unsigned long getRecoveredCount(){return g_recoveredCount;}
+
+        /// @brief 送受信に使った時間の累計[us]を返します(PmxBusPlannerのmeasureに差分を渡します)
+        unsigned long getBusyMicros(){return g_busyMicros;}
+
     //イネーブルピンの処理
     protected : 
         /**
@@ -98,6 +125,10 @@ class PmxHardSerial : public PmxBase
 
     private:
         void __synchronizeWrite(byte *txBuf, byte txLen);
+        bool __isValidReply(byte *rxBuf, byte rxLen);
+        bool __isRetryable(byte cmd);
+        bool __canRetry(byte *txBuf, byte attempt, byte txLen, byte rxLen);
+        void __applyDeadlineTimeout();
 
     //  ログの出力
 
@@ -0,0 +1,291 @@
+
+/**
+* @file PmxLinkStats.cpp
+* @brief  PMX per-servo link statistics source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+*/
+
+#include "PmxLinkStats.h"
+
+
+/**
+ * @brief Construct a new Pmx Link Stats:: Pmx Link Stats object
+ */
+PmxLinkStats::PmxLinkStats()
+{
+}
+
+
+/**
+ * @brief コマンドの結果を分類します。
+ *
+ * @param [in] flag コマンドの結果(送信結果(PMX::ComError参照) + PMXのstatus)
+ *
+ * @return byte 分類(PmxLinkClass参照)
+ */
+byte PmxLinkStats::classify(unsigned short flag)
+{
+    switch(flag & PMX::ComError::ErrorMask)
+    {
+        case PMX::ComError::OK:
+            return PmxLinkClass::OK;
+        case PMX::ComError::TimeOut:
+            return PmxLinkClass::TimeOut;
+        case PMX::ComError::CrcError:
+            return PmxLinkClass::Crc;
+        case PMX::ComError::MotorREADConvertError:
+            return PmxLinkClass::Convert;
+        default:
+            return PmxLinkClass::Format;
+    }
+}
+
+
+/**
+ * @brief コマンドの結果を記録します。
+ *
+ * @param [in] id コマンドを送ったサーボのID
+ * @param [in] flag コマンドの結果(送信結果(PMX::ComError参照) + PMXのstatus)
+ *
+ * @note 集計できるIDの数(MaxTrack)を超えた場合は記録しません。
+ */
+void PmxLinkStats::record(byte id, unsigned short flag)
+{
+    Track *track = this->find(id);
+
+    if(track == nullptr)
+    {
+        if(_trackCount >= MaxTrack)
+        {
+            return;
+        }
+        track = &_track[_trackCount++];
+        track->id = id;
+        this->reset(id);
+    }
+
+    byte linkClass = classify(flag);
+    bool failed = (linkClass != PmxLinkClass::OK);
+
+    track->count[linkClass]++;
+    track->history = (track->history << 1) | (failed ? 1 : 0);
+    if(track->historyCount < Window)
+    {
+        track->historyCount++;
+    }
+
+    if(failed)
+    {
+        track->consecutive++;
+        if(track->consecutive > track->maxConsecutive)
+        {
+            track->maxConsecutive = track->consecutive;
+        }
+    }
+    else
+    {
+        track->consecutive = 0;
+    }
+
+    track->lastFlag = flag;
+}
+
+/**
+ * @brief すべてのIDの集計を削除します。
+ */
+void PmxLinkStats::reset()
+{
+    _trackCount = 0;
+}
+
+/**
+ * @brief 指定したIDの集計を0にします。
+ *
+ * @param [in] id サーボのID
+ */
+void PmxLinkStats::reset(byte id)
+{
+    Track *track = this->find(id);
+
+    if(track == nullptr)
+    {
+        return;
+    }
+
+    for(int i = 0; i < PmxLinkClass::Count; i++)
+    {
+        track->count[i] = 0;
+    }
+    track->history = 0;
+    track->historyCount = 0;
+    track->consecutive = 0;
+    track->maxConsecutive = 0;
+    track->lastFlag = PMX::ComError::OK;
+}
+
+
+/**
+ * @brief 分類ごとの累計回数を返します。
+ *
+ * @param [in] id サーボのID
+ * @param [in] linkClass 分類(PmxLinkClass参照)
+ *
+ * @return unsigned long 累計回数(記録がない場合は0)
+ */
+unsigned long PmxLinkStats::getCount(byte id, byte linkClass)
+{
+    Track *track = this->find(id);
+
+    if(track == nullptr || linkClass >= PmxLinkClass::Count)
+    {
+        return 0;
+    }
+    return track->count[linkClass];
+}
+
+/**
+ * @brief 記録した結果の累計回数を返します。
+ *
+ * @param [in] id サーボのID
+ *
+ * @return unsigned long 累計回数(記録がない場合は0)
+ */
+unsigned long PmxLinkStats::getTotal(byte id)
+{
+    unsigned long total = 0;
+
+    for(int i = 0; i < PmxLinkClass::Count; i++)
+    {
+        total += this->getCount(id, i);
+    }
+    return total;
+}
+
+/**
+ * @brief 直近Window回のエラー率を返します。
+ *
+ * @param [in] id サーボのID
+ *
+ * @return float エラー率(0.0～1.0、記録がない場合は0.0)
+ */
+float PmxLinkStats::getErrorRate(byte id)
+{
+    Track *track = this->find(id);
+
+    if(track == nullptr || track->historyCount == 0)
+    {
+        return 0.0f;
+    }
+
+    int errors = 0;
+    for(int i = 0; i < track->historyCount; i++)
+    {
+        if((track->history >> i) & 0x01)
+        {
+            errors++;
+        }
+    }
+
+    return (float)errors / (float)track->historyCount;
+}
+
+/**
+ * @brief 現在連続で失敗している回数を返します。
+ *
+ * @param [in] id サーボのID
+ *
+ * @return unsigned int 連続失敗回数(記録がない場合は0)
+ */
+unsigned int PmxLinkStats::getConsecutiveFailures(byte id)
+{
+    Track *track = this->find(id);
+
+    return (track == nullptr) ? 0 : track->consecutive;
+}
+
+/**
+ * @brief 連続失敗回数の最大値を返します。
+ *
+ * @param [in] id サーボのID
+ *
+ * @return unsigned int 連続失敗回数の最大値(記録がない場合は0)
+ */
+unsigned int PmxLinkStats::getMaxConsecutiveFailures(byte id)
+{
+    Track *track = this->find(id);
+
+    return (track == nullptr) ? 0 : track->maxConsecutive;
+}
+
+/**
+ * @brief 最後に記録した結果を返します。
+ *
+ * @param [in] id サーボのID
+ *
+ * @return unsigned short 最後の結果(記録がない場合はPMX::ComError::OK)
+ */
+unsigned short PmxLinkStats::getLastFlag(byte id)
+{
+    Track *track = this->find(id);
+
+    return (track == nullptr) ? PMX::ComError::OK : track->lastFlag;
+}
+
+
+/**
+ * @brief 通信が途絶えていると判断できるか判定します。
+ *
+ * @param [in] id サーボのID
+ * @param [in] maxConsecutive この回数以上連続で失敗したら途絶と判断します
+ * @param [in] maxErrorRate 直近のエラー率がこの値を超えたら途絶と判断します(1.0で判定しない)
+ *
+ * @return true 通信が途絶えている(安全停止が必要)
+ * @return false 通信は継続している
+ *
+ * @note エラー率は直近の記録がWindowの1/4以上たまってから判定します。
+ */
+bool PmxLinkStats::isLinkDown(byte id, unsigned int maxConsecutive, float maxErrorRate)
+{
+    Track *track = this->find(id);
+
+    if(track == nullptr)
+    {
+        return false;
+    }
+
+    if(track->consecutive >= maxConsecutive)
+    {
+        return true;
+    }
+
+    if(track->historyCount >= Window / 4 && this->getErrorRate(id) > maxErrorRate)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief IDの集計を探します。
+ *
+ * @param [in] id サーボのID
+ *
+ * @return Track* 集計(ない場合はnullptr)
+ */
+PmxLinkStats::Track *PmxLinkStats::find(byte id)
+{
+    for(int i = 0; i < _trackCount; i++)
+    {
+        if(_track[i].id == id)
+        {
+            return &_track[i];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,88 @@
+
+/**
+* @file PmxLinkStats.h
+* @brief  PMX per-servo link statistics header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+* @details コマンドの結果(PMX::ComError + status)をサーボのIDごとに集計し、
+* @details 直近のエラー率や連続失敗回数から通信の健全性を判定するためのクラスです。
+**/
+
+#ifndef __Pmx_Link_Stats_h__
+#define __Pmx_Link_Stats_h__
+
+#include "PmxBaseClass.h"
+
+/// @brief PmxLinkStatsで集計する通信結果の分類
+namespace PmxLinkClass
+{
+    constexpr byte OK = 0;          //!< 正常
+    constexpr byte TimeOut = 1;     //!< 無応答/Timeout(PMX::ComError::TimeOut)
+    constexpr byte Crc = 2;         //!< CRCエラー(PMX::ComError::CrcError)
+    constexpr byte Format = 3;      //!< フォーマット/受信データ異常(FormatError, SendError, ReceiveError)
+    constexpr byte Convert = 4;     //!< 応答データの変換エラー(PMX::ComError::MotorREADConvertError)
+    constexpr byte Count = 5;       //!< 分類の数
+}
+
+/// @brief サーボのIDごとの通信統計
+/// @details
+/// * 分類(PmxLinkClass)ごとの累計回数
+/// * 直近Window回の結果から計算するエラー率
+/// * 連続で失敗した回数と、その最大値
+///
+/// @code
+/// PmxLinkStats stats;
+/// unsigned short flag = pmx.MotorWRITE(id, writeDatas, 1, receiveMode, receiveData, controlMode);
+/// stats.record(id, flag);
+/// if(stats.isLinkDown(id, 5, 0.5)) { /* 安全停止 */ }
+/// @endcode
+///
+/// @note サーボのステータス(下位8bit)は通信異常として扱いません。
+class PmxLinkStats
+{
+    public:
+        static constexpr int MaxTrack = 16;     //!< 集計できるIDの数
+        static constexpr int Window = 32;       //!< エラー率を計算する直近の回数
+
+    private:
+        /// @brief ID1つ分の集計
+        typedef struct
+        {
+            byte id;                                    //!< サーボのID
+            unsigned long count[PmxLinkClass::Count];   //!< 分類ごとの累計回数
+            unsigned long history;                      //!< 直近の結果(bit0が最新、1が失敗)
+            byte historyCount;                          //!< historyに入っている結果の数
+            unsigned int consecutive;                   //!< 連続で失敗している回数
+            unsigned int maxConsecutive;                //!< 連続失敗回数の最大値
+            unsigned short lastFlag;                    //!< 最後に記録した結果
+        } Track;
+
+        Track _track[MaxTrack];
+        int _trackCount = 0;
+
+    public:
+        PmxLinkStats();
+
+        static byte classify(unsigned short flag);
+
+        void record(byte id, unsigned short flag);
+        void reset();
+        void reset(byte id);
+
+        unsigned long getCount(byte id, byte linkClass);
+        unsigned long getTotal(byte id);
+        float getErrorRate(byte id);
+        unsigned int getConsecutiveFailures(byte id);
+        unsigned int getMaxConsecutiveFailures(byte id);
+        unsigned short getLastFlag(byte id);
+
+        bool isLinkDown(byte id, unsigned int maxConsecutive, float maxErrorRate=1.0f);
+
+    private:
+        Track *find(byte id);
+};
+
+#endif
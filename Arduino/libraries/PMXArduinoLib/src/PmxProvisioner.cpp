@@ -0,0 +1,563 @@
+
+/**
+* @file PmxProvisioner.cpp
+* @brief  PMX fleet provisioning source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+*/
+
+#include <string.h>
+#include "PmxProvisioner.h"
+
+
+/**
+ * @brief Construct a new Pmx Provisioner:: Pmx Provisioner object
+ */
+PmxProvisioner::PmxProvisioner()
+{
+}
+
+
+/**
+ * @brief サーボが接続されているバスを登録します。
+ *
+ * @param [in] pmx バスの通信に使用するPMXのインスタンス(PmxHardSerial、PmxSim等)
+ *
+ * @return int バスの番号(登録できない場合は-1)
+ */
+int PmxProvisioner::addBus(PmxBase *pmx)
+{
+    if(_busCount >= MaxBus || pmx == nullptr)
+    {
+        return -1;
+    }
+
+    _bus[_busCount] = pmx;
+
+    return _busCount++;
+}
+
+/**
+ * @brief 計画表に1行追加します。
+ *
+ * @param [in] serialNum 対象のサーボのシリアル番号
+ * @param [in] newId 新しいID(0～239、NoChangeで変更しない)
+ * @param [in] baudrate 新しい通信速度(PMX::EditBaudrate、NoChangeで変更しない)
+ * @param [in] parity 新しいパリティ(PMX::EditParity、NoChangeで変更しない)
+ *
+ * @return true 追加成功
+ * @return false 計画表がいっぱい、もしくは値が範囲外
+ */
+bool PmxProvisioner::addPlan(unsigned long serialNum, byte newId, byte baudrate, byte parity)
+{
+    if(_planCount >= MaxPlan
+        || (newId != NoChange && newId > MaxId)
+        || (baudrate != NoChange && baudrate > PMX::EditBaudrate::_3000000)
+        || (parity != NoChange && parity > PMX::EditParity::Even))
+    {
+        return false;
+    }
+
+    _plan[_planCount].serialNum = serialNum;
+    _plan[_planCount].newId = newId;
+    _plan[_planCount].baudrate = baudrate;
+    _plan[_planCount].parity = parity;
+    _planCount++;
+
+    return true;
+}
+
+/**
+ * @brief 計画表をすべて削除します。
+ */
+void PmxProvisioner::clearPlan()
+{
+    _planCount = 0;
+}
+
+
+/**
+ * @brief 全バスのIDを走査し、接続されているサーボのシリアル番号を集めます。
+ *
+ * @param [in] firstId 走査する最初のID
+ * @param [in] lastId 走査する最後のID
+ *
+ * @return int 見つかったサーボの数
+ *
+ * @note IDごとに全バスへ順番にgetSerialNumberを発行します。
+ * @note 応答がないIDはタイムアウトを待つので、走査前にタイムアウトを短くしておくと早く終わります。
+ */
+int PmxProvisioner::discover(byte firstId, byte lastId)
+{
+    _servoCount = 0;
+    _collisionCount = 0;
+    _firstId = firstId;
+    _lastId = (lastId > MaxId) ? MaxId : lastId;
+    memset(_answered, 0, sizeof(_answered));
+
+    for(int id = _firstId; id <= _lastId; id++)
+    {
+        for(int bus = 0; bus < _busCount; bus++)
+        {
+            unsigned long serialNum;
+            unsigned short flag = _bus[bus]->getSerialNumber((byte)id, &serialNum);
+
+            if((flag & PMX::ComError::ErrorMask) == PMX::ComError::CrcError)
+            {
+                //同じIDのサーボが複数つながっている(このIDは一時的なIDにも使わない)
+                _collisionCount++;
+                _answered[bus][id / 8] |= (byte)(1 << (id % 8));
+                continue;
+            }
+
+            if((flag & PMX::ComError::ErrorMask) != PMX::ComError::OK || _servoCount >= MaxServo)
+            {
+                continue;
+            }
+
+            _answered[bus][id / 8] |= (byte)(1 << (id % 8));
+
+            ServoRecord *servo = &_servo[_servoCount++];
+            servo->bus = (byte)bus;
+            servo->id = (byte)id;
+            servo->foundId = (byte)id;
+            servo->serialNum = serialNum;
+            servo->planIndex = this->findPlan(serialNum);
+            servo->state = (servo->planIndex < 0) ? PmxProvisionState::NotInPlan : PmxProvisionState::Found;
+            servo->flag = flag;
+        }
+    }
+
+    return _servoCount;
+}
+
+
+/**
+ * @brief 計画表に従って、シリアル番号指定のSystemWRITEでID・通信速度・パリティを書き換えます。
+ *
+ * @return int SystemWRITEに成功したサーボの数
+ *
+ * @note 書き換え後に同じバスでIDが重複する(計画表にないサーボ・衝突したIDを含む)サーボは書き換えずにErrorにします。
+ * @note 変更する項目がないサーボはUnchangedにします。
+ * @note 新しいIDを他のサーボが使っている間は後回しにし、書き込みの途中でも同じIDのサーボが2台にならない順番で書き込みます。
+ *       IDの入れ替えのように全員が待ちになった場合は、1台を空いているIDへ一時的に移してから続けます(空きがなければError)。
+ */
+int PmxProvisioner::apply()
+{
+    int written = 0;
+
+    //書き換え後のIDの重複と、変更の有無を確認する
+    for(int i = 0; i < _servoCount; i++)
+    {
+        ServoRecord *servo = &_servo[i];
+
+        if(servo->state != PmxProvisionState::Found)
+        {
+            continue;
+        }
+
+        const PlanEntry *plan = &_plan[servo->planIndex];
+        byte newId = this->targetId(servo);
+
+        bool conflict = false;
+        for(int j = 0; j < _servoCount; j++)
+        {
+            const ServoRecord *other = &_servo[j];
+            if(j != i && other->bus == servo->bus && this->targetId(other) == newId)
+            {
+                conflict = true;
+                break;
+            }
+        }
+
+        //discoverで衝突したID(見つけられなかったサーボがいる)
+        if(newId != servo->id && (_answered[servo->bus][newId / 8] & (1 << (newId % 8))) != 0 && this->findServo(servo->bus, newId, -1) < 0)
+        {
+            conflict = true;
+        }
+
+        if(conflict)
+        {
+            servo->state = PmxProvisionState::Error;
+            servo->flag = PMX::ComError::FormatError;
+            continue;
+        }
+
+        if(newId == servo->id && plan->baudrate == NoChange && plan->parity == NoChange)
+        {
+            servo->state = PmxProvisionState::Unchanged;
+        }
+    }
+
+    //新しいIDが空いているサーボから書き込む(全員が待ちになったら1台を一時的なIDへ移す)
+    while(true)
+    {
+        bool progress = false;
+        int waiting = -1;
+
+        for(int i = 0; i < _servoCount; i++)
+        {
+            ServoRecord *servo = &_servo[i];
+
+            if(servo->state != PmxProvisionState::Found)
+            {
+                continue;
+            }
+
+            const PlanEntry *plan = &_plan[servo->planIndex];
+            byte newId = this->targetId(servo);
+
+            int holder = (newId != servo->id) ? this->findServo(servo->bus, newId, i) : -1;
+            if(holder >= 0)
+            {
+                if(_servo[holder].state != PmxProvisionState::Found)
+                {
+                    //書き換えに失敗したサーボが新しいIDに残っている
+                    servo->state = PmxProvisionState::Error;
+                    servo->flag = PMX::ComError::FormatError;
+                    progress = true;
+                }
+                else if(waiting < 0)
+                {
+                    waiting = i;
+                }
+                continue;
+            }
+
+            byte option = 0x00;
+            if(newId != servo->id)
+            {
+                option |= 0x01;
+            }
+            if(plan->baudrate != NoChange)
+            {
+                option |= 0x02;
+            }
+            if(plan->parity != NoChange)
+            {
+                option |= 0x04;
+            }
+
+            if(this->writeServo(servo, newId, option))
+            {
+                servo->state = PmxProvisionState::Written;
+                written++;
+            }
+            else
+            {
+                servo->state = PmxProvisionState::Error;
+            }
+            progress = true;
+        }
+
+        if(waiting < 0)
+        {
+            break;
+        }
+
+        if(progress)
+        {
+            continue;
+        }
+
+        //IDの入れ替え : 1台を空いているIDへ移す
+        ServoRecord *servo = &_servo[waiting];
+        int tempId = this->findFreeId(servo->bus);
+
+        if(tempId < 0)
+        {
+            servo->state = PmxProvisionState::Error;
+            servo->flag = PMX::ComError::FormatError;
+            continue;
+        }
+
+        if(this->writeServo(servo, (byte)tempId, 0x01) == false)
+        {
+            servo->state = PmxProvisionState::Error;
+        }
+    }
+
+    return written;
+}
+
+
+/**
+ * @brief SystemWRITEしたサーボにReBootをまとめて送信します。
+ *
+ * @param [in] resetTime 再起動まで待つ時間(ms)
+ *
+ * @return int ReBootに成功したサーボの数
+ *
+ * @note 新しいIDで応答がない場合は元のIDで再送します。
+ * @note 起動待ちはverifyでまとめて行うので、この関数では待ちません。
+ */
+int PmxProvisioner::rebootAll(int resetTime)
+{
+    int rebooted = 0;
+
+    for(int i = 0; i < _servoCount; i++)
+    {
+        ServoRecord *servo = &_servo[i];
+
+        if(servo->state != PmxProvisionState::Written)
+        {
+            continue;
+        }
+
+        servo->flag = _bus[servo->bus]->ReBoot(servo->id, resetTime);
+
+        if((servo->flag & PMX::ComError::ErrorMask) == PMX::ComError::TimeOut && servo->id != servo->foundId)
+        {
+            servo->flag = _bus[servo->bus]->ReBoot(servo->foundId, resetTime);
+        }
+
+        if((servo->flag & PMX::ComError::ErrorMask) != PMX::ComError::OK)
+        {
+            servo->state = PmxProvisionState::Error;
+            continue;
+        }
+
+        servo->state = PmxProvisionState::Rebooted;
+        rebooted++;
+    }
+
+    return rebooted;
+}
+
+
+/**
+ * @brief 新しいIDでシリアル番号を読み出し、計画通りに書き換わったか確認します。
+ *
+ * @param [in] timeout 全サーボの確認を待つ最大時間[ms](ReBoot後の起動時間を含む)
+ *
+ * @return int 確認できたサーボの数
+ *
+ * @note 起動が終わっていないサーボは、時間内であれば次の周回で再確認します。
+ * @note 別のシリアル番号が返ってきた場合はErrorにします。
+ */
+int PmxProvisioner::verify(unsigned long timeout)
+{
+    unsigned long start = millis();
+    int pending;
+
+    do
+    {
+        pending = 0;
+
+        for(int i = 0; i < _servoCount; i++)
+        {
+            ServoRecord *servo = &_servo[i];
+
+            if(servo->state != PmxProvisionState::Rebooted && servo->state != PmxProvisionState::Unchanged)
+            {
+                continue;
+            }
+
+            unsigned long serialNum;
+            servo->flag = _bus[servo->bus]->getSerialNumber(servo->id, &serialNum);
+
+            if((servo->flag & PMX::ComError::ErrorMask) != PMX::ComError::OK)
+            {
+                pending++;
+                continue;
+            }
+
+            servo->state = (serialNum == servo->serialNum) ? PmxProvisionState::Verified : PmxProvisionState::Error;
+        }
+
+    } while(pending > 0 && (millis() - start) < timeout);
+
+    //時間内に確認できなかったサーボはエラーにする
+    for(int i = 0; i < _servoCount; i++)
+    {
+        if(_servo[i].state == PmxProvisionState::Rebooted || _servo[i].state == PmxProvisionState::Unchanged)
+        {
+            _servo[i].state = PmxProvisionState::Error;
+        }
+    }
+
+    return this->countState(PmxProvisionState::Verified);
+}
+
+
+/**
+ * @brief discover、apply、rebootAll、verifyを順番に実行します。
+ *
+ * @param [in] firstId 走査する最初のID
+ * @param [in] lastId 走査する最後のID
+ * @param [in] timeout verifyで待つ最大時間[ms]
+ *
+ * @return int 確認できたサーボの数
+ *
+ * @attention 通信速度やパリティを変更する計画の場合は、rebootAllとverifyの間でホストの通信設定を変更する必要があるため、個別に呼び出してください。
+ */
+int PmxProvisioner::run(byte firstId, byte lastId, unsigned long timeout)
+{
+    this->discover(firstId, lastId);
+    this->apply();
+    this->rebootAll();
+
+    return this->verify(timeout);
+}
+
+
+/**
+ * @brief 指定した状態のサーボの数を数えます。
+ *
+ * @param [in] state 数える状態(PmxProvisionState参照)
+ *
+ * @return int 指定した状態のサーボの数
+ */
+int PmxProvisioner::countState(byte state)
+{
+    int count = 0;
+
+    for(int i = 0; i < _servoCount; i++)
+    {
+        if(_servo[i].state == state)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief 計画表からシリアル番号の行を探します。
+ *
+ * @param [in] serialNum 探すシリアル番号
+ *
+ * @return int 計画表の行番号(ない場合は-1)
+ */
+int PmxProvisioner::findPlan(unsigned long serialNum)
+{
+    for(int i = 0; i < _planCount; i++)
+    {
+        if(_plan[i].serialNum == serialNum)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief 計画表に従った書き換え後のIDを返します。
+ *
+ * @param [in] servo 対象のサーボ
+ *
+ * @return byte 書き換え後のID(計画表にない、もしくはIDを変更しない場合はdiscoverで見つかった時のID)
+ */
+byte PmxProvisioner::targetId(const ServoRecord *servo)
+{
+    if(servo->planIndex < 0 || _plan[servo->planIndex].newId == NoChange)
+    {
+        return servo->foundId;
+    }
+
+    return _plan[servo->planIndex].newId;
+}
+
+/**
+ * @brief 同じバスで、今そのIDを使っているサーボを探します。
+ *
+ * @param [in] bus バスの番号
+ * @param [in] id 探すID
+ * @param [in] except 除くサーボの番号(-1で除かない)
+ *
+ * @return int サーボの番号(ない場合は-1)
+ */
+int PmxProvisioner::findServo(int bus, byte id, int except)
+{
+    for(int i = 0; i < _servoCount; i++)
+    {
+        if(i != except && _servo[i].bus == bus && _servo[i].id == id)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief IDを入れ替える時に一時的に使う、空いているIDを探します。
+ *
+ * @param [in] bus バスの番号
+ *
+ * @return int 空いているID(ない場合は-1)
+ *
+ * @note discoverで走査した範囲から、返信がなく(衝突したIDを除く)、どのサーボの今のID・書き換え後のIDでもないIDを大きい方から探します。
+ */
+int PmxProvisioner::findFreeId(int bus)
+{
+    for(int id = _lastId; id >= _firstId; id--)
+    {
+        if((_answered[bus][id / 8] & (1 << (id % 8))) != 0 || this->findServo(bus, (byte)id, -1) >= 0)
+        {
+            continue;
+        }
+
+        bool planned = false;
+        for(int i = 0; i < _servoCount; i++)
+        {
+            if(_servo[i].bus == bus && this->targetId(&_servo[i]) == id)
+            {
+                planned = true;
+                break;
+            }
+        }
+
+        if(planned == false)
+        {
+            return id;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief シリアル番号指定のSystemWRITEを送信し、書き換わったか確かめます。
+ *
+ * @param [in,out] servo 対象のサーボ(成功した場合はidを新しいIDにします)
+ * @param [in] newId 新しいID
+ * @param [in] option SystemWRITEのオプション(0x01:ID、0x02:通信速度、0x04:パリティ)
+ *
+ * @return true 書き換えた
+ * @return false 書き換えられなかった
+ *
+ * @note 返信が正常でなかった場合は、新しいIDでシリアル番号を読み直し、このサーボが返信した場合は書き換えたものとします。
+ */
+bool PmxProvisioner::writeServo(ServoRecord *servo, byte newId, byte option)
+{
+    const PlanEntry *plan = &_plan[servo->planIndex];
+
+    servo->flag = _bus[servo->bus]->SystemWRITE(servo->id, servo->serialNum, option, newId,
+                                (option & 0x02) ? plan->baudrate : 0,
+                                (option & 0x04) ? plan->parity : 0, 0);
+
+    if(servo->flag == PMX::ComError::OK)
+    {
+        servo->id = newId;
+        return true;
+    }
+
+    //返信が壊れていても書き換わっていることがあるので、新しいIDで読み直す
+    unsigned long serialNum;
+    unsigned short flag = _bus[servo->bus]->getSerialNumber(newId, &serialNum);
+    if((flag & PMX::ComError::ErrorMask) == PMX::ComError::OK && serialNum == servo->serialNum)
+    {
+        servo->id = newId;
+        servo->flag = flag;
+        return true;
+    }
+
+    //新しいIDにいなければ元のIDのまま(flagはSystemWRITEの結果を残す)
+    return false;
+}
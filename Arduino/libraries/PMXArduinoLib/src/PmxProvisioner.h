@@ -0,0 +1,125 @@
+
+/**
+* @file PmxProvisioner.h
+* @brief  PMX fleet provisioning header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+* @details 複数のバスに接続されたPMXサーボのシリアル番号を調べ、
+* @details 計画表に従ってID・通信速度・パリティをまとめて書き換えるためのクラスです。
+**/
+
+#ifndef __Pmx_Provisioner_h__
+#define __Pmx_Provisioner_h__
+
+#include "PmxBaseClass.h"
+
+/// @brief PmxProvisionerで管理するサーボの状態
+namespace PmxProvisionState
+{
+    constexpr byte Found = 0x00;        //!< discoverで見つかった
+    constexpr byte NotInPlan = 0x01;    //!< 計画表にないシリアル番号
+    constexpr byte Unchanged = 0x02;    //!< 計画表と同じ設定なので変更不要
+    constexpr byte Written = 0x03;      //!< SystemWRITE済み
+    constexpr byte Rebooted = 0x04;     //!< ReBoot済み
+    constexpr byte Verified = 0x05;     //!< 新しいIDで応答を確認した
+    constexpr byte Error = 0xFF;        //!< 通信エラーもしくは確認失敗
+}
+
+/// @brief 複数バスのPMXサーボにID・通信速度・パリティを一括で割り当てるクラス
+/// @details
+/// 1. discover : 各バスのIDを走査してシリアル番号(getSerialNumber)を集めます
+/// 2. apply : 計画表(シリアル番号→新しいID/通信速度/パリティ)に従ってシリアル番号指定のSystemWRITEを発行します
+/// 3. rebootAll : 書き換えたサーボにReBootをまとめて送信します(待ち時間は全サーボで1回)
+/// 4. verify : 新しいIDでシリアル番号を読み、計画通りか確認します
+///
+/// 各処理はバスを順番に切り替えながら1コマンドずつ発行します。コマンドは返信まで待つので、バスごとの通信は並行せず、全バスのコマンドを順番に送った時間がかかります。
+/// 並行して待つのはReBoot後の起動待ちだけで、rebootAllで全サーボに送ってからverifyで1回待つので、バスが増えてもこの待ち時間は増えません。
+///
+/// SystemWRITEのID変更はすぐに反映されるので、applyは書き換えの途中でも同じバスに同じIDのサーボが2台にならない順番で書き込みます。
+/// * 新しいIDを他のサーボが使っている間は後回しにし、空いたものから書き込みます
+/// * IDを入れ替える計画(0→1と1→0等)は、discoverで走査した範囲の空いているIDを一時的に使って入れ替えます
+/// * 返信が正常でなかったサーボは、新しいIDでシリアル番号を読み直し、書き換わっていればWrittenにします(書き換わっていなければError)
+///
+/// @attention 同じバスに同じIDのサーボが複数あると返信が衝突し、discoverで見つけられません(getCollisionCountで確認できます)。
+/// @attention 通信速度やパリティを変更した場合は、verifyの前にホスト側の通信設定(PmxHardSerial::begin等)を変更してください。
+class PmxProvisioner
+{
+    public:
+        static constexpr int MaxBus = 4;        //!< 登録できるバスの最大数
+        static constexpr int MaxServo = 32;     //!< 管理できるサーボの最大数
+        static constexpr int MaxPlan = 32;      //!< 計画表の最大数
+        static constexpr byte MaxId = 239;      //!< IDの最大値
+        static constexpr byte NoChange = PMX::ErrorByteData;    //!< 計画表で変更しない項目に指定する値
+
+        /// @brief 計画表の1行
+        typedef struct
+        {
+            unsigned long serialNum;    //!< 対象のシリアル番号
+            byte newId;                 //!< 新しいID(NoChangeで変更しない)
+            byte baudrate;              //!< 新しい通信速度(PMX::EditBaudrate、NoChangeで変更しない)
+            byte parity;                //!< 新しいパリティ(PMX::EditParity、NoChangeで変更しない)
+        } PlanEntry;
+
+        /// @brief 見つかったサーボの情報
+        typedef struct
+        {
+            byte bus;                   //!< 接続されているバスの番号
+            byte id;                    //!< 現在のID(apply後は新しいID)
+            byte foundId;               //!< discoverで見つかった時のID
+            unsigned long serialNum;    //!< シリアル番号
+            int planIndex;              //!< 計画表の行番号(ない場合は-1)
+            byte state;                 //!< 状態(PmxProvisionState参照)
+            unsigned short flag;        //!< 最後のコマンドの結果
+        } ServoRecord;
+
+    private:
+        PmxBase *_bus[MaxBus];
+        int _busCount = 0;
+
+        PlanEntry _plan[MaxPlan];
+        int _planCount = 0;
+
+        ServoRecord _servo[MaxServo];
+        int _servoCount = 0;
+
+        unsigned long _collisionCount = 0;
+
+        //discoverで走査した範囲と、返信があったID(衝突したIDを含む)
+        byte _firstId = 0;
+        byte _lastId = 0;
+        byte _answered[MaxBus][(MaxId + 8) / 8];
+
+    public:
+        PmxProvisioner();
+
+        int addBus(PmxBase *pmx);
+        bool addPlan(unsigned long serialNum, byte newId, byte baudrate=NoChange, byte parity=NoChange);
+        void clearPlan();
+
+        int discover(byte firstId=0, byte lastId=MaxId);
+        int apply();
+        int rebootAll(int resetTime=0);
+        int verify(unsigned long timeout=2000);
+        int run(byte firstId=0, byte lastId=MaxId, unsigned long timeout=2000);
+
+        /// @brief 管理しているサーボの数を返します
+        int getServoCount(){return _servoCount;}
+        /// @brief 管理しているサーボの情報を返します
+        const ServoRecord &getServo(int index){return _servo[index];}
+        /// @brief discoverで返信が衝突(CRCエラー)したIDの数を返します
+        unsigned long getCollisionCount(){return _collisionCount;}
+
+        int countState(byte state);
+
+    private:
+        int findPlan(unsigned long serialNum);
+        byte targetId(const ServoRecord *servo);
+        int findServo(int bus, byte id, int except);
+        int findFreeId(int bus);
+        bool writeServo(ServoRecord *servo, byte newId, byte option);
+};
+
+#endif
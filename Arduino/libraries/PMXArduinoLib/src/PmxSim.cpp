@@ -0,0 +1,586 @@
+
+/**
+* @file PmxSim.cpp
+* @brief  PMX virtual servo bus (simulator) source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+*/
+
+#include "PmxSim.h"
+#include "PmxCRC.h"
+#include "PmxConfigSnapshot.h"
+#include "DataConvert.h"
+
+
+/**
+ * @brief Construct a new Pmx Sim:: Pmx Sim object
+ *
+ * @note サーボは接続されていない状態で作成されます。addServoで追加してください。
+ */
+PmxSim::PmxSim()
+{
+}
+
+
+/**
+ * @brief 仮想サーボをバスに追加します。
+ *
+ * @param [in] serialNum シリアル番号
+ * @param [in] id ID番号(0～239)
+ * @param [in] baudrate 通信速度(PMX::EditBaudrate)
+ * @param [in] parity パリティ(PMX::EditParity)
+ *
+ * @return int 追加したサーボの番号(追加できない場合は-1)
+ */
+int PmxSim::addServo(unsigned long serialNum, byte id, byte baudrate, byte parity)
+{
+    if(_servoCount >= MaxServo || id > 239)
+    {
+        return -1;
+    }
+
+    VirtualServo *servo = &_servo[_servoCount];
+
+    servo->serialNum = serialNum;
+    servo->id = id;
+    servo->baudrate = baudrate;
+    servo->parity = parity;
+    servo->responseTime = 0;
+    servo->pendingBaudrate = baudrate;
+    servo->pendingParity = parity;
+    servo->rebootPending = false;
+    servo->rebootAt = 0;
+    servo->onlineAt = 0;
+    servo->saveCount = 0;
+
+    this->initRam(servo);
+
+    for(int i = 0; i < SaveAreaSize; i++)
+    {
+        servo->flash[i] = servo->ram[i];
+    }
+
+    return _servoCount++;
+}
+
+/**
+ * @brief 追加した仮想サーボをすべて取り外します。
+ */
+void PmxSim::clearServo()
+{
+    _servoCount = 0;
+}
+
+
+/**
+ * @brief ホスト(マイコン)側の通信速度とパリティを設定します。
+ *
+ * @param [in] baudrate 通信速度(PMX::EditBaudrate)
+ * @param [in] parity パリティ(PMX::EditParity)
+ *
+ * @note 通信速度とパリティが一致しないサーボは応答しません。
+ */
+void PmxSim::setHostSerial(byte baudrate, byte parity)
+{
+    _hostBaudrate = baudrate;
+    _hostParity = parity;
+}
+
+/**
+ * @brief 通信異常を発生させる設定をします。
+ *
+ * @param [in] faultType 通信異常の種類(PmxSimFault参照)
+ * @param [in] interval 何回の送受信ごとに発生させるか(0の場合は発生させない)
+ */
+void PmxSim::setFault(byte faultType, unsigned long interval)
+{
+    _faultType = faultType;
+    _faultInterval = interval;
+}
+
+
+/**
+ * @brief 仮想サーボの現在のIDを返します。
+ *
+ * @param [in] index addServoで返されたサーボの番号
+ *
+ * @return byte ID番号(番号が不正な場合はPMX::ErrorByteData)
+ */
+byte PmxSim::getServoId(int index)
+{
+    if(index < 0 || index >= _servoCount)
+    {
+        return PMX::ErrorByteData;
+    }
+    return _servo[index].id;
+}
+
+/**
+ * @brief 仮想サーボがSAVEされた回数を返します。
+ *
+ * @param [in] index addServoで返されたサーボの番号
+ *
+ * @return unsigned long SAVEされた回数(番号が不正な場合は0)
+ */
+unsigned long PmxSim::getSaveCount(int index)
+{
+    if(index < 0 || index >= _servoCount)
+    {
+        return 0;
+    }
+    return _servo[index].saveCount;
+}
+
+/**
+ * @brief 仮想サーボの現在の通信速度とパリティを返します。
+ *
+ * @param [in] index addServoで返されたサーボの番号
+ * @param [out] baudrate 通信速度(PMX::EditBaudrate)
+ * @param [out] parity パリティ(PMX::EditParity)
+ *
+ * @return true 取得成功
+ * @return false 番号が不正
+ */
+bool PmxSim::getServoSerial(int index, byte *baudrate, byte *parity)
+{
+    if(index < 0 || index >= _servoCount)
+    {
+        return false;
+    }
+    *baudrate = _servo[index].baudrate;
+    *parity = _servo[index].parity;
+    return true;
+}
+
+
+/**
+ * @brief 仮想バスで送受信します
+ *
+ * @param [in] txBuf 送信データ
+ * @param [in] txLen 送信データ数
+ * @param [out] rxBuf 受信データ
+ * @param [in] rxLen 受信データ数
+ * @return true 送受信成功
+ * @return false 送受信失敗
+ */
+bool PmxSim::synchronize(byte *txBuf, byte txLen, byte *rxBuf, byte rxLen)
+{
+    byte reply[256];
+    int replySize = this->transact(txBuf, txLen, reply);
+
+    for(int i = 0; i < rxLen; i++)
+    {
+        rxBuf[i] = (i < replySize) ? reply[i] : 0xFF;
+    }
+
+    return replySize >= rxLen;
+}
+
+/**
+ * @brief 仮想バスで送受信します。返信データ数がわからない場合に使用します。
+ *
+ * @param [in] txBuf 送信データ
+ * @param [in] txLen 送信データ数
+ * @param [out] rxBuf 受信データ
+ * @param [out] rxLen 受信データ数
+ * @return true 送受信成功
+ * @return false 送受信失敗
+ *
+ * @note PmxHardSerialと同様に、Lengthまでの6byteを受信できなかった場合はrxLenを0にします。
+ */
+bool PmxSim::synchronizeVariableRead(byte *txBuf, byte txLen, byte *rxBuf, byte *rxLen)
+{
+    byte reply[256];
+    int replySize = this->transact(txBuf, txLen, reply);
+    byte minRxSize = PMX::MinimumLength::Receive - 2;
+
+    if(replySize < minRxSize)
+    {
+        *rxLen = 0;
+        return false;
+    }
+
+    if(replySize < reply[PMX::BuffPter::Length])
+    {
+        memcpy(rxBuf, reply, minRxSize);
+        *rxLen = minRxSize;
+        return false;
+    }
+
+    *rxLen = reply[PMX::BuffPter::Length];
+    memcpy(rxBuf, reply, *rxLen);
+
+    return true;
+}
+
+
+/**
+ * @brief Pmxで送信したデータ配列を表示する関数
+ *
+ * @param [in] outputBytes 表示する送信データ
+ * @param [in] outputLength 表示する送信データ数
+ */
+void PmxSim::logOutputPrint(byte outputBytes[],int outputLength)
+{
+    if(this->getLogSerial())
+    {
+        this->getLogSerial()->print("(sim");
+        for(int i = 0; i < outputLength; i++)
+        {
+            this->getLogSerial()->print("[0x");
+            this->getLogSerial()->print(outputBytes[i],HEX);
+            this->getLogSerial()->print("]");
+        }
+        this->getLogSerial()->println(")");
+    }
+}
+
+
+/**
+ * @brief 送信データを各サーボに渡し、返信データを作成します。
+ *
+ * @param [in] txBuf 送信データ
+ * @param [in] txLen 送信データ数
+ * @param [out] rxBuf 返信データ(256byte)
+ *
+ * @return int 返信データ数(返信がない場合は0)
+ */
+int PmxSim::transact(byte *txBuf, byte txLen, byte *rxBuf)
+{
+    _transactionCount++;
+
+    //サーボは壊れたコマンドを無視する
+    if(txLen < PMX::MinimumLength::Send || txBuf[0] != 0xFE || txBuf[1] != 0xFE
+        || txBuf[PMX::BuffPter::Length] != txLen || PmxCrc16::checkCrc16(txBuf) == false)
+    {
+        return 0;
+    }
+
+    int replySize = 0;
+    int responders = 0;
+
+    for(int i = 0; i < _servoCount; i++)
+    {
+        VirtualServo *servo = &_servo[i];
+        this->update(servo);
+
+        if(servo->id != txBuf[PMX::BuffPter::ID] || this->isOnline(servo) == false)
+        {
+            continue;
+        }
+
+        int size = this->execute(servo, txBuf, rxBuf);
+        if(size > 0)
+        {
+            replySize = size;
+            responders++;
+        }
+    }
+
+    if(replySize == 0)
+    {
+        return 0;
+    }
+
+    //同じIDのサーボが複数返信すると信号が衝突する
+    if(responders > 1)
+    {
+        rxBuf[replySize - 1] ^= 0xFF;
+    }
+
+    if(_faultInterval > 0 && (_transactionCount % _faultInterval) == 0 && _faultType != PmxSimFault::None)
+    {
+        _faultCount++;
+
+        if(_faultType == PmxSimFault::NoReply)
+        {
+            return 0;
+        }
+        else if(_faultType == PmxSimFault::CrcError)
+        {
+            rxBuf[replySize - 2] ^= 0x5A;
+        }
+        else if(_faultType == PmxSimFault::Truncate)
+        {
+            replySize = replySize / 2;
+        }
+    }
+
+    return replySize;
+}
+
+
+/**
+ * @brief 1台のサーボでコマンドを実行し、返信データを作成します。
+ *
+ * @param [in,out] servo コマンドを実行するサーボ
+ * @param [in] txBuf 送信データ
+ * @param [out] rxBuf 返信データ
+ *
+ * @return int 返信データ数
+ */
+int PmxSim::execute(VirtualServo *servo, byte *txBuf, byte *rxBuf)
+{
+    byte cmd = txBuf[PMX::BuffPter::CMD];
+    byte option = txBuf[PMX::BuffPter::Option];
+    byte txLen = txBuf[PMX::BuffPter::Length];
+    byte status = 0x00;
+    int dataSize = 0;
+    byte *data = &rxBuf[PMX::BuffPter::Data];
+
+    unsigned short addr = (unsigned short)(txBuf[6] | (txBuf[7] << 8));
+    bool torqueOn = servo->ram[PMX::RamAddrList::TorqueSwitch] != PMX::TorqueSwitchType::Free;
+
+    switch(cmd)
+    {
+        case PMX::SendCmd::MemREAD:
+        {
+            int size = txBuf[8];
+            if(addr + size > RamSize)
+            {
+                status |= PMX::PmxStatusErrorList::RamAccessError;
+            }
+            for(int i = 0; i < size; i++)
+            {
+                data[i] = (addr + i < RamSize) ? servo->ram[addr + i] : 0x00;
+            }
+            dataSize = size;
+            break;
+        }
+
+        case PMX::SendCmd::MemWRITE:
+        {
+            int size = txLen - 10;
+            bool writable = (addr + size <= RamSize);
+            for(int i = 0; writable && i < size; i++)
+            {
+                if(addr + i < SaveAreaSize && PmxConfigSnapshot::isWritable(addr + i) == false)
+                {
+                    writable = false;
+                }
+            }
+
+            //トルクON中は強制書き込み以外で設定を変えられない
+            bool modeLocked = torqueOn && option == 0
+                && (addr < SaveAreaSize || (addr > PMX::RamAddrList::TorqueSwitch && addr <= PMX::RamAddrList::Trajectory));
+
+            if(writable == false)
+            {
+                status |= PMX::PmxStatusErrorList::RamAccessError;
+            }
+            else if(modeLocked)
+            {
+                status |= PMX::PmxStatusErrorList::ModeError;
+            }
+            else
+            {
+                for(int i = 0; i < size; i++)
+                {
+                    servo->ram[addr + i] = txBuf[8 + i];
+                }
+            }
+            break;
+        }
+
+        case PMX::SendCmd::LOAD:
+            for(int i = 0; i < SaveAreaSize; i++)
+            {
+                servo->ram[i] = servo->flash[i];
+            }
+            break;
+
+        case PMX::SendCmd::SAVE:
+            for(int i = 0; i < SaveAreaSize; i++)
+            {
+                servo->flash[i] = servo->ram[i];
+            }
+            servo->saveCount++;
+            break;
+
+        case PMX::SendCmd::MotorWRITE:
+        {
+            if(option != PMX::TorqueSwitchType::Control)
+            {
+                servo->ram[PMX::RamAddrList::TorqueSwitch] = option;
+            }
+
+            //指令値は目標指令値に入れ、位置制御の時は現在位置に反映する
+            int count = (txLen - PMX::MinimumLength::Send) / 2;
+            for(int i = 0; i < count && i < 3; i++)
+            {
+                servo->ram[PMX::RamAddrList::GoalCommandValue1 + i * 2] = txBuf[6 + i * 2];
+                servo->ram[PMX::RamAddrList::GoalCommandValue1 + i * 2 + 1] = txBuf[7 + i * 2];
+            }
+            if(count > 0 && servo->ram[PMX::RamAddrList::TorqueSwitch] == PMX::TorqueSwitchType::TorqueOn
+                && (servo->ram[PMX::RamAddrList::ControlMode] & PMX::ControlMode::Position) != 0)
+            {
+                servo->ram[PMX::RamAddrList::NowPosition] = txBuf[6];
+                servo->ram[PMX::RamAddrList::NowPosition + 1] = txBuf[7];
+            }
+        }
+        //ここから下はMotorREADと同じ返信
+        [[fallthrough]];
+        case PMX::SendCmd::MotorREAD:
+        {
+            byte receiveMode = servo->ram[PMX::RamAddrList::MotorReceiveData];
+            data[dataSize++] = servo->ram[PMX::RamAddrList::TorqueSwitch];
+            for(int i = 0; i < 8; i++)
+            {
+                if((receiveMode >> i) & 0x01)
+                {
+                    data[dataSize++] = servo->ram[PMX::RamAddrList::NowPosition + i * 2];
+                    data[dataSize++] = servo->ram[PMX::RamAddrList::NowPosition + i * 2 + 1];
+                }
+            }
+            break;
+        }
+
+        case PMX::SendCmd::SystemREAD:
+            DataConv::uint32ToBytes(servo->serialNum, &data[0]);
+            DataConv::uint32ToBytes(0x00010001, &data[4]);  //機種番号(仮想)
+            data[8] = 0x00;
+            data[9] = 0x00;
+            data[10] = 0x01;
+            data[11] = 0x01;
+            data[12] = servo->responseTime;
+            dataSize = 13;
+            break;
+
+        case PMX::SendCmd::SystemWRITE:
+        {
+            if(DataConv::bytesToUint32(&txBuf[6]) != servo->serialNum)
+            {
+                status |= PMX::PmxStatusErrorList::DataError;
+                break;
+            }
+            if((option & 0x01) && txBuf[10] <= 239)
+            {
+                servo->id = txBuf[10];
+            }
+            if((option & 0x02) && txBuf[11] <= PMX::EditBaudrate::_3000000)
+            {
+                servo->pendingBaudrate = txBuf[11];
+            }
+            if((option & 0x04) && txBuf[12] <= PMX::EditParity::Even)
+            {
+                servo->pendingParity = txBuf[12];
+            }
+            if(option & 0x08)
+            {
+                servo->responseTime = txBuf[13];
+            }
+            break;
+        }
+
+        case PMX::SendCmd::ReBoot:
+            servo->rebootPending = true;
+            servo->rebootAt = millis() + addr;
+            servo->onlineAt = servo->rebootAt + BootTime;
+            break;
+
+        case PMX::SendCmd::FactoryReset:
+            if(DataConv::bytesToUint32(&txBuf[6]) != servo->serialNum)
+            {
+                status |= PMX::PmxStatusErrorList::DataError;
+                break;
+            }
+            this->initRam(servo);
+            for(int i = 0; i < SaveAreaSize; i++)
+            {
+                servo->flash[i] = servo->ram[i];
+            }
+            servo->id = 0;
+            servo->pendingBaudrate = PMX::EditBaudrate::_115200;
+            servo->pendingParity = PMX::EditParity::ParityNone;
+            servo->rebootPending = true;
+            servo->rebootAt = millis();
+            servo->onlineAt = servo->rebootAt + BootTime;
+            break;
+
+        default:
+            status |= PMX::PmxStatusErrorList::CommandError;
+            break;
+    }
+
+    int replySize = PMX::MinimumLength::Receive + dataSize;
+
+    rxBuf[0] = 0xFE;
+    rxBuf[1] = 0xFE;
+    rxBuf[PMX::BuffPter::ID] = txBuf[PMX::BuffPter::ID];
+    rxBuf[PMX::BuffPter::Length] = (byte)replySize;
+    rxBuf[PMX::BuffPter::CMD] = cmd & 0x7f;
+    rxBuf[PMX::BuffPter::Status] = status;
+
+    PmxCrc16::setCrc16(rxBuf);
+
+    return replySize;
+}
+
+
+/**
+ * @brief ReBootの時刻になったサーボを再起動します。
+ *
+ * @param [in,out] servo 確認するサーボ
+ */
+void PmxSim::update(VirtualServo *servo)
+{
+    if(servo->rebootPending == false || (long)(millis() - servo->rebootAt) < 0)
+    {
+        return;
+    }
+
+    servo->rebootPending = false;
+    servo->baudrate = servo->pendingBaudrate;
+    servo->parity = servo->pendingParity;
+
+    //再起動時はフラッシュの内容を展開し、トルクはフリーにする
+    this->initRam(servo);
+    for(int i = 0; i < SaveAreaSize; i++)
+    {
+        servo->ram[i] = servo->flash[i];
+    }
+}
+
+/**
+ * @brief サーボのRAMを初期値にします。
+ *
+ * @param [out] servo 初期化するサーボ
+ */
+void PmxSim::initRam(VirtualServo *servo)
+{
+    for(int i = 0; i < RamSize; i++)
+    {
+        servo->ram[i] = 0x00;
+    }
+
+    DataConv::uint16ToBytes(3000, &servo->ram[PMX::RamAddrList::CurrentLimit]);
+    DataConv::uint16ToBytes(100, &servo->ram[PMX::RamAddrList::TotalPowerRate]);
+    DataConv::uint16ToBytes(30, &servo->ram[PMX::RamAddrList::MotorTemp]);
+    DataConv::uint16ToBytes(35, &servo->ram[PMX::RamAddrList::CPUTemp]);
+    DataConv::uint16ToBytes(12000, &servo->ram[PMX::RamAddrList::InputVoltage]);
+
+    servo->ram[PMX::RamAddrList::TorqueSwitch] = PMX::TorqueSwitchType::Free;
+    servo->ram[PMX::RamAddrList::ControlMode] = PMX::ControlMode::Position;
+    servo->ram[PMX::RamAddrList::MotorReceiveData] = PMX::ReceiveDataOption::NoReturn;
+}
+
+/**
+ * @brief サーボがホストのコマンドに応答できる状態か判定します。
+ *
+ * @param [in] servo 確認するサーボ
+ *
+ * @return true 応答できる
+ * @return false 再起動中、もしくは通信速度/パリティが一致しない
+ */
+bool PmxSim::isOnline(VirtualServo *servo)
+{
+    if((long)(millis() - servo->onlineAt) < 0)
+    {
+        return false;
+    }
+
+    return servo->baudrate == _hostBaudrate && servo->parity == _hostParity;
+}
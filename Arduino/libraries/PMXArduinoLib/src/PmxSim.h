@@ -0,0 +1,122 @@
+
+/**
+* @file PmxSim.h
+* @brief  PMX virtual servo bus (simulator) header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+* @details 実機のサーボを接続せずにPMXのコマンドを試すための仮想バスです。
+* @details PmxBaseを派生しているので、PmxHardSerialの代わりにそのまま使用できます。
+**/
+
+#ifndef __Pmx_Sim_h__
+#define __Pmx_Sim_h__
+
+#include "PmxBaseClass.h"
+
+/// @brief PmxSimで発生させる通信異常の種類
+namespace PmxSimFault
+{
+    constexpr byte None = 0x00;         //!< 異常なし
+    constexpr byte NoReply = 0x01;      //!< 返信しない(タイムアウト)
+    constexpr byte CrcError = 0x02;     //!< 返信のCRCを壊す
+    constexpr byte Truncate = 0x03;     //!< 返信を途中で切る
+}
+
+/// @brief PMXサーボを複数接続したRS-485バスを模擬するクラス
+/// @details
+/// * MemREAD/MemWRITE/LOAD/SAVE/MotorREAD/MotorWRITE/SystemREAD/SystemWRITE/ReBoot/FactoryResetに応答します
+/// * サーボごとにシリアル番号、ID、通信速度、パリティを持ち、ホスト側の設定と一致するサーボのみ応答します
+/// * SystemWRITEのIDは即時、通信速度とパリティはReBoot後に反映されます
+/// * 同じIDのサーボが複数応答した場合は返信が衝突し、CRCエラーになります
+/// * 指定した回数ごとに通信異常を発生させることができます
+///
+/// @code
+/// PmxSim sim;
+/// sim.addServo(0x12345678, 0);   // シリアル番号0x12345678、ID0のサーボを追加
+/// unsigned long serialNum;
+/// sim.getSerialNumber(0, &serialNum);
+/// @endcode
+class PmxSim : public PmxBase
+{
+    public:
+        static constexpr int MaxServo = 8;              //!< 1つのバスに追加できるサーボの最大数
+        static constexpr int RamSize = 720;             //!< 模擬するRAMのサイズ(0～719)
+        static constexpr int SaveAreaSize = 248;        //!< SAVE対象の領域(0～247)
+        static constexpr unsigned long BootTime = 300;  //!< ReBootしてから応答するまでの時間[ms]
+
+    private:
+        /// @brief 仮想サーボ1台分のデータ
+        typedef struct
+        {
+            unsigned long serialNum;    //!< シリアル番号
+            byte id;                    //!< ID
+            byte baudrate;              //!< 通信速度(PMX::EditBaudrate)
+            byte parity;                //!< パリティ(PMX::EditParity)
+            byte responseTime;          //!< 応答時間[us]
+            byte pendingBaudrate;       //!< ReBoot後に反映する通信速度
+            byte pendingParity;         //!< ReBoot後に反映するパリティ
+            bool rebootPending;         //!< ReBoot待ち
+            unsigned long rebootAt;     //!< 再起動する時刻[ms]
+            unsigned long onlineAt;     //!< 応答を再開する時刻[ms]
+            unsigned long saveCount;    //!< SAVEされた回数
+            byte ram[RamSize];          //!< RAM
+            byte flash[SaveAreaSize];   //!< フラッシュ(SAVE対象の領域)
+        } VirtualServo;
+
+        VirtualServo _servo[MaxServo];
+        int _servoCount = 0;
+
+        byte _hostBaudrate = PMX::EditBaudrate::_115200;
+        byte _hostParity = PMX::EditParity::ParityNone;
+
+        byte _faultType = PmxSimFault::None;
+        unsigned long _faultInterval = 0;
+        unsigned long _transactionCount = 0;
+        unsigned long _faultCount = 0;
+
+        HardwareSerial *_logOutputSerial = nullptr;
+
+    public:
+        PmxSim();
+
+        int addServo(unsigned long serialNum, byte id, byte baudrate=PMX::EditBaudrate::_115200, byte parity=PMX::EditParity::ParityNone);
+        void clearServo();
+        int getServoCount(){return _servoCount;}
+
+        void setHostSerial(byte baudrate, byte parity=PMX::EditParity::ParityNone);
+        void setFault(byte faultType, unsigned long interval);
+
+        /// @brief 送受信を行った回数を返します
+        unsigned long getTransactionCount(){return _transactionCount;}
+        /// @brief 発生させた通信異常の回数を返します
+        unsigned long getFaultCount(){return _faultCount;}
+
+        byte getServoId(int index);
+        unsigned long getSaveCount(int index);
+        bool getServoSerial(int index, byte *baudrate, byte *parity);
+
+    //データ送受信
+    public:
+        virtual bool synchronize(byte *txBuf, byte txLen, byte *rxBuf, byte rxLen);
+        virtual bool synchronizeVariableRead(byte *txBuf, byte txLen, byte *rxBuf, byte *rxLen);
+
+    //送受信ログの処理
+    public:
+        virtual void setLogSerial(HardwareSerial *logSerial){_logOutputSerial=logSerial;}
+
+    protected:
+        virtual void logOutputPrint(byte outputBytes[],int outputSize);
+        virtual HardwareSerial *getLogSerial(){return _logOutputSerial;}
+
+    private:
+        int transact(byte *txBuf, byte txLen, byte *rxBuf);
+        int execute(VirtualServo *servo, byte *txBuf, byte *rxBuf);
+        void update(VirtualServo *servo);
+        void initRam(VirtualServo *servo);
+        bool isOnline(VirtualServo *servo);
+};
+
+#endif
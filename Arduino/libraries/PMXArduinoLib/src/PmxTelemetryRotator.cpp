@@ -0,0 +1,216 @@
+
+/**
+* @file PmxTelemetryRotator.cpp
+* @brief  PMX telemetry rotator source file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+*/
+
+#include "PmxTelemetryRotator.h"
+
+
+/**
+ * @brief Construct a new Pmx Telemetry Rotator:: Pmx Telemetry Rotator object
+ *
+ * @param [in] pmx 通信に使用するPMXのインスタンス(PmxHardSerial等)
+ * @param [in] id PMXサーボモータのID番号
+ * @param [in] requiredMode 制御で毎サイクル必要な応答データ(ReceiveDataOptionの和)
+ * @param [in] controlMode 制御モード。応答データの位置を変換する際に使用します
+ */
+PmxTelemetryRotator::PmxTelemetryRotator(PmxBase *pmx, byte id, byte requiredMode, byte controlMode)
+{
+    _pmx = pmx;
+    _id = id;
+    _requiredMode = requiredMode;
+    _controlMode = controlMode;
+
+    for(int i = 0; i < DataCount; i++)
+    {
+        _latest[i] = PMX::ErrorUint32Data;
+        _latestCycle[i] = NeverUpdated;
+    }
+}
+
+
+/**
+ * @brief 応答データのスケジュールを追加します。
+ *
+ * @param [in] receiveBits 追加する応答データ(ReceiveDataOptionの和)
+ * @param [in] period 何サイクルに1回取得するか(1以上)
+ * @param [in] phase 取得するサイクルのずらし量(0～period-1)
+ *
+ * @return true 追加成功
+ * @return false 追加失敗(登録数オーバーや引数異常)
+ *
+ * @note 同じ周期の項目をphaseでずらすと、1サイクルの応答データ量を平均化できます。
+ * @note 同じphaseにまとめると、応答モードの切り替え回数(setMotorReceive)を減らせます。
+ * @note 周期の違う項目もphaseをそろえると(例: 50サイクルと10サイクルをどちらもphase0)、長い周期の項目は短い周期の項目と同じサイクルで取得できます。
+ */
+bool PmxTelemetryRotator::addSchedule(byte receiveBits, unsigned int period, unsigned int phase)
+{
+    if(_scheduleCount >= MaxSchedule || period == 0 || phase >= period || receiveBits == PMX::ReceiveDataOption::NoReturn)
+    {
+        return false;
+    }
+
+    _schedule[_scheduleCount].bits = receiveBits;
+    _schedule[_scheduleCount].period = period;
+    _schedule[_scheduleCount].phase = phase;
+    _scheduleCount++;
+
+    return true;
+}
+
+/**
+ * @brief 登録したスケジュールをすべて削除します。
+ */
+void PmxTelemetryRotator::clearSchedule()
+{
+    _scheduleCount = 0;
+}
+
+
+/**
+ * @brief 指定したサイクルでスケジュールが必要とする応答モードを計算します。
+ *
+ * @param [in] cycle サイクル番号
+ *
+ * @return byte requiredMode + スケジュールで該当する項目
+ */
+byte PmxTelemetryRotator::scheduledMode(unsigned long cycle)
+{
+    byte mode = _requiredMode;
+
+    for(int i = 0; i < _scheduleCount; i++)
+    {
+        if((cycle % _schedule[i].period) == _schedule[i].phase)
+        {
+            mode |= _schedule[i].bits;
+        }
+    }
+
+    return mode;
+}
+
+/**
+ * @brief 次のサイクルで使用する応答モードを計算します。
+ *
+ * @return byte 次のMotorWRITEで使用する応答モード(requiredMode + スケジュールで該当する項目)
+ *
+ * @note setHoldCyclesでholdCyclesを設定した場合、今の応答モードにある項目のうち、holdCyclesサイクル以内に再び必要になる項目は残します。
+ * @note 項目を戻して再び追加すると、setMotorReceive(1byteのMemWRITE)が2回増えます。
+ * @note 残した項目は応答データが毎サイクル1項目あたり2byte増えるので、holdCyclesは増える時間がMemWRITE2回より短くなる範囲で設定してください(PmxBusPlannerで見積もれます)。
+ */
+byte PmxTelemetryRotator::nextReceiveMode()
+{
+    byte mode = this->scheduledMode(_cycle);
+
+    if(_holdCycles > 0 && _activeMode != PMX::ErrorByteData)
+    {
+        byte upcoming = 0;
+        for(unsigned int i = 1; i <= _holdCycles; i++)
+        {
+            upcoming |= this->scheduledMode(_cycle + i);
+        }
+        mode |= upcoming & _activeMode;
+    }
+
+    return mode;
+}
+
+
+/**
+ * @brief 応答モードを切り替えながらMotorWRITEを発行し、受信したデータを最新値として保持します。
+ *
+ * @param [in] writeDatas モータへの指示値を格納
+ * @param [in] writeDataCount writeDatas 配列内の要素数
+ * @param [out] receiveData 今回のサイクルで受信したデータ[位置,速度,電流,トルク,PWM,モータ温度,CPU温度,電圧](合計8項目)
+ *
+ * @return unsigned short 通信の状態とステータス(送信結果(PMX::ComError参照) + PMXのstatus)
+ *
+ * @note 応答モードが前回と同じ場合はMotorWRITEのみを発行します。
+ * @note 応答モードの切り替えに失敗した場合は、前回の応答モードのままMotorWRITEを発行します。
+ * @attention receiveDataのうち今回取得していない項目はPMX::ErrorUint32Dataになります。最新値はgetLatestで取得してください。
+ */
+unsigned short PmxTelemetryRotator::MotorWRITE(long writeDatas[], int writeDataCount, long receiveData[8])
+{
+    byte mode = this->nextReceiveMode();
+
+    //応答モードが変わった時だけ書き換える(トルクON中なので強制書き込み)
+    if(mode != _activeMode)
+    {
+        unsigned short modeFlag = _pmx->setMotorReceive(_id, mode, 1);
+
+        if((modeFlag & PMX::ComError::ErrorMask) == PMX::ComError::OK)
+        {
+            _activeMode = mode;
+            _modeChangeCount++;
+        }
+        else if(_activeMode == PMX::ErrorByteData)
+        {
+            //サーボ側の応答モードがわからないので受信データを変換できない
+            _cycle++;
+            return modeFlag;
+        }
+    }
+
+    unsigned short flag = _pmx->MotorWRITE(_id, writeDatas, writeDataCount, _activeMode, receiveData, _controlMode);
+
+    if((flag & PMX::ComError::ErrorMask) == PMX::ComError::MotorREADConvertError)
+    {
+        //受信データ数が想定と違う＝サーボ側の応答モードが想定と違うので次回書き直す
+        _activeMode = PMX::ErrorByteData;
+    }
+    else if((flag & PMX::ComError::ErrorMask) == PMX::ComError::OK)
+    {
+        //受信した項目のみ最新値を更新する
+        for(int i = 0; i < DataCount; i++)
+        {
+            if((_activeMode >> i) & 0x01)
+            {
+                _latest[i] = receiveData[i];
+                _latestCycle[i] = _cycle;
+            }
+        }
+    }
+
+    _cycle++;
+
+    return flag;
+}
+
+
+/**
+ * @brief 項目ごとの最新値を取得します。
+ *
+ * @param [in] index 応答データの番号[位置,速度,電流,トルク,PWM,モータ温度,CPU温度,電圧](0～7)
+ *
+ * @return long 最新値(一度も取得していない場合はPMX::ErrorUint32Data)
+ */
+long PmxTelemetryRotator::getLatest(int index)
+{
+    if(index < 0 || index >= DataCount)
+    {
+        return PMX::ErrorUint32Data;
+    }
+    return _latest[index];
+}
+
+/**
+ * @brief 項目ごとの最新値が何サイクル前に取得されたかを返します。
+ *
+ * @param [in] index 応答データの番号[位置,速度,電流,トルク,PWM,モータ温度,CPU温度,電圧](0～7)
+ *
+ * @return unsigned long 取得してからのサイクル数(一度も取得していない場合はNeverUpdated)
+ */
+unsigned long PmxTelemetryRotator::getAge(int index)
+{
+    if(index < 0 || index >= DataCount || _latestCycle[index] == NeverUpdated)
+    {
+        return NeverUpdated;
+    }
+    return _cycle - 1 - _latestCycle[index];
+}
@@ -0,0 +1,97 @@
+
+/**
+* @file PmxTelemetryRotator.h
+* @brief  PMX telemetry rotator header file
+* @author SagaraLab
+* @date 2026/10/18
+* @version 1.0.4
+* @copyright SagaraLab 2026
+*
+* @details MotorWRITEの応答モードをサイクルごとに切り替え、温度・電圧などのデータを
+* @details 追加のMemREADなしで取得するためのクラスです。
+**/
+
+#ifndef __Pmx_Telemetry_Rotator_h__
+#define __Pmx_Telemetry_Rotator_h__
+
+#include "PmxBaseClass.h"
+
+/// @brief MotorWRITEの応答モード(ReceiveDataOption)をスケジュールに従って切り替えるクラス
+/// @details
+/// * 制御に必要な応答データ(requiredMode)は毎サイクル必ず含めます
+/// * それ以外の応答データはスケジュール(period, phase)に従って必要なサイクルだけ追加します
+/// * 応答モードが前回から変わった時のみsetMotorReceiveを発行します
+/// * setHoldCyclesを設定すると、数サイクル以内に再び必要になる項目は応答モードに残し、戻してまた切り替えるsetMotorReceiveを省きます
+/// * 受信したデータは項目ごとに最新値と取得したサイクル番号を保持します
+///
+/// @code
+/// PmxTelemetryRotator rotator(&pmx, 0, PMX::ReceiveDataOption::Position, PMX::ControlMode::Torque);
+/// rotator.addSchedule(PMX::ReceiveDataOption::MotorTemp, 50);      // 50サイクルに1回モータ温度
+/// rotator.addSchedule(PMX::ReceiveDataOption::Voltage, 50, 25);    // 50サイクルに1回電圧(25サイクルずらす)
+/// rotator.addSchedule(PMX::ReceiveDataOption::Current, 10);        // 10サイクルに1回電流
+/// rotator.setHoldCycles(9);                                        // 9サイクル以内に使う電流は応答モードに残す
+/// rotator.MotorWRITE(writeDatas, 1, receiveData);
+/// @endcode
+class PmxTelemetryRotator
+{
+    public:
+        static constexpr int MaxSchedule = 8;           //!< 登録できるスケジュールの最大数
+        static constexpr int DataCount = 8;             //!< 応答データの項目数[位置,速度,電流,トルク,PWM,モータ温度,CPU温度,電圧]
+        static constexpr unsigned long NeverUpdated = 0xFFFFFFFF;   //!< 一度も取得していない項目のサイクル番号
+
+    private:
+        /// @brief 応答データのスケジュール
+        typedef struct
+        {
+            byte bits;              //!< 追加する応答データ(ReceiveDataOption)
+            unsigned int period;    //!< 何サイクルに1回追加するか
+            unsigned int phase;     //!< 追加するサイクルのずらし量
+        } Schedule;
+
+        PmxBase *_pmx;
+        byte _id;
+        byte _requiredMode;
+        byte _controlMode;
+        byte _activeMode = PMX::ErrorByteData;  //サーボに設定されている応答モード(不明な時はErrorByteData)
+
+        Schedule _schedule[MaxSchedule];
+        int _scheduleCount = 0;
+
+        unsigned int _holdCycles = 0;
+
+        unsigned long _cycle = 0;
+        unsigned long _modeChangeCount = 0;
+
+        long _latest[DataCount];
+        unsigned long _latestCycle[DataCount];
+
+    public:
+        PmxTelemetryRotator(PmxBase *pmx, byte id, byte requiredMode, byte controlMode=0x01);
+
+        bool addSchedule(byte receiveBits, unsigned int period, unsigned int phase=0);
+        void clearSchedule();
+        /// @brief 応答モードに残す先読みのサイクル数を設定します(0で残さない、詳細はnextReceiveMode)
+        void setHoldCycles(unsigned int cycles){_holdCycles = cycles;}
+        /// @brief 応答モードに残す先読みのサイクル数を返します
+        unsigned int getHoldCycles(){return _holdCycles;}
+
+        byte nextReceiveMode();
+        unsigned short MotorWRITE(long writeDatas[], int writeDataCount, long receiveData[8]);
+
+        long getLatest(int index);
+        unsigned long getAge(int index);
+
+        /// @brief サーボに設定されていると思われる応答モードを返します(不明な時はPMX::ErrorByteData)
+        byte getActiveMode(){return _activeMode;}
+        /// @brief 応答モードの切り替え(setMotorReceive)を行った回数を返します
+        unsigned long getModeChangeCount(){return _modeChangeCount;}
+        /// @brief MotorWRITEを行ったサイクル数を返します
+        unsigned long getCycle(){return _cycle;}
+        /// @brief サーボ側の応答モードを不明にし、次のサイクルで必ずsetMotorReceiveを発行させます
+        void invalidateActiveMode(){_activeMode = PMX::ErrorByteData;}
+
+    private:
+        byte scheduledMode(unsigned long cycle);
+};
+
+#endif
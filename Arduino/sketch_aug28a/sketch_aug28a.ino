@@ -7,13 +7,17 @@
  * 3. リアルタイムでIMUデータを受信
  * 4. シリアルモニタにデータを表示
  * 5. MIPプロトコルの基本的な解析
+ * 6. キャプチャモード（CAPTURE_MODE）：受信したbyte列を受信時刻付きのレコードでPCへ送る
+ *    PC側は stty -F /dev/ttyACM0 raw; cat /dev/ttyACM0 > session.mcap で記録し、
+ *    MipParser/extras/host/mip_replay で元の速度・N倍速・最高速度で再生する
  * 
- * 必要なライブラリ: USBHost_t36
+ * 必要なライブラリ: USBHost_t36, MipParser
  * 作成者: Arduino IDE + Claude
  * 対象ハードウェア: Teensy 4.1 + 3DM-CV7-AHRS
  */
 
 #include "USBHost_t36.h"
+#include <MipParser.h>
 
 // =============================================================================
 // USBホスト関連オブジェクト
@@ -25,9 +29,12 @@ USBSerial_BigBuffer userial(myusb);         // USB Serial device（3DM-CV7-AHRS
 // =============================================================================
 // グローバル変数定義
 // =============================================================================
+const bool CAPTURE_MODE = false;            // true: 受信データをキャプチャ形式で送る（状態表示の文字列は送らない）
 bool deviceConnected = false;               // デバイス接続状態フラグ
-uint8_t buffer[1024];                       // データ受信バッファ（1KB）
-int bufferIndex = 0;                        // バッファの現在位置
+MipCaptureWriter capture;                   // 受信データを受信時刻付きのレコードにして送る
+MipRing<1024> mipRing;                      // データ受信リングバッファ（1KB、詰め直しなし）
+MipIngest mipIngest;                        // USB Serialからリングバッファへまとめて移す
+MipFramer framer;                           // MIPパケットの切り出し（1byteずつ状態遷移で処理）
 unsigned long lastDataTime = 0;             // 最後にデータを受信した時刻
 unsigned long lastStatusTime = 0;           // 最後に状態表示した時刻
 
@@ -49,11 +56,19 @@ void setup() {
   // USBホストコントローラ初期化
   myusb.begin();
   
+  // 完成したMIPパケット（チェックサム確認済み）の受け取り先
+  framer.setHandler(parseDataPacket);
+  
   Serial.println("Waiting for AHRS USB device...");
   Serial.println("Connect 3DM-CV7-AHRS to Teensy USB Host port");
   Serial.println();
   
   delay(1000);  // 初期化完了待機
+
+  // キャプチャの開始（この前の起動メッセージはmip_replayが読み飛ばす）
+  if (CAPTURE_MODE) {
+    capture.begin(Serial, micros());
+  }
 }
 
 // =============================================================================
@@ -66,7 +81,7 @@ void loop() {
   // USB Serial device接続状態チェック
   if (userial && !deviceConnected) {
     // 新規接続検出
-    Serial.println("3DM-CV7-AHRS USB device connected!");
+    logText("3DM-CV7-AHRS USB device connected!");
     
     // デバイス情報を表示
     displayDeviceInfo();
@@ -79,9 +94,10 @@ void loop() {
     
   } else if (!userial && deviceConnected) {
     // 切断検出
-    Serial.println("3DM-CV7-AHRS USB device disconnected!");
+    logText("3DM-CV7-AHRS USB device disconnected!");
     deviceConnected = false;
-    bufferIndex = 0;  // バッファリセット
+    mipRing.flush();  // バッファリセット
+    framer.reset();   // 組み立て中のパケットを破棄
   }
   
   // データ受信処理（デバイス接続時のみ）
@@ -89,8 +105,8 @@ void loop() {
     readAHRSData();
   }
   
-  // 定期的な状態表示（5秒間隔）
-  if (millis() - lastStatusTime > 5000) {
+  // 定期的な状態表示（5秒間隔、キャプチャ中は文字列を混ぜない）
+  if (!CAPTURE_MODE && millis() - lastStatusTime > 5000) {
     displaySystemStatus();
     
     // デバッグ情報追加
@@ -110,6 +126,9 @@ void loop() {
 // デバイス情報表示関数
 // =============================================================================
 void displayDeviceInfo() {
+  if (CAPTURE_MODE) {
+    return;
+  }
   Serial.println("--- Device Information ---");
   
   // メーカー名表示
@@ -143,132 +162,98 @@ void displayDeviceInfo() {
 // AHRSデータストリーミング開始関数
 // =============================================================================
 void startAHRSStreaming() {
-  Serial.println("Starting AHRS data streaming...");
+  logText("Starting AHRS data streaming...");
   
   /*
    * MIP（Microstrain Interface Protocol）コマンド構造
    * 
    * バイト構成:
    * [0-1]: 同期バイト (0x75, 0x65)
-   * [2]:   記述子セット (0x0C = IMU Data)
+   * [2]:   記述子セット (0x0C = 3DM Command)
    * [3]:   ペイロード長
-   * [4]:   コマンドID (0x08 = Message Format)
-   * [5]:   機能選択 (0x01 = 新設定適用)
-   * [6]:   フィールド数
-   * [7-8]: データフィールド1 (0x04 = Scaled Accel, 0x0A = 10Hz)
-   * [9-10]: データフィールド2 (0x05 = Scaled Gyro, 0x0A = 10Hz)
-   * [11-12]: データフィールド3 (0x06 = Scaled Mag, 0x0A = 10Hz)
-   * 最後: チェックサム
+   * [4]:   フィールド長
+   * [5]:   コマンドID (0x0F = Message Format)
+   * [6]:   機能選択 (0x01 = 新設定適用)
+   * [7]:   データの記述子セット (0x80 = IMU Data)
+   * [8]:   フィールド数
+   * [9-11]:  データフィールド1 (0x04 = Scaled Accel, 分周比10)
+   * [12-14]: データフィールド2 (0x05 = Scaled Gyro, 分周比10)
+   * [15-17]: データフィールド3 (0x06 = Scaled Mag, 分周比10)
+   * 最後: Fletcherチェックサム（MipCommandが計算）
    */
-  uint8_t cmd[] = {
-    0x75, 0x65,  // MIP同期バイト
-    0x0C,        // 記述子セット（IMU）
-    0x08,        // ペイロード長
-    0x08,        // メッセージフォーマットコマンド
-    0x01,        // 機能選択（新設定適用）
-    0x03,        // フィールド記述子数
-    0x04, 0x0A,  // スケール済み加速度計, 10Hz
-    0x05, 0x0A,  // スケール済みジャイロ, 10Hz  
-    0x06, 0x0A   // スケール済み磁力計, 10Hz
-  };
+  MipCommand cmd(MIP::DescSet::ThreeDm);
+  cmd.beginField(MIP::ThreeDmCmd::MessageFormat);
+  cmd.addU8(MIP::Function::Apply);     // 機能選択（新設定適用）
+  cmd.addU8(MIP::DescSet::Imu);        // IMUデータセット
+  cmd.addU8(3);                        // フィールド記述子数
+  cmd.addU8(MIP::ImuField::Accel);     // スケール済み加速度計
+  cmd.addU16(10);                      //   10Hz
+  cmd.addU8(MIP::ImuField::Gyro);      // スケール済みジャイロ
+  cmd.addU16(10);                      //   10Hz
+  cmd.addU8(MIP::ImuField::Mag);       // スケール済み磁力計
+  cmd.addU16(10);                      //   10Hz
+  cmd.endField();
+  cmd.finish();
   
-  // MIPプロトコルのチェックサム計算
-  uint16_t checksum = 0;
-  for (size_t i = 0; i < sizeof(cmd); i++) {
-    checksum += cmd[i];
-  }
-  
-  // コマンドとチェックサムをデバイスに送信
-  userial.write(cmd, sizeof(cmd));           // メインコマンド送信
-  userial.write(checksum & 0xFF);            // チェックサム下位バイト
-  userial.write((checksum >> 8) & 0xFF);     // チェックサム上位バイト
+  // コマンド（チェックサム込み）をデバイスに送信
+  userial.write(cmd.getData(), cmd.getLength());
   
-  Serial.println("MIP streaming command sent to AHRS device.");
-  Serial.println("Expecting IMU data at 10Hz...");
+  logText("MIP streaming command sent to AHRS device.");
+  logText("Expecting IMU data at 10Hz...");
 }
 
 // =============================================================================
 // AHRSデータ読み取り関数
 // =============================================================================
 void readAHRSData() {
-  // 受信可能なデータがある限りループ
-  while (userial.available()) {
-    uint8_t byte = userial.read();  // 1バイト読み取り
-    
-    // 生データをPC（シリアルモニタ）に転送
-    Serial.write(byte);
-    
-    // 内部バッファにも格納（パケット解析用）
-    buffer[bufferIndex++] = byte;
-    
-    // バッファオーバーフロー防止
-    if (bufferIndex >= (int)sizeof(buffer)) {
-      bufferIndex = 0;
-      Serial.println("\\n[WARNING] Buffer overflow! Resetting buffer.");
-    }
-    
+  // 受信可能なデータをまとめてリングバッファへ移す
+  // （空きがない分はUSB側に残るので、バッファのリセットは不要）
+  if (mipIngest.read(userial, mipRing, micros()) > 0) {
     // データ受信時刻を更新
     lastDataTime = millis();
   }
   
-  // 十分なデータが溜まったらMIPパケット解析実行
-  if (bufferIndex > 4) {
-    parseMIPPackets();
+  // キャプチャモードでは、生データを受信時刻付きのレコードでPCへ送る
+  // （送信が間に合わない分は待たずに捨て、Gapレコードで捨てたbyte数を知らせる）
+  if (CAPTURE_MODE) {
+    capture.writeRing(Serial, mipRing, mipIngest.getLastStamp());
   }
-}
-
-// =============================================================================
-// MIPパケット解析関数
-// =============================================================================
-void parseMIPPackets() {
-  /*
-   * MIPパケットの同期バイト（0x75, 0x65）を検索し、
-   * 完全なパケットが受信されていれば解析する
-   */
   
-  for (int i = 0; i < bufferIndex - 3; i++) {
-    // 同期バイト検出チェック
-    if (buffer[i] == 0x75 && buffer[i+1] == 0x65) {
-      uint8_t length = buffer[i+3];  // ペイロード長取得
-      
-      // 完全なパケットが受信済みかチェック
-      // パケット構造: [同期2][記述子1][長さ1][ペイロードN][チェックサム2]
-      if (i + 4 + length + 2 <= bufferIndex) {
-        // 完全なパケットを発見 -> 解析実行
-        parseDataPacket(&buffer[i], length + 4 + 2);
-        
-        // 処理済みデータをバッファから削除
-        int remainingBytes = bufferIndex - (i + 4 + length + 2);
-        memmove(buffer, &buffer[i + 4 + length + 2], remainingBytes);
-        bufferIndex = remainingBytes;
-        break;  // 1回のループで1パケットのみ処理
-      }
-    }
-  }
+  // MIPパケット解析実行（完成したパケットはparseDataPacketに渡される）
+  framer.drain(mipRing);
 }
 
 // =============================================================================
 // データパケット解析関数
 // =============================================================================
-void parseDataPacket(uint8_t* packet, int packetLength) {
-  uint8_t descriptor = packet[2];  // 記述子セット取得
-  uint8_t length = packet[3];      // ペイロード長取得
+void parseDataPacket(const uint8_t* packet, int packetLength, void* context) {
+  (void)packetLength;
+  (void)context;
+
+  // キャプチャ中は解析結果の文字列を送らない（パケットの集計のみ）
+  if (CAPTURE_MODE) {
+    return;
+  }
+  
+  uint8_t descriptor = packet[MIP::BuffPter::Descriptor];  // 記述子セット取得
+  uint8_t length = packet[MIP::BuffPter::Length];          // ペイロード長取得
+  const uint8_t* payload = &packet[MIP::BuffPter::Payload];
   
   // データタイプに応じた処理分岐
   switch (descriptor) {
-    case 0x80: // IMUデータセット
+    case MIP::DescSet::Imu: // IMUデータセット
       Serial.print("\\n[IMU] ");
-      parseIMUData(&packet[4], length);
+      parseIMUData(payload, length);
       break;
       
     case 0x81: // GNSSデータセット
       Serial.print("\\n[GNSS] ");
-      parseGNSSData(&packet[4], length);
+      parseGNSSData(payload, length);
       break;
       
-    case 0x82: // 推定フィルタデータセット
+    case MIP::DescSet::Filter: // 推定フィルタデータセット
       Serial.print("\\n[EST] ");
-      parseEstimationData(&packet[4], length);
+      parseEstimationData(payload, length);
       break;
       
     default:
@@ -283,7 +268,7 @@ void parseDataPacket(uint8_t* packet, int packetLength) {
 // =============================================================================
 // IMUデータ解析関数
 // =============================================================================
-void parseIMUData(uint8_t* data, int length) {
+void parseIMUData(const uint8_t* data, int length) {
   // 簡易的なIMUデータ情報表示
   Serial.print("IMU Data Length: ");
   Serial.print(length);
@@ -297,7 +282,7 @@ void parseIMUData(uint8_t* data, int length) {
 // =============================================================================
 // GNSSデータ解析関数
 // =============================================================================
-void parseGNSSData(uint8_t* data, int length) {
+void parseGNSSData(const uint8_t* data, int length) {
   Serial.print("GNSS Data Length: ");
   Serial.print(length);  
   Serial.print(" bytes - GPS/Position data");
@@ -306,7 +291,7 @@ void parseGNSSData(uint8_t* data, int length) {
 // =============================================================================
 // 推定データ解析関数
 // =============================================================================
-void parseEstimationData(uint8_t* data, int length) {
+void parseEstimationData(const uint8_t* data, int length) {
   Serial.print("Estimation Data Length: ");
   Serial.print(length);
   Serial.print(" bytes - Attitude/Navigation data");
@@ -335,9 +320,18 @@ void displaySystemStatus() {
   
   // 内部バッファ使用状況
   Serial.print("Internal buffer usage: ");
-  Serial.print(bufferIndex);
+  Serial.print(mipRing.available());
   Serial.print("/");
-  Serial.println(sizeof(buffer));
+  Serial.print(mipRing.capacity());
+  Serial.print(" (overflow: ");
+  Serial.print(mipRing.getOverflowBytes());
+  Serial.println(" bytes)");
+  
+  // パケット受信状況
+  Serial.print("MIP packets: ");
+  Serial.print(framer.getPacketCount());
+  Serial.print(", checksum errors: ");
+  Serial.println(framer.getChecksumErrorCount());
   
   // 最後のデータ受信時刻
   Serial.print("Last data received: ");
@@ -357,9 +351,21 @@ void displaySystemStatus() {
 void checkDataTimeout() {
   // 10秒間データが受信されない場合の警告表示
   if (lastDataTime > 0 && (millis() - lastDataTime) > 10000) {
-    Serial.println("[WARNING] Data timeout detected!");
-    Serial.println("No data received for 10 seconds.");
-    Serial.println("Check AHRS device connection and power.");
+    logText("[WARNING] Data timeout detected!");
+    logText("No data received for 10 seconds.");
+    logText("Check AHRS device connection and power.");
     lastDataTime = 0; // 重複警告を避けるためリセット
   }
-}
\ No newline at end of file
+}
+
+// =============================================================================
+// メッセージ出力関数
+// =============================================================================
+// キャプチャ中はTextレコードで送る（mip_replay --textで表示できる）
+void logText(const char* text) {
+  if (CAPTURE_MODE) {
+    capture.text(Serial, text, micros());
+  } else {
+    Serial.println(text);
+  }
+}
@@ -3,6 +3,10 @@
 
 #include "USBHost_t36.h"
 #include <PmxHardSerialClass.h>
+#include <PmxTelemetryRotator.h>
+#include <PmxLinkStats.h>
+#include <PmxBusPlanner.h>
+#include <MipParser.h>
 #include <DataConvert.h>
 #include <math.h>
 // SDカードはRaspberry Pi側で管理するため不要
@@ -11,7 +15,8 @@
 USBHost myusb;
 USBHub hub1(myusb);
 USBHub hub2(myusb);
-USBSerial userial(myusb, 1);        // 3DM-CV7-AHRSセンサー用
+USBSerial_BigBuffer userial(myusb, 1);   // 3DM-CV7-AHRSセンサー用（1kHz出力でもモータ通信中に溢れないよう大きいバッファ）
+USBSerial_BigBuffer userial2(myusb, 1);  // 2台目（脚）用。どちらのポートに接続してもシリアル番号でセンサーを区別する
 // Raspberry PiはUSBシリアル（Serial）で通信
 
 // ========== モータ制御設定 ==========
@@ -20,14 +25,55 @@ const long MOTOR_BAUDRATE = 115200;
 const int MOTOR_TIMEOUT = 200;     // 200msに短縮（エラー検出高速化）
 PmxHardSerial pmx(&Serial1, EN_PIN, MOTOR_BAUDRATE, MOTOR_TIMEOUT);
 const byte SERVO_ID = 0;           // サーボのID
+// 位置は毎サイクル、温度・電圧・電流はMotorWRITEの応答に順番に載せて取得する
+PmxTelemetryRotator telemetry(&pmx, SERVO_ID, PMX::ReceiveDataOption::Position, PMX::ControlMode::Torque);
+// 通信の再送と安全停止の設定
+const byte MOTOR_RETRIES = 1;                     // 1コマンドあたりの再送回数（制御周期内に収まる時のみ）
+const unsigned long MOTOR_COM_BUDGET_US = 4000;   // 1制御周期でモータ通信に使える時間[us]
+const unsigned int MOTOR_LINK_MAX_FAIL = 3;       // 連続失敗この回数でトルクOFF
+const float MOTOR_LINK_MAX_ERROR_RATE = 0.5;      // 直近のエラー率がこれを超えたらトルクOFF
+PmxLinkStats linkStats;                           // ID別の通信統計
+bool motor_safe_off = false;                      // 通信異常でトルクOFFした状態
+PmxBusPlanner busPlanner(MOTOR_BAUDRATE);         // バスの通信時間の見積もりと使用率の計測
+unsigned long last_busy_us = 0;                   // 前の周期までのバス使用時間[us]
 
 // ========== センサー設定 ==========
-const uint8_t SYNC1 = 0x75;
-const uint8_t SYNC2 = 0x65;
-uint8_t buffer[1024];
-int bufferIndex = 0;
-bool sensorConnected = false;
-bool sensorConfigured = false;
+// センサーごとにリングバッファ・パケットの切り出し・振り分け・時刻・設定コマンド・公開するサンプルを持つ（MipDevice）
+// シリアル番号を空にすると、接続した順に割り当てる（SensorConnectのDevice Infoで確認して書き込む）
+const char TORSO_IMU_SERIAL[] = "";  // 胴体のセンサーのシリアル番号
+const char LEG_IMU_SERIAL[] = "";    // 脚のセンサーのシリアル番号
+MipDevice torsoImu("胴体", TORSO_IMU_SERIAL);
+MipDevice legImu("脚", LEG_IMU_SERIAL);
+MipDeviceGroup<USBSerial_BigBuffer, 2> sensors;  // ポートの接続管理と、すべてのセンサーの受信
+MipDeviceGroup<USBSerial_BigBuffer, 2>::Frame sensorFrame;  // 制御周期の始めにまとめてコピーした各センサーの最新サンプル
+const int TORSO = 0;                 // sensorFrameの添字（addDeviceの順）
+const int LEG = 1;
+MipRateConfig sensorRate;            // 基本周波数を問い合わせ、出力周波数から分周比を求めて設定する（胴体のセンサー）
+MipRateConfig legRate;               // 同じ設定（脚のセンサー）
+// 接続 → 起動待ち → 設定(ACK/NACKを確認) → 受信 → 途切れ を状態遷移で管理する（delayで待たない）
+MipLink torsoLink(torsoImu, &sensorRate);
+MipLink legLink(legImu, &legRate);
+const uint32_t SENSOR_STALE_MS = 20; // この時間サンプルが届かなければ途切れとして安全な出力に切り替える[ms]（出力周期5msの4回分）
+const int SENSOR_HOLD_TORQUE = 0;    // センサーのデータが途切れている間のトルク指令[mNm]（姿勢を使わない）
+MipHistory<MipAhrsSample, 16> ahrsHistory;  // 胴体の最新16サンプル（差分・フィルター用、[0]が最新）
+const uint16_t SENSOR_RATE_HZ = 200; // センサー出力周波数[Hz]（制御周期5msに合わせる、最大1000Hz）
+unsigned long sensor_ingest_us = 0;  // センサー受信処理にかかった時間の累計[us]（状態表示で0に戻す）
+// USBのバッファからリングバッファへの受信をタイマー割り込みで行う（PMXの通信待ち等でloop()が遅れても、受信時刻が遅れない）
+// パケットの処理・設定コマンドの送信はloop()で行う。falseにするとloop()で受信する
+const bool SENSOR_TIMER_INGEST = true;
+const unsigned int SENSOR_INGEST_PERIOD_US = 250;  // 受信の割り込み周期[us]（1kHz出力のパケット間隔より短く）
+IntervalTimer sensorTimer;
+// 胴体の姿勢を、0x82のフィルター出力の代わりにIMUデータ（0x80のジャイロ・加速度）からTeensy側で求める（'e'キーで切り替え）
+// センサー内のフィルターの遅れを含まず、IMU_RATE_HZで更新される。磁気を使わないので、ヨーはジャイロの積分（ドリフトする）
+const bool USE_ESTIMATOR = true;     // falseにするとIMUデータを設定せず、0x82だけを使う
+const uint16_t IMU_RATE_HZ = 1000;   // IMUデータの出力周波数[Hz]（最大1000Hz）
+const MipAttitudeEstimator::Mode ESTIMATOR_MODE = MipAttitudeEstimator::Ekf;  // Complementaryにすると相補フィルター
+const uint32_t ESTIMATOR_BUDGET_US = 50;  // 1ステップの予算[us]（EKFが続けて超えたら相補フィルターに切り替える）
+MipAttitudeEstimator torsoEstimator;
+bool sensorConnected = false;        // 胴体のセンサーが接続中
+bool legConnected = false;           // 脚のセンサーが接続中
+MipLink::State torso_link_state = MipLink::Absent;  // 表示済みの接続状態
+MipLink::State leg_link_state = MipLink::Absent;
 bool raspiConnected = false;         // Raspberry Pi接続状態（USBシリアル経由）
 
 // ========== PD制御パラメータ ==========
@@ -43,13 +89,15 @@ const double d_torso = 0.0846;     // 胴体重心位置[m]
 const double gravity = 9.81;       // 重力加速度[m/s^2]
 
 // ========== センサーデータ ==========
-float current_roll = 0.0;
-float current_pitch = 0.0;
-float current_yaw = 0.0;
-float gyro_x = 0.0;
-float gyro_y = 0.0;
-float gyro_z = 0.0;
-bool new_sensor_data = false;
+// 制御周期の始めにsensorFrameからコピーした胴体のセンサーの、姿勢・角速度・線形加速度・フィルターの状態・時刻をまとめたサンプル
+// （受信処理が割り込みやコールバックになっても、ピッチと角速度が別のパケットの値にならない）
+//   euler[0..2] : Roll, Pitch, Yaw [rad]
+//   angularRate[0..2] : フィルター済み角速度 X, Y, Z [rad/s]
+//   sensorNanos / hostMicros / arrivalMicros : センサー時刻、計測時刻と受信時刻（micros()基準）
+MipAhrsSample ahrs = {};
+MipAhrsSample leg_ahrs = {};       // 脚のセンサーの最新サンプル（接続中のみ更新）
+uint32_t ahrs_sequence = 0;        // 制御で使ったサンプルの番号（publishした回数）
+uint32_t ahrs_missed = 0;          // 制御で使わずに上書きされたサンプルの数（状態表示で0に戻す）
 
 // ========== エンコーダ・モータ状態 ==========
 int encoder_offset = 0;            // エンコーダオフセット
@@ -58,6 +106,8 @@ int encoder_segment = 0;           // エンコーダセグメント（境界処
 double theta_motor = 0.0;          // モータ角度[rad]
 double omega_motor = 0.0;          // モータ角速度[rad/s]
 double previous_theta_motor = 0.0; // 前回のモータ角度
+long motor_position_raw = 0;       // MotorWRITEの応答の位置（度×100）
+bool motor_position_fresh = false; // motor_position_rawをまだupdateMotorStateで使っていない
 
 // ========== 支持脚状態（歩行制御用） ==========
 double thetaq = 0.0;               // 支持脚と胴体の相対角[rad]
@@ -73,28 +123,56 @@ unsigned long last_control_time = 0;
 unsigned long last_sensor_time = 0;
 unsigned long last_sd_log_time = 0;
 
+// ========== 起動シーケンス ==========
+// 固定のdelayで待たずに、モータの応答とセンサーの受信を確認しながら並行して起動する
+// （センサーの接続・設定はMipLinkが行うので、モータの起動待ちの間に進む）
+enum BootStage {
+  BootProbeMotor,   // モータが応答するまで短いMotorREADで確認する
+  BootSetupMotor,   // トルクモード設定・エンコーダ初期化
+  BootReady         // 制御周期を開始（胴体のセンサーがStreamingになるまでは安全な出力）
+};
+BootStage boot_stage = BootProbeMotor;
+const unsigned long BOOT_PROBE_PERIOD = 10;       // モータへの確認の間隔[ms]
+const unsigned long BOOT_PROBE_BUDGET_US = 5000;  // 確認1回の応答待ち[us]（MOTOR_TIMEOUTの200msは待たない）
+const unsigned long BOOT_MOTOR_WARN_MS = 5000;    // この時間応答がなければ確認項目を表示する[ms]
+unsigned long boot_last_probe = 0;     // 前回モータに確認した時刻[ms]
+unsigned int boot_probe_count = 0;     // モータに確認した回数
+bool boot_motor_warned = false;        // 確認項目を表示済み
+unsigned long boot_motor_ms = 0;       // モータが応答した時刻[ms]（millis、電源投入から）
+unsigned long boot_setup_ms = 0;       // トルクモード設定・エンコーダ初期化が終わった時刻[ms]
+unsigned long boot_sensor_ms = 0;      // 胴体のセンサーが最初にStreamingになった時刻[ms]
+unsigned long boot_control_ms = 0;     // 最初のPD制御の時刻[ms]（0はまだ）
+
 // ========== 関数プロトタイプ宣言 ==========
 void initializeSDCard();
 void logDataToSDCard();
 void initializeEncoder();
 void updateMotorState();
+uint16_t readMotorPosition(long *position);
 void calculateLegState();
 void setupMotorTorqueMode();
 void sendMotorTorque(int torque_value);
+void safeTorqueOff();
+void planMotorBus();
 void manageSensorConnection();
 void configureSensor();
+void onCommandResult(const MipExecutor::Result& result, const uint8_t* reply, void* context);
 void readSensorData();
-void processBuffer();
-void processMIPPacket(uint8_t* packet, int length);
-void parseIMUData(uint8_t* data, int length);
-void parseAHRSData(uint8_t* data, int length);
+void onSensorTimer();
+void registerSensorFields();
+void onImuGyro(const MipVector3fView& gyro, void* context);
+uint32_t readCycleCounter();
+void onAhrsSample(const MipAhrsSample& sample, void* context);
+void printDeviceStatus(MipDevice& device, MipLink& link);
 void executePDControl();
+void executeSafeHold();
+void addSensorFields(MipRateConfig& rateConfig, bool imu);
+void reportLinkState(MipLink& link, MipDevice& device, MipLink::State& reported);
 void handleKeyboardInput();
 void displayStatus();
-void shiftBuffer();
-bool verifyChecksum(uint8_t* packet, int length);
-float parseFloat(uint8_t* bytes);
-void calculateChecksum(uint8_t* data, int length, uint8_t* checksum1, uint8_t* checksum2);
+void updateBootSequence();
+bool probeMotor();
+void reportBootTime();
 
 // ========== デバッグ設定 ==========
 const bool DEBUG_MODE = false;         // falseにしてデバッグ出力を無効化
@@ -112,18 +190,8 @@ unsigned long sessionStartTime = 0;
 
 void setup() {
   Serial.begin(115200);
-  
-  // 起動確認LED（5回高速点滅 = プログラム開始）
   pinMode(LED_BUILTIN, OUTPUT);
-  for(int i = 0; i < 5; i++) {
-    digitalWrite(LED_BUILTIN, HIGH);
-    delay(100);
-    digitalWrite(LED_BUILTIN, LOW);
-    delay(100);
-  }
-
-  // Serialの初期化待ち時間を短縮（Raspberry Pi接続用）
-  delay(500);
+  digitalWrite(LED_BUILTIN, HIGH);   // 起動中はloop()で高速点滅
 
   // 起動メッセージを無効化（CSVデータのみ送信）
   // Serial.println("\n===== AHRS + PMX PD制御システム起動 =====");
@@ -132,6 +200,20 @@ void setup() {
   // USBホスト初期化
   // Serial.print("USBホスト初期化...");
   myusb.begin();
+  registerSensorFields();
+  sensors.addPort(userial);
+  sensors.addPort(userial2);
+  sensors.addDevice(torsoImu);   // TORSO
+  sensors.addDevice(legImu);     // LEG
+  torsoImu.getExecutor().setHandler(onCommandResult, &sensorRate);
+  legImu.getExecutor().setHandler(onCommandResult, &legRate);
+  torsoLink.setStaleTimeout(SENSOR_STALE_MS);
+  legLink.setStaleTimeout(SENSOR_STALE_MS);
+  addSensorFields(sensorRate, USE_ESTIMATOR);
+  addSensorFields(legRate, false);
+  if (SENSOR_TIMER_INGEST) {
+    sensorTimer.begin(onSensorTimer, SENSOR_INGEST_PERIOD_US);
+  }
   // Serial.println("完了");
   
   // USBホスト接続確認（デバッグ出力を無効化）
@@ -139,35 +221,21 @@ void setup() {
   // 1. センサーはTeensy 4.1のUSBホストポート(5ピンヘッダー)に接続
   // 2. 通常のUSBポート(Type-B)ではありません
   
-  // モータ初期化
-  // Serial.print("モータ通信初期化...");
-  delay(3000);  // モータ起動待ち時間
+  // モータ通信開始（起動待ちはdelayせず、loop()のupdateBootSequenceで応答を確認する）
   pmx.begin();
-  // Serial.println("開始");
+  pmx.setRetryPolicy(MOTOR_RETRIES);
 
-  // モータ接続確認
-  Serial.print("モータ接続テスト...");
-  long testData[8];
-  uint16_t testFlag = pmx.MotorREAD(SERVO_ID, PMX::ReceiveDataOption::Torque, testData, PMX::ControlMode::Torque);
-  if (testFlag == 0) {
-    Serial.println("成功");
-    Serial.print("  現在トルク: ");
-    Serial.print(testData[1]);
-    Serial.println("mNm");
-  } else {
-    Serial.print("失敗 (flag=0x");
-    Serial.print(testFlag, HEX);
-    Serial.println(")");
-    Serial.println("\n[エラー] モータと通信できません！");
-    Serial.println("確認項目:");
-    Serial.println("  1. モータの電源がONになっているか");
-    Serial.println("  2. RS485の配線（Serial1のTX/RX）");
-    Serial.println("  3. モータIDが0に設定されているか");
-    Serial.println("  4. ボーレートが115200か");
-  }
+  // テレメトリのスケジュール（追加のMemREADなしで取得する）
+  // phaseをそろえ、温度・電圧は電流と同じサイクルで取得する
+  telemetry.addSchedule(PMX::ReceiveDataOption::MotorTemp
+                        + PMX::ReceiveDataOption::CpuTemp
+                        + PMX::ReceiveDataOption::Voltage, 50);   // 50サイクル(250ms)に1回
+  telemetry.addSchedule(PMX::ReceiveDataOption::Current, 10);      // 10サイクル(50ms)に1回
+  // 次の電流までの9サイクルは電流を応答に残す（2byte×9サイクルは応答モードの戻し・切替のMemWRITE2回より短い）
+  telemetry.setHoldCycles(9);
 
-  // モータをトルク制御モードに設定
-  setupMotorTorqueMode();
+  // 1周期の通信が制御周期に収まるか確認する
+  planMotorBus();
 
   Serial.println("\n===== VERSION 2.1 - ENCODER FIX (度×100形式) =====");  // PMXは度×100で返す
   Serial.println("\n目標角度設定:");
@@ -182,33 +250,37 @@ void setup() {
   Serial.println("  'n' : 新しいログファイル開始");
   Serial.println("  'r' : SDカード再初期化");
   Serial.println("\nセンサーを接続してください...");
-
-  // エンコーダ初期化
-  delay(500);
-  initializeEncoder();
-  
-  delay(2000);
+  Serial.print("モータ接続テスト...");
 }
 
 void loop() {
-  // 動作確認LED（1秒ごとに点滅）
+  // 動作確認LED（1秒ごとに点滅、最初の制御までは0.1秒ごと）
   static unsigned long last_led_time = 0;
   static bool led_state = false;
-  if (millis() - last_led_time > 1000) {
+  if (millis() - last_led_time > (boot_control_ms == 0 ? 100UL : 1000UL)) {
     led_state = !led_state;
     digitalWrite(LED_BUILTIN, led_state ? HIGH : LOW);
     last_led_time = millis();
   }
 
-  // USBホストタスク
+  // USBホストタスク（受信の割り込みと同時にUSBホストのドライバを呼ばないよう、割り込みを止める）
+  if (SENSOR_TIMER_INGEST) NVIC_DISABLE_IRQ(IRQ_PIT);
   myusb.Task();
+  if (SENSOR_TIMER_INGEST) NVIC_ENABLE_IRQ(IRQ_PIT);
   
   // センサー接続管理
   manageSensorConnection();
   
-  // センサーデータ読み取り
-  if (sensorConfigured) {
-    readSensorData();
+  // センサーデータ読み取り（設定コマンドの送信・再送も行う）
+  readSensorData();
+
+  // 接続状態の更新（接続したら設定し、途切れたらすぐにStaleにする）
+  torsoLink.update(millis());
+  legLink.update(millis());
+
+  // 起動シーケンス（モータの応答確認・トルクモード設定・エンコーダ初期化）
+  if (boot_stage != BootReady) {
+    updateBootSequence();
   }
 
   // Raspberry Pi接続管理（USBシリアル経由）
@@ -221,10 +293,26 @@ void loop() {
   
   // PD制御実行（10ms周期）
   unsigned long current_time = millis();
-  if (current_time - last_control_time >= CONTROL_PERIOD) {
-    if (new_sensor_data) {
+  if (boot_stage == BootReady && current_time - last_control_time >= CONTROL_PERIOD) {
+    // すべてのセンサーの最新サンプルをまとめてコピーし、胴体の新しいサンプルがある時だけ制御する（番号が飛んだ分は使わなかったサンプル）
+    sensors.read(sensorFrame);
+    if (sensorFrame.validMask & (1UL << LEG)) {
+      leg_ahrs = sensorFrame.sample[LEG];
+    }
+    // 胴体のセンサーが受信中でなければ、止まった姿勢で制御せずに安全な出力にする
+    uint32_t sequence = sensorFrame.sequence[TORSO];
+    if (!torsoLink.isStreaming()) {
+      executeSafeHold();
+    } else if ((sensorFrame.validMask & (1UL << TORSO)) && sequence != ahrs_sequence) {
+      ahrs = sensorFrame.sample[TORSO];
+      if (ahrs_sequence != 0) {
+        ahrs_missed += sequence - ahrs_sequence - 1;
+      }
+      ahrs_sequence = sequence;
       executePDControl();
-      new_sensor_data = false;
+      if (boot_control_ms == 0) {
+        reportBootTime();
+      }
     }
     last_control_time = current_time;
   }
@@ -257,277 +345,231 @@ void manageSensorConnection() {
     Serial.print("USB Host Status: ");
     Serial.print("userial=");
     Serial.print(userial ? "true" : "false");
-    // Serial.print(", raspi=");
-    // Serial.print(raspiserial ? "true" : "false");
-    Serial.print(", connected=");
-    Serial.println(sensorConnected ? "true" : "false");
+    Serial.print(", userial2=");
+    Serial.print(userial2 ? "true" : "false");
+    Serial.print(", torso=");
+    Serial.print(torsoImu.isConnected() ? "true" : "false");
+    Serial.print(", leg=");
+    Serial.println(legImu.isConnected() ? "true" : "false");
     last_check = millis();
   }
-  
-  if (userial) {
-    if (!sensorConnected) {
-      Serial.println("\n🔌 センサー検出！");
-      Serial.print("VID: 0x");
-      Serial.print(userial.idVendor(), HEX);
-      Serial.print(", PID: 0x");
-      Serial.println(userial.idProduct(), HEX);
-      
-      userial.begin(115200);
-      sensorConnected = true;
-      sensorConfigured = true;  // SensorConnectで設定済みなので即true
-      delay(500);
-
-      // 自動設定をスキップ（SensorConnectの設定を使用）
-      Serial.println("SensorConnectの設定を使用します");
-      Serial.println("期待されるデータ:");
-      Serial.println("  - 0x05: オイラー角");
-      Serial.println("  - 0x10: Angular Rate（フィルター済み角速度）");
-    }
-  } else {
-    if (sensorConnected) {
-      Serial.println("センサー切断");
-      sensorConnected = false;
-      sensorConfigured = false;
-      bufferIndex = 0;
+
+  // ポートへの割り当て・切断時の破棄はsensors.updateが、設定・途切れの判断はMipLinkが行う（ここでは表示と履歴の破棄だけ）
+  sensorConnected = torsoImu.isConnected();
+  legConnected = legImu.isConnected();
+  if (torsoLink.getState() != torso_link_state && torsoLink.getState() == MipLink::Absent) {
+    ahrsHistory.clear();
+  }
+  reportLinkState(torsoLink, torsoImu, torso_link_state);
+  reportLinkState(legLink, legImu, leg_link_state);
+  if (sensors.getUnmatchedCount() > 0) {
+    static uint32_t reported_unmatched = 0;
+    if (sensors.getUnmatchedCount() != reported_unmatched) {
+      reported_unmatched = sensors.getUnmatchedCount();
+      Serial.println("[警告] シリアル番号が一致しないセンサーが接続されました（TORSO_IMU_SERIAL / LEG_IMU_SERIALを確認してください）");
     }
   }
+}
+
+// 接続状態が変わった時に表示する（受信に戻った時は途切れてからの復帰時間も表示する）
+void reportLinkState(MipLink& link, MipDevice& device, MipLink::State& reported) {
+  MipLink::State state = link.getState();
+  if (state == reported) {
+    return;
+  }
+  reported = state;
+
+  Serial.print("センサー(");
+  Serial.print(device.getName());
+  Serial.print("): ");
+  Serial.print(MipLink::stateName(state));
+  if (state == MipLink::Enumerating) {
+    Serial.print(" シリアル番号=");
+    Serial.print(device.getSerialNumber());
+  } else if (state == MipLink::Streaming && link.getRecoveryCount() > 0) {
+    Serial.print(" 復帰時間=");
+    Serial.print(link.getLastRecovery());
+    Serial.print("ms");
+  } else if (state == MipLink::Stale) {
+    Serial.print(" → 安全な出力に切り替え");
+  }
+  Serial.println();
+}
 
+// 出力周波数を設定するフィールド（接続・再設定のたびにMipLinkが設定する）
+// imu: 姿勢推定に使うIMUデータ（ジャイロ・加速度・時刻）もIMU_RATE_HZで出力する
+void addSensorFields(MipRateConfig& rateConfig, bool imu) {
+  rateConfig.addField(MIP::DescSet::Filter, MIP::FilterField::Euler, SENSOR_RATE_HZ);
+  rateConfig.addField(MIP::DescSet::Filter, MIP::FilterField::AngularRate, SENSOR_RATE_HZ);
+  rateConfig.addField(MIP::DescSet::Filter, MIP::FilterField::Quaternion, SENSOR_RATE_HZ);
+  rateConfig.addField(MIP::DescSet::Filter, MIP::FilterField::LinearAccel, SENSOR_RATE_HZ);
+  rateConfig.addField(MIP::DescSet::Filter, MIP::FilterField::Status, SENSOR_RATE_HZ);
+  rateConfig.addField(MIP::DescSet::Filter, MIP::SharedField::ReferenceTime, SENSOR_RATE_HZ);
+  if (imu) {
+    rateConfig.addField(MIP::DescSet::Imu, MIP::ImuField::Accel, IMU_RATE_HZ);
+    rateConfig.addField(MIP::DescSet::Imu, MIP::ImuField::Gyro, IMU_RATE_HZ);
+    rateConfig.addField(MIP::DescSet::Imu, MIP::SharedField::ReferenceTime, IMU_RATE_HZ);
+  }
 }
 
 void configureSensor() {
   Serial.println("\n===== センサー設定開始 =====");
-  Serial.println("⚠️ 注意: センサーが既に設定されている可能性があります");
-  
-  uint8_t checksum1, checksum2;
-  
-  // Step 1: Idle状態にする
-  uint8_t idle_cmd[] = {
-    0x75, 0x65,  // Sync bytes
-    0x01,        // Base command set
-    0x02,        // Payload length
-    0x02,        // Set to Idle command
-    0x00, 0x00   // チェックサム
-  };
-  calculateChecksum(idle_cmd, sizeof(idle_cmd) - 2, &checksum1, &checksum2);
-  idle_cmd[sizeof(idle_cmd) - 2] = checksum1;
-  idle_cmd[sizeof(idle_cmd) - 1] = checksum2;
-  
-  Serial.println("Step 1: センサーをアイドル状態にする");
-  userial.write(idle_cmd, sizeof(idle_cmd));
-  delay(500);
-  
-  // Step 2: IMUストリームを無効化（フィルター済みデータのみ使用）
-  // ※ コメントアウトしてIMUデータを無効化
-  
-  // Step 3: AHRSデータフォーマット設定（オイラー角 + Angular Rate）
-  uint8_t set_ahrs_format[] = {
-    0x75, 0x65,  // Sync bytes
-    0x0C,        // Command set
-    0x0D,        // Payload length (13バイトに増加)
-    0x08,        // Message Format command
-    0x02,        // Descriptor set (0x02 = AHRS/Filter)
-    0x02,        // Number of fields (2つに変更)
-    0x05,        // Field 1: Euler Angles
-    0x00, 0x01,  // Rate divider (every packet)
-    0x10,        // Field 2: Angular Rate (追加)
-    0x00, 0x01,  // Rate divider (every packet)
-    0x00, 0x00   // チェックサム
-  };
-  calculateChecksum(set_ahrs_format, sizeof(set_ahrs_format) - 2, &checksum1, &checksum2);
-  set_ahrs_format[sizeof(set_ahrs_format) - 2] = checksum1;
-  set_ahrs_format[sizeof(set_ahrs_format) - 1] = checksum2;
-  
-  Serial.println("Step 3: AHRSフォーマット設定（オイラー角 + Angular Rate @ 100Hz）");
-  userial.write(set_ahrs_format, sizeof(set_ahrs_format));
-  delay(200);
-  
-  // Step 4: AHRSストリームのみを有効化
-  uint8_t enable_streams[] = {
-    0x75, 0x65,  // Sync bytes
-    0x0C,        // Command set
-    0x05,        // Payload length
-    0x11,        // Enable Data Stream
-    0x01,        // Function selector
-    0x02,        // AHRS(0x82) stream only
-    0x01,        // Enable
-    0x00, 0x00   // チェックサム
-  };
-  calculateChecksum(enable_streams, sizeof(enable_streams) - 2, &checksum1, &checksum2);
-  enable_streams[sizeof(enable_streams) - 2] = checksum1;
-  enable_streams[sizeof(enable_streams) - 1] = checksum2;
-  
-  Serial.println("Step 4: AHRS(0x82)ストリームのみを有効化");
-  userial.write(enable_streams, sizeof(enable_streams));
-  delay(200);
-  
-  Serial.println("✅ センサー設定完了！");
-  Serial.println("期待される出力:");
-  Serial.println("  - 0x82パケットのみ");
-  Serial.println("    - 0x05: オイラー角 (Roll/Pitch/Yaw)");
-  Serial.println("    - 0x10: Angular Rate (フィルター済み角速度)");
+
+  // Idle → 基本周波数の問い合わせ（分かっていれば省略） → Message Format（分周比 = 基本周波数 / SENSOR_RATE_HZ）
+  // → Enable Stream → Resume をMipLinkが登録する
+  // 送信はloop()の中で各センサーのMipExecutorが行うので、返信待ちの間もPD制御は止まらない（設定中は安全な出力）
+  torsoLink.reconfigure();
+  legLink.reconfigure();
+  Serial.print("AHRSフォーマット設定（オイラー角 + Angular Rate等 @ ");
+  Serial.print(SENSOR_RATE_HZ);
+  Serial.println("Hz）");
+  Serial.println("📨 設定コマンドを登録します（結果はACK/NACKを受信した時に表示）");
 }
 
-void readSensorData() {
-  while (userial.available()) {
-    if (bufferIndex >= (int)(sizeof(buffer) - 1)) {
-      shiftBuffer();
-    }
-    
-    uint8_t byte = userial.read();
-    buffer[bufferIndex++] = byte;
-    last_sensor_time = millis();
-    
-    processBuffer();
+// 設定コマンドの結果（ACK/NACK/タイムアウト）
+void onCommandResult(const MipExecutor::Result& result, const uint8_t* reply, void* context) {
+  MipRateConfig& rateConfig = *(MipRateConfig*)context;  // センサーごとの設定（setHandlerで指定）
+
+  Serial.print(result.status == MipExecutor::Acked ? "  ✅ " : "  ❌ ");
+  Serial.print("コマンド 0x");
+  Serial.print(result.descSet, HEX);
+  Serial.print("/0x");
+  Serial.print(result.fieldDesc, HEX);
+  Serial.print(" ");
+  Serial.print(MipExecutor::statusName(result.status));
+  if (result.status == MipExecutor::Nacked) {
+    Serial.print(" code=0x");
+    Serial.print(result.code, HEX);
+  }
+  Serial.print(" (");
+  Serial.print(result.latency);
+  Serial.println("ms)");
+
+  // 基本周波数の返信が揃ったら、MipRateConfigがMessage Format等を登録する
+  bool wasDone = rateConfig.isDone();
+  rateConfig.handleResult(result, reply);
+  if (!wasDone && rateConfig.isDone()) {
+    Serial.print("  出力周波数: 基本周波数=");
+    Serial.print(rateConfig.getBaseRate(MIP::DescSet::Filter));
+    Serial.print("Hz 分周比=");
+    Serial.print(rateConfig.getDecimation(MIP::DescSet::Filter, MIP::FilterField::Euler));
+    Serial.print(" → ");
+    Serial.print(rateConfig.getActualRate(MIP::DescSet::Filter, MIP::FilterField::Euler), 1);
+    Serial.println("Hz");
+  } else if (rateConfig.isFailed()) {
+    Serial.println("  ❌ 出力周波数の設定に失敗しました");
   }
 }
 
-void processBuffer() {
-  int processedBytes = 0;
-  
-  while (processedBytes < bufferIndex - 3) {
-    bool foundPacket = false;
-    
-    for (int i = processedBytes; i <= bufferIndex - 4; i++) {
-      if (buffer[i] == SYNC1 && buffer[i+1] == SYNC2) {
-        uint8_t length = buffer[i+3];
-        int packetSize = 4 + length + 2;
-        
-        if (i + packetSize <= bufferIndex) {
-          if (verifyChecksum(&buffer[i], packetSize)) {
-            processMIPPacket(&buffer[i], packetSize);
-          }
-          processedBytes = i + packetSize;
-          foundPacket = true;
-          break;
-        } else {
-          processedBytes = i;
-          foundPacket = false;
-          break;
-        }
-      }
-    }
-    
-    if (!foundPacket) break;
+void readSensorData() {
+  unsigned long start = micros();
+
+  // 先にすべてのセンサーのUSBシリアルからリングバッファへまとめて移し（時刻は1回だけ記録）、
+  // その後でセンサーごとに各byteを1回だけ処理する（1台の処理が、もう1台の受信時刻を遅らせない）
+  // 完成したパケットは、設定コマンドの返信ならMipExecutorへ、それ以外はセンサーごとのMipDispatcherで各フィールドのハンドラへ
+  // 割り込みで受信している場合は、リングバッファに溜まった分の処理とコマンドの送信だけを行う
+  // 割り込みを止めるのはUSBに触れる接続の確認・コマンドの送信の間だけで、パケットの処理（切り出し・振り分け・EKF）の間も受信時刻を記録する
+  uint32_t before = torsoImu.getIngest().getByteCount() + legImu.getIngest().getByteCount();
+  if (SENSOR_TIMER_INGEST) {
+    NVIC_DISABLE_IRQ(IRQ_PIT);
+    sensors.checkPorts();
+    NVIC_ENABLE_IRQ(IRQ_PIT);
+    sensors.process(start, millis());
+    NVIC_DISABLE_IRQ(IRQ_PIT);
+    sensors.sendCommands(millis());
+    NVIC_ENABLE_IRQ(IRQ_PIT);
+  } else {
+    sensors.update(start, millis());
   }
-  
-  if (processedBytes > 0) {
-    memmove(buffer, &buffer[processedBytes], bufferIndex - processedBytes);
-    bufferIndex -= processedBytes;
+  if (torsoImu.getIngest().getByteCount() + legImu.getIngest().getByteCount() != before) {
+    last_sensor_time = millis();
   }
+
+  sensor_ingest_us += micros() - start;
 }
 
-void processMIPPacket(uint8_t* packet, int length) {
-  uint8_t descriptor = packet[2];
-  uint8_t payload_length = packet[3];
-  
-  if (descriptor == 0x80) {
-    // IMUデータ（ジャイロ）
-    parseIMUData(&packet[4], payload_length);
-  } else if (descriptor == 0x82) {
-    // AHRSデータ（オイラー角）
-    parseAHRSData(&packet[4], payload_length);
+// 使用するフィールドのハンドラを登録する（同じ0x05でもセットによって意味が違う）
+//   (0x80, 0x05) : IMUのジャイロ（USE_ESTIMATORの場合は、加速度(0x04)・Reference Timestamp(0xD5)と合わせてtorsoEstimatorが登録する）
+//   (0x82, ～)   : 各センサーのMipAhrsDecoderが登録済み
+//                  クォータニオン(0x03)、オイラー角(0x05)、線形加速度(0x0D)、フィルター済み角速度(0x0E)、
+//                  フィルターの状態(0x10)、GPSタイムスタンプ(0xD3)、Reference Timestamp(0xD5)
+// 登録していないフィールドはLengthだけ見て読み飛ばされる
+// 受信の割り込み（USBのバッファからリングバッファへ移して受信時刻を記録するだけ）
+void onSensorTimer() {
+  sensors.ingest(micros());
+}
+
+void registerSensorFields() {
+  if (USE_ESTIMATOR) {
+    // 同じフィールドのハンドラは置き換えられるので、onImuGyroは登録しない
+    torsoEstimator.setMode(ESTIMATOR_MODE);
+    torsoEstimator.setCycleCounter(readCycleCounter, ESTIMATOR_BUDGET_US * (F_CPU_ACTUAL / 1000000));
+    torsoImu.setEstimator(&torsoEstimator);
+  } else {
+    torsoImu.getDispatcher().on(MIP::DescSet::Imu, MIP::ImuField::Gyro, onImuGyro);
   }
+  torsoImu.setSampleHandler(onAhrsSample);
 }
 
-void parseIMUData(uint8_t* data, int length) {
-  int idx = 0;
-  
-  while (idx < length - 2) {
-    uint8_t field_length = data[idx];
-    uint8_t field_descriptor = data[idx + 1];
-    
-    if (field_length == 0 || field_length > length - idx) break;
-    
-    // ジャイロデータ (0x05)
-    if (field_descriptor == 0x05 && field_length >= 14) {
-      gyro_x = parseFloat(&data[idx + 2]);
-      gyro_y = parseFloat(&data[idx + 6]);
-      gyro_z = parseFloat(&data[idx + 10]);
-      
-      if (DEBUG_MODE) {
-        Serial.print("Gyro: X=");
-        Serial.print(gyro_x, 3);
-        Serial.print(" Y=");
-        Serial.print(gyro_y, 3);
-        Serial.print(" Z=");
-        Serial.println(gyro_z, 3);
-      }
-    }
-    
-    idx += field_length;
+// 姿勢推定の1ステップの計測に使うサイクルカウンタ
+uint32_t readCycleCounter() {
+  return ARM_DWT_CYCCNT;
+}
+
+// IMUデータ（ジャイロ）
+void onImuGyro(const MipVector3fView& gyro, void* context) {
+  (void)context;
+  // 制御にはフィルター済み角速度（ahrs.angularRate）を使う
+  if (DEBUG_MODE) {
+    Serial.print("Gyro: X=");
+    Serial.print(gyro.x(), 3);
+    Serial.print(" Y=");
+    Serial.print(gyro.y(), 3);
+    Serial.print(" Z=");
+    Serial.println(gyro.z(), 3);
   }
 }
 
-void parseAHRSData(uint8_t* data, int length) {
-  int idx = 0;
-  
-  while (idx < length - 2) {
-    uint8_t field_length = data[idx];
-    uint8_t field_descriptor = data[idx + 1];
-    
-    if (field_length == 0 || field_length > length - idx) break;
-    
-    // オイラー角 (0x05 in AHRS context)
-    if (field_descriptor == 0x05 && field_length >= 16) {
-      current_roll = parseFloat(&data[idx + 2]);
-      current_pitch = parseFloat(&data[idx + 6]);
-      current_yaw = parseFloat(&data[idx + 10]);
-      new_sensor_data = true;
-      
-      if (DEBUG_MODE) {
-        Serial.print("Euler: R=");
-        Serial.print(current_roll * 180.0 / PI, 1);
-        Serial.print("° P=");
-        Serial.print(current_pitch * 180.0 / PI, 1);
-        Serial.print("° Y=");
-        Serial.println(current_yaw * 180.0 / PI, 1);
-      }
-    }
-    // Angular Rate (0x10) - フィルター済み角速度
-    else if (field_descriptor == 0x0E && field_length >= 14) {
-      gyro_x = parseFloat(&data[idx + 2]);
-      gyro_y = parseFloat(&data[idx + 6]);
-      gyro_z = parseFloat(&data[idx + 10]);
-      
-      // デバッグ用（5秒ごとに表示）
-      static unsigned long last_gyro_debug = 0;
-      if (millis() - last_gyro_debug > 5000) {
-        Serial.print("[INFO] フィルター済み角速度取得: X=");
-        Serial.print(gyro_x, 4);
-        Serial.print(" Y=");
-        Serial.print(gyro_y, 4);
-        Serial.print(" Z=");
-        Serial.print(gyro_z, 4);
-        Serial.println(" rad/s");
-        last_gyro_debug = millis();
-      }
-    }
-    // デバッグ: 未知のフィールド
-    else {
-      static unsigned long last_unknown = 0;
-      if (millis() - last_unknown > 10000) {  // 10秒ごと
-        Serial.print("[DEBUG] AHRSパケット内のフィールド: 0x");
-        Serial.print(field_descriptor, HEX);
-        Serial.print(" (長さ=");
-        Serial.print(field_length);
-        Serial.println("バイト)");
-        last_unknown = millis();
-      }
-    }
-    
-    idx += field_length;
+// 胴体のAHRSデータ（1パケット分をまとめたサンプル、制御側への公開はtorsoImuが行う）
+void onAhrsSample(const MipAhrsSample& sample, void* context) {
+  (void)context;
+  ahrsHistory.push(sample);
+
+  if (DEBUG_MODE) {
+    Serial.print("Euler: R=");
+    Serial.print(sample.euler[0] * MipConv::RadToDeg, 1);
+    Serial.print("° P=");
+    Serial.print(sample.euler[1] * MipConv::RadToDeg, 1);
+    Serial.print("° Y=");
+    Serial.println(sample.euler[2] * MipConv::RadToDeg, 1);
+  }
+
+  // デバッグ用（5秒ごとに表示）
+  static unsigned long last_gyro_debug = 0;
+  if (millis() - last_gyro_debug > 5000) {
+    Serial.print("[INFO] フィルター済み角速度取得: X=");
+    Serial.print(sample.angularRate[0], 4);
+    Serial.print(" Y=");
+    Serial.print(sample.angularRate[1], 4);
+    Serial.print(" Z=");
+    Serial.print(sample.angularRate[2], 4);
+    Serial.println(" rad/s");
+    last_gyro_debug = millis();
   }
 }
 
 void executePDControl() {
+  // この周期のモータ通信は期限内に終える（再送も期限内に1往復できる時だけ）
+  pmx.setDeadline(micros() + MOTOR_COM_BUDGET_US);
+
   // エンコーダ読み取りと支持脚状態更新
   updateMotorState();
   calculateLegState();
 
   // PD制御計算（ピッチ軸を制御）+ 重力補償
-  double error = theta_target - current_pitch;
-  double torque = -Kp * error - Kd * gyro_y
-                  - m_torso * gravity * d_torso * sin(current_pitch);
+  double error = theta_target - ahrs.euler[1];
+  double torque = -Kp * error - Kd * ahrs.angularRate[1]
+                  - m_torso * gravity * d_torso * sin(ahrs.euler[1]);
 
   // トルクをモータ指令値に変換（mNm単位）
   int motor_torque = (int)(torque * 1000);
@@ -540,15 +582,22 @@ void executePDControl() {
     motor_torque = -TORQUE_LIMIT;
   }
   
-  // モータにトルク指令送信（通信エラー時はスキップ）
-  static int error_count = 0;
-  if (error_count < 3) {  // 連続エラー3回まで
-    sendMotorTorque(motor_torque);
-  } else if (error_count == 3) {
-    Serial.println("\n[警告] モータ通信エラーが継続 - トルク出力を停止");
-    sendMotorTorque(0);  // 安全のため停止
-    error_count++;
+  // モータにトルク指令送信（通信異常が続いたらトルクOFFして停止）
+  if (!motor_safe_off) {
+    if (!linkStats.isLinkDown(SERVO_ID, MOTOR_LINK_MAX_FAIL, MOTOR_LINK_MAX_ERROR_RATE)) {
+      sendMotorTorque(motor_torque);
+    } else {
+      Serial.println("\n[警告] モータ通信エラーが継続 - トルク出力を停止");
+      safeTorqueOff();
+    }
   }
+
+  pmx.clearDeadline();
+
+  // この周期のバス使用時間を記録する
+  unsigned long busy_us = pmx.getBusyMicros();
+  busPlanner.measure(busy_us - last_busy_us, (unsigned long)(CONTROL_PERIOD * 1000));
+  last_busy_us = busy_us;
   
   if (SHOW_CONTROL_DATA) {
     static unsigned long last_print = 0;
@@ -556,7 +605,7 @@ void executePDControl() {
       Serial.print("PD: 目標=");
       Serial.print(theta_target * 180.0 / PI, 1);
       Serial.print("° Pitch=");
-      Serial.print(current_pitch * 180.0 / PI, 1);
+      Serial.print(ahrs.euler[1] * MipConv::RadToDeg, 1);
       Serial.print("° 誤差=");
       Serial.print(error * 180.0 / PI, 1);
       Serial.print("°");
@@ -584,6 +633,93 @@ void adjustPDGains() {
   // 例: 振動検出、応答速度評価、ゲインの自動調整
 }
 
+// モータに短いMotorREADを送り、応答したか返す（期限付きなので応答がなくてもBOOT_PROBE_BUDGET_USで戻る）
+// 無応答とCRCエラー以外は応答ありとする（ステータスのビットや、前回の応答モードのままで受信データ数が合わない場合も応答はある）
+bool probeMotor() {
+  long receiveData[8];
+  pmx.setDeadline(micros() + BOOT_PROBE_BUDGET_US);
+  uint16_t flag = pmx.MotorREAD(SERVO_ID, PMX::ReceiveDataOption::Torque, receiveData, PMX::ControlMode::Torque);
+  pmx.clearDeadline();
+  boot_probe_count++;
+
+  uint16_t error = flag & PMX::ComError::ErrorMask;
+  if (error == PMX::ComError::TimeOut || error == PMX::ComError::CrcError) {
+    return false;
+  }
+  Serial.print("成功 flag=0x");
+  Serial.println(flag, HEX);
+  if (error == PMX::ComError::OK) {
+    Serial.print("  現在トルク: ");
+    Serial.print(receiveData[3]);  // [位置,速度,電流,トルク,...]のトルク
+    Serial.println("mNm");
+  }
+  return true;
+}
+
+// 起動シーケンスを1段進める（loop()から呼び出し、待つ間もセンサーの受信・設定は止まらない）
+void updateBootSequence() {
+  unsigned long now = millis();
+
+  if (boot_sensor_ms == 0 && torsoLink.isStreaming()) {
+    boot_sensor_ms = now;
+  }
+
+  switch (boot_stage) {
+    case BootProbeMotor:
+      if (now - boot_last_probe < BOOT_PROBE_PERIOD) {
+        break;
+      }
+      boot_last_probe = now;
+      if (probeMotor()) {
+        boot_motor_ms = millis();
+        boot_stage = BootSetupMotor;
+      } else if (!boot_motor_warned && now >= BOOT_MOTOR_WARN_MS) {
+        boot_motor_warned = true;
+        Serial.println("応答なし（確認を続けます）");
+        Serial.println("\n[エラー] モータと通信できません！");
+        Serial.println("確認項目:");
+        Serial.println("  1. モータの電源がONになっているか");
+        Serial.println("  2. RS485の配線（Serial1のTX/RX）");
+        Serial.println("  3. モータIDが0に設定されているか");
+        Serial.println("  4. ボーレートが115200か");
+      }
+      break;
+
+    case BootSetupMotor:
+      // モータが応答したらすぐにトルクモード設定と初期位置の取得を行う
+      setupMotorTorqueMode();
+      initializeEncoder();
+      boot_setup_ms = millis();
+      boot_stage = BootReady;
+      Serial.print("モータ準備完了: ");
+      Serial.print(boot_setup_ms);
+      Serial.print("ms（確認");
+      Serial.print(boot_probe_count);
+      Serial.println("回）");
+      break;
+
+    case BootReady:
+      break;
+  }
+}
+
+// 起動から最初のPD制御までの時間を表示する
+void reportBootTime() {
+  boot_control_ms = millis();
+  if (boot_sensor_ms == 0) {
+    boot_sensor_ms = boot_control_ms;
+  }
+  Serial.print("起動完了: 最初の制御まで");
+  Serial.print(boot_control_ms);
+  Serial.print("ms（モータ応答");
+  Serial.print(boot_motor_ms);
+  Serial.print("ms, トルクモード設定・エンコーダ初期化");
+  Serial.print(boot_setup_ms);
+  Serial.print("ms, センサー受信");
+  Serial.print(boot_sensor_ms);
+  Serial.println("ms、電源投入から）");
+}
+
 void setupMotorTorqueMode() {
   Serial.println("\n===== モータトルクモード設定 =====");
 
@@ -616,14 +752,43 @@ void setupMotorTorqueMode() {
   }
 }
 
+// センサーのデータが途切れている間の出力（姿勢を使わずに一定のトルクを出し、モータとの通信は続ける）
+void executeSafeHold() {
+  pmx.setDeadline(micros() + MOTOR_COM_BUDGET_US);
+
+  updateMotorState();
+  last_torque_for_raspi = SENSOR_HOLD_TORQUE;
+
+  if (!motor_safe_off) {
+    if (!linkStats.isLinkDown(SERVO_ID, MOTOR_LINK_MAX_FAIL, MOTOR_LINK_MAX_ERROR_RATE)) {
+      sendMotorTorque(SENSOR_HOLD_TORQUE);
+    } else {
+      Serial.println("\n[警告] モータ通信エラーが継続 - トルク出力を停止");
+      safeTorqueOff();
+    }
+  }
+
+  pmx.clearDeadline();
+
+  unsigned long busy_us = pmx.getBusyMicros();
+  busPlanner.measure(busy_us - last_busy_us, (unsigned long)(CONTROL_PERIOD * 1000));
+  last_busy_us = busy_us;
+}
+
 void sendMotorTorque(int torque_value) {
   // トルク値をPMXフォーマットで送信
   long writeDatas[1] = {torque_value};
-  byte controlMode = PMX::ControlMode::Torque;
-  byte receiveMode = PMX::ReceiveDataOption::Position;  // 位置データを受信（PMXManager設定に合わせる）
   long receiveData[8];
 
-  uint16_t flag = pmx.MotorWRITE(SERVO_ID, writeDatas, 1, receiveMode, receiveData, controlMode);
+  // 位置は毎回、温度・電圧・電流はスケジュールに従って応答に含める
+  uint16_t flag = telemetry.MotorWRITE(writeDatas, 1, receiveData);
+  linkStats.record(SERVO_ID, flag);
+
+  // 次の周期のupdateMotorStateは、この応答の位置を使う
+  if ((flag & PMX::ComError::ErrorMask) == PMX::ComError::OK) {
+    motor_position_raw = receiveData[0];
+    motor_position_fresh = true;
+  }
 
   // エラー詳細表示
   if (flag != 0) {
@@ -645,6 +810,21 @@ void sendMotorTorque(int torque_value) {
   }
 }
 
+void safeTorqueOff() {
+  // 通信が不安定でも届くように再送を使ってフリーにする
+  pmx.clearDeadline();
+  uint16_t flag = pmx.MotorWRITE(SERVO_ID, PMX::TorqueSwitchType::Free);
+  motor_safe_off = true;
+
+  Serial.print("  -> トルクOFF flag=0x");
+  Serial.print(flag, HEX);
+  Serial.print(" 連続失敗=");
+  Serial.print(linkStats.getConsecutiveFailures(SERVO_ID));
+  Serial.print(" エラー率=");
+  Serial.print(linkStats.getErrorRate(SERVO_ID) * 100.0, 0);
+  Serial.println("% ('t'キーで復帰)");
+}
+
 void handleKeyboardInput() {
   if (Serial.available()) {
     char cmd = Serial.read();
@@ -683,7 +863,7 @@ void handleKeyboardInput() {
         
       case 'f':
       case 'F':
-        if (sensorConnected) {
+        if (sensorConnected || legConnected) {
           Serial.println("強制的にセンサー設定を送信...");
           configureSensor();
         } else {
@@ -694,11 +874,15 @@ void handleKeyboardInput() {
       case 's':
       case 'S':
         Serial.println("\n📊 現在の状態:");
-        Serial.print("センサー接続: ");
-        Serial.println(sensorConnected ? "Yes" : "No");
+        Serial.print("センサー接続: 胴体=");
+        Serial.print(sensorConnected ? "Yes" : "No");
+        Serial.print(" 脚=");
+        Serial.println(legConnected ? "Yes" : "No");
         Serial.print("USBSerial: ");
-        Serial.println(userial ? "検出" : "未検出");
-        Serial.println("- 0x80パケット = IMU生データ（ジャイロ）");
+        Serial.print(userial ? "検出" : "未検出");
+        Serial.print(" / ");
+        Serial.println(userial2 ? "検出" : "未検出");
+        Serial.println(USE_ESTIMATOR ? "- 0x80パケット = IMU生データ（ジャイロ・加速度、姿勢推定に使用）" : "- 0x80パケット = IMU生データ（ジャイロ）");
         Serial.println("- 0x82パケット = AHRSフィルターデータ（オイラー角）");
         break;
 
@@ -718,33 +902,105 @@ void handleKeyboardInput() {
       case 'R':
         Serial.println("SDカード機能は無効化されています（Raspberry Piでログ記録）");
         break;
+
+      case 'e':
+      case 'E':
+        if (!USE_ESTIMATOR) {
+          Serial.println("姿勢推定は無効です（USE_ESTIMATOR）");
+          break;
+        }
+        // 公開するサンプルの出どころを切り替える（履歴は出どころが混ざらないよう破棄する）
+        torsoImu.setSource(torsoImu.getSource() == MipDevice::FilterSource ? MipDevice::EstimatorSource : MipDevice::FilterSource);
+        ahrsHistory.clear();
+        Serial.print("姿勢の出どころ: ");
+        Serial.println(torsoImu.getSource() == MipDevice::FilterSource ? "0x82フィルター" : "IMUデータからの推定");
+        break;
+
+      case 't':
+      case 'T':
+        // 通信異常によるトルクOFFから復帰
+        Serial.println("モータ通信統計をリセットしてトルクONします");
+        linkStats.reset(SERVO_ID);
+        telemetry.invalidateActiveMode();
+        setupMotorTorqueMode();
+        motor_safe_off = false;
+        break;
     }
   }
 }
 
 void displayStatus() {
   Serial.println("=== システム状態 ===");
-  Serial.print("センサー: ");
-  Serial.println(sensorConnected ? "接続" : "未接続");
+  printDeviceStatus(torsoImu, torsoLink);
+  printDeviceStatus(legImu, legLink);
+  Serial.print("受信処理=");
+  Serial.print(sensor_ingest_us);
+  Serial.print("us/s センサー間の計測時刻の差=");
+  Serial.print(sensorFrame.skewMicros);
+  Serial.println("us");
+  sensor_ingest_us = 0;
   Serial.print("目標角度: ");
   Serial.print(theta_target * 180.0 / PI);
   Serial.println("度");
 
   // IMUセンサー情報
   Serial.print("現在角度: Roll=");
-  Serial.print(current_roll * 180.0 / PI, 1);
+  Serial.print(ahrs.euler[0] * MipConv::RadToDeg, 1);
   Serial.print("° Pitch=");
-  Serial.print(current_pitch * 180.0 / PI, 1);
+  Serial.print(ahrs.euler[1] * MipConv::RadToDeg, 1);
   Serial.print("° Yaw=");
-  Serial.print(current_yaw * 180.0 / PI, 1);
+  Serial.print(ahrs.euler[2] * MipConv::RadToDeg, 1);
   Serial.println("°");
   Serial.print("角速度: X=");
-  Serial.print(gyro_x, 3);
+  Serial.print(ahrs.angularRate[0], 3);
   Serial.print("rad/s Y=");
-  Serial.print(gyro_y, 3);
+  Serial.print(ahrs.angularRate[1], 3);
   Serial.print("rad/s Z=");
-  Serial.print(gyro_z, 3);
+  Serial.print(ahrs.angularRate[2], 3);
   Serial.println("rad/s");
+  Serial.print("フィルター状態=");
+  Serial.print(ahrs.filterState);
+  Serial.print(" フラグ=0x");
+  Serial.print(ahrs.statusFlags, HEX);
+  Serial.print(" 線形加速度: X=");
+  Serial.print(ahrs.linearAccel[0], 2);
+  Serial.print(" Y=");
+  Serial.print(ahrs.linearAccel[1], 2);
+  Serial.print(" Z=");
+  Serial.print(ahrs.linearAccel[2], 2);
+  Serial.println("m/s^2");
+
+  // 履歴の最新と最も古いサンプルの差から求めたPitch角速度（ジャイロとの比較用）
+  if (ahrsHistory.size() >= 2) {
+    const MipAhrsSample& newest = ahrsHistory.newest();
+    const MipAhrsSample& oldest = ahrsHistory.oldest();
+    uint32_t span_us = newest.hostMicros - oldest.hostMicros;
+    if (span_us > 0) {
+      Serial.print("履歴: ");
+      Serial.print(ahrsHistory.size());
+      Serial.print("サンプル ");
+      Serial.print(span_us);
+      Serial.print("us 差分Pitch角速度=");
+      Serial.print((newest.euler[1] - oldest.euler[1]) * 1.0e6f / span_us, 3);
+      Serial.println("rad/s");
+    }
+  }
+  Serial.print("制御サンプル番号=");
+  Serial.print(ahrs_sequence);
+  Serial.print(" 未使用=");
+  Serial.print(ahrs_missed);
+  Serial.print(" 読み直し=");
+  Serial.println(torsoImu.getSnapshot().getRetryCount());
+  ahrs_missed = 0;
+  if (legConnected) {
+    Serial.print("脚のセンサー: Roll=");
+    Serial.print(leg_ahrs.euler[0] * MipConv::RadToDeg, 1);
+    Serial.print("° Pitch=");
+    Serial.print(leg_ahrs.euler[1] * MipConv::RadToDeg, 1);
+    Serial.print("° Pitch角速度=");
+    Serial.print(leg_ahrs.angularRate[1], 3);
+    Serial.println("rad/s");
+  }
 
   // 歩行制御情報
   Serial.print("支持脚角度: ");
@@ -761,47 +1017,187 @@ void displayStatus() {
   Serial.print("° モータ角速度: ");
   Serial.print(omega_motor, 3);
   Serial.println("rad/s");
-}
-
-void shiftBuffer() {
-  int shiftAmount = bufferIndex / 2;
-  memmove(buffer, &buffer[shiftAmount], bufferIndex - shiftAmount);
-  bufferIndex -= shiftAmount;
-}
 
-bool verifyChecksum(uint8_t* packet, int length) {
-  uint8_t calc_checksum1, calc_checksum2;
-  calculateChecksum(packet, length - 2, &calc_checksum1, &calc_checksum2);
-  return (packet[length - 2] == calc_checksum1 && 
-          packet[length - 1] == calc_checksum2);
+  // サーボ状態（MotorWRITEの応答から取得）
+  Serial.print("モータ温度: ");
+  Serial.print(telemetry.getLatest(5));
+  Serial.print("℃ CPU温度: ");
+  Serial.print(telemetry.getLatest(6));
+  Serial.print("℃ 電圧: ");
+  Serial.print(telemetry.getLatest(7));
+  Serial.print("mV 電流: ");
+  Serial.print(telemetry.getLatest(2));
+  Serial.print("mA 応答モード切替: ");
+  Serial.println(telemetry.getModeChangeCount());
+
+  // モータ通信統計
+  Serial.print("通信: 合計=");
+  Serial.print(linkStats.getTotal(SERVO_ID));
+  Serial.print(" Timeout=");
+  Serial.print(linkStats.getCount(SERVO_ID, PmxLinkClass::TimeOut));
+  Serial.print(" CRC=");
+  Serial.print(linkStats.getCount(SERVO_ID, PmxLinkClass::Crc));
+  Serial.print(" Format=");
+  Serial.print(linkStats.getCount(SERVO_ID, PmxLinkClass::Format));
+  Serial.print(" Convert=");
+  Serial.print(linkStats.getCount(SERVO_ID, PmxLinkClass::Convert));
+  Serial.print(" エラー率=");
+  Serial.print(linkStats.getErrorRate(SERVO_ID) * 100.0, 1);
+  Serial.print("% 再送=");
+  Serial.print(pmx.getRetryCount());
+  Serial.print(" 回復=");
+  Serial.print(pmx.getRecoveredCount());
+  Serial.print(" 期限不足=");
+  Serial.print(pmx.getRetrySkipCount());
+  Serial.println(motor_safe_off ? " [トルクOFF中]" : "");
+
+  // バス使用率（見積もりと実測）
+  Serial.print("バス: 見積=");
+  Serial.print(busPlanner.getWorstCycleTime());
+  Serial.print("us 実測=");
+  Serial.print(busPlanner.getLastBusy());
+  Serial.print("us 最大=");
+  Serial.print(busPlanner.getMaxBusy());
+  Serial.print("us 使用率=");
+  Serial.print(busPlanner.getMeasuredUtilization(), 1);
+  Serial.print("% 空き最小=");
+  Serial.print(busPlanner.getMinIdle());
+  Serial.print("us 超過=");
+  Serial.println(busPlanner.getOverrunCount());
 }
 
-float parseFloat(uint8_t* bytes) {
-  union {
-    float f;
-    uint8_t b[4];
-  } u;
-  
-  // ビッグエンディアンからリトルエンディアンへ変換
-  u.b[0] = bytes[3];
-  u.b[1] = bytes[2];
-  u.b[2] = bytes[1];
-  u.b[3] = bytes[0];
-  
-  return u.f;
+// センサーごとの受信状態（パケット・エラー・リングバッファ・受信周波数・時刻）
+void printDeviceStatus(MipDevice& device, MipLink& link) {
+  MipFramer& framer = device.getFramer();
+  MipRing<MipDevice::RingSize>& ring = device.getRing();
+  MipRateMonitor& filterRate = device.getRateMonitor();
+  MipClockSync& sensorClock = device.getClock();
+
+  Serial.print("センサー(");
+  Serial.print(device.getName());
+  Serial.print("): ");
+  Serial.print(device.isConnected() ? "接続" : "未接続");
+  Serial.print(" シリアル番号=");
+  Serial.print(device.getSerialNumber());
+  Serial.print(" パケット=");
+  Serial.print(framer.getPacketCount());
+  Serial.print(" チェックサムエラー=");
+  Serial.print(framer.getChecksumErrorCount());
+  Serial.print(" 同期外れ=");
+  Serial.print(framer.getSyncLossCount());
+  Serial.print(" サイズ異常=");
+  Serial.print(framer.getOversizeCount());
+  Serial.print(" 未登録フィールド=");
+  Serial.print(device.getDispatcher().getUnknownFieldCount());
+  Serial.print(" 溢れ=");
+  Serial.print(ring.getOverflowBytes());
+  Serial.print("bytes 最大使用=");
+  Serial.print(ring.getHighWater());
+  Serial.print(" 最大チャンク=");
+  Serial.print(device.getIngest().getMaxChunk());
+  Serial.println("bytes");
+  Serial.print("  周波数: ");
+  Serial.print(filterRate.getRate(), 1);
+  Serial.print("Hz（設定");
+  Serial.print(SENSOR_RATE_HZ);
+  Serial.print("Hz） 受信間隔=");
+  Serial.print(filterRate.getMeanInterval(), 0);
+  Serial.print("us ジッタ=");
+  Serial.print(filterRate.getJitter(), 0);
+  Serial.print("us 最小=");
+  Serial.print(filterRate.getMinInterval());
+  Serial.print("us 最大=");
+  Serial.print(filterRate.getMaxInterval());
+  Serial.println("us");
+  Serial.print("  切り出しまで: 計測から 平均=");
+  Serial.print(device.getParseLatency(), 0);
+  Serial.print("us 最大=");
+  Serial.print(device.getMaxParseLatency());
+  Serial.print("us 受信から 最大=");
+  Serial.print(device.getMaxQueueDelay());
+  Serial.print("us 読み残し=");
+  Serial.println(device.getChunkStallCount());
+  MipAttitudeEstimator* estimator = device.getEstimator();
+  if (estimator != nullptr) {
+    // 計測から切り出しまでの時間を、0x82とIMUデータからの推定で比べる
+    Serial.print("  姿勢推定: ");
+    Serial.print(device.getSource() == MipDevice::EstimatorSource ? "使用中 " : "比較のみ ");
+    Serial.print(estimator->getMode() == MipAttitudeEstimator::Ekf ? "EKF" : "相補フィルター");
+    Serial.print(estimator->isFallback() ? "（予算超過で切り替え）" : "");
+    Serial.print(" ステップ=");
+    Serial.print(estimator->getStepCount());
+    Serial.print(" 最大=");
+    Serial.print(estimator->getMaxCycles() / (F_CPU_ACTUAL / 1000000));
+    Serial.print("us 予算超過=");
+    Serial.print(estimator->getOverrunCount());
+    Serial.print(" 切り出しまで 0x82=");
+    Serial.print(device.getParseLatency(MipDevice::FilterSource), 0);
+    Serial.print("us 推定=");
+    Serial.print(device.getParseLatency(MipDevice::EstimatorSource), 0);
+    Serial.println("us");
+    estimator->resetCycles();
+  }
+  device.resetLatency();
+  Serial.print("  センサー時刻: ");
+  if (sensorClock.isValid()) {
+    Serial.print("ドリフト=");
+    Serial.print(sensorClock.getDriftPpm(), 1);
+    Serial.print("ppm オフセット=");
+    Serial.print((long)(sensorClock.getOffsetMicros() / 1000));
+    Serial.print("ms 遅れ 平均=");
+    Serial.print(sensorClock.getMeanLatency(), 0);
+    Serial.print("us ジッタ=");
+    Serial.print(sensorClock.getLatencyJitter(), 0);
+    Serial.print("us 最大=");
+    Serial.print(sensorClock.getMaxLatency(), 0);
+    Serial.print("us 再同期=");
+    Serial.println(sensorClock.getResetCount());
+    sensorClock.resetLatencyMax();
+  } else {
+    Serial.println("同期中");
+  }
+  Serial.print("  接続状態: ");
+  Serial.print(MipLink::stateName(link.getState()));
+  Serial.print(" 途切れ=");
+  Serial.print(link.getStaleCount());
+  Serial.print(" 復帰=");
+  Serial.print(link.getRecoveryCount());
+  Serial.print("回 直前=");
+  Serial.print(link.getLastRecovery());
+  Serial.print("ms 最大=");
+  Serial.print(link.getMaxRecovery());
+  Serial.print("ms 設定=");
+  Serial.print(link.getConfigCount());
+  Serial.print("回 設定失敗=");
+  Serial.println(link.getConfigFailCount());
 }
 
-void calculateChecksum(uint8_t* data, int length, uint8_t* checksum1, uint8_t* checksum2) {
-  uint8_t sum1 = 0;
-  uint8_t sum2 = 0;
-
-  for (int i = 0; i < length; i++) {
-    sum1 = (sum1 + data[i]) & 0xFF;
-    sum2 = (sum2 + sum1) & 0xFF;
+void planMotorBus() {
+  // sendMotorTorqueのMotorWRITE（トルク指令1つ、位置の応答）
+  // 位置はこの応答から取るので、updateMotorStateのMotorREADはMotorWRITEしなかった周期（トルクOFF中など）だけ
+  busPlanner.addMotorWRITE(1, 1, PMX::ReceiveDataOption::Position);
+  // 電流はsetHoldCyclesで応答に残るので、MotorWRITEの返信が毎サイクル2byte増える
+  busPlanner.addReplyBytes(1, 2);               // 電流
+  // 温度・電圧のサイクルは応答モードの切替(1byteのMemWRITE)と戻し、返信が増える分を加える
+  busPlanner.addMemWRITE(1, 1, 50, 0);
+  busPlanner.addMemWRITE(1, 1, 50, 1);
+  busPlanner.addReplyBytes(1, 6, 50, 0);        // モータ温度+CPU温度+電圧
+
+  unsigned long period_us = (unsigned long)(CONTROL_PERIOD * 1000);
+  Serial.print("バス見積もり: 最大");
+  Serial.print(busPlanner.getWorstCycleTime());
+  Serial.print("us / 平均");
+  Serial.print(busPlanner.getAverageCycleTime());
+  Serial.print("us (周期");
+  Serial.print(period_us);
+  Serial.print("us, 使用率");
+  Serial.print(busPlanner.getUtilization(period_us), 1);
+  Serial.println("%)");
+
+  // 再送の期限(MOTOR_COM_BUDGET_US)に収まらないと再送する余裕がない
+  if (!busPlanner.fits(MOTOR_COM_BUDGET_US)) {
+    Serial.println("[警告] モータ通信が通信時間の上限に収まりません（通信速度か応答データを見直してください）");
   }
-
-  *checksum1 = sum1;
-  *checksum2 = sum2;
 }
 
 // ラズパイにデータを送信（USBシリアル版）
@@ -816,17 +1212,17 @@ void sendDataToRaspberryPi() {
   Serial.print(",");
 
   // IMUデータ
-  Serial.print(current_roll, 4);
+  Serial.print(ahrs.euler[0], 4);
   Serial.print(",");
-  Serial.print(current_pitch, 4);
+  Serial.print(ahrs.euler[1], 4);
   Serial.print(",");
-  Serial.print(current_yaw, 4);
+  Serial.print(ahrs.euler[2], 4);
   Serial.print(",");
-  Serial.print(gyro_x, 4);
+  Serial.print(ahrs.angularRate[0], 4);
   Serial.print(",");
-  Serial.print(gyro_y, 4);
+  Serial.print(ahrs.angularRate[1], 4);
   Serial.print(",");
-  Serial.print(gyro_z, 4);
+  Serial.print(ahrs.angularRate[2], 4);
   Serial.print(",");
 
   // モータ・支持脚データ
@@ -849,31 +1245,35 @@ void sendDataToRaspberryPi() {
 
 // ========== モータエンコーダ関連関数 ==========
 void updateMotorState() {
-  // PMXモータからエンコーダ値とステータスを読み取り
-  long receiveData[8];
-  // トルク制御中でも位置情報を取得
-  byte receiveMode = PMX::ReceiveDataOption::Position;  // エンコーダ位置を取得
-  uint16_t flag = pmx.MotorREAD(SERVO_ID, receiveMode, receiveData, PMX::ControlMode::Torque);
+  // 位置は前の周期のMotorWRITEの応答から取る（テレメトリのローテータは位置を毎回応答に含める）
+  // 応答モードは位置だけではないので、位置だけのMotorREADは受信データ数が合わずにエラーになる
+  long position = 0;
+  uint16_t flag = 0;
+  bool from_write = motor_position_fresh;
+  if (from_write) {
+    position = motor_position_raw;
+    motor_position_fresh = false;
+  } else {
+    // MotorWRITEしなかった周期（トルクOFF中・通信エラー）はサーボの応答モードでMotorREADする
+    flag = readMotorPosition(&position);
+    linkStats.record(SERVO_ID, flag);
+  }
 
   // デバッグ: 読み取り結果を表示（常時有効）
   static unsigned long last_debug = 0;
   if (millis() - last_debug > 1000) {
-    Serial.print("[MOTOR READ] flag=");
+    Serial.print("[MOTOR READ] ");
+    Serial.print(from_write ? "MotorWRITE応答" : "MotorREAD");
+    Serial.print(" flag=");
     Serial.print(flag, HEX);
-    Serial.print(" data[0]=");
-    Serial.print(receiveData[0]);
-    Serial.print(" data[1]=");
-    Serial.print(receiveData[1]);
-    Serial.print(" data[2]=");
-    Serial.print(receiveData[2]);
-    Serial.print(" data[3]=");
-    Serial.println(receiveData[3]);
+    Serial.print(" position=");
+    Serial.println(position);
     last_debug = millis();
   }
 
   if (flag == 0) {
     // ===== VERSION 2.1: PMXは度×100形式でデータを返す =====
-    int32_t position_deg_x100 = (int32_t)receiveData[1];  // 度×100形式
+    int32_t position_deg_x100 = (int32_t)position;  // 度×100形式
 
     // 360度を超える値の正規化（累積角度の場合）
     while (position_deg_x100 > 18000) position_deg_x100 -= 36000;   // 180度超えは-360度
@@ -947,7 +1347,7 @@ void calculateLegState() {
   }
 
   // 支持脚角度の計算
-  theta_leg = M_PI - thetaq - current_pitch + (M_PI/4) * walk_count;
+  theta_leg = M_PI - thetaq - ahrs.euler[1] + (M_PI/4) * walk_count;
 
   // 支持脚切り替え検出
   if (previous_thetaq - thetaq > 6.0) {
@@ -988,15 +1388,31 @@ void calculateLegState() {
   last_leg_time = now;
 }
 
-void initializeEncoder() {
-  // モータ初期位置を取得
+// サーボに設定されている応答モードでMotorREADし、位置（度×100）を読む
+// ローテータが応答モードを切り替えていなければ、setupMotorTorqueModeで設定した位置だけのモード
+uint16_t readMotorPosition(long *position) {
   long receiveData[8];
-  byte receiveMode = PMX::ReceiveDataOption::Position;  // 位置情報を取得
+  byte receiveMode = telemetry.getActiveMode();
+  if (receiveMode == PMX::ErrorByteData) {
+    receiveMode = PMX::ReceiveDataOption::Position;
+  }
   uint16_t flag = pmx.MotorREAD(SERVO_ID, receiveMode, receiveData, PMX::ControlMode::Torque);
+  if ((flag & PMX::ComError::ErrorMask) == PMX::ComError::MotorREADConvertError) {
+    // 応答モードが想定と違うので、次のMotorWRITEで書き直させる
+    telemetry.invalidateActiveMode();
+  }
+  *position = receiveData[0];  // [位置,速度,電流,トルク,PWM,モータ温度,CPU温度,電圧]の位置
+  return flag;
+}
+
+void initializeEncoder() {
+  // モータ初期位置を取得
+  long position = 0;
+  uint16_t flag = readMotorPosition(&position);
 
   if (flag == 0) {
     // VERSION 2.1: 度×100形式として解釈
-    int32_t initial_pos_x100 = (int32_t)receiveData[1];
+    int32_t initial_pos_x100 = (int32_t)position;
 
     // 360度超えの正規化
     while (initial_pos_x100 > 18000) initial_pos_x100 -= 36000;
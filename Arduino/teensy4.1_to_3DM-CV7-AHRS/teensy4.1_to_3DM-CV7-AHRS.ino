@@ -1,6 +1,7 @@
 // Teensy 4.1 USBホスト + 3DM-CV7-AHRS 通信例
 
 #include "USBHost_t36.h"
+#include <MipParser.h>
 
 // USBホストオブジェクト
 USBHost myusb;
@@ -12,13 +13,26 @@ USBSerial userial(myusb, 1); // 標準バッファサイズで十分
 const bool DEBUG_MODE = true;  // デバッグ出力の有効/無効
 const bool SKIP_CHECKSUM = true;  // チェックサム検証をスキップ（デバッグ用）
 
-// データバッファ
-uint8_t buffer[1024];  // バッファサイズを増加
-int bufferIndex = 0;
+// 受信データのリングバッファ（詰め直しなし、溢れた分は数える）
+MipRing<4096> mipRing;
+// USBシリアルからリングバッファへまとめて移す
+MipIngest mipIngest;
+// 受信処理にかかった時間（5秒ごとの表示で使用）
+unsigned long ingestMicros = 0;
+// MIPパケットの切り出し（1byteずつ状態遷移で処理する）
+MipFramer framer;
+// (ディスクリプタセット, フィールド)の表でハンドラに振り分ける
+MipDispatcher mipDispatcher;
+// 設定コマンドを順番に送信し、ACK/NACKを待つ（delayで待たない）
+MipExecutor mipExecutor;
+// 基本周波数を問い合わせ、出力周波数から分周比を求めて設定する
+MipRateConfig sensorRate;
+const uint16_t SENSOR_RATE_HZ = 100;  // オイラー角の出力周波数[Hz]（1回ごとに表示するため100Hz、最大1000Hz）
+// 0x82パケットの受信周波数と受信間隔のジッタ
+MipRateMonitor filterRate;
 
-// MIPプロトコル用定数
-const uint8_t SYNC1 = 0x75;
-const uint8_t SYNC2 = 0x65;
+// 1秒間に受信した0x82パケットの数（レート表示用）
+int filterPacketCount = 0;
 
 // 接続状態管理
 bool sensorConnected = false;
@@ -51,6 +65,13 @@ void setup() {
   Serial.println("USBホスト初期化中...");
   myusb.begin();
   Serial.println("USBホスト初期化完了");
+
+  // 完成したパケットはonMipPacketからmipDispatcherで各フィールドのハンドラに渡す
+  registerSensorFields();
+  framer.setHandler(onMipPacket);
+  framer.setVerifyChecksum(!SKIP_CHECKSUM);
+  mipExecutor.setHandler(onCommandResult);
+  sensorRate.addField(MIP::DescSet::Filter, MIP::FilterField::Euler, SENSOR_RATE_HZ);
   
   delay(2000);
   Serial.println("セットアップ完了 - メインループ開始");
@@ -69,7 +90,33 @@ void loop() {
     Serial.print("ms - センサー接続: ");
     Serial.print(userial ? "検出" : "未検出");
     Serial.print(" | 設定済み: ");
-    Serial.println(sensorConfigured ? "Yes" : "No");
+    Serial.print(sensorConfigured ? "Yes" : "No");
+    Serial.print(" | パケット: ");
+    Serial.print(framer.getPacketCount());
+    Serial.print(" チェックサムエラー: ");
+    Serial.print(framer.getChecksumErrorCount());
+    Serial.print(" 同期外れ: ");
+    Serial.print(framer.getSyncLossCount());
+    Serial.print(" サイズ異常: ");
+    Serial.print(framer.getOversizeCount());
+    Serial.print(" 未登録フィールド: ");
+    Serial.print(mipDispatcher.getUnknownFieldCount());
+    Serial.print(" バッファ溢れ: ");
+    Serial.print(mipRing.getOverflowBytes());
+    Serial.print("bytes 最大使用: ");
+    Serial.print(mipRing.getHighWater());
+    Serial.print(" | 受信処理: ");
+    Serial.print(ingestMicros / 5);
+    Serial.print("us/s 最大チャンク: ");
+    Serial.print(mipIngest.getMaxChunk());
+    Serial.print("bytes | 周波数: ");
+    Serial.print(filterRate.getRate(), 1);
+    Serial.print("Hz ジッタ: ");
+    Serial.print(filterRate.getJitter(), 0);
+    Serial.print("us 最大間隔: ");
+    Serial.print(filterRate.getMaxInterval());
+    Serial.println("us");
+    ingestMicros = 0;
     lastDebugTime = millis();
     
     // LED点滅で動作確認
@@ -99,6 +146,7 @@ void loop() {
       Serial.println("コマンド:");
       Serial.println("  'c' - センサーを設定");
       Serial.println("  's' - 状態確認");
+      Serial.println("  'i' - デバイス情報");
       Serial.println("━━━━━━━━━━━━━━━━━━━━━━━");
       sensorConfigured = true;  // 自動設定はスキップ
     }
@@ -106,6 +154,9 @@ void loop() {
     // データ読み取り
     if (sensorConfigured) {
       readSensorData();
+
+      // 設定コマンドの送信・再送（返信はonMipPacketで受け取る）
+      mipExecutor.update(userial, millis());
       
       // キーボード入力処理
       if (Serial.available() > 0) {
@@ -113,11 +164,26 @@ void loop() {
         if (cmd == 'c' || cmd == 'C') {
           Serial.println("\n📡 センサー設定コマンド送信...");
           configureSensor();
+        } else if (cmd == 'i' || cmd == 'I') {
+          MipCommand info;
+          info.buildGetDeviceInfo();
+          mipExecutor.enqueue(info);
         } else if (cmd == 's' || cmd == 'S') {
           Serial.println("\n📊 現在の状態:");
           Serial.println("- 0x80パケット = IMU生データ");
           Serial.println("- 0x82パケット = AHRSフィルターデータ");
-          Serial.println("- 0x05 = ジャイロ, 0x0C = オイラー角");
+          Serial.println("- (0x80, 0x05) = ジャイロ, (0x82, 0x05) = オイラー角, (0x82, 0x0E) = 角速度");
+          Serial.print("- コマンド: ACK=");
+          Serial.print(mipExecutor.getAckCount());
+          Serial.print(" NACK=");
+          Serial.print(mipExecutor.getNackCount());
+          Serial.print(" タイムアウト=");
+          Serial.print(mipExecutor.getTimeoutCount());
+          Serial.print(" 再送=");
+          Serial.print(mipExecutor.getRetryCount());
+          Serial.print(" 最大応答時間=");
+          Serial.print(mipExecutor.getMaxLatency());
+          Serial.println("ms");
         }
       }
     }
@@ -133,7 +199,10 @@ void loop() {
       Serial.println("センサーが切断されました");
       sensorConnected = false;
       sensorConfigured = false;
-      bufferIndex = 0; // バッファクリア
+      mipRing.flush(); // 溜まっているデータを破棄
+      framer.reset();  // 組み立て中のパケットを破棄
+      mipExecutor.cancel(); // 送信待ちのコマンドを中止
+      filterRate.reset();
     }
   }
 }
@@ -142,323 +211,213 @@ void configureSensor() {
   Serial.println("\n===== センサー設定開始 =====");
   Serial.println("⚠️ 注意: センサーが既に設定されている可能性があります");
   Serial.println("SensorConnectツールでの設定を確認してください");
-  
-  uint8_t checksum1, checksum2;
-  
-  // まず現在のデータストリームを確認するために少し待つ
-  Serial.println("\n現在のデータストリームを確認中...");
-  delay(1000);
-  
+
+  if (mipExecutor.isBusy()) {
+    Serial.println("前の設定コマンドの返信待ちです");
+    return;
+  }
+
+  // コマンドのLengthとFletcherチェックサムはMipCommandが計算する
+  // 送信はmipExecutorがloop()の中で行い、ACKを受信したらすぐ次のコマンドを送る
+  MipCommand cmd;
+
   // Step 1: Idleコマンドを送信（センサーをアイドル状態にする）
-  uint8_t idle_cmd[] = {
-    0x75, 0x65,  // Sync bytes
-    0x01,        // Base command set
-    0x02,        // Payload length
-    0x02,        // Set to Idle command
-    0x00, 0x00   // チェックサム
-  };
-  
-  calculateChecksum(idle_cmd, sizeof(idle_cmd) - 2, &checksum1, &checksum2);
-  idle_cmd[sizeof(idle_cmd) - 2] = checksum1;
-  idle_cmd[sizeof(idle_cmd) - 1] = checksum2;
-  
+  cmd.buildIdle();
+  mipExecutor.enqueue(cmd);
   Serial.println("\nStep 1: センサーをアイドル状態にする");
-  userial.write(idle_cmd, sizeof(idle_cmd));
-  delay(500);
-  
+
   // Step 2: AHRSメッセージフォーマットを設定（オイラー角のみ）
-  uint8_t set_ahrs_format[] = {
-    0x75, 0x65,  // Sync bytes
-    0x0C,        // Command set
-    0x0A,        // Payload length
-    0x08,        // Message Format command
-    0x02,        // Descriptor set (0x02 = AHRS/Filter)
-    0x01,        // Number of fields (1つ = オイラー角のみ)
-    0x0C,        // Field: Euler Angles
-    0x00, 0x01,  // Rate divider (every packet = 100Hz)
-    0x00, 0x00   // チェックサム
-  };
-  
-  calculateChecksum(set_ahrs_format, sizeof(set_ahrs_format) - 2, &checksum1, &checksum2);
-  set_ahrs_format[sizeof(set_ahrs_format) - 2] = checksum1;
-  set_ahrs_format[sizeof(set_ahrs_format) - 1] = checksum2;
-  
-  Serial.println("Step 2: AHRSフォーマット設定（オイラー角のみ @ 100Hz）");
-  userial.write(set_ahrs_format, sizeof(set_ahrs_format));
-  delay(200);
-  
-  // Step 3: AHRSストリームのみを有効化
-  uint8_t enable_ahrs_only[] = {
-    0x75, 0x65,  // Sync bytes
-    0x0C,        // Command set
-    0x05,        // Payload length
-    0x11,        // Enable Data Stream
-    0x01,        // Function selector
-    0x02,        // AHRS/Filter stream (0x82)
-    0x01,        // Enable
-    0x00, 0x00   // チェックサム
-  };
-  
-  calculateChecksum(enable_ahrs_only, sizeof(enable_ahrs_only) - 2, &checksum1, &checksum2);
-  enable_ahrs_only[sizeof(enable_ahrs_only) - 2] = checksum1;
-  enable_ahrs_only[sizeof(enable_ahrs_only) - 1] = checksum2;
-  
+  //         基本周波数を問い合わせてから、分周比 = 基本周波数 / SENSOR_RATE_HZ で設定する
+  // Step 3: AHRSストリームのみを有効化し、Resumeで出力を再開する
+  if (!sensorRate.start(mipExecutor)) {
+    Serial.println("出力周波数の設定を開始できません");
+    return;
+  }
+  Serial.print("Step 2: AHRSフォーマット設定（オイラー角のみ @ ");
+  Serial.print(SENSOR_RATE_HZ);
+  Serial.println("Hz）");
   Serial.println("Step 3: AHRSストリーム(0x82)のみを有効化");
-  userial.write(enable_ahrs_only, sizeof(enable_ahrs_only));
-  delay(200);
-  
+
   Serial.println("━━━━━━━━━━━━━━━━━━━━━━━");
-  Serial.println("✅ 設定送信完了！");
+  Serial.println("📨 設定コマンドを登録しました（結果はACK/NACKを受信した時に表示）");
   Serial.println("📊 期待される出力:");
   Serial.println("  - 0x82パケットのみ（0x80は停止）");
-  Serial.println("  - Filter内0x05 = オイラー角(Euler RPY) @ 100Hz");
+  Serial.print("  - Filter内0x05 = オイラー角(Euler RPY) @ ");
+  Serial.print(SENSOR_RATE_HZ);
+  Serial.println("Hz");
   Serial.println("  ※ 0x82内の0x05はオイラー角です（ジャイロではありません）");
   Serial.println("━━━━━━━━━━━━━━━━━━━━━━━");
   Serial.println();
 }
 
-// Pingコマンドは削除（不要）
+// 設定コマンドの結果（ACK/NACK/タイムアウト）
+void onCommandResult(const MipExecutor::Result& result, const uint8_t* reply, void* context) {
+  (void)context;
 
-void readSensorData() {
-  // USBシリアルからデータ読み取り
-  while (userial.available()) {
-    // バッファに余裕があるか確認
-    if (bufferIndex >= (int)(sizeof(buffer) - 1)) {
-      // バッファが満杯に近い場合、古いデータをシフト
-      shiftBuffer();
-    }
-    
-    uint8_t byte = userial.read();
-    buffer[bufferIndex++] = byte;
-    lastActivityTime = millis(); // アクティビティ記録
-    
-    // パケット検出と処理
-    processBuffer();
+  Serial.print(result.status == MipExecutor::Acked ? "  ✅ " : "  ❌ ");
+  Serial.print("コマンド 0x");
+  Serial.print(result.descSet, HEX);
+  Serial.print("/0x");
+  Serial.print(result.fieldDesc, HEX);
+  Serial.print(" ");
+  Serial.print(MipExecutor::statusName(result.status));
+  if (result.status == MipExecutor::Nacked) {
+    Serial.print(" code=0x");
+    Serial.print(result.code, HEX);
   }
-}
+  if (reply != nullptr) {
+    Serial.print(" (");
+    Serial.print(result.latency);
+    Serial.print("ms)");
+  }
+  Serial.println();
 
-void processBuffer() {
-  int processedBytes = 0;
-  
-  // バッファ内のすべてのパケットを処理
-  while (processedBytes < bufferIndex - 3) {
-    // Sync bytesを探す
-    bool foundPacket = false;
-    
-    for (int i = processedBytes; i <= bufferIndex - 4; i++) {
-      if (buffer[i] == SYNC1 && buffer[i+1] == SYNC2) {
-        // MIPパケット発見
-        uint8_t length = buffer[i+3];
-        
-        // 完全なパケットがあるか確認
-        int packetSize = 4 + length + 2; // header(4) + payload + checksum(2)
-        if (i + packetSize <= bufferIndex) {
-          // デバッグ: パケット情報表示
-          if (DEBUG_MODE) {
-            Serial.print("パケット検出: Desc=0x");
-            Serial.print(buffer[i+2], HEX);
-            Serial.print(" Len=");
-            Serial.print(length);
-            Serial.print(" Size=");
-            Serial.println(packetSize);
-          }
-          
-          // チェックサム検証
-          bool checksumOK = verifyChecksum(&buffer[i], packetSize);
-          if (SKIP_CHECKSUM || checksumOK) {
-            processMIPPacket(&buffer[i], packetSize);
-          } else {
-            // チェックサムエラーの詳細表示
-            Serial.print("チェックサムエラー: ");
-            uint8_t calc1, calc2;
-            calculateChecksum(&buffer[i], packetSize - 2, &calc1, &calc2);
-            Serial.print("計算値=0x");
-            if (calc1 < 0x10) Serial.print("0");
-            Serial.print(calc1, HEX);
-            if (calc2 < 0x10) Serial.print("0");
-            Serial.print(calc2, HEX);
-            Serial.print(" 受信値=0x");
-            if (buffer[i + packetSize - 2] < 0x10) Serial.print("0");
-            Serial.print(buffer[i + packetSize - 2], HEX);
-            if (buffer[i + packetSize - 1] < 0x10) Serial.print("0");
-            Serial.println(buffer[i + packetSize - 1], HEX);
-          }
-          
-          processedBytes = i + packetSize;
-          foundPacket = true;
-          break;
-        } else {
-          // 不完全なパケット - 後で処理
-          processedBytes = i;
-          foundPacket = false;
-          break;
-        }
+  // 基本周波数の返信が揃ったら、MipRateConfigがMessage Format等を登録する
+  bool wasDone = sensorRate.isDone();
+  sensorRate.handleResult(result, reply);
+  if (!wasDone && sensorRate.isDone()) {
+    Serial.print("  出力周波数: 基本周波数=");
+    Serial.print(sensorRate.getBaseRate(MIP::DescSet::Filter));
+    Serial.print("Hz 分周比=");
+    Serial.print(sensorRate.getDecimation(MIP::DescSet::Filter, MIP::FilterField::Euler));
+    Serial.print(" → ");
+    Serial.print(sensorRate.getActualRate(MIP::DescSet::Filter, MIP::FilterField::Euler), 1);
+    Serial.println("Hz");
+  }
+
+  // Get Device Informationの返信はACKと同じパケットに入っている
+  if (result.status == MipExecutor::Acked && reply != nullptr
+      && result.descSet == MIP::DescSet::Base && result.fieldDesc == MIP::BaseCmd::GetDeviceInfo) {
+    MipFieldReader reader(reply);
+    MipField field;
+    while (reader.next(field)) {
+      if (field.descriptor == MIP::ReplyField::DeviceInfo && field.length >= MipDeviceInfoView::Size) {
+        MipDeviceInfoView info(field);
+        char text[MipDeviceInfoView::StringLength + 1];
+        info.modelName(text);
+        Serial.print("  モデル: ");
+        Serial.print(text);
+        info.serialNumber(text);
+        Serial.print(" シリアル: ");
+        Serial.print(text);
+        Serial.print(" FW: ");
+        Serial.println(info.firmwareVersion());
       }
     }
-    
-    if (!foundPacket) {
-      break;
-    }
-  }
-  
-  // 処理済みデータを削除
-  if (processedBytes > 0) {
-    memmove(buffer, &buffer[processedBytes], bufferIndex - processedBytes);
-    bufferIndex -= processedBytes;
   }
 }
 
-void shiftBuffer() {
-  // バッファの前半を削除してスペースを作る
-  int shiftAmount = bufferIndex / 2;
-  memmove(buffer, &buffer[shiftAmount], bufferIndex - shiftAmount);
-  bufferIndex -= shiftAmount;
-  Serial.println("警告: バッファシフト実行");
-}
+// Pingコマンドは削除（不要）
 
-bool verifyChecksum(uint8_t* packet, int length) {
-  uint8_t calc_checksum1, calc_checksum2;
-  calculateChecksum(packet, length - 2, &calc_checksum1, &calc_checksum2);
-  
-  return (packet[length - 2] == calc_checksum1 && 
-          packet[length - 1] == calc_checksum2);
+void readSensorData() {
+  unsigned long start = micros();
+
+  // USBシリアルに溜まっているデータをまとめてリングバッファへ移す
+  if (mipIngest.read(userial, mipRing, start) > 0) {
+    lastActivityTime = millis(); // アクティビティ記録（受信1回につき1度だけ）
+  }
+
+  // 溜まったデータをパケットに切り出す（各byteは1回だけ処理される）
+  framer.drain(mipRing);
+  filterRate.update(micros());
+
+  ingestMicros += micros() - start;
 }
 
-void processMIPPacket(uint8_t* packet, int length) {
-  uint8_t descriptor = packet[2];
-  uint8_t payload_length = packet[3];
-  
+void onMipPacket(const uint8_t* packet, int length, void* context) {
+  (void)context;
+
+  // 設定コマンドの返信（ACK/NACK）はmipExecutorで処理する
+  if (mipExecutor.handlePacket(packet, millis())) {
+    return;
+  }
+
+  uint8_t descriptor = packet[MIP::BuffPter::Descriptor];
+  uint8_t payload_length = packet[MIP::BuffPter::Length];
+
+  // デバッグ: パケット情報表示
+  if (DEBUG_MODE) {
+    Serial.print("パケット検出: Desc=0x");
+    Serial.print(descriptor, HEX);
+    Serial.print(" Len=");
+    Serial.print(payload_length);
+    Serial.print(" Size=");
+    Serial.println(length);
+  }
+
   // AHRSデータセット (0x82) - オイラー角データ
-  if (descriptor == 0x82) {
+  if (descriptor == MIP::DescSet::Filter) {
     // デバッグモードでのみ詳細表示
     if (DEBUG_MODE) {
       Serial.print("📦 0x82 (");
       Serial.print(payload_length);
       Serial.print("bytes) ");
     }
-    parseAHRSData(&packet[4], payload_length);
+    filterPacketCount++;
+    filterRate.record(mipIngest.getLastStamp());  // USBから読み出した時刻
   }
   // IMUデータ (0x80) - 無効化されているはずだが、来た場合は警告
-  else if (descriptor == 0x80) {
+  else if (descriptor == MIP::DescSet::Imu) {
     static unsigned long lastWarning = 0;
     if (millis() - lastWarning > 5000) {  // 5秒ごとに警告
       Serial.println("⚠️ IMUデータ(0x80)が受信されています - 無効化を確認してください");
       lastWarning = millis();
     }
+    return;
   }
+
+  // 登録したフィールドだけハンドラに渡す（それ以外は読み飛ばして数える）
+  mipDispatcher.dispatch(packet);
 }
 
-// IMUデータ解析は不要なので削除
-void parseIMUData(uint8_t* data, int length) {
-  // 0x80パケットは完全に無視
-  (void)data;    // 未使用パラメータの警告を抑制
-  (void)length;
-  return;
+// 使用するフィールドのハンドラを登録する
+// 注意: IMU(0x80)の0x05はジャイロだが、Filter(0x82)の0x05はオイラー角
+// フィールドを増やす時はここに登録を追加する
+void registerSensorFields() {
+  mipDispatcher.on(MIP::DescSet::Filter, MIP::FilterField::Euler, onFilterEuler);
+  mipDispatcher.on(MIP::DescSet::Filter, MIP::SharedField::GpsTimestamp, onGpsTimestamp);
 }
 
-void parseAHRSData(uint8_t* data, int length) {
-  int idx = 0;  // indexではなくidxを使用（名前競合回避）
+// Estimation Filter (0x82)内での0x05 = オイラー角（Attitude Euler RPY）
+// データ構造: Roll(4) + Pitch(4) + Yaw(4) + Flags(2)
+void onFilterEuler(const MipEulerView& euler, void* context) {
+  (void)context;
   static unsigned long lastPrintTime = 0;
-  static int packetCount = 0;
   
-  packetCount++;
+  // 度に変換（3成分をまとめて変換し、掛け算はfloatのまま行う）
+  float rpy_deg[3];
+  euler.getDegrees(rpy_deg);
+  float roll_deg = rpy_deg[0];
+  float pitch_deg = rpy_deg[1];
+  float yaw_deg = rpy_deg[2];
   
-  while (idx < length - 2) {
-    uint8_t field_length = data[idx];
-    uint8_t field_descriptor = data[idx + 1];
-    
-    if (field_length == 0 || field_length > length - idx) break;
-    
-    // Estimation Filter (0x82)内での0x05 = オイラー角（Attitude Euler RPY）
-    // 注意: IMU(0x80)の0x05はジャイロだが、Filter(0x82)の0x05はオイラー角
-    if (field_descriptor == 0x05 && field_length >= 16) {
-      // データ構造: Roll(4) + Pitch(4) + Yaw(4) + Flags(4) = 16バイト
-      float roll = parseFloat(&data[idx + 2]);
-      float pitch = parseFloat(&data[idx + 6]);
-      float yaw = parseFloat(&data[idx + 10]);
-      // 最後の4バイトはステータスフラグ
-      
-      // 度に変換
-      float roll_deg = roll * 180.0 / PI;
-      float pitch_deg = pitch * 180.0 / PI;
-      float yaw_deg = yaw * 180.0 / PI;
-      
-      // 通常の出力
-      Serial.print("🎯 [");
-      Serial.print(millis());
-      Serial.print("ms] Roll=");
-      Serial.print(roll_deg, 2);
-      Serial.print("° Pitch=");
-      Serial.print(pitch_deg, 2);
-      Serial.print("° Yaw=");
-      Serial.print(yaw_deg, 2);
-      Serial.print("°");
-      
-      // 100Hz確認用のレート表示（1秒ごと）
-      unsigned long currentTime = millis();
-      if (currentTime - lastPrintTime >= 1000) {
-        Serial.print(" | Rate: ");
-        Serial.print(packetCount);
-        Serial.print("Hz");
-        packetCount = 0;
-        lastPrintTime = currentTime;
-      }
-      
-      Serial.println();
-    }
-    // 0x0C - IMUデータセットでのオイラー角（今回は使用しない）
-    else if (field_descriptor == 0x0C && field_length >= 14) {
-      Serial.println("⚠️ IMU形式のオイラー角(0x0C)を受信");
-    }
-    // GPSタイムスタンプ (0xD3)
-    else if (field_descriptor == 0xD3 && field_length >= 14) {
-      Serial.println("⏰ タイムスタンプ受信");
-    }
-    // 加速度データ(0x04)
-    else if (field_descriptor == 0x04 && field_length >= 14) {
-      Serial.println("⚠️ 加速度データ(0x04)を受信");
-    }
-    // その他の未知フィールド
-    else {
-      Serial.print("⚠️ 未知のフィールド: 0x");
-      Serial.print(field_descriptor, HEX);
-      Serial.print(" (Length=");
-      Serial.print(field_length);
-      Serial.println(")");
-    }
-    
-    idx += field_length;
-  }
-}
-
-// ビッグエンディアンのfloatをパース（簡略化）
-float parseFloat(uint8_t* bytes) {
-  union {
-    float f;
-    uint8_t b[4];
-  } u;
+  // 通常の出力
+  Serial.print("🎯 [");
+  Serial.print(millis());
+  Serial.print("ms] Roll=");
+  Serial.print(roll_deg, 2);
+  Serial.print("° Pitch=");
+  Serial.print(pitch_deg, 2);
+  Serial.print("° Yaw=");
+  Serial.print(yaw_deg, 2);
+  Serial.print("°");
   
-  // ビッグエンディアンからリトルエンディアンへ変換
-  // Teensyは常にリトルエンディアン
-  u.b[0] = bytes[3];
-  u.b[1] = bytes[2];
-  u.b[2] = bytes[1];
-  u.b[3] = bytes[0];
+  // 100Hz確認用のレート表示（1秒ごと）
+  unsigned long currentTime = millis();
+  if (currentTime - lastPrintTime >= 1000) {
+    Serial.print(" | Rate: ");
+    Serial.print(filterPacketCount);
+    Serial.print("Hz");
+    filterPacketCount = 0;
+    lastPrintTime = currentTime;
+  }
   
-  return u.f;
+  Serial.println();
 }
 
-// MIPプロトコル用のFletcher-16チェックサム計算
-void calculateChecksum(uint8_t* data, int length, uint8_t* checksum1, uint8_t* checksum2) {
-  uint8_t sum1 = 0;
-  uint8_t sum2 = 0;
-  
-  // Fletcher-16チェックサムアルゴリズム
-  for (int i = 0; i < length; i++) {
-    sum1 = (sum1 + data[i]) & 0xFF;
-    sum2 = (sum2 + sum1) & 0xFF;
-  }
-  
-  *checksum1 = sum1;
-  *checksum2 = sum2;
-}
\ No newline at end of file
+// GPSタイムスタンプ (0xD3)
+void onGpsTimestamp(const MipGpsTimestampView& timestamp, void* context) {
+  (void)context;
+  (void)timestamp;
+  Serial.println("⏰ タイムスタンプ受信");
+}